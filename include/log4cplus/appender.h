@@ -94,6 +94,35 @@ namespace log4cplus {
          */
         virtual void close() = 0;
 
+        /**
+         * Flush any output buffered by this appender to its
+         * destination.  The default implementation does nothing.
+         */
+        virtual void flush();
+
+        /**
+         * Called before the process forks, see Hierarchy::atforkPrepare().
+         * The default implementation waits for a pending append to
+         * complete, keeps other threads from appending until the fork is
+         * over and calls flush(), so that buffered output is written
+         * once rather than by both processes.
+         */
+        virtual void atforkPrepare();
+
+        /**
+         * Called in the parent process after fork().  The default
+         * implementation undoes atforkPrepare().
+         */
+        virtual void atforkParent();
+
+        /**
+         * Called in the child process after fork(), where only the
+         * forking thread exists.  The default implementation makes the
+         * appender usable again.  Appenders that run threads or hold
+         * connections start or open their own ones here.
+         */
+        virtual void atforkChild();
+
         /**
          * This method performs threshold checks and invokes filters before
          * delegating actual logging to the subclasses specific {@link
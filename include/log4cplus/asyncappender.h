@@ -0,0 +1,243 @@
+// -*- C++ -*-
+// Module:  Log4CPLUS
+// File:    asyncappender.h
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file */
+
+#ifndef LOG4CPLUS_ASYNCAPPENDER_HEADER_
+#define LOG4CPLUS_ASYNCAPPENDER_HEADER_
+
+#include <log4cplus/config.hxx>
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+
+#include <log4cplus/appender.h>
+#include <log4cplus/helpers/appenderattachableimpl.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/thread/syncprims.h>
+#include <log4cplus/thread/threads.h>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+
+namespace log4cplus {
+
+    /**
+     * AsyncAppender hands events over to a background thread which
+     * passes them on to the attached appenders, so that the logging
+     * thread does not wait for slow destinations.
+     *
+     * Queued events are kept in two lanes.  Events at or above
+     * <code>PriorityThreshold</code> go to the priority lane, which
+     * the background thread always drains first, so that an ERROR does
+     * not wait behind a backlog of DEBUG messages.  The order of events
+     * is kept within each lane, but not across the lanes.
+     *
+     * With <code>FormatterThreads</code> set, a pool of threads formats
+     * queued events with the layouts of the attached appenders in
+     * parallel.  Each event carries a sequence number assigned when it
+     * is queued, and the formatted events are passed on in that order.
+     * The layouts then only write out the ready text.  Layouts of the
+     * attached appenders must not be replaced while the appender is in
+     * use.
+     *
+     * <h3>Properties</h3>
+     * <dl>
+     * <dt><tt>Appender</tt></dt>
+     * <dd>Class name of the appender the events are passed to.  Its
+     * properties are given with the <tt>Appender.</tt> prefix, e.g.
+     * <tt>Appender.File</tt>.</dd>
+     *
+     * <dt><tt>QueueLimit</tt></dt>
+     * <dd>Number of events the queue can hold, at least 1.  Default
+     * is 100.</dd>
+     *
+     * <dt><tt>Blocking</tt></dt>
+     * <dd>When it is set true (the default), a logging thread waits for
+     * free space in a full queue.  Otherwise an event that does not fit
+     * is dropped.</dd>
+     *
+     * <dt><tt>PriorityThreshold</tt></dt>
+     * <dd>Events at or above this LogLevel use the priority lane.
+     * Default is ERROR.</dd>
+     *
+     * <dt><tt>PriorityReserve</tt></dt>
+     * <dd>Additional room, beyond <tt>QueueLimit</tt>, that only
+     * priority events may use.  Default is 16.  When even that is
+     * exhausted and <tt>Blocking</tt> is false, the oldest event of the
+     * normal lane is dropped instead, so that a priority event is never
+     * dropped while lower ones are still queued.</dd>
+     *
+     * <dt><tt>FlushOnPriority</tt></dt>
+     * <dd>When it is set true (the default), the attached appenders are
+     * flushed as soon as a batch of priority events has been passed
+     * on.</dd>
+     *
+     * <dt><tt>FormatterThreads</tt></dt>
+     * <dd>Number of threads formatting events in parallel.  Default is
+     * 0, in which case a single thread passes events on and the attached
+     * appenders format them.</dd>
+     *
+     * <dt><tt>CPUs</tt></dt>
+     * <dd>CPUs the background threads may run on, e.g. <tt>0-3,8</tt>.
+     * See thread::ThreadPlacement.</dd>
+     *
+     * <dt><tt>NumaNode</tt></dt>
+     * <dd>NUMA node the background threads run on.</dd>
+     *
+     * </dl>
+     *
+     * The appender may be used across fork().  Events queued before the
+     * fork are passed on by the parent only, and the child process gets
+     * its own background threads.
+     */
+    class LOG4CPLUS_EXPORT AsyncAppender
+        : public Appender
+        , public helpers::AppenderAttachableImpl
+    {
+    public:
+      // Ctors
+        AsyncAppender(SharedAppenderPtr const & app, unsigned queueLimit);
+        AsyncAppender(helpers::Properties const & properties);
+
+      // Dtor
+        virtual ~AsyncAppender();
+
+      // Methods
+        /**
+         * Passes on the queued events, stops the background threads and
+         * closes and removes the attached appenders.
+         */
+        virtual void close();
+
+        /**
+         * Waits until all events queued so far have been passed on and
+         * then flushes the attached appenders.
+         */
+        virtual void flush();
+
+        /** Returns the number of events dropped because of overflow. */
+        unsigned long getDroppedCount() const;
+
+        /**
+         * Drains the queue and prepares the attached appenders.  The
+         * background threads are idle while the process forks.
+         */
+        virtual void atforkPrepare();
+        virtual void atforkParent();
+
+        /**
+         * Starts new background threads, as those of the parent do not
+         * exist in the child.
+         */
+        virtual void atforkChild();
+
+    protected:
+        virtual void append(spi::InternalLoggingEvent const & event);
+
+        enum Lane
+        {
+            PRIORITY_LANE,
+            NORMAL_LANE,
+            LANE_COUNT
+        };
+
+        struct QueueEntry
+        {
+            QueueEntry (unsigned long seq, spi::InternalLoggingEvent const &);
+
+            unsigned long seq;
+            spi::InternalLoggingEvent event;
+            //! Set for events dropped after their sequence number was taken.
+            bool dropped;
+        };
+
+        typedef std::deque<QueueEntry> EventQueue;
+        typedef std::map<unsigned long, QueueEntry> ReorderBuffer;
+
+        void init(thread::ThreadPlacement const & placement);
+        void startDispatchers(thread::ThreadPlacement const & placement);
+        void flushAppenders();
+
+        void dispatchEvents();
+        void formatEvents();
+        void commitEvents();
+        void formatEvent(spi::InternalLoggingEvent const & event);
+        void passOn(EventQueue const & batch, bool priority);
+
+        class LOG4CPLUS_EXPORT DispatcherThread;
+        friend class DispatcherThread;
+
+        class LOG4CPLUS_EXPORT DispatcherThread
+            : public thread::AbstractThread
+        {
+        public:
+            DispatcherThread (AsyncAppender &);
+            virtual ~DispatcherThread ();
+
+            virtual void run();
+
+        protected:
+            AsyncAppender & aa;
+        };
+
+      // Data
+        unsigned queueLimit;
+        unsigned priorityReserve;
+        LogLevel priorityThreshold;
+        bool blocking;
+        bool flushOnPriority;
+        unsigned formatterThreads;
+
+        thread::Mutex queue_mutex;
+        //! Signalled when an event has been queued.
+        thread::ManualResetEvent queue_ev;
+        //! Signalled when room has been made in the queue.
+        thread::ManualResetEvent space_ev;
+        //! Signalled when queued events have been passed on.
+        thread::ManualResetEvent done_ev;
+        EventQueue lanes[LANE_COUNT];
+        //! Next sequence number to assign, per lane.
+        unsigned long nextSeq[LANE_COUNT];
+        //! Next sequence number to pass on, per lane.
+        unsigned long commitSeq[LANE_COUNT];
+        //! Formatted events waiting for their turn, per lane.
+        ReorderBuffer formattedEvents[LANE_COUNT];
+        //! Set while a formatter thread passes events on.
+        bool committing;
+        unsigned long queuedCount;
+        unsigned long doneCount;
+        unsigned long droppedCount;
+        bool exit_flag;
+
+        std::vector<helpers::SharedObjectPtr<DispatcherThread> > dispatchers;
+
+    private:
+      // Disallow copying of instances of this class
+        AsyncAppender(const AsyncAppender&);
+        AsyncAppender& operator=(const AsyncAppender&);
+    };
+
+} // end namespace log4cplus
+
+#endif // LOG4CPLUS_SINGLE_THREADED
+
+#endif // LOG4CPLUS_ASYNCAPPENDER_HEADER_
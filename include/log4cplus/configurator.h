@@ -188,6 +188,20 @@ namespace log4cplus
          * "log4cplus.disableOverride" to <code>true</code> or any value other
          * than false. As in <pre>log4cplus.disableOverride=true </pre>
          *
+         * The clock used to timestamp events is selected by the
+         * "log4cplus.eventClock" key, with one of the values
+         * <code>REALTIME</code> (the default), <code>REALTIME_COARSE</code>
+         * or <code>TSC</code>.  See helpers::Time::EventClock.
+         *
+         * Keys with the "log4cplus.governor." prefix configure the
+         * LoadGovernor of the hierarchy, e.g.
+         * <pre>log4cplus.governor.EventsPerSecond=10000</pre>
+         *
+         * Events at or above the LogLevel given by the
+         * "log4cplus.backtraceLevel" key carry the backtrace of the
+         * logging call, which PatternLayout outputs with <b>%S</b>.  See
+         * helpers::setBacktraceThreshold().
+         *
          * <h3>Example</h3>
          *
          * An example configuration is given below.
@@ -278,6 +292,9 @@ namespace log4cplus
         void configureLogger(log4cplus::Logger logger, const log4cplus::tstring& config);
         void configureAppenders();
         void configureAdditivity();
+        void configureEventClock();
+        void configureLoadGovernor();
+        void configureBacktrace();
         
         virtual Logger getLogger(const log4cplus::tstring& name);
         virtual void addAppender(Logger &logger, log4cplus::SharedAppenderPtr& appender);
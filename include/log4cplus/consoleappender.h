@@ -26,6 +26,10 @@
 
 #include <log4cplus/config.hxx>
 #include <log4cplus/appender.h>
+#include <log4cplus/streams.h>
+
+#include <sstream>
+#include <string>
 
 namespace log4cplus {
     /**
@@ -41,7 +45,36 @@ namespace log4cplus {
      *
      * <dt><tt>ImmediateFlush</tt></dt>
      * <dd>When it is set true, output stream will be flushed after
-     * each appended event.</dd>
+     * each appended event.  It is false by default, except with
+     * <tt>DirectWrite</tt>.</dd>
+     *
+     * <dt><tt>DirectWrite</tt></dt>
+     * <dd>When it is set true, events are written to the standard
+     * output or error descriptor with <code>write()</code>, bypassing
+     * the iostreams and the LogLog lock.  Each event is written with
+     * one call unless <tt>ImmediateFlush</tt> is set false.  Then
+     * events are batched up to <code>PIPE_BUF</code> bytes and written
+     * when the batch is full, on flush() or on close().  This saves
+     * system calls, but the last batch may wait indefinitely and is
+     * lost if the process exits without log4cplus::shutdown().
+     * Batches are not longer, so that writing one to a pipe is atomic;
+     * only an event longer than <code>PIPE_BUF</code> is written on its
+     * own in several steps.  Only available where
+     * <code>unistd.h</code> is.</dd>
+     *
+     * <dt><tt>NonBlocking</tt></dt>
+     * <dd>With <tt>DirectWrite</tt>, when it is set true and the
+     * output is a pipe, writes do not wait for the reader.  A batch
+     * that finds the pipe full is dropped and counted, see
+     * getDroppedCount().  An event longer than <code>PIPE_BUF</code>
+     * that fills the pipe part way waits at most 100 ms for the reader
+     * before the rest of it is dropped, too.  The pipe is opened anew
+     * for this (Linux), so that other writers to it are not
+     * affected.</dd>
+     *
+     * <dt><tt>PipeSize</tt></dt>
+     * <dd>With <tt>DirectWrite</tt>, when the output is a pipe, its
+     * capacity is set to this many bytes (Linux).</dd>
      * 
      * </dl>
      */
@@ -56,10 +89,23 @@ namespace log4cplus {
 
       // Methods
         virtual void close();
+        virtual void flush();
+
+        /**
+         * Returns the number of events dropped by <tt>NonBlocking</tt>
+         * writes.
+         */
+        unsigned long getDroppedCount() const;
 
     protected:
         virtual void append(const spi::InternalLoggingEvent& event);
 
+        void initDirectWrite(bool nonBlocking, unsigned long pipeSize);
+        void writeBuffer();
+        //! Writes the first <code>size</code> bytes of buffer, which
+        //! hold <code>events</code> events.
+        void writeBatch(std::size_t size, unsigned long events);
+
       // Data
         bool logToStdErr;
         /**
@@ -67,6 +113,18 @@ namespace log4cplus {
          * will be flushed at the end of each append operation.
          */
         bool immediateFlush;
+
+        //! Descriptor written to in DirectWrite mode, -1 otherwise.
+        int fd;
+        //! Set when fd was opened by this appender.
+        bool ownFd;
+        //! Formatted events waiting to be written.
+        std::string buffer;
+        unsigned long bufferedEvents;
+        unsigned long droppedCount;
+        //! Part of droppedCount not reported to LogLog yet.
+        unsigned long unreportedDrops;
+        log4cplus::tostringstream formatBuffer;
     };
 
 } // end namespace log4cplus
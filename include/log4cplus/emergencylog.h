@@ -0,0 +1,114 @@
+// -*- C++ -*-
+// Module:  Log4CPLUS
+// File:    emergencylog.h
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file */
+
+
+/** @file
+ * An async-signal-safe logging path for signal and crash handlers.
+ *
+ * Regular logging allocates memory, takes locks and uses iostreams, so
+ * it can deadlock or crash when it is called from a signal handler.
+ * emergencyLog() does none of these.  It formats a record of the form
+ *
+ * <pre>2026-10-18 12:34:56.789Z FATAL message</pre>
+ *
+ * into a buffer on the stack, with the timestamp in UTC, and either
+ * writes it to a file descriptor with <code>write(2)</code> only or
+ * copies it into a buffer allocated in advance.  Records longer than
+ * 512 bytes are truncated.
+ *
+ * installFatalSignalHandlers() logs fatal signals this way and makes
+ * the appenders of the default hierarchy write out what they buffer,
+ * including the queues of AsyncAppender, before the process dies.
+ */
+
+#ifndef LOG4CPLUS_EMERGENCYLOG_HEADER_
+#define LOG4CPLUS_EMERGENCYLOG_HEADER_
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/loglevel.h>
+
+#include <cstddef>
+#include <string>
+
+
+namespace log4cplus {
+
+    /**
+     * Sets where emergencyLog() puts records.  With <code>fd</code> at
+     * or above 0 they are written to it, otherwise they are kept in a
+     * buffer of <code>bufferSize</code> bytes allocated here; records
+     * that no longer fit are dropped.  By default records are written
+     * to standard error.
+     *
+     * This function is not async-signal-safe.  Call it before
+     * installing handlers that use emergencyLog().
+     */
+    LOG4CPLUS_EXPORT void initEmergencyLog(int fd,
+        std::size_t bufferSize = 0);
+
+    /**
+     * Logs <code>message</code> at LogLevel <code>ll</code>.  This
+     * function is async-signal-safe.  The message is plain
+     * <code>char</code> text in every build, as it cannot be converted
+     * in a signal handler.
+     */
+    LOG4CPLUS_EXPORT void emergencyLog(LogLevel ll, char const * message);
+
+    /** Logs the first <code>len</code> bytes of <code>message</code>. */
+    LOG4CPLUS_EXPORT void emergencyLog(LogLevel ll, char const * message,
+        std::size_t len);
+
+    /**
+     * Returns the records kept in the buffer and empties it.  No
+     * records may be logged meanwhile.  This function is not
+     * async-signal-safe.
+     */
+    LOG4CPLUS_EXPORT std::string readEmergencyLog();
+
+    /**
+     * Returns the number of records that did not fit into the buffer
+     * or could not be written.
+     */
+    LOG4CPLUS_EXPORT unsigned long getEmergencyLogDropCount();
+
+    /**
+     * Installs handlers for SIGSEGV, SIGBUS, SIGFPE, SIGILL and
+     * SIGABRT, for those signals that still have their default
+     * disposition.  The handler logs the signal with emergencyLog(),
+     * flushes the appenders of the default hierarchy, waiting at most
+     * <code>flushTimeout</code> milliseconds, and then lets the signal
+     * terminate the process as it would have.
+     *
+     * Flushing takes locks and is only best effort.  It runs on a
+     * thread started here, so that the handler does not hang when the
+     * crashing thread holds a lock the flush needs; the handler waits
+     * for that thread with <code>poll()</code> only.  In a child process
+     * forked afterwards, the handler does not flush.
+     *
+     * Returns false where signal handlers are not supported.
+     */
+    LOG4CPLUS_EXPORT bool installFatalSignalHandlers(
+        unsigned long flushTimeout = 1000);
+
+} // end namespace log4cplus
+
+#endif // LOG4CPLUS_EMERGENCYLOG_HEADER_
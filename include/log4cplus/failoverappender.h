@@ -0,0 +1,240 @@
+// -*- C++ -*-
+// Module:  Log4CPLUS
+// File:    failoverappender.h
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file */
+
+#ifndef LOG4CPLUS_FAILOVERAPPENDER_HEADER_
+#define LOG4CPLUS_FAILOVERAPPENDER_HEADER_
+
+#include <log4cplus/config.hxx>
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+
+#include <log4cplus/appender.h>
+#include <log4cplus/helpers/timehelper.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/thread/syncprims.h>
+#include <log4cplus/thread/threads.h>
+
+#include <vector>
+
+
+namespace log4cplus {
+
+    /**
+     * FailoverAppender keeps a primary appender whose destination may
+     * hang or fail, e.g. a file on NFS or on a full disk, from stalling
+     * the logging threads.
+     *
+     * The primary appender is called by a writer thread, while the
+     * logging thread waits for it for at most <code>Timeout</code>
+     * milliseconds.  The appender tracks the health of the primary:
+     *
+     * <ul>
+     *   <li><b>HEALTHY</b>: appends succeed within half the time
+     *   budget.</li>
+     *   <li><b>DEGRADED</b>: an append reported an error through the
+     *   primary's ErrorHandler, or used more than half the budget.  An
+     *   event whose append failed is passed to the fallback appender as
+     *   well.</li>
+     *   <li><b>FAILED</b>: <code>FailureThreshold</code> appends in a
+     *   row failed, or one exceeded the budget.  Events go straight to
+     *   the fallback appender, or are dropped without one, without
+     *   waiting for the primary.</li>
+     * </ul>
+     *
+     * Every <code>ProbeInterval</code> milliseconds the next event is
+     * handed to a failed primary as a probe, once the writer thread is
+     * no longer stuck in it.  The writer thread appends the probe in the
+     * background; the logging thread does not wait for it.  A later
+     * event picks up the outcome: when the probe succeeded, the primary
+     * is healthy again, otherwise the probe event is passed to the
+     * fallback appender, out of order.  State changes are reported
+     * through helpers::LogLog.
+     *
+     * <h3>Properties</h3>
+     * <dl>
+     * <dt><tt>Appender</tt></dt>
+     * <dd>Class name of the primary appender.  Its properties are given
+     * with the <tt>Appender.</tt> prefix, e.g.
+     * <tt>Appender.File</tt>.</dd>
+     *
+     * <dt><tt>Fallback</tt></dt>
+     * <dd>Class name of the fallback appender, with its properties
+     * given with the <tt>Fallback.</tt> prefix.  It is called by the
+     * logging thread and should not block.</dd>
+     *
+     * <dt><tt>Timeout</tt></dt>
+     * <dd>Time budget of an append, in milliseconds.  Default is
+     * 1000.</dd>
+     *
+     * <dt><tt>ProbeInterval</tt></dt>
+     * <dd>Milliseconds between probes of a failed primary.  Default is
+     * 5000.</dd>
+     *
+     * <dt><tt>FailureThreshold</tt></dt>
+     * <dd>Number of failed appends in a row after which the primary is
+     * treated as failed.  Default is 3.</dd>
+     *
+     * </dl>
+     */
+    class LOG4CPLUS_EXPORT FailoverAppender
+        : public Appender
+    {
+    public:
+        enum Health
+        {
+            HEALTHY,
+            DEGRADED,
+            FAILED
+        };
+
+      // Ctors
+        FailoverAppender(SharedAppenderPtr const & primary,
+                         SharedAppenderPtr const & fallback,
+                         unsigned long timeout = 1000);
+        FailoverAppender(helpers::Properties const & properties);
+
+      // Dtor
+        virtual ~FailoverAppender();
+
+      // Methods
+        /**
+         * Closes the appenders.  A primary appender the writer thread
+         * is stuck in is left to that thread, which closes it if the
+         * append ever returns.
+         */
+        virtual void close();
+
+        /** Flushes the fallback appender, and the primary unless it
+         * has failed. */
+        virtual void flush();
+
+        Health getHealth() const;
+
+        /** Returns the number of events passed to the fallback
+         * appender. */
+        unsigned long getDivertedCount() const;
+
+        /** Returns the number of events dropped for lack of a fallback
+         * appender. */
+        unsigned long getDroppedCount() const;
+
+        /**
+         * Starts a new writer thread, as that of the parent does not
+         * exist in the child.
+         */
+        virtual void atforkChild();
+
+        void setProbeInterval(unsigned long interval);
+        void setFailureThreshold(unsigned limit);
+
+    protected:
+        virtual void append(spi::InternalLoggingEvent const & event);
+
+        void init(SharedAppenderPtr const & primary);
+        void setHealth(Health state, tstring const & reason);
+        void checkProbe(std::vector<spi::InternalLoggingEvent> & failed);
+        void divert(spi::InternalLoggingEvent const & event);
+
+        class ErrorRecorder;
+
+        class LOG4CPLUS_EXPORT WriterThread;
+        friend class WriterThread;
+
+        //! Calls the primary appender.  It owns the primary, so that a
+        //! thread stuck in it can outlive the FailoverAppender, and
+        //! records the errors the primary reports while appending.
+        class LOG4CPLUS_EXPORT WriterThread
+            : public thread::AbstractThread
+        {
+        public:
+            WriterThread (SharedAppenderPtr const & primary);
+            virtual ~WriterThread ();
+
+            virtual void run();
+
+            //! Hands an event over, unless the thread is still busy
+            //! with an earlier one.
+            bool submit (spi::InternalLoggingEvent const & event,
+                unsigned long & ticket);
+            //! Waits up to timeout milliseconds for the event of the
+            //! ticket to be appended.
+            bool wait (unsigned long ticket, unsigned long timeout);
+            bool isBusy () const;
+            bool isCompleted (unsigned long ticket) const;
+            //! Whether the primary reported an error while appending the
+            //! event of the ticket.
+            bool hasFailed (unsigned long ticket) const;
+            //! Called by the primary's error handler.
+            void recordError ();
+            //! Stops the thread.  Returns false when it is stuck in the
+            //! primary for longer than timeout milliseconds.
+            bool stop (unsigned long timeout);
+
+            SharedAppenderPtr const primary;
+
+        protected:
+            mutable thread::Mutex mutex;
+            //! Signalled when an event has been handed over.
+            thread::ManualResetEvent work_ev;
+            //! Signalled when an event has been appended.
+            thread::ManualResetEvent done_ev;
+            std::vector<spi::InternalLoggingEvent> pending;
+            unsigned long submitted;
+            unsigned long completed;
+            //! Ticket of the last append that reported an error.
+            unsigned long failed;
+            bool exit_flag;
+            //! Error handler of the primary, owned by it.
+            ErrorRecorder * recorder;
+        };
+
+      // Data
+        SharedAppenderPtr fallback;
+        unsigned long timeout;
+        unsigned long probeInterval;
+        unsigned failureThreshold;
+
+        mutable thread::Mutex state_mutex;
+        Health health;
+        unsigned failures;
+        //! Time from which a failed primary may be probed.
+        helpers::Time probeTime;
+        //! Ticket of the probe in progress, or 0.
+        unsigned long probeTicket;
+        //! Copy of the probe event, diverted if the probe fails.
+        std::vector<spi::InternalLoggingEvent> probeEvent;
+        unsigned long divertedCount;
+        unsigned long droppedCount;
+
+        helpers::SharedObjectPtr<WriterThread> writer;
+
+    private:
+      // Disallow copying of instances of this class
+        FailoverAppender(const FailoverAppender&);
+        FailoverAppender& operator=(const FailoverAppender&);
+    };
+
+} // end namespace log4cplus
+
+#endif // LOG4CPLUS_SINGLE_THREADED
+
+#endif // LOG4CPLUS_FAILOVERAPPENDER_HEADER_
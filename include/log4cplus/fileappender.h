@@ -26,6 +26,8 @@
 
 #include <log4cplus/config.hxx>
 #include <log4cplus/appender.h>
+#include <log4cplus/fileindex.h>
+#include <log4cplus/fileshipper.h>
 #include <log4cplus/fstreams.h>
 #include <log4cplus/helpers/property.h>
 #include <log4cplus/helpers/timehelper.h>
@@ -66,6 +68,47 @@ namespace log4cplus {
      * <dd>Non-zero value of this property sets up buffering of output
      * stream using a buffer of given size.
      * </dd>
+     *
+     * <dt><tt>Encoding</tt></dt>
+     * <dd>When it is set to <tt>UTF-8</tt>, the output stream is
+     * imbued with helpers::getUTF8Locale(), so that UNICODE builds
+     * write UTF-8 with a bulk converter instead of the locale's.  It
+     * has no effect on other builds.
+     * </dd>
+     *
+     * <dt><tt>Index</tt></dt>
+     * <dd>When it is set true, the appender keeps a FileIndex of the
+     * file in a sidecar file named like the file with an
+     * <tt>.idx</tt> suffix.  The index is saved when the appender is
+     * flushed or closed and when the file rolls over, and the sidecar
+     * files are renamed along with the rolled files.  An index that
+     * does not match a file opened for appending is discarded, and the
+     * file is not indexed until it is rolled over.
+     * </dd>
+     *
+     * <dt><tt>IndexInterval</tt></dt>
+     * <dd>Number of bytes between the checkpoints of the index.
+     * Default is 64 KB.  It is possible to use <tt>MB</tt> and
+     * <tt>KB</tt> suffixes.
+     * </dd>
+     *
+     * <dt><tt>IndexBloomBits</tt></dt>
+     * <dd>Size of the Bloom filter of the index in bits.  Default is
+     * 262144, which keeps false positives under 2% for up to about
+     * 30000 distinct tokens per file.
+     * </dd>
+     *
+     * <dt><tt>ShipTo</tt></dt>
+     * <dd>Server, as <tt>host:port</tt>, to which the rolling file
+     * appenders send each rolled file with a FileShipper.  The server
+     * is a loggingserver running in the <tt>-files</tt> mode.  Shipping
+     * needs a multi threaded build.
+     * </dd>
+     *
+     * <dt><tt>ShipSource</tt></dt>
+     * <dd>Name the server stores the shipped files under, to tell
+     * hosts apart.  Default is the host name.
+     * </dd>
      * </dl>
      */
     class LOG4CPLUS_EXPORT FileAppender : public Appender {
@@ -82,6 +125,7 @@ namespace log4cplus {
 
       // Methods
         virtual void close();
+        virtual void flush();
 
       //! Redefine default locale for output stream. It may be a good idea to
       //! provide UTF-8 locale in case UNICODE macro is defined.
@@ -90,12 +134,29 @@ namespace log4cplus {
       //! \Return Locale imbued in fstream. 
         virtual std::locale getloc () const;
 
+        /**
+         * Lets the FileShipper of the child process send the files
+         * rolled in the child.
+         */
+        virtual void atforkChild();
+
     protected:
         virtual void append(const spi::InternalLoggingEvent& event);
 
         void open(LOG4CPLUS_OPEN_MODE_TYPE mode);
         bool reopen();
 
+        //! Loads the index of a file opened with <code>mode</code>.
+        void loadIndex(LOG4CPLUS_OPEN_MODE_TYPE mode);
+        //! Writes the index to its sidecar file.
+        void saveIndex();
+        //! Starts a new index, for a file that was truncated.
+        void resetIndex();
+        //! Suffix of the sidecar files to roll with the log files.
+        log4cplus::tstring getIndexSuffix() const;
+        //! Hands the rolled file <code>completed</code> to the shipper.
+        void shipFile(const log4cplus::tstring& completed);
+
       // Data
         /**
          * Immediate flush means that the underlying writer or output stream
@@ -128,6 +189,14 @@ namespace log4cplus {
 
         log4cplus::helpers::Time reopen_time;
 
+        std::auto_ptr<FileIndex> index;
+        //! Set when <code>index</code> covers the whole file.
+        bool indexing;
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+        std::auto_ptr<FileShipper> shipper;
+#endif
+
     private:
         void init(const log4cplus::tstring& filename,
                   LOG4CPLUS_OPEN_MODE_TYPE mode);
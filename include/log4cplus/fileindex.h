@@ -0,0 +1,161 @@
+// -*- C++ -*-
+// Module:  Log4CPLUS
+// File:    fileindex.h
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file */
+
+
+#ifndef LOG4CPLUS_FILEINDEX_HEADER_
+#define LOG4CPLUS_FILEINDEX_HEADER_
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/tstring.h>
+#include <log4cplus/helpers/timehelper.h>
+
+#include <vector>
+
+
+namespace log4cplus {
+
+    namespace spi {
+        class InternalLoggingEvent;
+    }
+
+    /**
+     * Sparse index of a log file, kept by FileAppender in a sidecar
+     * file next to the log, e.g. <tt>app.log.idx</tt> for
+     * <tt>app.log</tt>.
+     *
+     * The index records the time range of the events in the file, a
+     * checkpoint with the time and the byte offset of an event every
+     * <code>interval</code> bytes, and a Bloom filter of tokens taken
+     * from the events: the words of the NDC and the values of the
+     * typed event fields.  A search for an id can then skip files
+     * whose filter does not contain it, and a search for a time range
+     * can seek to the nearest checkpoint instead of reading the file
+     * from the start.  Checkpoints assume that timestamps grow along
+     * the file.
+     *
+     * A <code>bloomBits</code> of 0 leaves the filter out, for files
+     * whose events are not decoded while they are written; such an
+     * index only helps with time ranges.
+     *
+     * The index covers the file up to getEndOffset().  Anything past
+     * that was written after the index was saved last and has to be
+     * searched without its help.
+     */
+    class LOG4CPLUS_EXPORT FileIndex
+    {
+    public:
+        struct Checkpoint
+        {
+            helpers::Time time;
+            unsigned long offset;
+        };
+
+        typedef std::vector<Checkpoint> CheckpointList;
+
+        //! Suffix appended to the name of a log file to name its index.
+        static tchar const SUFFIX[];
+
+      // Ctors
+        FileIndex(unsigned long interval = 64 * 1024,
+            unsigned long bloomBits = 256 * 1024);
+
+      // Methods
+        //! Forgets all events, keeping the interval and filter size.
+        void clear();
+
+        //! Returns true when no event has been recorded.
+        bool empty() const;
+
+        /**
+         * Records an event that starts at <code>offset</code> in the
+         * file.  Returns true if a checkpoint was added for it.
+         */
+        bool addEvent(const spi::InternalLoggingEvent& event,
+            unsigned long offset);
+
+        /**
+         * Records the time of an event that starts at
+         * <code>offset</code> without taking any tokens from it.
+         * Returns true if a checkpoint was added for it.
+         */
+        bool addTime(const helpers::Time& time, unsigned long offset);
+
+        //! Adds <code>token</code> to the Bloom filter.
+        void addToken(const tstring& token);
+
+        //! Sets the size of the file the index covers.
+        void setEndOffset(unsigned long offset);
+
+        //! Writes the index to <code>filename</code>.
+        bool write(const tstring& filename) const;
+
+        /**
+         * Reads the index from <code>filename</code>.  Returns false
+         * and leaves the index empty if the file does not exist or is
+         * not a valid index.
+         */
+        bool read(const tstring& filename);
+
+        /**
+         * Returns false if no event in the file carries
+         * <code>token</code>.  A true result may be a false positive.
+         */
+        bool mightContain(const tstring& token) const;
+
+        /**
+         * Returns the offset of the last checkpoint at or before
+         * <code>time</code>, where reading for events from that time on
+         * can start.
+         */
+        unsigned long findStartOffset(const helpers::Time& time) const;
+
+        /**
+         * Returns the offset of the first checkpoint after
+         * <code>time</code>, where reading for events up to that time
+         * can stop, or getEndOffset() if there is none.
+         */
+        unsigned long findEndOffset(const helpers::Time& time) const;
+
+        const helpers::Time& getFirstTime() const { return firstTime; }
+        const helpers::Time& getLastTime() const { return lastTime; }
+        unsigned long getEndOffset() const { return endOffset; }
+        const CheckpointList& getCheckpoints() const { return checkpoints; }
+
+    protected:
+        void setBit(unsigned long bit);
+        bool testBit(unsigned long bit) const;
+
+      // Data
+        unsigned long interval;
+        unsigned long bloomBits;
+        unsigned hashCount;
+        std::vector<unsigned char> bloom;
+        CheckpointList checkpoints;
+        helpers::Time firstTime;
+        helpers::Time lastTime;
+        unsigned long endOffset;
+        unsigned long eventCount;
+    };
+
+} // end namespace log4cplus
+
+#endif // LOG4CPLUS_FILEINDEX_HEADER_
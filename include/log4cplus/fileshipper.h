@@ -0,0 +1,197 @@
+// -*- C++ -*-
+// Module:  Log4CPLUS
+// File:    fileshipper.h
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file */
+
+#ifndef LOG4CPLUS_FILESHIPPER_HEADER_
+#define LOG4CPLUS_FILESHIPPER_HEADER_
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/tstring.h>
+#include <log4cplus/helpers/socket.h>
+#include <log4cplus/thread/syncprims.h>
+#include <log4cplus/thread/threads.h>
+
+#include <deque>
+
+
+namespace log4cplus {
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+
+    /**
+     * FileShipper transfers completed log files to a loggingserver
+     * running in the <tt>-files</tt> mode, which stores them with a
+     * FileReceiver.  Rolling file appenders hand their rolled files to
+     * it, see the <tt>ShipTo</tt> property of FileAppender.
+     *
+     * A handed over file is first hard linked to a spool name next to
+     * the log file, <tt><i>File</i>.<i>time</i>.ship</tt>, so that
+     * later rollovers can rename or remove the rolled file.  A
+     * background thread sends the spooled files, oldest first, and
+     * removes each spool link once the server has confirmed that the
+     * file is stored.  Spool links left behind by an earlier process
+     * are sent first.
+     *
+     * On Linux the file data is sent with <code>sendfile()</code>,
+     * without copying it through user space.  The server keeps
+     * partially received files, and a transfer that is cut short
+     * continues from where the server stands, over a new connection
+     * or after a restart.
+     *
+     * The server stores a file as
+     * <tt><i>source</i>.<i>name</i>.<i>time</i></tt>, where
+     * <code>source</code> tells the shipping hosts apart and defaults
+     * to the host name.
+     */
+    class LOG4CPLUS_EXPORT FileShipper
+    {
+    public:
+      // Ctors
+        FileShipper(const log4cplus::tstring& host, unsigned short port,
+                    const log4cplus::tstring& filename,
+                    const log4cplus::tstring& source = log4cplus::tstring());
+
+      // Dtor
+        ~FileShipper();
+
+      // Methods
+        /**
+         * Spools the completed file <code>completed</code>, a rolled
+         * file of the log file this shipper was created for, and queues
+         * it to be sent.
+         */
+        void ship(const log4cplus::tstring& completed);
+
+        /**
+         * Waits up to <code>timeout</code> milliseconds for the queued
+         * files to be sent.  Returns true when none is left.
+         */
+        bool waitShipped(unsigned long timeout);
+
+        /**
+         * Stops the background thread.  A transfer in progress is cut
+         * short and files not yet sent stay spooled for the next
+         * shipper.
+         */
+        void close();
+
+        /** Returns the number of files the server confirmed. */
+        unsigned long getShippedCount() const;
+
+        /**
+         * Starts a new background thread for the child process, which
+         * sends only the files handed over in the child.
+         */
+        void atforkChild();
+
+        //! Suffix of the spool links.
+        static log4cplus::tchar const SPOOL_SUFFIX[];
+
+    protected:
+        enum ShipResult
+        {
+            SHIPPED,
+            //! The spooled file cannot be sent and is given up.
+            DROPPED,
+            RETRY
+        };
+
+        void scanSpool();
+        ShipResult shipFile(helpers::SOCKET_TYPE sock,
+                            const log4cplus::tstring& spoolName);
+        void shipFiles();
+        void startShipper();
+
+        class LOG4CPLUS_EXPORT ShipperThread;
+        friend class ShipperThread;
+
+        class LOG4CPLUS_EXPORT ShipperThread
+            : public thread::AbstractThread
+        {
+        public:
+            ShipperThread (FileShipper &);
+            virtual ~ShipperThread ();
+
+            virtual void run();
+
+        protected:
+            FileShipper & shipper;
+        };
+
+      // Data
+        log4cplus::tstring host;
+        unsigned short port;
+        log4cplus::tstring filename;
+        log4cplus::tstring source;
+
+        mutable thread::Mutex mutex;
+        //! Signalled when a file has been queued, and by close().
+        thread::ManualResetEvent queue_ev;
+        //! Signalled when the queue has been emptied.
+        thread::ManualResetEvent done_ev;
+        //! Signalled by close(), to cut retry delays short.
+        thread::ManualResetEvent exit_ev;
+        //! Spool names of the files to send, oldest first.
+        std::deque<log4cplus::tstring> queue;
+        unsigned long shippedCount;
+        bool exit_flag;
+
+        helpers::SharedObjectPtr<ShipperThread> thread;
+
+    private:
+      // Disallow copying of instances of this class
+        FileShipper(const FileShipper&);
+        FileShipper& operator=(const FileShipper&);
+    };
+
+#endif // LOG4CPLUS_SINGLE_THREADED
+
+
+    /**
+     * FileReceiver stores the files sent by FileShipper in a directory.
+     * This is the <tt>-files</tt> mode of loggingserver.
+     *
+     * A file is received into <tt><i>name</i>.part</tt> and renamed to
+     * its name once complete.  When a transfer of the same file is
+     * started again, the part already received is kept and only the
+     * rest is asked for.  On Linux the data is moved from the socket to
+     * the file with <code>splice()</code>.
+     */
+    class LOG4CPLUS_EXPORT FileReceiver
+    {
+    public:
+        explicit FileReceiver(const log4cplus::tstring& directory);
+
+        /**
+         * Receives files over the connection <code>sock</code> until
+         * the shipper closes it.  The socket is not closed.  Returns
+         * false when the connection failed or the shipper sent
+         * something invalid.
+         */
+        bool receive(helpers::SOCKET_TYPE sock);
+
+    protected:
+        log4cplus::tstring directory;
+    };
+
+} // end namespace log4cplus
+
+#endif // LOG4CPLUS_FILESHIPPER_HEADER_
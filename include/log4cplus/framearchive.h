@@ -0,0 +1,212 @@
+// -*- C++ -*-
+// Module:  Log4CPLUS
+// File:    framearchive.h
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file */
+
+
+#ifndef LOG4CPLUS_FRAMEARCHIVE_HEADER_
+#define LOG4CPLUS_FRAMEARCHIVE_HEADER_
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/fileindex.h>
+#include <log4cplus/loglevel.h>
+#include <log4cplus/tstring.h>
+#include <log4cplus/helpers/timehelper.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/thread/syncprims.h>
+
+#include <cstddef>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace log4cplus {
+
+    /**
+     * FrameArchiveWriter stores events received in the socket protocol
+     * of SocketAppender as they arrived on the wire, without decoding
+     * them.  This lets <tt>loggingserver -archive</tt> persist events
+     * at the speed of the disk; they are decoded and rendered only when
+     * the archive is read, e.g. by <tt>log4cplus-query</tt>.
+     *
+     * Each frame is stored with the id of its source, typically a
+     * client connection, and each source is described by a source
+     * record.  The records of all open sources are repeated at the
+     * start of every file and before every index checkpoint, so that a
+     * reader may start at any checkpoint.
+     *
+     * The writer keeps a FileIndex without a Bloom filter next to each
+     * file.  Its checkpoints carry the latest event time seen so far,
+     * which keeps seeking correct when the clocks of the sources
+     * differ.  The index and the file are flushed at every checkpoint,
+     * by flush() and by close().  An existing file is rolled over when
+     * the writer starts, so that every file is covered by its index.
+     *
+     * All methods may be called from several threads.
+     */
+    class LOG4CPLUS_EXPORT FrameArchiveWriter
+    {
+    public:
+      // Ctors
+        FrameArchiveWriter(const log4cplus::tstring& filename,
+                           long maxFileSize = 256 * 1024 * 1024,
+                           int maxBackupIndex = 10,
+                           unsigned long indexInterval = 64 * 1024);
+
+      // Dtor
+        ~FrameArchiveWriter();
+
+      // Methods
+        /** Returns true if the archive file is open for writing. */
+        bool isOpen() const;
+
+        /**
+         * Registers a source of frames, e.g. a client connection, and
+         * returns its id.
+         */
+        unsigned long addSource(const log4cplus::tstring& description);
+
+        /** Forgets a source once no more frames follow from it. */
+        void removeSource(unsigned long source);
+
+        /**
+         * Stores a frame of <code>size</code> bytes, as written by
+         * helpers::convertToBuffer(), without its length prefix.
+         */
+        void append(unsigned long source, const char* frame,
+                    std::size_t size);
+
+        /** Writes buffered frames and the index out. */
+        void flush();
+
+        void close();
+
+    protected:
+        void open();
+        void rollover();
+        void writeRecord(char type, unsigned long source,
+                         const char* data, std::size_t size);
+        void writeSources();
+        void saveIndex();
+
+        typedef std::map<unsigned long, std::string> SourceMap;
+
+      // Data
+        log4cplus::tstring filename;
+        long maxFileSize;
+        int maxBackupIndex;
+        std::ofstream out;
+        unsigned long fileSize;
+        FileIndex index;
+        //! Latest event time stored in the current file.
+        helpers::Time latestTime;
+        //! Descriptions of the open sources, UTF-8 encoded.
+        SourceMap sources;
+        unsigned long nextSource;
+        //! Record header buffer, kept to reuse its memory.
+        std::string header;
+        thread::Mutex mutex;
+
+    private:
+      // Disallow copying of instances of this class
+        FrameArchiveWriter(const FrameArchiveWriter&);
+        FrameArchiveWriter& operator=(const FrameArchiveWriter&);
+    };
+
+
+    /**
+     * FrameArchiveReader decodes the events of a file written by
+     * FrameArchiveWriter.  With a time range set, reading starts at the
+     * index checkpoint for its start, if the file has an index.
+     *
+     * <pre>
+     * FrameArchiveReader reader(LOG4CPLUS_TEXT("server.frames"));
+     * std::vector<spi::InternalLoggingEvent> events;
+     * while(reader.readEvent(events)) {
+     *     // ...
+     * }
+     * </pre>
+     */
+    class LOG4CPLUS_EXPORT FrameArchiveReader
+    {
+    public:
+      // Ctors
+        explicit FrameArchiveReader(const log4cplus::tstring& filename);
+
+      // Dtor
+        ~FrameArchiveReader();
+
+      // Methods
+        /** Returns true if the file was opened and is a frame archive. */
+        bool isOpen() const { return valid; }
+
+        /**
+         * Only return events with timestamps in [from, to].  Must be
+         * called before the first event is read.
+         */
+        void setTimeRange(const helpers::Time& from, const helpers::Time& to);
+
+        /** Only return events at or above <code>ll</code>. */
+        void setMinLogLevel(LogLevel ll) { minLogLevel = ll; }
+
+        /**
+         * Appends the next matching event to <code>events</code>.
+         * Returns false at the end of the file or when the file is
+         * damaged, see isDamaged().
+         */
+        bool readEvent(std::vector<spi::InternalLoggingEvent>& events);
+
+        /** Description of the source of the event read last. */
+        const log4cplus::tstring& getSource() const { return source; }
+
+        /** Returns true if reading stopped at a damaged record. */
+        bool isDamaged() const { return damaged; }
+
+    protected:
+        bool readRecord(char& type, unsigned long& sourceId);
+
+        typedef std::map<unsigned long, log4cplus::tstring> SourceMap;
+
+      // Data
+        log4cplus::tstring filename;
+        std::ifstream in;
+        bool valid;
+        bool damaged;
+        bool started;
+        bool timeFilter;
+        helpers::Time from;
+        helpers::Time to;
+        LogLevel minLogLevel;
+        SourceMap sources;
+        log4cplus::tstring source;
+        //! Payload of the record read last.
+        std::string payload;
+
+    private:
+      // Disallow copying of instances of this class
+        FrameArchiveReader(const FrameArchiveReader&);
+        FrameArchiveReader& operator=(const FrameArchiveReader&);
+    };
+
+} // end namespace log4cplus
+
+#endif // LOG4CPLUS_FRAMEARCHIVE_HEADER_
@@ -0,0 +1,172 @@
+// -*- C++ -*-
+// Module:  Log4CPLUS
+// File:    framerelay.h
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file */
+
+
+#ifndef LOG4CPLUS_FRAMERELAY_HEADER_
+#define LOG4CPLUS_FRAMERELAY_HEADER_
+
+#include <log4cplus/config.hxx>
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+
+#include <log4cplus/tstring.h>
+#include <log4cplus/helpers/socket.h>
+#include <log4cplus/thread/syncprims.h>
+#include <log4cplus/thread/threads.h>
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+
+namespace log4cplus {
+
+    /**
+     * FrameRelay forwards frames of the socket protocol, as received
+     * by a loggingserver, to an upstream loggingserver without decoding
+     * them.  This is the relay mode of <tt>loggingserver -relay</tt>,
+     * for e.g. one server per rack forwarding to a central one.
+     *
+     * Frames are queued in memory and a background thread writes them
+     * upstream in batches of up to <code>batchSize</code> bytes, each
+     * with a single socket write.  When the queue reaches
+     * <code>memoryLimit</code> bytes, further frames go to the spool
+     * file, if there is one, until the thread has caught up with it.
+     * When the spool file, too, has reached <code>spoolLimit</code>
+     * bytes, append() waits for room.  A server that calls append()
+     * from the threads reading its client connections then stops
+     * reading them, which passes the backpressure on to the clients.
+     *
+     * While the upstream server cannot be reached, the thread retries
+     * with a growing delay.  A batch that fails is sent again in full
+     * over the new connection, so that frames are delivered at least
+     * once.  A spool file left behind by an earlier relay is forwarded
+     * first.  Frames still in memory are lost when the relay is closed
+     * while the upstream server is unreachable.
+     */
+    class LOG4CPLUS_EXPORT FrameRelay
+    {
+    public:
+      // Ctors
+        FrameRelay(const log4cplus::tstring& host, unsigned short port,
+                   std::size_t memoryLimit = 4 * 1024 * 1024,
+                   const log4cplus::tstring& spoolFile = log4cplus::tstring(),
+                   unsigned long spoolLimit = 256 * 1024 * 1024,
+                   std::size_t batchSize = 256 * 1024);
+
+      // Dtor
+        ~FrameRelay();
+
+      // Methods
+        /**
+         * Queues a frame of <code>size</code> bytes, as written by
+         * helpers::convertToBuffer(), without its length prefix.
+         * Waits while the queue and the spool file are full.
+         */
+        void append(const char* frame, std::size_t size);
+
+        /**
+         * Waits until all frames queued so far have been written
+         * upstream.
+         */
+        void flush();
+
+        /**
+         * Stops the background thread after it has forwarded the
+         * queued frames, or failed to.
+         */
+        void close();
+
+        /** Returns the number of frames written upstream. */
+        unsigned long getForwardedCount() const;
+
+    protected:
+        void openSpool();
+        void resetSpool();
+        bool takeBatch(std::string& batch, unsigned long& frames,
+                       bool& fromSpool);
+        void commitBatch(std::size_t size, unsigned long frames,
+                         bool fromSpool);
+        bool send(const std::string& batch);
+        void forwardFrames();
+
+        class LOG4CPLUS_EXPORT ForwarderThread;
+        friend class ForwarderThread;
+
+        class LOG4CPLUS_EXPORT ForwarderThread
+            : public thread::AbstractThread
+        {
+        public:
+            ForwarderThread (FrameRelay &);
+            virtual ~ForwarderThread ();
+
+            virtual void run();
+
+        protected:
+            FrameRelay & relay;
+        };
+
+      // Data
+        log4cplus::tstring host;
+        unsigned short port;
+        std::size_t memoryLimit;
+        log4cplus::tstring spoolFile;
+        unsigned long spoolLimit;
+        std::size_t batchSize;
+        helpers::Socket upstream;
+
+        mutable thread::Mutex mutex;
+        //! Signalled when a frame has been queued.
+        thread::ManualResetEvent queue_ev;
+        //! Signalled when room has been made in the queue.
+        thread::ManualResetEvent space_ev;
+        //! Signalled when frames have been written upstream.
+        thread::ManualResetEvent done_ev;
+        //! Signalled by close(), to cut retry delays short.
+        thread::ManualResetEvent exit_ev;
+
+        //! Queued frames, each with its length prefix, oldest first.
+        std::string memory;
+        std::fstream spool;
+        //! Offset of the first frame in the spool not yet written.
+        unsigned long spoolRead;
+        //! Size of the spool file.
+        unsigned long spoolWrite;
+        //! Set while new frames have to go to the spool file.
+        bool spooling;
+        unsigned long queuedCount;
+        unsigned long forwardedCount;
+        bool exit_flag;
+
+        helpers::SharedObjectPtr<ForwarderThread> forwarder;
+
+    private:
+      // Disallow copying of instances of this class
+        FrameRelay(const FrameRelay&);
+        FrameRelay& operator=(const FrameRelay&);
+    };
+
+} // end namespace log4cplus
+
+#endif // LOG4CPLUS_SINGLE_THREADED
+
+#endif // LOG4CPLUS_FRAMERELAY_HEADER_
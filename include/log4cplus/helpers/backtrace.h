@@ -0,0 +1,93 @@
+// -*- C++ -*-
+// Module:  Log4CPLUS
+// File:    backtrace.h
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file */
+
+#ifndef LOG4CPLUS_HELPERS_BACKTRACE_HEADER_
+#define LOG4CPLUS_HELPERS_BACKTRACE_HEADER_
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/loglevel.h>
+#include <log4cplus/tstring.h>
+
+#include <vector>
+
+
+namespace log4cplus {
+    namespace helpers {
+
+        //! Return addresses of a call stack, innermost first.
+        typedef std::vector<void*> Backtrace;
+
+        /**
+         * Sets the LogLevel at and above which loggers attach the
+         * backtrace of the logging call to their events.  The default,
+         * <code>NOT_SET_LOG_LEVEL</code>, attaches none.
+         * PropertyConfigurator sets it from the
+         * <code>log4cplus.backtraceLevel</code> property.
+         *
+         * Only the raw return addresses are captured, with
+         * <code>backtrace()</code>.  They are turned into names when
+         * the event is formatted, see symbolizeBacktrace().  Returns
+         * <code>false</code> where backtraces are not supported.
+         */
+        LOG4CPLUS_EXPORT bool setBacktraceThreshold(LogLevel ll);
+
+        /** Returns the level set with setBacktraceThreshold(). */
+        LOG4CPLUS_EXPORT LogLevel getBacktraceThreshold();
+
+        /**
+         * Stores the return addresses of the calling thread in
+         * <code>frames</code>, at most 64, without the frame of this
+         * function.  Returns <code>false</code> if none could be
+         * captured.
+         */
+        LOG4CPLUS_EXPORT bool captureBacktrace(Backtrace& frames);
+
+        /**
+         * Appends the frames of <code>frames</code> to <code>out</code>,
+         * one per line, each line starting with a newline and a tab,
+         * e.g. <tt>at main+0x2a (app)</tt>.  Leading frames inside
+         * log4cplus are left out, and at most <code>maxDepth</code>
+         * frames are written, all if it is 0.
+         *
+         * Names are looked up with <code>backtrace_symbols()</code>,
+         * which only sees dynamic symbols; executables have to be linked
+         * with <tt>-rdynamic</tt> to show their own functions.  Names
+         * are demangled and cached by address, so that repeated stacks
+         * are written without looking them up again.
+         */
+        LOG4CPLUS_EXPORT void symbolizeBacktrace(tstring& out,
+            const Backtrace& frames, unsigned maxDepth = 0);
+
+        /**
+         * Locks the symbol cache of symbolizeBacktrace() for fork().
+         * Called by Hierarchy::atforkPrepare(), followed by
+         * backtraceAtforkParent() in the parent and
+         * backtraceAtforkChild() in the child process.
+         */
+        LOG4CPLUS_EXPORT void backtraceAtforkPrepare();
+        LOG4CPLUS_EXPORT void backtraceAtforkParent();
+        LOG4CPLUS_EXPORT void backtraceAtforkChild();
+
+    } // end namespace helpers
+} // end namespace log4cplus
+
+#endif // LOG4CPLUS_HELPERS_BACKTRACE_HEADER_
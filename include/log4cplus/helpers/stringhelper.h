@@ -26,10 +26,14 @@
 
 #include <log4cplus/config.hxx>
 #include <log4cplus/tstring.h>
+#include <log4cplus/streams.h>
 
 #include <algorithm>
 #include <limits>
 #include <iterator>
+#include <locale>
+#include <ostream>
+#include <string>
 
 
 namespace log4cplus {
@@ -47,6 +51,44 @@ namespace log4cplus {
         LOG4CPLUS_EXPORT log4cplus::tstring toLower(const log4cplus::tstring& s);
 
 
+        /**
+         * Appends <code>src</code>, UTF-16 or UTF-32 depending on the size
+         * of <code>wchar_t</code>, to <code>out</code> as UTF-8.  Runs of
+         * ASCII characters are converted with SSE2 where available.
+         * Unpaired surrogates and values outside of Unicode are replaced
+         * by U+FFFD.
+         */
+        LOG4CPLUS_EXPORT void appendUTF8(std::string & out,
+            wchar_t const * src, std::size_t size);
+
+
+        /**
+         * Returns <code>src</code> converted to UTF-8, see appendUTF8().
+         */
+        LOG4CPLUS_EXPORT std::string toUTF8(const std::wstring& src);
+
+
+        /**
+         * Returns the UTF-8 string [src, src + size) converted to
+         * UTF-16 or UTF-32, depending on the size of
+         * <code>wchar_t</code>.  Malformed sequences are replaced by
+         * U+FFFD.
+         */
+        LOG4CPLUS_EXPORT std::wstring fromUTF8(char const * src,
+            std::size_t size);
+
+
+        /**
+         * Returns a copy of <code>loc</code> whose
+         * <code>std::codecvt<wchar_t, char, std::mbstate_t></code> facet
+         * converts to and from UTF-8 with appendUTF8()'s converter.
+         * Wide streams imbued with it write UTF-8 independently of the
+         * C library locale.
+         */
+        LOG4CPLUS_EXPORT std::locale getUTF8Locale(
+            std::locale const & loc = std::locale ());
+
+
         /**
          * Tokenize <code>s</code> using <code>c</code> as the delimiter and
          * put the resulting tokens in <code>_result</code>.  If
@@ -133,20 +175,28 @@ namespace log4cplus {
         };
 
 
+        //! Two digit decimal strings of 00 to 99, concatenated.
+        LOG4CPLUS_EXPORT extern tchar const digitPairs[201];
+
+
+        /**
+         * Writes <code>value</code> in decimal to the characters before
+         * <code>buf_end</code>, two digits at a time and without
+         * consulting any locale, and returns the position of the first
+         * character.  The buffer must have room for
+         * <code>std::numeric_limits<intType>::digits10 + 2</code>
+         * characters.
+         */
         template<class intType>
         inline
-        void
-        convertIntegerToString (tstring & str, intType value)
+        tchar *
+        convertIntegerToChars (tchar * buf_end, intType value)
         {
             typedef std::numeric_limits<intType> intTypeLimits;
             typedef ConvertIntegerToStringHelper<intType,
                 intTypeLimits::is_signed> HelperType;
 
-            const size_t buffer_size
-                = intTypeLimits::digits10 + 2;
-            tchar buffer[buffer_size];
-            tchar * it = &buffer[buffer_size];
-            tchar const * const buf_end = it;
+            tchar * it = buf_end;
 
             if (value == 0)
             {
@@ -158,11 +208,25 @@ namespace log4cplus {
             if (negative)
                 HelperType::step1 (it, value);
 
-            for (; value != 0; --it)
+            while (value >= 100)
+            {
+                intType const pair = value % 100;
+                value = value / 100;
+                it -= 2;
+                it[0] = digitPairs[pair * 2];
+                it[1] = digitPairs[pair * 2 + 1];
+            }
+
+            if (value >= 10)
+            {
+                it -= 2;
+                it[0] = digitPairs[value * 2];
+                it[1] = digitPairs[value * 2 + 1];
+            }
+            else if (value != 0)
             {
-                intType mod = value % 10;
-                value = value / 10;
-                *(it - 1) = LOG4CPLUS_TEXT('0') + static_cast<tchar>(mod);
+                --it;
+                *it = LOG4CPLUS_TEXT('0') + static_cast<tchar>(value);
             }
 
             if (negative)
@@ -171,7 +235,24 @@ namespace log4cplus {
                 *it = LOG4CPLUS_TEXT('-');
             }
 
-            str.assign (static_cast<tchar const *>(it), buf_end);
+            return it;
+        }
+
+
+        template<class intType>
+        inline
+        void
+        convertIntegerToString (tstring & str, intType value)
+        {
+            typedef std::numeric_limits<intType> intTypeLimits;
+
+            const size_t buffer_size
+                = intTypeLimits::digits10 + 2;
+            tchar buffer[buffer_size];
+            tchar * const buf_end = &buffer[buffer_size];
+            tchar const * const it = convertIntegerToChars (buf_end, value);
+
+            str.assign (it, static_cast<tchar const *>(buf_end));
         }
 
 
@@ -186,6 +267,100 @@ namespace log4cplus {
         }
 
 
+        //! Size of buffers passed to convertDoubleToChars().
+        std::size_t const DOUBLE_CHARS_BUFFER_SIZE = 32;
+
+
+        /**
+         * Writes the shortest decimal form of <code>value</code> that
+         * reads back as the same double to <code>buf</code>, which must
+         * hold DOUBLE_CHARS_BUFFER_SIZE characters, and returns its
+         * length.  The decimal point is always '.', whatever the
+         * locale.  Infinities and NaN are written as <tt>inf</tt>,
+         * <tt>-inf</tt> and <tt>nan</tt>.
+         */
+        LOG4CPLUS_EXPORT std::size_t convertDoubleToChars (tchar * buf,
+            double value);
+
+
+        /**
+         * Sets <code>str</code> to the result of convertDoubleToChars().
+         */
+        LOG4CPLUS_EXPORT void convertDoubleToString (tstring & str,
+            double value);
+
+
+        template <typename T>
+        struct DecimalManip
+        {
+            T value;
+        };
+
+
+        /**
+         * Stream manipulator writing <code>value</code> with
+         * convertIntegerToChars() or convertDoubleToChars(), bypassing
+         * the stream's locale and formatting flags.
+         *
+         * <b>Example:</b>
+         * <pre>
+         *   LOG4CPLUS_INFO(logger, "took " << helpers::decimal(ms)
+         *       << " ms, ratio " << helpers::decimal(ratio));
+         * </pre>
+         */
+        template <typename T>
+        inline
+        DecimalManip<T>
+        decimal (T value)
+        {
+            DecimalManip<T> manip = { value };
+            return manip;
+        }
+
+
+        inline
+        DecimalManip<double>
+        decimal (float value)
+        {
+            DecimalManip<double> manip = { value };
+            return manip;
+        }
+
+
+        inline
+        DecimalManip<double>
+        decimal (long double value)
+        {
+            DecimalManip<double> manip = { static_cast<double>(value) };
+            return manip;
+        }
+
+
+        template <typename T>
+        inline
+        tostream &
+        operator << (tostream & os, DecimalManip<T> const & manip)
+        {
+            tchar buffer[std::numeric_limits<T>::digits10 + 2];
+            tchar * const buf_end
+                = buffer + sizeof (buffer) / sizeof (buffer[0]);
+            tchar const * const it = convertIntegerToChars (buf_end,
+                manip.value);
+            return os.write (it, buf_end - it);
+        }
+
+
+        inline
+        tostream &
+        operator << (tostream & os, DecimalManip<double> const & manip)
+        {
+            tchar buffer[DOUBLE_CHARS_BUFFER_SIZE];
+            std::size_t const len = convertDoubleToChars (buffer,
+                manip.value);
+            return os.write (buffer, len);
+        }
+
+
 
         /**
          * This iterator can be used in place of the back_insert_iterator
@@ -237,4 +412,14 @@ namespace log4cplus {
 
 } // namespace log4cplus
 
+
+#ifdef UNICODE
+#define LOG4CPLUS_TSTRING_TO_UTF8(STRING) log4cplus::helpers::toUTF8(STRING)
+#define LOG4CPLUS_UTF8_TO_TSTRING(PTR, SIZE) \
+    log4cplus::helpers::fromUTF8(PTR, SIZE)
+#else
+#define LOG4CPLUS_TSTRING_TO_UTF8(STRING) STRING
+#define LOG4CPLUS_UTF8_TO_TSTRING(PTR, SIZE) log4cplus::tstring(PTR, SIZE)
+#endif
+
 #endif // LOG4CPLUS_HELPERS_STRINGHELPER_HEADER_
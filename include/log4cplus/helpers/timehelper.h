@@ -35,6 +35,8 @@
 #include <ctime>
 #endif
 
+#include <vector>
+
 
 namespace log4cplus {
 
@@ -53,7 +55,7 @@ using std::tm;
 
 
 /**
- * This class represents a Epoch time with microsecond accuracy.
+ * This class represents a Epoch time with nanosecond accuracy.
  */
 class LOG4CPLUS_EXPORT Time {
 public:
@@ -64,10 +66,45 @@ public:
     /**
      * Returns the current time using the <code>gettimeofday()</code>
      * method if it is available on the current platform.  (Not on 
-     * WIN32.)
+     * WIN32.)  It has nanosecond resolution where
+     * <code>clock_gettime()</code> is available.
      */
     static Time gettimeofday();
 
+    /**
+     * Clocks that logging events can be stamped with.
+     */
+    enum EventClock
+    {
+        //! <code>CLOCK_REALTIME</code>, the same as gettimeofday().
+        REALTIME_CLOCK,
+        //! <code>CLOCK_REALTIME_COARSE</code> (Linux).  It is cheaper to
+        //! read but advances only once per timer tick.
+        COARSE_REALTIME_CLOCK,
+        //! The time stamp counter of x86-64 CPUs with an invariant TSC,
+        //! calibrated against the real time clock.  Each thread
+        //! synchronizes it with the real time clock again every second,
+        //! so events of different threads may be out of order by the
+        //! drift accumulated within one second.
+        TSC_CLOCK
+    };
+
+    /**
+     * Selects the clock returned by eventTime().  A clock that is not
+     * available on the current platform leaves REALTIME_CLOCK selected,
+     * and <code>false</code> is returned.
+     */
+    static bool setEventClock(EventClock clock);
+
+    /** Returns the clock selected with setEventClock(). */
+    static EventClock getEventClock();
+
+    /**
+     * Returns the current time read from the event clock.  Logging
+     * events are stamped with it.
+     */
+    static Time eventTime();
+
   // Methods
     /**
      * Returns <i>seconds</i> value.
@@ -77,7 +114,12 @@ public:
     /**
      * Returns <i>microseconds</i> value.
      */
-    long usec() const { return tv_usec; }
+    long usec() const { return tv_nsec / 1000; }
+
+    /**
+     * Returns <i>nanoseconds</i> value.
+     */
+    long nsec() const { return tv_nsec; }
 
     /**
      * Sets the <i>seconds</i> value.
@@ -87,7 +129,12 @@ public:
     /**
      * Sets the <i>microseconds</i> value.
      */
-    void usec(long us) { tv_usec = us; }
+    void usec(long us) { tv_nsec = us * 1000; }
+
+    /**
+     * Sets the <i>nanoseconds</i> value.
+     */
+    void nsec(long ns) { tv_nsec = ns; }
 
     /**
      * Sets this Time using the <code>mktime</code> function.
@@ -100,14 +147,18 @@ public:
     time_t getTime() const;
 
     /**
-     * Populates <code>tm</code> using the <code>gmtime()</code>
-     * function.
+     * Populates <code>tm</code> with the same result as the
+     * <code>gmtime()</code> function, but computes it without calling
+     * into the C library.
      */
     void gmtime(tm* t) const;
 
     /**
-     * Populates <code>tm</code> using the <code>localtime()</code>
-     * function.
+     * Populates <code>tm</code> with the same result as the
+     * <code>localtime()</code> function.  The local time offset is
+     * looked up with <code>localtime()</code> once an hour per thread,
+     * or at a transition, and cached; the rest is computed without
+     * calling into the C library.
      */
     void localtime(tm* t) const;
 
@@ -122,7 +173,8 @@ public:
      * The following additional options are provided:<br>
      * <code>%q</code> - 3 character field that provides milliseconds
      * <code>%Q</code> - 7 character field that provides fractional 
-     * milliseconds.
+     * milliseconds.<br>
+     * <code>%N</code> - 9 character field that provides nanoseconds.
      */
     log4cplus::tstring getFormattedTime(const log4cplus::tstring& fmt,
                                         bool use_gmtime = false) const;
@@ -136,10 +188,11 @@ public:
 private:
     void build_q_value (log4cplus::tstring & q_str) const;
     void build_uc_q_value (log4cplus::tstring & uc_q_str) const;
+    void build_n_value (log4cplus::tstring & n_str) const;
 
   // Data
     time_t tv_sec;  /* seconds */
-    long tv_usec;  /* microseconds */
+    long tv_nsec;  /* nanoseconds */
 };
 
 
@@ -171,6 +224,77 @@ LOG4CPLUS_EXPORT bool operator==(const log4cplus::helpers::Time& lhs,
 LOG4CPLUS_EXPORT bool operator!=(const log4cplus::helpers::Time& lhs,
                                  const log4cplus::helpers::Time& rhs);
 
+
+/**
+ * A time format string, as accepted by Time::getFormattedTime(),
+ * parsed once into fields.  The numeric fields (<code>%Y %y %m %d %e
+ * %H %I %M %S %j %F %T %R %D %s %q %Q %N</code>) are rendered without
+ * calling <code>strftime()</code>; the remaining, locale dependent,
+ * specifiers are passed to it one at a time.
+ */
+class LOG4CPLUS_EXPORT CompiledTimeFormat {
+public:
+    CompiledTimeFormat();
+    explicit CompiledTimeFormat(const log4cplus::tstring& fmt,
+                                bool use_gmtime = false);
+
+    /**
+     * Parses <code>fmt</code>, replacing the previous format.
+     */
+    void compile(const log4cplus::tstring& fmt, bool use_gmtime = false);
+
+    /** Returns the format string given to compile(). */
+    const log4cplus::tstring& getFormat() const { return format; }
+
+    /**
+     * Appends <code>time</code> formatted according to this format to
+     * <code>out</code>.
+     */
+    void formatTo(log4cplus::tstring& out, const Time& time) const;
+
+    /** Returns <code>time</code> formatted according to this format. */
+    log4cplus::tstring formatTime(const Time& time) const;
+
+private:
+    enum FieldType
+    {
+        LITERAL,
+        YEAR,
+        YEAR_OF_CENTURY,
+        MONTH,
+        DAY,
+        DAY_SPACE_PADDED,
+        HOUR,
+        HOUR_12,
+        MINUTE,
+        SECOND,
+        DAY_OF_YEAR,
+        EPOCH_SECONDS,
+        MILLISECONDS,
+        FRACTIONAL_MILLISECONDS,
+        NANOSECONDS,
+        //! Passed to strftime().
+        STRFTIME
+    };
+
+    struct Field
+    {
+        FieldType type;
+        //! Text of LITERAL, specifier of STRFTIME.
+        log4cplus::tstring text;
+    };
+
+    void addField(FieldType type);
+    void addLiteral(log4cplus::tchar ch);
+
+  // Data
+    log4cplus::tstring format;
+    bool use_gmtime;
+    //! Set when a field needs the broken down time.
+    bool needs_tm;
+    std::vector<Field> fields;
+};
+
 } // namespace helpers
 
 } // namespace log4cplus
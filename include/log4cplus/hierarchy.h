@@ -26,6 +26,7 @@
 
 #include <log4cplus/config.hxx>
 #include <log4cplus/logger.h>
+#include <log4cplus/loadgovernor.h>
 #include <log4cplus/helpers/logloguser.h>
 #include <log4cplus/helpers/pointer.h>
 #include <log4cplus/thread/threads.h>
@@ -232,6 +233,35 @@ namespace log4cplus {
          */
         virtual void shutdown();
 
+        /**
+         * Prepares the hierarchy for fork().  It waits for logging calls
+         * in progress to complete, blocks new ones and calls
+         * Appender::atforkPrepare() on the appenders of all loggers.
+         * Every call must be followed by atforkParent() in the parent
+         * and atforkChild() in the child process.
+         *
+         * log4cplus calls these for the default hierarchy through
+         * <code>pthread_atfork()</code>, so programs using POSIX threads
+         * do not have to.
+         */
+        void atforkPrepare();
+
+        /** Lets logging continue in the parent process after fork(). */
+        void atforkParent();
+
+        /**
+         * Reinitializes locks left behind by threads of the parent and
+         * lets the appenders restart their threads and connections in the
+         * child process after fork().
+         */
+        void atforkChild();
+
+        /**
+         * Returns the LoadGovernor that keeps the log volume of this
+         * hierarchy within a budget.
+         */
+        LoadGovernor & getLoadGovernor() { return governor; }
+
     private:
       // Types
         typedef std::vector<Logger> ProvisionNode;
@@ -299,9 +329,15 @@ namespace log4cplus {
 
        int disableValue;
 
+       //! Loggers and appenders locked by atforkPrepare().
+       LoggerList forkLoggers;
+       SharedAppenderPtrList forkAppenders;
+
        bool emittedNoAppenderWarning;
        bool emittedNoResourceBundleWarning;
 
+       LoadGovernor governor;
+
      // Disallow copying of instances of this class
        Hierarchy(const Hierarchy&);
        Hierarchy& operator=(const Hierarchy&);
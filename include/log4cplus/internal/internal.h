@@ -43,7 +43,11 @@
 
 #include <log4cplus/config.hxx>
 #include <log4cplus/ndc.h>
+#include <log4cplus/streams.h>
+#include <log4cplus/helpers/timehelper.h>
 #include <log4cplus/thread/impl/tls.h>
+#include <sstream>
+#include <string>
 
 
 namespace log4cplus {
@@ -56,6 +60,26 @@ namespace internal {
 extern log4cplus::tstring const empty_str;
 
 
+//! Local time offset in effect over [from, until), cached by
+//! helpers::Time::localtime().
+struct tz_cache
+{
+    tz_cache ();
+
+    helpers::time_t from;
+    helpers::time_t until;
+    //! Seconds east of UTC.
+    long offset;
+    //! localtime() result within the range; supplies tm_isdst and
+    //! the platform specific fields like tm_zone.
+    helpers::tm templ;
+    //! Value of the TZ environment variable the offset was looked up
+    //! with, and whether it was set at all.
+    std::string tz;
+    bool tz_set;
+};
+
+
 //! Per thread data.
 struct per_thread_data
 {
@@ -63,6 +87,21 @@ struct per_thread_data
     ~per_thread_data ();
 
     DiagnosticContextStack ndc_dcs;
+    //! Buffer for Layout::beginFormat().
+    log4cplus::tostringstream layout_oss;
+    //! Buffer for formatted timestamps.
+    log4cplus::tstring date_buf;
+    //! Buffer for layouts that build the whole line at once.
+    log4cplus::tstring layout_buf;
+    //! TSC reading at which tsc_anchor_time was taken, see
+    //! helpers::Time::TSC_CLOCK.
+    unsigned long tsc_anchor_ticks;
+    helpers::Time tsc_anchor_time;
+    tz_cache local_tz;
+    //! gmtime() result supplying the platform specific fields of
+    //! helpers::Time::gmtime().
+    helpers::tm gmt_templ;
+    bool gmt_templ_valid;
 };
 
 
@@ -138,6 +177,15 @@ get_ptd (bool alloc = true)
 #endif // defined (LOG4CPLUS_THREAD_LOCAL_VAR)
 
 
+//! Renames <code>filename</code> to <code>filename.1</code>, after
+//! shifting the older backups up to <code>maxBackupIndex</code>, the
+//! way RollingFileAppender rolls its file.  The file must be closed.
+//! Sidecar files named with a non-empty <code>sidecarSuffix</code> are
+//! renamed along with the files.
+void roll_file (tstring const & filename, unsigned maxBackupIndex,
+    tstring const & sidecarSuffix = tstring ());
+
+
 } // namespace internal {
 
 
@@ -0,0 +1,208 @@
+// -*- C++ -*-
+// Module:  Log4CPLUS
+// File:    segment.h
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file
+ * Encoding of the files written by SegmentAppender.  This header is
+ * internal to log4cplus.
+ */
+
+
+#ifndef LOG4CPLUS_INTERNAL_SEGMENT_HEADER_
+#define LOG4CPLUS_INTERNAL_SEGMENT_HEADER_
+
+#if ! defined (INSIDE_LOG4CPLUS)
+#  error "This header must not be be used outside log4cplus' implementation files."
+#endif
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/tstring.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <cstring>
+#include <string>
+
+
+namespace log4cplus { namespace internal {
+
+
+//! File header: "L4CSEG", a zero byte and the format version.
+static char const segment_magic[8] = { 'L', '4', 'C', 'S', 'E', 'G', 0, 1 };
+
+//! Marker preceding each row group.
+static char const row_group_marker[2] = { 'R', 'G' };
+
+
+//! Columns of a row group, in the order they are stored.  Readers
+//! ignore columns past the ones they know.
+enum SegmentColumn
+{
+    TIME_COLUMN,
+    LEVEL_COLUMN,
+    LOGGER_COLUMN,
+    THREAD_COLUMN,
+    NDC_COLUMN,
+    FILE_COLUMN,
+    LINE_COLUMN,
+    MESSAGE_COLUMN,
+    FIELDS_COLUMN,
+    SEGMENT_COLUMN_COUNT
+};
+
+
+//! Appends <code>value</code> as LEB128: 7 bits per byte, low bits
+//! first, the high bit set on all bytes but the last one.
+inline
+void
+put_varint (std::string & out, unsigned long value)
+{
+    while (value >= 0x80)
+    {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+
+//! Appends a signed value with zigzag encoding, which keeps small
+//! negative values short.
+inline
+void
+put_svarint (std::string & out, long value)
+{
+    unsigned long const sign = value < 0 ? ~0ul : 0ul;
+    put_varint (out, (static_cast<unsigned long>(value) << 1) ^ sign);
+}
+
+
+inline
+void
+put_string (std::string & out, char const * str, std::size_t size)
+{
+    put_varint (out, size);
+    out.append (str, size);
+}
+
+
+inline
+void
+put_string (std::string & out, tstring const & str)
+{
+#if defined (UNICODE)
+    std::string const utf8 (LOG4CPLUS_TSTRING_TO_UTF8 (str));
+    put_string (out, utf8.data (), utf8.size ());
+#else
+    put_string (out, str.data (), str.size ());
+#endif
+}
+
+
+//! Appends the IEEE 754 bits of <code>value</code>, low byte first.
+inline
+void
+put_double (std::string & out, double value)
+{
+    unsigned char bytes[sizeof (double)];
+    std::memcpy (bytes, &value, sizeof (bytes));
+    unsigned const one = 1;
+    bool const little_endian
+        = *reinterpret_cast<unsigned char const *>(&one) == 1;
+    for (std::size_t i = 0; i != sizeof (bytes); ++i)
+        out += static_cast<char>(
+            bytes[little_endian ? i : sizeof (bytes) - 1 - i]);
+}
+
+
+inline
+bool
+get_varint (char const * & p, char const * end, unsigned long & value)
+{
+    value = 0;
+    for (unsigned shift = 0; p != end && shift < sizeof (value) * 8;
+         shift += 7)
+    {
+        unsigned char const byte = static_cast<unsigned char>(*p++);
+        value |= static_cast<unsigned long>(byte & 0x7F) << shift;
+        if (! (byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+
+//! Reverses the zigzag encoding of put_svarint().
+inline
+long
+unzigzag (unsigned long value)
+{
+    return static_cast<long>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+
+inline
+bool
+get_svarint (char const * & p, char const * end, long & value)
+{
+    unsigned long u;
+    if (! get_varint (p, end, u))
+        return false;
+
+    value = unzigzag (u);
+    return true;
+}
+
+
+inline
+bool
+get_string (char const * & p, char const * end, tstring & str)
+{
+    unsigned long size;
+    if (! get_varint (p, end, size)
+        || size > static_cast<unsigned long>(end - p))
+        return false;
+
+    str = LOG4CPLUS_UTF8_TO_TSTRING (p, size);
+    p += size;
+    return true;
+}
+
+
+inline
+bool
+get_double (char const * & p, char const * end, double & value)
+{
+    if (end - p < static_cast<std::ptrdiff_t>(sizeof (double)))
+        return false;
+
+    unsigned char bytes[sizeof (double)];
+    unsigned const one = 1;
+    bool const little_endian
+        = *reinterpret_cast<unsigned char const *>(&one) == 1;
+    for (std::size_t i = 0; i != sizeof (bytes); ++i)
+        bytes[little_endian ? i : sizeof (bytes) - 1 - i]
+            = static_cast<unsigned char>(p[i]);
+    std::memcpy (&value, bytes, sizeof (value));
+    p += sizeof (double);
+    return true;
+}
+
+
+} } // namespace log4cplus { namespace internal {
+
+#endif // LOG4CPLUS_INTERNAL_SEGMENT_HEADER_
@@ -0,0 +1,107 @@
+// -*- C++ -*-
+// Module:  Log4CPLUS
+// File:    shmring.h
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file
+ * Layout of the shared memory rings of SharedMemoryAppender.  This
+ * header is internal to log4cplus.
+ */
+
+
+#ifndef LOG4CPLUS_INTERNAL_SHMRING_HEADER_
+#define LOG4CPLUS_INTERNAL_SHMRING_HEADER_
+
+#if ! defined (INSIDE_LOG4CPLUS)
+#  error "This header must not be be used outside log4cplus' implementation files."
+#endif
+
+#include <log4cplus/config.hxx>
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H) && defined (LOG4CPLUS_HAVE_SYS_STAT_H) \
+    && defined (__GNUC__) && ! defined (_WIN32)
+#  define LOG4CPLUS_HAVE_SHM_RING
+#endif
+
+
+namespace log4cplus { namespace internal {
+
+
+//! Ring header: "L4CRING" and the format version.
+static char const shm_ring_magic[8] = { 'L', '4', 'C', 'R', 'I', 'N', 'G', 1 };
+
+//! Frame length that tells the reader to continue at the start of the
+//! data area.
+static unsigned const shm_ring_wrap = 0xFFFFFFFFu;
+
+static unsigned long const shm_ring_min_size = 64 * 1024;
+static unsigned long const shm_ring_max_size = 1024 * 1024 * 1024;
+
+
+//! Header at the start of a ring.  The data area follows it.  The
+//! producer only writes <code>head</code> and the consumer only
+//! <code>tail</code>; each has a cache line of its own.  Both are byte
+//! positions that wrap around at 2^32, and the ring holds
+//! <code>head - tail</code> bytes.
+//!
+//! The data area holds frames: a length and as many bytes of an event
+//! in the socket protocol's encoding, padded to a multiple of four
+//! bytes.  A frame that does not fit before the end of the area is
+//! preceded by a shm_ring_wrap length.
+struct ShmRingHeader
+{
+    char magic[8];
+    unsigned capacity;
+    unsigned pid;
+    //! Set when the producer has closed the ring.
+    volatile unsigned closed;
+    //! Events the producer dropped because the ring was full.
+    volatile unsigned dropped;
+    char pad0[64 - 24];
+
+    volatile unsigned head;
+    char pad1[64 - sizeof (unsigned)];
+
+    volatile unsigned tail;
+    char pad2[64 - sizeof (unsigned)];
+};
+
+
+inline
+unsigned
+shm_ring_align (unsigned size)
+{
+    return (size + 3) & ~3u;
+}
+
+
+//! Orders the accesses to the ring between the processes.
+inline
+void
+shm_ring_barrier ()
+{
+#if defined (LOG4CPLUS_HAVE_SHM_RING)
+    __sync_synchronize ();
+#endif
+}
+
+
+} } // namespace log4cplus { namespace internal {
+
+
+#endif // LOG4CPLUS_INTERNAL_SHMRING_HEADER_
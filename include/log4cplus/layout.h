@@ -57,8 +57,65 @@ namespace log4cplus {
 
         virtual void formatAndAppend(log4cplus::tostream& output, 
                                      const log4cplus::spi::InternalLoggingEvent& event) = 0;
+
+        /**
+         * Returns a string which is equal for two layouts of the same
+         * type exactly when they format every event the same way, e.g.
+         * the conversion pattern of a PatternLayout.  Appenders whose
+         * layouts have the same fingerprint share the formatted output
+         * of an event instead of formatting it again.  It is empty for
+         * layouts that do not take part in the sharing.
+         */
+        const log4cplus::tstring& getFingerprint() const { return fingerprint; }
+
     protected:
+        /**
+         * Writes the output formatted ahead of time for this layout (see
+         * spi::InternalLoggingEvent::setFormattedOutput()) and returns
+         * <code>true</code>.  Returns <code>false</code> if there is none.
+         */
+        bool appendPreformatted(log4cplus::tostream& output,
+                                const log4cplus::spi::InternalLoggingEvent& event) const
+        {
+            if(! event.hasFormattedOutput()) {
+                return false;
+            }
+            const log4cplus::tstring* text
+                = event.getFormattedOutput(this, output.getloc());
+            if(text == 0) {
+                return false;
+            }
+            output << *text;
+            return true;
+        }
+
+        /**
+         * Returns <code>true</code> if the output of this layout for
+         * <code>event</code> is worth storing in the event, i.e. the
+         * layout has a fingerprint and more than one appender may see
+         * the event.
+         */
+        bool shareOutput(const log4cplus::spi::InternalLoggingEvent& event) const
+        {
+            return event.isOutputShared() && ! fingerprint.empty();
+        }
+
+        /**
+         * Returns the stream to format <code>event</code> into.  When
+         * shareOutput() is true this is a per thread buffer, whose
+         * content endFormat() stores in the event and then writes to
+         * <code>output</code>.  Otherwise it is <code>output</code>
+         * itself.
+         */
+        log4cplus::tostream& beginFormat(log4cplus::tostream& output,
+                                         const log4cplus::spi::InternalLoggingEvent& event) const;
+
+        /** Completes the formatting started by beginFormat(). */
+        void endFormat(log4cplus::tostream& output,
+                       const log4cplus::spi::InternalLoggingEvent& event) const;
+
         LogLevelManager& llmCache;
+        log4cplus::tstring fingerprint;
         
     private:
       // Disable copy
@@ -80,8 +137,8 @@ namespace log4cplus {
      */
     class LOG4CPLUS_EXPORT SimpleLayout : public Layout {
     public:
-        SimpleLayout() {}
-        SimpleLayout(const log4cplus::helpers::Properties& properties) : Layout(properties) {}
+        SimpleLayout();
+        SimpleLayout(const log4cplus::helpers::Properties& properties);
 
         virtual void formatAndAppend(log4cplus::tostream& output, 
                                      const log4cplus::spi::InternalLoggingEvent& event);
@@ -141,8 +198,11 @@ namespace log4cplus {
                                      const log4cplus::spi::InternalLoggingEvent& event);
 
     protected:
+       void init();
+
        log4cplus::tstring dateFormat;
        bool use_gmtime;
+       helpers::CompiledTimeFormat compiledDateFormat;
      
     private: 
       // Disallow copying of instances of this class
@@ -257,6 +317,7 @@ namespace log4cplus {
      *   <li>%%p -- Locale's equivalent of AM or PM</li>
      *   <li>%%q -- milliseconds as decimal(0-999) -- <b>Log4CPLUS specific</b>
      *   <li>%%Q -- fractional milliseconds as decimal(0-999.999) -- <b>Log4CPLUS specific</b>
+     *   <li>%%N -- nanoseconds as decimal(000000000-999999999) -- <b>Log4CPLUS specific</b>
      *   <li>%%S -- Second as decimal(0-59)</li>
      *   <li>%%U -- Week of year, Sunday being first day(0-53)</li>
      *   <li>%%w -- Weekday as a decimal(0-6, Sunday being 0)</li>
@@ -383,6 +444,30 @@ namespace log4cplus {
      * </tr>
      *
      * <tr>
+     *   <td align=center><b>X</b></td>
+     *
+     *   <td>Used to output the typed fields of the logging event, see
+     *   spi::EventFields.  With a key enclosed between braces, e.g.
+     *   <b>%%X{user}</b>, only the value of that field is output, or
+     *   nothing if the event has no such field.  Without a key all
+     *   fields are output as <code>key=value</code> pairs separated by
+     *   spaces.
+     *   </td>
+     * </tr>
+     *
+     * <tr>
+     *   <td align=center><b>S</b></td>
+     *
+     *   <td>Used to output the backtrace captured for the logging
+     *   event, one frame per line, each line preceded by a newline and
+     *   a tab.  Backtraces are captured only for events at or above the
+     *   threshold set with helpers::setBacktraceThreshold(); for other
+     *   events nothing is output.  The maximum number of frames can be
+     *   given between braces, e.g. <b>%%S{8}</b>.
+     *   </td>
+     * </tr>
+     *
+     * <tr>
      *   <td align=center><b>"%%"</b></td>
      *   <td>The sequence "%%" outputs a single percent sign.
      *   </td>     
@@ -527,6 +612,80 @@ namespace log4cplus {
 
 
 
+    /**
+     * JsonLayout formats each event as one line holding a JSON object,
+     * e.g.
+     *
+     * <pre>
+     * {"time":"2026-10-18T12:00:00.123Z","level":"INFO","logger":"app","thread":"1234","ndc":"","message":"say \"hi\"\n"}
+     * </pre>
+     *
+     * Strings are escaped as JSON requires; characters outside of
+     * ASCII are left as they are.  The typed fields of the event, see
+     * spi::EventFields, are written as the object <tt>fields</tt>, with
+     * numbers and booleans unquoted.  Events without fields do not get
+     * the member.
+     *
+     * <h3>Properties</h3>
+     * <dl>
+     * <dt><tt>Fields</tt></dt>
+     * <dd>Comma separated list of the members to write, in this
+     * order.  Recognized are <tt>time</tt>, <tt>level</tt>,
+     * <tt>logger</tt>, <tt>thread</tt>, <tt>ndc</tt>, <tt>file</tt>,
+     * <tt>line</tt>, <tt>message</tt> and <tt>fields</tt>.  The default
+     * is <tt>time,level,logger,thread,ndc,message,fields</tt>.</dd>
+     *
+     * <dt><tt>DateFormat</tt></dt>
+     * <dd>Format of <tt>time</tt>, see Time::getFormattedTime().  The
+     * default is <tt>%Y-%m-%dT%H:%M:%S.%qZ</tt>.</dd>
+     *
+     * <dt><tt>Use_gmtime</tt></dt>
+     * <dd>When it is set false, <tt>time</tt> is in local time.  The
+     * default is true.</dd>
+     * </dl>
+     */
+    class LOG4CPLUS_EXPORT JsonLayout : public Layout {
+    public:
+      // Ctors and dtor
+        JsonLayout();
+        JsonLayout(const log4cplus::helpers::Properties& properties);
+        virtual ~JsonLayout();
+
+        virtual void formatAndAppend(log4cplus::tostream& output, 
+                                     const log4cplus::spi::InternalLoggingEvent& event);
+
+        enum Field
+        {
+            TIME_FIELD,
+            LEVEL_FIELD,
+            LOGGER_FIELD,
+            THREAD_FIELD,
+            NDC_FIELD,
+            FILE_FIELD,
+            LINE_FIELD,
+            MESSAGE_FIELD,
+            EVENT_FIELDS
+        };
+
+    protected:
+        void init(const log4cplus::tstring& fields);
+        void format(log4cplus::tstring& out,
+                    const log4cplus::spi::InternalLoggingEvent& event) const;
+
+      // Data
+        std::vector<Field> fields;
+        log4cplus::tstring dateFormat;
+        bool use_gmtime;
+        helpers::CompiledTimeFormat compiledDateFormat;
+
+    private: 
+      // Disallow copying of instances of this class
+        JsonLayout(const JsonLayout&);
+        JsonLayout& operator=(const JsonLayout&);
+    };
+
+
+
 } // end namespace log4cplus
 
 #endif // _LOG4CPLUS_LAYOUT_HEADER_
@@ -0,0 +1,231 @@
+// -*- C++ -*-
+// Module:  Log4CPLUS
+// File:    loadgovernor.h
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file */
+
+
+/** @file */
+
+#ifndef LOG4CPLUS_LOADGOVERNOR_HEADER_
+#define LOG4CPLUS_LOADGOVERNOR_HEADER_
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/loglevel.h>
+#include <log4cplus/tstring.h>
+#include <log4cplus/helpers/pointer.h>
+#include <log4cplus/helpers/timehelper.h>
+#include <log4cplus/thread/syncprims.h>
+
+#include <vector>
+
+
+namespace log4cplus {
+
+    // Forward Declarations
+    class Hierarchy;
+
+    namespace helpers {
+        class Properties;
+    }
+
+    namespace spi {
+        class InternalLoggingEvent;
+        class LoggerImpl;
+    }
+
+    /**
+     * LoadGovernor keeps the log volume of a Hierarchy within a budget.
+     * It measures the events and message bytes of each logger over
+     * windows of <code>Interval</code> milliseconds.  When a window
+     * exceeds the budget, the governor raises the LogLevel of the
+     * noisiest loggers by one step, e.g. from DEBUG to INFO, until their
+     * share covers the excess.  It never raises a level beyond
+     * <code>MaxLevel</code>, so that events at or above it are always
+     * logged.  A raised level also applies to the descendants that
+     * inherit it.
+     *
+     * Levels are restored with hysteresis: only after the volume has
+     * stayed below <code>RestoreRatio</code> percent of the budget for
+     * <code>RestoreAfter</code> windows in a row, the governor restores
+     * the logger it raised last, and so on one logger at a time.
+     * Windows without any events count as quiet when the next event
+     * arrives.  A level changed by other means while it is raised is
+     * left alone.
+     *
+     * Every adjustment is logged at WARN through the
+     * <code>log4cplus.governor</code> logger of the hierarchy, which is
+     * itself never raised.
+     *
+     * Each Hierarchy owns a governor, disabled until a budget is set.
+     * PropertyConfigurator configures it from the properties with the
+     * <code>log4cplus.governor.</code> prefix.
+     *
+     * <h3>Properties</h3>
+     * <dl>
+     * <dt><tt>EventsPerSecond</tt></dt>
+     * <dd>Budget in events per second.  Default is 0, no limit.</dd>
+     *
+     * <dt><tt>BytesPerSecond</tt></dt>
+     * <dd>Budget in message bytes per second.  Default is 0, no
+     * limit.</dd>
+     *
+     * <dt><tt>Interval</tt></dt>
+     * <dd>Length of a measuring window in milliseconds.  Default is
+     * 1000.</dd>
+     *
+     * <dt><tt>MaxLevel</tt></dt>
+     * <dd>The highest LogLevel the governor raises loggers to.  Default
+     * is WARN.</dd>
+     *
+     * <dt><tt>RestoreRatio</tt></dt>
+     * <dd>Percentage of the budget the volume must stay below before
+     * levels are restored.  Default is 50.</dd>
+     *
+     * <dt><tt>RestoreAfter</tt></dt>
+     * <dd>Number of quiet windows in a row after which a level is
+     * restored.  Default is 5.</dd>
+     *
+     * </dl>
+     */
+    class LOG4CPLUS_EXPORT LoadGovernor
+    {
+    public:
+      // Ctor and Dtor
+        LoadGovernor(Hierarchy & hierarchy);
+        ~LoadGovernor();
+
+      // Methods
+        /** Sets the budget and options from <code>properties</code>. */
+        void configure(helpers::Properties const & properties);
+
+        /**
+         * Sets the budget.  Either limit may be 0 for none; with both
+         * 0 the governor is disabled.
+         */
+        void setBudget(unsigned long eventsPerSecond,
+            unsigned long bytesPerSecond);
+
+        void setInterval(unsigned long millis);
+        void setMaxLevel(LogLevel level);
+        void setRestoreThreshold(unsigned ratio, unsigned windows);
+
+        /**
+         * Restores the levels raised by the governor and disables it.
+         * Called by Hierarchy::resetConfiguration().
+         */
+        void reset();
+
+        /**
+         * Returns whether a budget is set.  It is read without the lock,
+         * so a change may be seen by events logged shortly after it.
+         */
+        bool isEnabled() const;
+
+        /** Returns the number of loggers whose level is raised. */
+        std::size_t getShedCount() const;
+
+        /**
+         * Accounts for <code>event</code>, logged by <code>logger</code>,
+         * and adjusts levels at the end of a window.  Called by
+         * spi::LoggerImpl::callAppenders() when the governor is
+         * enabled.
+         */
+        void record(spi::LoggerImpl & logger,
+            spi::InternalLoggingEvent const & event);
+
+        /** Locks the governor for fork(), see Hierarchy::atforkPrepare(). */
+        void atforkPrepare();
+
+        /** Unlocks the governor in the parent process after fork(). */
+        void atforkParent();
+
+        /** Reinitializes the lock in the child process after fork(). */
+        void atforkChild();
+
+    protected:
+        typedef helpers::SharedObjectPtr<spi::LoggerImpl> LoggerImplPtr;
+
+        struct Volume
+        {
+            Volume ();
+
+            LoggerImplPtr logger;
+            unsigned long events;
+            unsigned long bytes;
+        };
+
+        struct ShedLogger
+        {
+            LoggerImplPtr logger;
+            //! Level of the logger before it was first raised.
+            LogLevel original;
+            //! Level the governor set last.
+            LogLevel applied;
+        };
+
+        typedef std::vector<Volume> VolumeList;
+
+        unsigned long millisOf(helpers::Time const & time) const;
+        void rollover(unsigned long now, std::vector<tstring> & messages);
+        void collect();
+        void evaluate(std::vector<tstring> & messages);
+        void addQuietWindows(unsigned long windows,
+            std::vector<tstring> & messages);
+        void shed(unsigned long events, unsigned long bytes,
+            std::vector<tstring> & messages);
+        void restore(std::vector<tstring> & messages);
+        void restoreAll();
+
+      // Data
+        Hierarchy & hierarchy;
+        //! Read and written with atomic operations, like windowEnd.
+        unsigned long volatile enabled;
+        unsigned long eventsPerSecond;
+        unsigned long bytesPerSecond;
+        unsigned long interval;
+        LogLevel maxLevel;
+        unsigned restoreRatio;
+        unsigned restoreAfter;
+
+        thread::Mutex mutex;
+        //! Event times are counted in milliseconds from here, modulo
+        //! the range of unsigned long.
+        helpers::Time origin;
+        //! End of the current window, read without the lock.
+        unsigned long volatile windowEnd;
+        bool started;
+        //! Loggers whose events are counted, by
+        //! spi::LoggerImpl::governorEvents and governorBytes.
+        std::vector<LoggerImplPtr> counted;
+        //! Volumes of the window being evaluated.
+        VolumeList volumes;
+        //! Raised loggers, in the order they were first raised.
+        std::vector<ShedLogger> shedLoggers;
+        unsigned quietWindows;
+
+    private:
+      // Disallow copying of instances of this class
+        LoadGovernor(LoadGovernor const &);
+        LoadGovernor & operator = (LoadGovernor const &);
+    };
+
+} // end namespace log4cplus
+
+#endif // LOG4CPLUS_LOADGOVERNOR_HEADER_
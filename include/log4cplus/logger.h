@@ -47,6 +47,7 @@ namespace log4cplus
     {
 
         class LoggerImpl;
+        class EventFields;
 
     }
 
@@ -177,6 +178,14 @@ namespace log4cplus
         void log(LogLevel ll, const log4cplus::tstring& message,
                  const char* file=NULL, int line=-1) const;
 
+        /**
+         * Like log() above, with the typed <code>fields</code> attached
+         * to the event.
+         */
+        void log(LogLevel ll, const log4cplus::tstring& message,
+                 const spi::EventFields& fields,
+                 const char* file=NULL, int line=-1) const;
+
         /**
          * This method creates a new logging event and logs the event
          * without further checks.  
@@ -184,6 +193,15 @@ namespace log4cplus
         void forcedLog(LogLevel ll, const log4cplus::tstring& message,
                        const char* file=NULL, int line=-1) const;
 
+        /**
+         * Like forcedLog() above, with the typed <code>fields</code>
+         * attached to the event.  The field values are kept in their
+         * types and only formatted by layouts that print them.
+         */
+        void forcedLog(LogLevel ll, const log4cplus::tstring& message,
+                       const spi::EventFields& fields,
+                       const char* file=NULL, int line=-1) const;
+
         /**
          * Call the appenders in the hierrachy starting at
          * <code>this</code>.  If no appenders could be found, emit a
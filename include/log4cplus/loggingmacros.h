@@ -27,6 +27,7 @@
 
 #include <log4cplus/config.hxx>
 #include <log4cplus/streams.h>
+#include <log4cplus/spi/loggingevent.h>
 #include <sstream>
 
 
@@ -70,6 +71,18 @@ LOG4CPLUS_EXPORT void _clear_tostringstream (tostringstream &);
     } while (0)
 
 
+#define LOG4CPLUS_MACRO_FIELDS_BODY(logger, logEvent, fields, logLevel) \
+    do {                                                                \
+        if((logger).isEnabledFor(log4cplus::logLevel##_LOG_LEVEL)) {    \
+            log4cplus::_clear_tostringstream (log4cplus::_macros_oss);  \
+            log4cplus::_macros_oss << logEvent;                         \
+            (logger).forcedLog(log4cplus::logLevel##_LOG_LEVEL,         \
+                log4cplus::_macros_oss.str(), fields,                   \
+                __FILE__, __LINE__);                                    \
+        }                                                               \
+    } while (0)
+
+
 #else // defined (LOG4CPLUS_SINGLE_THREADED)
 
 #define LOG4CPLUS_MACRO_BODY(logger, logEvent, logLevel)                \
@@ -83,6 +96,17 @@ LOG4CPLUS_EXPORT void _clear_tostringstream (tostringstream &);
     } while (0)
 
 
+#define LOG4CPLUS_MACRO_FIELDS_BODY(logger, logEvent, fields, logLevel) \
+    do {                                                                \
+        if((logger).isEnabledFor(log4cplus::logLevel##_LOG_LEVEL)) {    \
+            log4cplus::tostringstream _log4cplus_buf;                   \
+            _log4cplus_buf << logEvent;                                 \
+            (logger).forcedLog(log4cplus::logLevel##_LOG_LEVEL,         \
+                _log4cplus_buf.str(), fields, __FILE__, __LINE__);      \
+        }                                                               \
+    } while (0)
+
+
 #endif // defined (LOG4CPLUS_SINGLE_THREADED)
 
 #define LOG4CPLUS_MACRO_STR_BODY(logger, logEvent, logLevel)            \
@@ -94,6 +118,14 @@ LOG4CPLUS_EXPORT void _clear_tostringstream (tostringstream &);
     } while(0)
 
 
+/**
+ * Each of the LOG4CPLUS_TRACE() to LOG4CPLUS_FATAL() macros has a
+ * <code>_FIELDS</code> variant, e.g. LOG4CPLUS_INFO_FIELDS(logger,
+ * logEvent, fields), which attaches the spi::EventFields
+ * <code>fields</code> to the event.  The expression <code>fields</code>
+ * is only evaluated if the logger is enabled for the level.
+ */
+
 /**
  * @def LOG4CPLUS_TRACE(logger, logEvent)  This macro creates a TraceLogger 
  * to log a TRACE_LOG_LEVEL message to <code>logger</code> upon entry and
@@ -108,10 +140,13 @@ LOG4CPLUS_EXPORT void _clear_tostringstream (tostringstream &);
     LOG4CPLUS_MACRO_BODY (logger, logEvent, TRACE)
 #define LOG4CPLUS_TRACE_STR(logger, logEvent)                           \
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, TRACE)
+#define LOG4CPLUS_TRACE_FIELDS(logger, logEvent, fields)                \
+    LOG4CPLUS_MACRO_FIELDS_BODY (logger, logEvent, fields, TRACE)
 #else
 #define LOG4CPLUS_TRACE_METHOD(logger, logEvent) do { } while (0)
 #define LOG4CPLUS_TRACE(logger, logEvent) do { } while (0)
 #define LOG4CPLUS_TRACE_STR(logger, logEvent) do { } while (0)
+#define LOG4CPLUS_TRACE_FIELDS(logger, logEvent, fields) do { } while (0)
 #endif
 
 /**
@@ -124,9 +159,12 @@ LOG4CPLUS_EXPORT void _clear_tostringstream (tostringstream &);
     LOG4CPLUS_MACRO_BODY (logger, logEvent, DEBUG)
 #define LOG4CPLUS_DEBUG_STR(logger, logEvent)                           \
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, DEBUG)
+#define LOG4CPLUS_DEBUG_FIELDS(logger, logEvent, fields)                \
+    LOG4CPLUS_MACRO_FIELDS_BODY (logger, logEvent, fields, DEBUG)
 #else
 #define LOG4CPLUS_DEBUG(logger, logEvent) do { } while (0)
 #define LOG4CPLUS_DEBUG_STR(logger, logEvent) do { } while (0)
+#define LOG4CPLUS_DEBUG_FIELDS(logger, logEvent, fields) do { } while (0)
 #endif
 
 /**
@@ -139,9 +177,12 @@ LOG4CPLUS_EXPORT void _clear_tostringstream (tostringstream &);
     LOG4CPLUS_MACRO_BODY (logger, logEvent, INFO)
 #define LOG4CPLUS_INFO_STR(logger, logEvent)                            \
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, INFO)
+#define LOG4CPLUS_INFO_FIELDS(logger, logEvent, fields)                 \
+    LOG4CPLUS_MACRO_FIELDS_BODY (logger, logEvent, fields, INFO)
 #else
 #define LOG4CPLUS_INFO(logger, logEvent) do { } while (0)
 #define LOG4CPLUS_INFO_STR(logger, logEvent) do { } while (0)
+#define LOG4CPLUS_INFO_FIELDS(logger, logEvent, fields) do { } while (0)
 #endif
 
 /**
@@ -154,9 +195,12 @@ LOG4CPLUS_EXPORT void _clear_tostringstream (tostringstream &);
     LOG4CPLUS_MACRO_BODY (logger, logEvent, WARN)
 #define LOG4CPLUS_WARN_STR(logger, logEvent)                            \
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, WARN)
+#define LOG4CPLUS_WARN_FIELDS(logger, logEvent, fields)                 \
+    LOG4CPLUS_MACRO_FIELDS_BODY (logger, logEvent, fields, WARN)
 #else
 #define LOG4CPLUS_WARN(logger, logEvent) do { } while (0)
 #define LOG4CPLUS_WARN_STR(logger, logEvent) do { } while (0)
+#define LOG4CPLUS_WARN_FIELDS(logger, logEvent, fields) do { } while (0)
 #endif
 
 /**
@@ -169,9 +213,12 @@ LOG4CPLUS_EXPORT void _clear_tostringstream (tostringstream &);
     LOG4CPLUS_MACRO_BODY (logger, logEvent, ERROR)
 #define LOG4CPLUS_ERROR_STR(logger, logEvent)                           \
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, ERROR)
+#define LOG4CPLUS_ERROR_FIELDS(logger, logEvent, fields)                \
+    LOG4CPLUS_MACRO_FIELDS_BODY (logger, logEvent, fields, ERROR)
 #else
 #define LOG4CPLUS_ERROR(logger, logEvent) do { } while (0)
 #define LOG4CPLUS_ERROR_STR(logger, logEvent) do { } while (0)
+#define LOG4CPLUS_ERROR_FIELDS(logger, logEvent, fields) do { } while (0)
 #endif
 
 /**
@@ -184,9 +231,12 @@ LOG4CPLUS_EXPORT void _clear_tostringstream (tostringstream &);
     LOG4CPLUS_MACRO_BODY (logger, logEvent, FATAL)
 #define LOG4CPLUS_FATAL_STR(logger, logEvent)                           \
     LOG4CPLUS_MACRO_STR_BODY (logger, logEvent, FATAL)
+#define LOG4CPLUS_FATAL_FIELDS(logger, logEvent, fields)                \
+    LOG4CPLUS_MACRO_FIELDS_BODY (logger, logEvent, fields, FATAL)
 #else
 #define LOG4CPLUS_FATAL(logger, logEvent) do { } while (0)
 #define LOG4CPLUS_FATAL_STR(logger, logEvent) do { } while (0)
+#define LOG4CPLUS_FATAL_FIELDS(logger, logEvent, fields) do { } while (0)
 #endif
 
 #endif /* _LOG4CPLUS_LOGGING_MACROS_HEADER_ */
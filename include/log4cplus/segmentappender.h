@@ -0,0 +1,207 @@
+// -*- C++ -*-
+// Module:  Log4CPLUS
+// File:    segmentappender.h
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file */
+
+
+#ifndef LOG4CPLUS_SEGMENTAPPENDER_HEADER_
+#define LOG4CPLUS_SEGMENTAPPENDER_HEADER_
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/appender.h>
+#include <log4cplus/loglevel.h>
+#include <log4cplus/tstring.h>
+#include <log4cplus/helpers/timehelper.h>
+#include <log4cplus/spi/loggingevent.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+namespace log4cplus {
+
+    /**
+     * SegmentAppender stores events in a compact binary, column
+     * oriented file instead of text.  Events are collected into row
+     * groups; each row group stores every event attribute as a column:
+     *
+     * <ul>
+     * <li>the timestamps as deltas,</li>
+     * <li>the log level, logger name, thread name, NDC and file name as
+     * indices into a dictionary of the distinct values of the row
+     * group,</li>
+     * <li>the line numbers,</li>
+     * <li>the messages, compressed with helpers::lzCompress(),</li>
+     * <li>the typed event fields.</li>
+     * </ul>
+     *
+     * Each row group starts with the number of its rows and the range of
+     * its levels and timestamps, so that readers skip row groups that
+     * cannot match a query without decoding them.  Strings are stored
+     * as UTF-8.  The files are read by SegmentReader.  The appender does
+     * not use its layout.
+     *
+     * A row group is written when it is full and by flush() and
+     * close(); events still collected are lost when the process dies.
+     *
+     * <h3>Properties</h3>
+     * <dl>
+     * <dt><tt>File</tt></dt>
+     * <dd>Name of the segment file.</dd>
+     *
+     * <dt><tt>RowGroupSize</tt></dt>
+     * <dd>Number of events per row group.  Default is 4096.</dd>
+     *
+     * <dt><tt>MaxFileSize</tt></dt>
+     * <dd>Size after which the file is rolled over the way
+     * RollingFileAppender does, with <tt>KB</tt> and <tt>MB</tt>
+     * suffixes understood.  Default is 64MB.</dd>
+     *
+     * <dt><tt>MaxBackupIndex</tt></dt>
+     * <dd>Number of rolled segment files kept.  Default is 1.</dd>
+     * </dl>
+     */
+    class LOG4CPLUS_EXPORT SegmentAppender
+        : public Appender
+    {
+    public:
+      // Ctors
+        SegmentAppender(const log4cplus::tstring& filename,
+                        unsigned rowGroupSize = 4096,
+                        long maxFileSize = 64 * 1024 * 1024,
+                        int maxBackupIndex = 1);
+        SegmentAppender(const log4cplus::helpers::Properties& properties);
+
+      // Dtor
+        virtual ~SegmentAppender();
+
+      // Methods
+        virtual void close();
+
+        /** Writes the events collected so far as a row group. */
+        virtual void flush();
+
+    protected:
+        virtual void append(const spi::InternalLoggingEvent& event);
+
+        void init(const log4cplus::tstring& filename, unsigned rowGroupSize,
+                  long maxFileSize, int maxBackupIndex);
+        void open();
+        void writeRowGroup();
+        void rollover();
+
+      // Data
+        log4cplus::tstring filename;
+        unsigned rowGroupSize;
+        long maxFileSize;
+        int maxBackupIndex;
+
+        std::ofstream out;
+        long fileSize;
+        std::vector<spi::InternalLoggingEvent> rows;
+        //! Encoding buffer, kept to reuse its memory.
+        std::string buffer;
+
+    private:
+      // Disallow copying of instances of this class
+        SegmentAppender(const SegmentAppender&);
+        SegmentAppender& operator=(const SegmentAppender&);
+    };
+
+
+
+    /**
+     * SegmentReader reads the events from a file written by
+     * SegmentAppender, one row group at a time.  Row groups that cannot
+     * hold events within the time range and level set with
+     * setTimeRange() and setMinLogLevel() are skipped without being
+     * decoded.
+     *
+     * <pre>
+     * SegmentReader reader(LOG4CPLUS_TEXT("app.seg"));
+     * reader.setMinLogLevel(WARN_LOG_LEVEL);
+     * std::vector<spi::InternalLoggingEvent> events;
+     * while(reader.readRowGroup(events)) {
+     *     // ...
+     *     events.clear();
+     * }
+     * </pre>
+     */
+    class LOG4CPLUS_EXPORT SegmentReader
+    {
+    public:
+      // Ctors
+        explicit SegmentReader(const log4cplus::tstring& filename);
+
+      // Dtor
+        ~SegmentReader();
+
+      // Methods
+        /** Returns true if the file was opened and is a segment file. */
+        bool isOpen() const { return valid; }
+
+        /**
+         * Only return events with timestamps in [from, to].
+         */
+        void setTimeRange(const helpers::Time& from, const helpers::Time& to);
+
+        /** Only return events at or above <code>ll</code>. */
+        void setMinLogLevel(LogLevel ll) { minLogLevel = ll; }
+
+        /**
+         * Appends the matching events of the next row group that may
+         * hold any to <code>events</code>.  Returns false at the end of
+         * the file or when the file is damaged, see isDamaged().
+         */
+        bool readRowGroup(std::vector<spi::InternalLoggingEvent>& events);
+
+        /** Returns true if reading stopped at a damaged row group. */
+        bool isDamaged() const { return damaged; }
+
+        /** Number of row groups skipped by the filters so far. */
+        unsigned long getSkippedRowGroups() const { return skippedRowGroups; }
+
+    protected:
+        bool decodeRowGroup(unsigned long rowCount, long minSec,
+                            std::vector<spi::InternalLoggingEvent>& events);
+        bool matches(const spi::InternalLoggingEvent& event) const;
+
+      // Data
+        std::ifstream in;
+        bool valid;
+        bool damaged;
+        bool timeFilter;
+        helpers::Time from;
+        helpers::Time to;
+        LogLevel minLogLevel;
+        unsigned long skippedRowGroups;
+        //! Row group being decoded.
+        std::string body;
+
+    private:
+      // Disallow copying of instances of this class
+        SegmentReader(const SegmentReader&);
+        SegmentReader& operator=(const SegmentReader&);
+    };
+
+} // end namespace log4cplus
+
+#endif // LOG4CPLUS_SEGMENTAPPENDER_HEADER_
@@ -0,0 +1,189 @@
+// -*- C++ -*-
+// Module:  Log4CPLUS
+// File:    sharedmemoryappender.h
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file */
+
+
+#ifndef LOG4CPLUS_SHAREDMEMORYAPPENDER_HEADER_
+#define LOG4CPLUS_SHAREDMEMORYAPPENDER_HEADER_
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/appender.h>
+#include <log4cplus/helpers/property.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+namespace log4cplus {
+
+    namespace internal {
+        struct ShmRingHeader;
+    }
+
+    /**
+     * SharedMemoryAppender hands events to a collector process, e.g.
+     * <tt>loggingserver -shm</tt>, through a ring buffer in POSIX shared
+     * memory, so that many processes on a host can share the
+     * collector's appenders instead of each writing its own files.
+     *
+     * Each process creates its own ring, named with the
+     * <tt>Prefix</tt> and its process id.  Events are written into the
+     * ring in the encoding of the socket protocol without any system
+     * call; the collector polls the rings.  When a ring is full, events
+     * are dropped and counted.
+     *
+     * The ring outlives the process, so that the collector can read
+     * the last events, and the collector removes it afterwards.  Rings
+     * are only found by a collector on Linux, where they are listed in
+     * <tt>/dev/shm</tt>.
+     *
+     * <h3>Properties</h3>
+     * <dl>
+     * <dt><tt>Prefix</tt></dt>
+     * <dd>Prefix of the ring names.  Default is <tt>/log4cplus-</tt>.
+     * </dd>
+     *
+     * <dt><tt>RingSize</tt></dt>
+     * <dd>Size of the ring, rounded up to a power of two between 64 KB
+     * and 1 GB.  Default is 4 MB.  It is possible to use <tt>MB</tt>
+     * and <tt>KB</tt> suffixes.  Negative or malformed values keep the
+     * default.</dd>
+     *
+     * <dt><tt>HugePages</tt></dt>
+     * <dd>When it is set true, the ring is mapped with transparent huge
+     * pages where the system allows it for shared memory (Linux).</dd>
+     *
+     * <dt><tt>ServerName</tt></dt>
+     * <dd>Host name of event's origin prepended to each event.</dd>
+     * </dl>
+     */
+    class LOG4CPLUS_EXPORT SharedMemoryAppender : public Appender {
+    public:
+      // Ctors
+        SharedMemoryAppender(const log4cplus::tstring& prefix
+                                 = LOG4CPLUS_TEXT("/log4cplus-"),
+                             unsigned long ringSize = 4 * 1024 * 1024,
+                             bool hugePages = false);
+        SharedMemoryAppender(const log4cplus::helpers::Properties& properties);
+
+      // Dtor
+        virtual ~SharedMemoryAppender();
+
+      // Methods
+        virtual void close();
+
+        /**
+         * Leaves the ring of the parent process alone and creates one
+         * for the child.
+         */
+        virtual void atforkChild();
+
+        //! Name of the ring of this process.
+        const std::string& getRingName() const { return ringName; }
+
+        //! Returns the number of events dropped because the ring was full.
+        unsigned long getDroppedCount() const;
+
+    protected:
+        virtual void append(const spi::InternalLoggingEvent& event);
+
+        void openRing();
+        //! Unmaps the ring and, with <code>markClosed</code>, tells the
+        //! collector that no more events follow.
+        void closeRing(bool markClosed);
+
+      // Data
+        log4cplus::tstring prefix;
+        unsigned long ringSize;
+        bool hugePages;
+        log4cplus::tstring serverName;
+        std::string ringName;
+        internal::ShmRingHeader* ring;
+        char* data;
+
+    private:
+        void init();
+
+      // Disallow copying of instances of this class
+        SharedMemoryAppender(const SharedMemoryAppender&);
+        SharedMemoryAppender& operator=(const SharedMemoryAppender&);
+    };
+
+
+    /**
+     * Reads the rings of SharedMemoryAppenders and passes the events on
+     * to the appenders of their loggers in this process, the way
+     * <tt>loggingserver</tt> does with events received over sockets.
+     *
+     * Rings whose producer has closed them or has exited are removed
+     * once they are empty.
+     */
+    class LOG4CPLUS_EXPORT SharedMemoryCollector
+    {
+    public:
+      // Ctors
+        explicit SharedMemoryCollector(const log4cplus::tstring& prefix
+                                           = LOG4CPLUS_TEXT("/log4cplus-"));
+
+      // Dtor
+        ~SharedMemoryCollector();
+
+      // Methods
+        /** Attaches to rings created since the last call. */
+        void rescan();
+
+        /**
+         * Passes on all events in the attached rings and returns their
+         * number.
+         */
+        std::size_t drain();
+
+        //! Number of attached rings.
+        std::size_t getRingCount() const { return rings.size(); }
+
+    protected:
+        struct Ring
+        {
+            std::string name;
+            internal::ShmRingHeader* header;
+            char* data;
+            std::size_t mappedSize;
+            unsigned dropped;
+        };
+
+        bool attach(const std::string& name);
+        std::size_t drainRing(Ring& ring);
+        void detach(Ring& ring, bool remove);
+
+      // Data
+        std::string prefix;
+        std::vector<Ring> rings;
+
+    private:
+      // Disallow copying of instances of this class
+        SharedMemoryCollector(const SharedMemoryCollector&);
+        SharedMemoryCollector& operator=(const SharedMemoryCollector&);
+    };
+
+} // end namespace log4cplus
+
+#endif // LOG4CPLUS_SHAREDMEMORYAPPENDER_HEADER_
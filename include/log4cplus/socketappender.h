@@ -103,6 +103,12 @@ namespace log4cplus {
       // Methods
         virtual void close();
 
+        /**
+         * Opens a new connection for the child process, so that the
+         * processes do not write into the same one.
+         */
+        virtual void atforkChild();
+
     protected:
         void openSocket();
         void initConnector ();
@@ -130,6 +136,10 @@ namespace log4cplus {
             void terminate ();
             void trigger ();
 
+            //! Makes the object safe to destroy in a child process after
+            //! fork(), where its thread does not exist.
+            void reinitialize ();
+
         protected:
             SocketAppender & sa;
             thread::ManualResetEvent trigger_ev;
@@ -147,6 +157,12 @@ namespace log4cplus {
     };
 
     namespace helpers {
+        /**
+         * Serializes <code>event</code> for the socket protocol.  The
+         * message has version 4 if the event has fields, version 3 if
+         * its timestamp has nanoseconds beyond the microseconds, and
+         * version 2, which older readers understand, otherwise.
+         */
         LOG4CPLUS_EXPORT
         void convertToBuffer(SocketBuffer & buffer,
             const spi::InternalLoggingEvent& event, const tstring& serverName);
@@ -0,0 +1,198 @@
+// -*- C++ -*-
+// Module:  Log4CPLUS
+// File:    socketpoolappender.h
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/** @file */
+
+#ifndef LOG4CPLUS_SOCKETPOOLAPPENDER_HEADER_
+#define LOG4CPLUS_SOCKETPOOLAPPENDER_HEADER_
+
+#include <log4cplus/config.hxx>
+#include <log4cplus/appender.h>
+#include <log4cplus/helpers/socket.h>
+#include <log4cplus/helpers/timehelper.h>
+#include <log4cplus/thread/syncprims.h>
+#include <log4cplus/thread/threads.h>
+
+#include <utility>
+#include <vector>
+
+
+namespace log4cplus {
+
+    /**
+     * SocketPoolAppender sends events, in the format of SocketAppender,
+     * to a pool of log servers.
+     *
+     * The servers are placed on a consistent hash ring, each at a number
+     * of points.  An event goes to the server that follows the hash of
+     * its key on the ring, so all events of one logger (or of one value
+     * of the key field) reach the same server, and adding or removing a
+     * server only moves the keys next to its points.
+     *
+     * When writing to a server fails, or its average write latency
+     * exceeds <code>MaxLatency</code>, the server is taken out of the
+     * ring and its events go to the next healthy server along the ring.
+     * A connector thread tries to reconnect to such servers once
+     * <code>RetryDelay</code> has passed, and puts them back into use.
+     * In single threaded builds the reconnection is done by the logging
+     * thread.  Events are dropped only when no server is healthy.
+     *
+     * <h3>Properties</h3>
+     * <dl>
+     * <dt><tt>Servers</tt></dt>
+     * <dd>Comma separated list of servers as <tt>host:port</tt>.  The
+     * port defaults to 9998.</dd>
+     *
+     * <dt><tt>HashKey</tt></dt>
+     * <dd>Name of the event field whose value selects the server.
+     * Events without that field, and all events when it is not set, are
+     * hashed by their logger name.</dd>
+     *
+     * <dt><tt>VirtualNodes</tt></dt>
+     * <dd>Number of points each server has on the ring.  Default is
+     * 64.</dd>
+     *
+     * <dt><tt>RetryDelay</tt></dt>
+     * <dd>Milliseconds to wait before reconnecting to a failed server.
+     * Default is 5000.</dd>
+     *
+     * <dt><tt>MaxLatency</tt></dt>
+     * <dd>Average write latency in milliseconds above which a server is
+     * treated as failed.  Default is 0, which disables the check.</dd>
+     *
+     * <dt><tt>ServerName</tt></dt>
+     * <dd>Host name of event's origin prepended to each event.</dd>
+     *
+     * </dl>
+     */
+    class LOG4CPLUS_EXPORT SocketPoolAppender : public Appender {
+    public:
+        /** Health and latency figures of one server of the pool. */
+        struct EndpointStats
+        {
+            tstring host;
+            int port;
+            bool healthy;
+            //! Events written to the server.
+            unsigned long sent;
+            //! Failed writes and connection attempts.
+            unsigned long failures;
+            //! Events the server took over from a failed one.
+            unsigned long failovers;
+            //! Moving average and maximum of write latency, in
+            //! microseconds.
+            unsigned long avgLatency;
+            unsigned long maxLatency;
+        };
+
+      // Ctors
+        SocketPoolAppender(const tstring& servers,
+                           const tstring& serverName = tstring());
+        SocketPoolAppender(const helpers::Properties & properties);
+
+      // Dtor
+        ~SocketPoolAppender();
+
+      // Methods
+        virtual void close();
+
+        /** Returns the figures of the servers in configuration order. */
+        std::vector<EndpointStats> getEndpointStats();
+
+        /** Returns the number of events no healthy server was left for. */
+        unsigned long getDroppedCount();
+
+        /**
+         * Opens new connections for the child process, so that the
+         * processes do not write into the same ones.
+         */
+        virtual void atforkChild();
+
+    protected:
+        struct Endpoint
+        {
+            EndpointStats stats;
+            helpers::Socket socket;
+            //! Time of the next connection attempt of a failed server.
+            helpers::Time retryTime;
+        };
+
+        //! Points of the ring, sorted by hash, with the server index.
+        typedef std::vector<std::pair<unsigned long, std::size_t> > Ring;
+
+        void init(const tstring& servers);
+        void openSockets();
+        void initConnector();
+        void markFailed(std::size_t index, const tstring& reason);
+
+        //! Reconnects to the failed servers which are due.  Returns the
+        //! milliseconds until the next attempt.
+        long reconnect();
+
+        virtual void append(const spi::InternalLoggingEvent& event);
+
+      // Data
+        std::vector<Endpoint> endpoints;
+        Ring ring;
+        tstring hashKey;
+        unsigned virtualNodes;
+        long retryDelay;
+        unsigned long maxLatency;
+        tstring serverName;
+        unsigned long droppedCount;
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+        class LOG4CPLUS_EXPORT ConnectorThread;
+        friend class ConnectorThread;
+
+        class LOG4CPLUS_EXPORT ConnectorThread
+            : public thread::AbstractThread
+        {
+        public:
+            ConnectorThread (SocketPoolAppender &);
+            virtual ~ConnectorThread ();
+
+            virtual void run();
+
+            void terminate ();
+            void trigger ();
+
+            //! Makes the object safe to destroy in a child process after
+            //! fork(), where its thread does not exist.
+            void reinitialize ();
+
+        protected:
+            SocketPoolAppender & spa;
+            thread::ManualResetEvent trigger_ev;
+            bool exit_flag;
+        };
+
+        helpers::SharedObjectPtr<ConnectorThread> connector;
+#endif
+
+    private:
+      // Disallow copying of instances of this class
+        SocketPoolAppender(const SocketPoolAppender&);
+        SocketPoolAppender& operator=(const SocketPoolAppender&);
+    };
+
+} // end namespace log4cplus
+
+#endif // LOG4CPLUS_SOCKETPOOLAPPENDER_HEADER_
@@ -35,6 +35,7 @@
 
 namespace log4cplus {
     class DefaultLoggerFactory;
+    class LoadGovernor;
 
     namespace spi {
 
@@ -88,6 +89,14 @@ namespace log4cplus {
             virtual void log(LogLevel ll, const log4cplus::tstring& message,
                              const char* file=NULL, int line=-1);
 
+            /**
+             * Like log() above, with <code>fields</code> attached to the
+             * event.
+             */
+            virtual void log(LogLevel ll, const log4cplus::tstring& message,
+                             const EventFields& fields,
+                             const char* file=NULL, int line=-1);
+
             /**
              * Starting from this logger, search the logger hierarchy for a
              * "set" LogLevel and return it. Otherwise, return the LogLevel of the
@@ -158,6 +167,16 @@ namespace log4cplus {
                                    const char* file=NULL, 
                                    int line=-1);
 
+            /**
+             * Like forcedLog() above, with <code>fields</code> attached
+             * to the event.
+             */
+            virtual void forcedLog(LogLevel ll,
+                                   const log4cplus::tstring& message,
+                                   const EventFields& fields,
+                                   const char* file=NULL,
+                                   int line=-1);
+
 
           // Data
             /** The name of this logger */
@@ -190,6 +209,15 @@ namespace log4cplus {
             /** Loggers need to know what Hierarchy they are in. */
             Hierarchy& hierarchy;
 
+            /**
+             * Events and message bytes counted by the LoadGovernor in its
+             * current window, and whether it keeps track of them.  They
+             * are accessed with atomic operations.
+             */
+            unsigned long volatile governorEvents;
+            unsigned long volatile governorBytes;
+            unsigned long volatile governed;
+
           // Disallow copying of instances of this class
             LoggerImpl(const LoggerImpl&);
             LoggerImpl& operator=(const LoggerImpl&);
@@ -198,6 +226,7 @@ namespace log4cplus {
             friend class log4cplus::Logger;
             friend class log4cplus::DefaultLoggerFactory;
             friend class log4cplus::Hierarchy;
+            friend class log4cplus::LoadGovernor;
         };
 
         typedef LoggerImpl::SharedLoggerImplPtr SharedLoggerImplPtr;
@@ -28,12 +28,137 @@
 #include <log4cplus/loglevel.h>
 #include <log4cplus/ndc.h>
 #include <log4cplus/tstring.h>
+#include <log4cplus/helpers/backtrace.h>
 #include <log4cplus/helpers/timehelper.h>
 #include <log4cplus/thread/threads.h>
+#include <locale>
 #include <memory>
+#include <typeinfo>
+#include <vector>
 
 namespace log4cplus {
+
+    // Forward Declarations
+    class Layout;
+
     namespace spi {
+        /**
+         * A typed key-value pair attached to a logging event.  The value
+         * is kept in its native type and only converted to text by the
+         * layouts that print it.
+         */
+        class LOG4CPLUS_EXPORT EventField {
+        public:
+            /** Value types.  The numbers are part of the socket protocol. */
+            enum Type
+            {
+                INTEGER_FIELD  = 0,
+                DOUBLE_FIELD   = 1,
+                STRING_FIELD   = 2,
+                BOOL_FIELD     = 3,
+                UNSIGNED_FIELD = 4
+            };
+
+          // Ctors
+            EventField(const log4cplus::tstring& key, long value);
+            EventField(const log4cplus::tstring& key, unsigned long value);
+            EventField(const log4cplus::tstring& key, double value);
+            EventField(const log4cplus::tstring& key, bool value);
+            EventField(const log4cplus::tstring& key,
+                       const log4cplus::tstring& value);
+
+          // Methods
+            const log4cplus::tstring& getKey() const { return key; }
+            Type getType() const { return type; }
+
+            /** Valid for INTEGER_FIELD only. */
+            long getInteger() const { return value.integer; }
+
+            /** Valid for UNSIGNED_FIELD only. */
+            unsigned long getUnsigned() const { return value.uinteger; }
+
+            /** Valid for DOUBLE_FIELD only. */
+            double getDouble() const { return value.dbl; }
+
+            /** Valid for BOOL_FIELD only. */
+            bool getBool() const { return value.boolean; }
+
+            /** Valid for STRING_FIELD only. */
+            const log4cplus::tstring& getString() const { return str; }
+
+            /**
+             * Appends the value as text to <code>out</code>.  Numbers are
+             * formatted without regard to the locale, booleans as
+             * <code>true</code> or <code>false</code>.
+             */
+            void appendValue(log4cplus::tstring& out) const;
+
+        private:
+          // Data
+            log4cplus::tstring key;
+            Type type;
+            union
+            {
+                long integer;
+                unsigned long uinteger;
+                double dbl;
+                bool boolean;
+            } value;
+            //! Only used by STRING_FIELD.
+            log4cplus::tstring str;
+        };
+
+
+        /**
+         * Fields of a logging event, in the order they were added.  The
+         * fields are added with the call operator, e.g.
+         *
+         * <pre>
+         * LOG4CPLUS_INFO_FIELDS(logger, "request done",
+         *     log4cplus::spi::EventFields()
+         *         (LOG4CPLUS_TEXT("user"), user)
+         *         (LOG4CPLUS_TEXT("ms"), elapsed)
+         *         (LOG4CPLUS_TEXT("cached"), true));
+         * </pre>
+         */
+        class LOG4CPLUS_EXPORT EventFields {
+        public:
+            typedef std::vector<EventField>::const_iterator const_iterator;
+
+          // Methods
+            EventFields& operator()(const log4cplus::tstring& key, int value);
+            EventFields& operator()(const log4cplus::tstring& key,
+                                    unsigned value);
+            EventFields& operator()(const log4cplus::tstring& key, long value);
+            EventFields& operator()(const log4cplus::tstring& key,
+                                    unsigned long value);
+            EventFields& operator()(const log4cplus::tstring& key,
+                                    double value);
+            EventFields& operator()(const log4cplus::tstring& key, bool value);
+            EventFields& operator()(const log4cplus::tstring& key,
+                                    const log4cplus::tstring& value);
+            EventFields& operator()(const log4cplus::tstring& key,
+                                    const log4cplus::tchar* value);
+
+            void add(const EventField& field) { fields.push_back(field); }
+
+            bool empty() const { return fields.empty(); }
+            std::size_t size() const { return fields.size(); }
+            const_iterator begin() const { return fields.begin(); }
+            const_iterator end() const { return fields.end(); }
+
+            /**
+             * Returns the first field named <code>key</code>, or NULL if
+             * there is none.
+             */
+            const EventField* find(const log4cplus::tstring& key) const;
+
+        private:
+          // Data
+            std::vector<EventField> fields;
+        };
+
+
         /**
          * The internal representation of logging events. When an affirmative
          * decision is made to log then a <code>InternalLoggingEvent</code> 
@@ -68,11 +193,12 @@ namespace log4cplus {
                 threadCached(false),
                 ndcCached(false),
                 ll(ll_),
-                timestamp(log4cplus::helpers::Time::gettimeofday()),
+                timestamp(log4cplus::helpers::Time::eventTime()),
                 file( (  filename
                        ? LOG4CPLUS_C_STR_TO_TSTRING(filename) 
                        : log4cplus::tstring()) ),
-                line(line_)
+                line(line_),
+                outputShared(false)
              {
              }
 
@@ -93,7 +219,8 @@ namespace log4cplus {
                 ll(ll_),
                 timestamp(time),
                 file(file_),
-                line(line_)
+                line(line_),
+                outputShared(false)
              {
              }
 
@@ -107,7 +234,11 @@ namespace log4cplus {
                 ll(rhs.getLogLevel()),
                 timestamp(rhs.getTimestamp()),
                 file(rhs.getFile()),
-                line(rhs.getLine())
+                line(rhs.getLine()),
+                fields(rhs.fields),
+                backtrace(rhs.backtrace),
+                outputShared(rhs.outputShared),
+                formatted(rhs.formatted)
              {
              }
 
@@ -167,6 +298,59 @@ namespace log4cplus {
 
             /** The is the line where this log statement was written */
             int getLine() const { return line; }
+
+            /** The typed key-value fields attached to this event. */
+            const EventFields& getFields() const { return fields; }
+
+            /** Replaces the fields attached to this event. */
+            void setFields(const EventFields& fields_) { fields = fields_; }
+
+            /**
+             * The return addresses of the logging call, captured for
+             * events at or above helpers::getBacktraceThreshold().  It is
+             * empty for other events.
+             */
+            const helpers::Backtrace& getBacktrace() const { return backtrace; }
+
+            /** Attaches <code>frames</code> as the backtrace of this event. */
+            void setBacktrace(const helpers::Backtrace& frames) { backtrace = frames; }
+
+            /**
+             * Stores <code>text</code>, formatted for a stream with the
+             * locale <code>loc</code>, as the output of <code>layout</code>
+             * for this event, so that the layout can write it later
+             * without formatting the event again.  This is used to format
+             * events ahead of time, e.g. by AsyncAppender, and to share
+             * the output between appenders whose layouts have the same
+             * Layout::getFingerprint().  The stored output is not
+             * synchronized; only one thread may format an event at a
+             * time.
+             */
+            void setFormattedOutput(const Layout* layout,
+                                    const std::locale& loc,
+                                    const log4cplus::tstring& text) const;
+
+            /**
+             * Returns the output stored by setFormattedOutput() for
+             * <code>layout</code> or for a layout of the same type with the
+             * same fingerprint, and for the locale <code>loc</code>, or
+             * NULL if there is none.
+             */
+            const log4cplus::tstring* getFormattedOutput(const Layout* layout,
+                                                         const std::locale& loc) const;
+
+            /** Returns <code>true</code> if any output has been stored. */
+            bool hasFormattedOutput() const { return ! formatted.empty(); }
+
+            /**
+             * Tells layouts whether more than one appender may see this
+             * event, in which case they store their output with
+             * setFormattedOutput() for the others.  Loggers set it while
+             * they pass the event to their appenders; it is false for
+             * events that are appended directly.
+             */
+            void setOutputShared(bool shared) const { outputShared = shared; }
+            bool isOutputShared() const { return outputShared; }
  
           // public operators
             log4cplus::spi::InternalLoggingEvent&
@@ -191,6 +375,25 @@ namespace log4cplus {
             log4cplus::helpers::Time timestamp;
             log4cplus::tstring file;
             int line;
+            EventFields fields;
+            helpers::Backtrace backtrace;
+            mutable bool outputShared;
+            struct FormattedOutput
+            {
+                bool matches(const Layout* layout,
+                             const std::locale& loc) const;
+
+                //! Layout the output was stored for.  It is only compared
+                //! for layouts without a fingerprint, never dereferenced.
+                const Layout* layout;
+                const std::type_info* type;
+                log4cplus::tstring fingerprint;
+                std::locale locale;
+                log4cplus::tstring text;
+            };
+
+            /** Output formatted ahead of time, by layout. */
+            mutable std::vector<FormattedOutput> formatted;
         };
 
     } // end namespace spi
@@ -67,10 +67,14 @@ public:
 
     void lock () const;
     void unlock () const;
+    void reinitialize ();
 
 private:
 #if defined (LOG4CPLUS_USE_PTHREADS)
+    void init ();
+
     mutable pthread_mutex_t mtx;
+    log4cplus::thread::Mutex::Type type;
     friend class ManualResetEvent;
 #elif defined (LOG4CPLUS_USE_WIN32_THREADS)
     mutable CRITICAL_SECTION cs;
@@ -145,6 +149,7 @@ public:
     void wait () const;
     bool timed_wait (unsigned long msec) const;
     void reset () const;
+    void reinitialize ();
 
 private:
 #if defined (LOG4CPLUS_USE_PTHREADS)
@@ -89,9 +89,18 @@ struct PthreadMutexAttr
 
 inline
 Mutex::Mutex (log4cplus::thread::Mutex::Type t)
+    : type (t)
+{
+    init ();
+}
+
+
+inline
+void
+Mutex::init ()
 {
     PthreadMutexAttr attr;
-    attr.set_type (t);
+    attr.set_type (type);
 
     int ret = pthread_mutex_init (&mtx, &attr.attr);
     if (ret != 0)
@@ -133,6 +142,17 @@ Mutex::unlock () const
 }
 
 
+//! A locked mutex cannot be unlocked in a child process, not even by
+//! the thread that called fork(), because the owner recorded in it is
+//! the parent's thread.  It is initialized over again instead.
+inline
+void
+Mutex::reinitialize ()
+{
+    init ();
+}
+
+
 //
 //
 //
@@ -302,7 +322,7 @@ ManualResetEvent::timed_wait (unsigned long msec) const
         helpers::Time const wakeup_time (helpers::Time::gettimeofday ()
             + helpers::Time (msec / 1000, (msec % 1000) * 1000));
         struct timespec const ts = {wakeup_time.sec (),
-            wakeup_time.usec () * 1000};
+            wakeup_time.nsec ()};
         unsigned prev_count = sigcount;
         do
         {
@@ -338,6 +358,21 @@ ManualResetEvent::reset () const
 }
 
 
+//! Threads waiting for the event in the parent do not exist in the
+//! child, but the condition variable still counts them and would block
+//! later signals.
+inline
+void
+ManualResetEvent::reinitialize ()
+{
+    mtx.reinitialize ();
+
+    int ret = pthread_cond_init (&cv, 0);
+    if (ret != 0)
+        LOG4CPLUS_THROW_RTE ("ManualResetEvent::reinitialize");
+}
+
+
 //
 //
 //
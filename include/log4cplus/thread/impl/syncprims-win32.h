@@ -90,6 +90,12 @@ Mutex::unlock () const
 }
 
 
+inline
+void
+Mutex::reinitialize ()
+{ }
+
+
 //
 //
 //
@@ -258,6 +264,12 @@ ManualResetEvent::reset () const
 }
 
 
+inline
+void
+ManualResetEvent::reinitialize ()
+{ }
+
+
 //
 //
 //
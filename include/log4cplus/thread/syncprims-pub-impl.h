@@ -84,6 +84,14 @@ Mutex::unlock () const
 }
 
 
+LOG4CPLUS_INLINE_EXPORT
+void
+Mutex::reinitialize ()
+{
+    LOG4CPLUS_THREADED (static_cast<impl::Mutex *>(mtx)->reinitialize ());
+}
+
+
 //
 //
 //
@@ -231,6 +239,15 @@ ManualResetEvent::reset () const
 }
 
 
+LOG4CPLUS_INLINE_EXPORT
+void
+ManualResetEvent::reinitialize ()
+{
+    LOG4CPLUS_THREADED (
+        static_cast<impl::ManualResetEvent *>(ev)->reinitialize ());
+}
+
+
 //
 //
 //
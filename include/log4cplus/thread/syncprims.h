@@ -76,6 +76,10 @@ public:
     void lock () const;
     void unlock () const;
 
+    //! Makes the mutex unlocked again in a child process after fork(),
+    //! whichever thread of the parent held it.
+    void reinitialize ();
+
 private:
     MutexImplBase * mtx;
 
@@ -159,6 +163,10 @@ public:
     bool timed_wait (unsigned long msec) const;
     void reset () const;
 
+    //! Makes the event usable again in a child process after fork(),
+    //! dropping waiters that were left behind in the parent.
+    void reinitialize ();
+
 private:
     ManualResetEventImplBase * ev;
 
@@ -28,6 +28,8 @@
 #include <log4cplus/tstring.h>
 #include <log4cplus/helpers/pointer.h>
 
+#include <vector>
+
 
 namespace log4cplus { namespace thread {
 
@@ -83,6 +85,65 @@ protected:
 };
 
 
+/**
+ * Describes the CPUs a thread started through AbstractThread is
+ * allowed to run on.  An empty placement, the default, leaves the
+ * scheduling to the operating system.
+ *
+ * When a NUMA node is given, the CPUs of that node, as reported by
+ * the kernel, are added to the CPU set.  The placement is applied by
+ * the new thread itself before AbstractThread::run() is called, so
+ * buffers the thread allocates and touches first end up on the memory
+ * of its node.
+ *
+ * Placement is currently implemented only on Linux.  Elsewhere it is
+ * ignored.
+ */
+class LOG4CPLUS_EXPORT ThreadPlacement
+{
+public:
+    ThreadPlacement ();
+
+    /** Returns <code>true</code> if no CPU and no NUMA node is set. */
+    bool empty () const;
+
+    /** Adds <code>cpu</code> to the set of allowed CPUs. */
+    void addCpu (unsigned cpu);
+
+    /**
+     * Adds the CPUs given in the kernel's "cpulist" format, e.g.
+     * <code>0-3,8,10-11</code>.  Returns <code>false</code> if
+     * <code>list</code> is malformed or names a CPU beyond the
+     * largest CPU set the system supports.
+     */
+    bool addCpuList (log4cplus::tstring const & list);
+
+    std::vector<unsigned> const & getCpus () const;
+
+    /** Sets the NUMA node to run on, -1 clears it. */
+    void setNumaNode (int node);
+    int getNumaNode () const;
+
+private:
+    std::vector<unsigned> cpus;
+    int numaNode;
+};
+
+
+/**
+ * Returns the number of NUMA nodes known to the kernel, or 1 if this
+ * cannot be determined.
+ */
+LOG4CPLUS_EXPORT int getNumaNodeCount ();
+
+
+/**
+ * Returns the NUMA node the calling thread is running on, or -1 if
+ * this cannot be determined.
+ */
+LOG4CPLUS_EXPORT int getCurrentNumaNode ();
+
+
 /**
  * There are many cross-platform C++ Threading libraries.  The goal of
  * this class is not to replace (or match in functionality) those
@@ -99,12 +160,20 @@ public:
     void join () const;
     virtual void run() = 0;
 
+    /**
+     * Sets where the thread runs.  Takes effect on the next call to
+     * start().
+     */
+    void setPlacement (ThreadPlacement const & placement);
+    ThreadPlacement const & getPlacement () const;
+
 protected:
     // Force objects to be constructed on the heap
     virtual ~AbstractThread();
 
 private:
     helpers::SharedObjectPtr<ThreadImplBase> thread;
+    ThreadPlacement placement;
 
     // Disallow copying of instances of this class.
     AbstractThread(const AbstractThread&);
@@ -23,8 +23,13 @@
 #include <log4cplus/config.hxx>
 #include <log4cplus/configurator.h>
 #include <log4cplus/consoleappender.h>
+#include <log4cplus/fileshipper.h>
+#include <log4cplus/framearchive.h>
+#include <log4cplus/framerelay.h>
+#include <log4cplus/sharedmemoryappender.h>
 #include <log4cplus/socketappender.h>
 #include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/sleep.h>
 #include <log4cplus/helpers/socket.h>
 #include <log4cplus/thread/threads.h>
 #include <log4cplus/spi/loggerimpl.h>
@@ -57,6 +62,185 @@ namespace loggingserver {
         Socket clientsock;
     };
 
+
+    //! Stores the frames of a client connection in the archive as they
+    //! arrive, without decoding them.
+    class ArchiveThread : public AbstractThread {
+    public:
+        ArchiveThread(Socket clientsock_, FrameArchiveWriter & archive_,
+            unsigned long connection_)
+        : clientsock(clientsock_)
+        , archive(archive_)
+        , connection(connection_)
+        {
+            cout << "Received a client connection!!!!" << endl;
+        }
+
+        ~ArchiveThread()
+        {
+            cout << "Client connection closed." << endl;
+        }
+
+        virtual void run();
+
+    private:
+        Socket clientsock;
+        FrameArchiveWriter & archive;
+        unsigned long connection;
+    };
+
+
+    //! Forwards the frames of a client connection upstream without
+    //! decoding them.
+    class RelayThread : public AbstractThread {
+    public:
+        RelayThread(Socket clientsock_, FrameRelay & relay_)
+        : clientsock(clientsock_)
+        , relay(relay_)
+        {
+            cout << "Received a client connection!!!!" << endl;
+        }
+
+        ~RelayThread()
+        {
+            cout << "Client connection closed." << endl;
+        }
+
+        virtual void run();
+
+    private:
+        Socket clientsock;
+        FrameRelay & relay;
+    };
+
+
+    //! Stores the files a FileShipper sends over a client connection.
+    class FilesThread : public AbstractThread {
+    public:
+        FilesThread(SOCKET_TYPE clientsock_, FileReceiver & receiver_)
+        : clientsock(clientsock_)
+        , receiver(receiver_)
+        {
+            cout << "Received a client connection!!!!" << endl;
+        }
+
+        ~FilesThread()
+        {
+            closeSocket(clientsock);
+            cout << "Client connection closed." << endl;
+        }
+
+        virtual void run();
+
+    private:
+        SOCKET_TYPE clientsock;
+        FileReceiver & receiver;
+    };
+
+
+    int archive(int port, tstring const & filename)
+    {
+        FrameArchiveWriter writer(filename);
+        if(!writer.isOpen()) {
+            return 2;
+        }
+
+        ServerSocket serverSocket(port);
+        if (!serverSocket.isOpen()) {
+            cout << "Could not open server socket, maybe port "
+                << port << " is already in use." << endl;
+            return 2;
+        }
+
+        for(unsigned long connection = 1; ; ++connection) {
+            ArchiveThread *thr =
+                new ArchiveThread(serverSocket.accept(), writer, connection);
+            thr->start();
+        }
+
+        return 0;
+    }
+
+
+    int relay(int port, tstring const & host, int upstreamPort,
+        tstring const & spoolFile)
+    {
+        FrameRelay relay(host, static_cast<unsigned short>(upstreamPort),
+            4 * 1024 * 1024, spoolFile);
+
+        ServerSocket serverSocket(port);
+        if (!serverSocket.isOpen()) {
+            cout << "Could not open server socket, maybe port "
+                << port << " is already in use." << endl;
+            return 2;
+        }
+
+        while(1) {
+            RelayThread *thr = new RelayThread(serverSocket.accept(), relay);
+            thr->start();
+        }
+
+        return 0;
+    }
+
+
+    int files(int port, tstring const & directory)
+    {
+        FileReceiver receiver(directory);
+
+        // The raw socket is needed to splice the data into the files.
+        SocketState state;
+        SOCKET_TYPE serverSocket = openSocket(
+            static_cast<unsigned short>(port), state);
+        if (serverSocket == INVALID_SOCKET_VALUE) {
+            cout << "Could not open server socket, maybe port "
+                << port << " is already in use." << endl;
+            return 2;
+        }
+
+        while(1) {
+            SOCKET_TYPE clientsock = acceptSocket(serverSocket, state);
+            if (clientsock == INVALID_SOCKET_VALUE) {
+                continue;
+            }
+            FilesThread *thr = new FilesThread(clientsock, receiver);
+            thr->start();
+        }
+
+        return 0;
+    }
+
+
+    //! Passes on the events of SharedMemoryAppenders on this host.
+    int collect(tstring const & prefix)
+    {
+        SharedMemoryCollector collector(prefix);
+        unsigned long const maxIdleSleep = 100;
+        unsigned long idleSleep = 1;
+        unsigned long sinceRescan = 0;
+
+        while(1) {
+            // New rings are looked for about once a second.
+            if(sinceRescan >= 1000) {
+                collector.rescan();
+                sinceRescan = 0;
+            }
+
+            if(collector.drain() != 0) {
+                idleSleep = 1;
+                continue;
+            }
+
+            sleepmillis(idleSleep);
+            sinceRescan += idleSleep;
+            if(idleSleep < maxIdleSleep) {
+                idleSleep *= 2;
+            }
+        }
+
+        return 0;
+    }
+
 }
 
 
@@ -66,9 +250,56 @@ int
 main(int argc, char** argv)
 {
     if(argc < 3) {
-        cout << "Usage: port config_file" << endl;
+        cout << "Usage: port config_file" << endl
+             << "       -shm config_file [prefix]" << endl
+             << "       -archive port archive_file" << endl
+             << "       -relay port upstream_host upstream_port [spool_file]"
+             << endl
+             << "       -files port directory" << endl;
         return 1;
     }
+
+    if(std::string(argv[1]) == "-files") {
+        if(argc < 4) {
+            cout << "Usage: -files port directory" << endl;
+            return 1;
+        }
+        return loggingserver::files(std::atoi(argv[2]),
+            LOG4CPLUS_C_STR_TO_TSTRING(argv[3]));
+    }
+
+    if(std::string(argv[1]) == "-archive") {
+        if(argc < 4) {
+            cout << "Usage: -archive port archive_file" << endl;
+            return 1;
+        }
+        return loggingserver::archive(std::atoi(argv[2]),
+            LOG4CPLUS_C_STR_TO_TSTRING(argv[3]));
+    }
+
+    if(std::string(argv[1]) == "-shm") {
+        tstring configFile = LOG4CPLUS_C_STR_TO_TSTRING(argv[2]);
+        PropertyConfigurator config(configFile);
+        config.configure();
+
+        tstring prefix = argc > 3 ? LOG4CPLUS_C_STR_TO_TSTRING(argv[3])
+            : tstring(LOG4CPLUS_TEXT("/log4cplus-"));
+        return loggingserver::collect(prefix);
+    }
+
+    if(std::string(argv[1]) == "-relay") {
+        if(argc < 5) {
+            cout << "Usage: -relay port upstream_host upstream_port"
+                " [spool_file]" << endl;
+            return 1;
+        }
+        tstring spoolFile = argc > 5 ? LOG4CPLUS_C_STR_TO_TSTRING(argv[5])
+            : tstring();
+        return loggingserver::relay(std::atoi(argv[2]),
+            LOG4CPLUS_C_STR_TO_TSTRING(argv[3]), std::atoi(argv[4]),
+            spoolFile);
+    }
+
     int port = std::atoi(argv[1]);
     tstring configFile = LOG4CPLUS_C_STR_TO_TSTRING(argv[2]);
 
@@ -123,3 +354,91 @@ loggingserver::ClientThread::run()
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+// loggingserver::ArchiveThread implementation
+////////////////////////////////////////////////////////////////////////////////
+
+
+void
+loggingserver::ArchiveThread::run()
+{
+    tostringstream description;
+    description << LOG4CPLUS_TEXT("connection ") << connection
+        << LOG4CPLUS_TEXT(" accepted ")
+        << Time::gettimeofday().getFormattedTime(
+            LOG4CPLUS_TEXT("%Y-%m-%d %H:%M:%S"));
+    unsigned long const source = archive.addSource(description.str());
+
+    while(1) {
+        if(!clientsock.isOpen()) {
+            break;
+        }
+        SocketBuffer msgSizeBuffer(sizeof(unsigned int));
+        if(!clientsock.read(msgSizeBuffer)) {
+            break;
+        }
+
+        unsigned int msgSize = msgSizeBuffer.readInt();
+        // Such a frame could not be read back from the archive.
+        if(msgSize == 0 || msgSize > LOG4CPLUS_MAX_MESSAGE_SIZE) {
+            break;
+        }
+
+        SocketBuffer buffer(msgSize);
+        if(!clientsock.read(buffer)) {
+            break;
+        }
+
+        archive.append(source, buffer.getBuffer(), msgSize);
+    }
+
+    archive.removeSource(source);
+    archive.flush();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// loggingserver::RelayThread implementation
+////////////////////////////////////////////////////////////////////////////////
+
+
+void
+loggingserver::RelayThread::run()
+{
+    while(1) {
+        if(!clientsock.isOpen()) {
+            return;
+        }
+        SocketBuffer msgSizeBuffer(sizeof(unsigned int));
+        if(!clientsock.read(msgSizeBuffer)) {
+            return;
+        }
+
+        unsigned int msgSize = msgSizeBuffer.readInt();
+        if(msgSize == 0 || msgSize > LOG4CPLUS_MAX_MESSAGE_SIZE) {
+            return;
+        }
+
+        SocketBuffer buffer(msgSize);
+        if(!clientsock.read(buffer)) {
+            return;
+        }
+
+        // Waits while the relay's buffers are full.
+        relay.append(buffer.getBuffer(), msgSize);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// loggingserver::FilesThread implementation
+////////////////////////////////////////////////////////////////////////////////
+
+
+void
+loggingserver::FilesThread::run()
+{
+    if(!receiver.receive(clientsock)) {
+        cout << "File transfer failed." << endl;
+    }
+}
@@ -0,0 +1,248 @@
+// Module:  Log4CPLUS
+// File:    loglookup.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <log4cplus/config.hxx>
+#include <log4cplus/fileindex.h>
+#include <log4cplus/fstreams.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/helpers/timehelper.h>
+
+
+using namespace std;
+using namespace log4cplus;
+using namespace log4cplus::helpers;
+
+
+namespace loglookup {
+
+    struct Query
+    {
+        Query ()
+            : hasFrom (false)
+            , hasTo (false)
+        { }
+
+        bool hasFrom;
+        Time from;
+        bool hasTo;
+        Time to;
+        string token;
+    };
+
+
+    //! Region of a file to search.
+    struct Region
+    {
+        unsigned long start;
+        unsigned long end;
+    };
+
+
+    void
+    usage ()
+    {
+        cerr << "Usage: loglookup [-from TIME] [-to TIME] [-token TOKEN]"
+            " FILE...\n"
+            "TIME is in seconds since the epoch or local"
+            " YYYY-MM-DD[THH:MM[:SS]].\n"
+            "Files are searched with the help of their .idx sidecar"
+            " files, when there\nare any.  The time range selects the"
+            " regions of the files to print, and\nthe lines printed are"
+            " those containing TOKEN." << endl;
+    }
+
+
+    bool
+    parseTime (char const * str, Time & t)
+    {
+        char * end;
+        long const sec = strtol (str, &end, 10);
+        if (*end == 0 && end != str)
+        {
+            t = Time (sec, 0);
+            return true;
+        }
+
+        struct tm tm;
+        memset (&tm, 0, sizeof (tm));
+        char sep = 0;
+        int const n = sscanf (str, "%d-%d-%d%c%d:%d:%d", &tm.tm_year,
+            &tm.tm_mon, &tm.tm_mday, &sep, &tm.tm_hour, &tm.tm_min,
+            &tm.tm_sec);
+        if (n != 3 && n < 6)
+            return false;
+        if (n > 3 && sep != 'T' && sep != ' ')
+            return false;
+
+        tm.tm_year -= 1900;
+        tm.tm_mon -= 1;
+        tm.tm_isdst = -1;
+        return t.setTime (&tm) != -1;
+    }
+
+
+    //! Picks the regions of a file of <code>size</code> bytes that may
+    //! hold lines matching the query.
+    void
+    selectRegions (Query const & query, FileIndex const & index,
+        unsigned long size, vector<Region> & regions)
+    {
+        unsigned long const indexed = index.getEndOffset ();
+
+        bool skip = index.empty ()
+            || (query.hasFrom && index.getLastTime () < query.from)
+            || (query.hasTo && query.to < index.getFirstTime ());
+        if (! skip && ! query.token.empty ())
+        {
+            skip = ! index.mightContain (
+                LOG4CPLUS_STRING_TO_TSTRING (query.token));
+        }
+
+        if (! skip)
+        {
+            Region r;
+            r.start = query.hasFrom ? index.findStartOffset (query.from) : 0;
+            r.end = query.hasTo ? index.findEndOffset (query.to) : indexed;
+            if (r.start < r.end)
+                regions.push_back (r);
+        }
+
+        // Lines written after the index was saved last.
+        if (indexed < size)
+        {
+            Region tail = { indexed, size };
+            if (! regions.empty () && regions.back ().end == indexed)
+                regions.back ().end = size;
+            else
+                regions.push_back (tail);
+        }
+    }
+
+
+    bool
+    searchFile (Query const & query, string const & filename,
+        bool showFilename)
+    {
+        ifstream in (filename.c_str (), ios::in | ios::binary);
+        if (! in)
+        {
+            cerr << "loglookup: cannot open " << filename << endl;
+            return false;
+        }
+        in.seekg (0, ios::end);
+        unsigned long const size = static_cast<unsigned long>(in.tellg ());
+
+        vector<Region> regions;
+        FileIndex index;
+        tstring const indexFilename
+            = LOG4CPLUS_STRING_TO_TSTRING (filename) + FileIndex::SUFFIX;
+        if (index.read (indexFilename) && index.getEndOffset () <= size)
+            selectRegions (query, index, size, regions);
+        else
+        {
+            Region all = { 0, size };
+            regions.push_back (all);
+        }
+
+        string line;
+        for (vector<Region>::const_iterator it = regions.begin ();
+             it != regions.end (); ++it)
+        {
+            in.clear ();
+            in.seekg (it->start);
+            unsigned long pos = it->start;
+            while (pos < it->end && getline (in, line))
+            {
+                pos += static_cast<unsigned long>(line.size ()) + 1;
+                if (! query.token.empty ()
+                    && line.find (query.token) == string::npos)
+                    continue;
+
+                if (showFilename)
+                    cout << filename << ':';
+                cout << line << '\n';
+            }
+        }
+
+        return true;
+    }
+
+} // namespace loglookup
+
+
+int
+main(int argc, char** argv)
+{
+    loglookup::Query query;
+    vector<string> files;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        string const arg (argv[i]);
+        bool const hasValue = i + 1 < argc;
+        if (arg == "-from" && hasValue)
+        {
+            query.hasFrom = loglookup::parseTime (argv[++i], query.from);
+            if (! query.hasFrom)
+            {
+                cerr << "loglookup: invalid time " << argv[i] << endl;
+                return 2;
+            }
+        }
+        else if (arg == "-to" && hasValue)
+        {
+            query.hasTo = loglookup::parseTime (argv[++i], query.to);
+            if (! query.hasTo)
+            {
+                cerr << "loglookup: invalid time " << argv[i] << endl;
+                return 2;
+            }
+        }
+        else if (arg == "-token" && hasValue)
+            query.token = argv[++i];
+        else if (! arg.empty () && arg[0] == '-')
+        {
+            loglookup::usage ();
+            return 2;
+        }
+        else
+            files.push_back (arg);
+    }
+
+    if (files.empty ())
+    {
+        loglookup::usage ();
+        return 2;
+    }
+
+    bool ok = true;
+    for (vector<string>::const_iterator it = files.begin ();
+         it != files.end (); ++it)
+        ok = loglookup::searchFile (query, *it, files.size () > 1) && ok;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,1246 @@
+// Module:  Log4CPLUS
+// File:    logquery.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <log4cplus/config.hxx>
+#include <log4cplus/fileindex.h>
+#include <log4cplus/framearchive.h>
+#include <log4cplus/layout.h>
+#include <log4cplus/loglevel.h>
+#include <log4cplus/segmentappender.h>
+#include <log4cplus/helpers/pointer.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/helpers/timehelper.h>
+#include <log4cplus/spi/loggingevent.h>
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+#  include <log4cplus/thread/syncprims.h>
+#  include <log4cplus/thread/threads.h>
+#endif
+
+#if defined (_WIN32)
+#  define LOGQUERY_READ_FILES
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#if defined (__SSE2__) || defined (_M_X64) \
+    || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define LOGQUERY_HAVE_SSE2
+#  include <emmintrin.h>
+#endif
+
+
+using namespace std;
+using namespace log4cplus;
+using namespace log4cplus::helpers;
+
+
+namespace logquery {
+
+    char const DEFAULT_PATTERN[]
+        = "%D{%Y-%m-%d %H:%M:%S.%q} %-5p %c - %m%n";
+
+    //! Text files are split into chunks of about this size, so that
+    //! the cores share the work on large files.
+    unsigned long const CHUNK_SIZE = 4 * 1024 * 1024;
+
+    char const * const month_names[12] = { "Jan", "Feb", "Mar", "Apr",
+        "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+
+    struct Query
+    {
+        Query ()
+            : hasFrom (false)
+            , hasTo (false)
+            , minLevel (NOT_SET_LOG_LEVEL)
+            , pattern (DEFAULT_PATTERN)
+        { }
+
+        bool hasFrom;
+        Time from;
+        bool hasTo;
+        Time to;
+        LogLevel minLevel;
+        string logger;
+        string text;
+        string pattern;
+    };
+
+
+    //! A converter or a run of literal text of the pattern.
+    struct PatternItem
+    {
+        enum Kind
+        {
+            LITERAL,
+            TIME,
+            LEVEL,
+            LOGGER,
+            MESSAGE,
+            OTHER
+        };
+
+        Kind kind;
+        //! Literal text or the date format.
+        string text;
+        bool gmt;
+    };
+
+    typedef vector<PatternItem> Pattern;
+
+
+    //! A matching log record: its first line and continuation lines.
+    struct Record
+    {
+        Time time;
+        string text;
+    };
+
+    typedef vector<Record> RecordList;
+
+
+    enum FileKind
+    {
+        TEXT_FILE,
+        SEGMENT_FILE,
+        FRAME_ARCHIVE
+    };
+
+
+    //! Part of a file that one worker searches.
+    struct WorkUnit
+    {
+        size_t file;
+        FileKind kind;
+        unsigned long start;
+        unsigned long end;
+        RecordList records;
+        string error;
+    };
+
+
+    // Searching
+
+    //! Finds <code>needle</code> in [hay, hay + len).  With SSE2, the
+    //! first and the last byte of the needle are compared at 16
+    //! positions at once and only the candidates are compared in full.
+    char const *
+    findText (char const * hay, size_t len, string const & needle)
+    {
+        size_t const n = needle.size ();
+        if (n == 0)
+            return hay;
+        if (n > len)
+            return 0;
+
+        char const * const last = hay + len - n;
+        char const * p = hay;
+
+#if defined (LOGQUERY_HAVE_SSE2)
+        __m128i const first = _mm_set1_epi8 (needle[0]);
+        __m128i const final = _mm_set1_epi8 (needle[n - 1]);
+        for (; p + 16 <= last + 1; p += 16)
+        {
+            __m128i const a = _mm_loadu_si128 (
+                reinterpret_cast<__m128i const *>(p));
+            __m128i const b = _mm_loadu_si128 (
+                reinterpret_cast<__m128i const *>(p + n - 1));
+            int mask = _mm_movemask_epi8 (_mm_and_si128 (
+                _mm_cmpeq_epi8 (a, first), _mm_cmpeq_epi8 (b, final)));
+            while (mask != 0)
+            {
+                int bit = 0;
+                while (! (mask & (1 << bit)))
+                    ++bit;
+                if (memcmp (p + bit, needle.data (), n) == 0)
+                    return p + bit;
+                mask &= mask - 1;
+            }
+        }
+#endif
+
+        for (; p <= last; ++p)
+        {
+            p = static_cast<char const *>(memchr (p, needle[0], last - p + 1));
+            if (! p)
+                return 0;
+            if (memcmp (p, needle.data (), n) == 0)
+                return p;
+        }
+        return 0;
+    }
+
+
+    bool
+    loggerMatches (Query const & query, char const * name, size_t len)
+    {
+        size_t const n = query.logger.size ();
+        return n == 0
+            || (len >= n && memcmp (name, query.logger.data (), n) == 0
+                && (len == n || name[n] == '.'));
+    }
+
+
+    bool
+    timeMatches (Query const & query, Time const & t)
+    {
+        return ! (query.hasFrom && t < query.from)
+            && ! (query.hasTo && query.to < t);
+    }
+
+
+    // Time parsing
+
+    //! Days since 1970-01-01 of a date of the proleptic Gregorian
+    //! calendar.
+    long
+    daysFromCivil (long y, unsigned m, unsigned d)
+    {
+        y -= m <= 2;
+        long const era = (y >= 0 ? y : y - 399) / 400;
+        unsigned long const yoe = static_cast<unsigned long>(y - era * 400);
+        unsigned long const doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        unsigned long const doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + static_cast<long>(doe) - 719468;
+    }
+
+
+    //! Converts local time to seconds since the epoch.  The offset of
+    //! the local time is looked up with mktime() once per hour.
+    class LocalTimeCache
+    {
+    public:
+        LocalTimeCache ()
+            : hourKey (-1)
+            , offset (0)
+        { }
+
+        time_t convert (struct tm const & tm)
+        {
+            long const days = daysFromCivil (tm.tm_year + 1900,
+                tm.tm_mon + 1, tm.tm_mday);
+            long const key = days * 24 + tm.tm_hour;
+            long const seconds = days * 86400L + tm.tm_hour * 3600L
+                + tm.tm_min * 60L + tm.tm_sec;
+            if (key != hourKey)
+            {
+                struct tm copy = tm;
+                copy.tm_min = 0;
+                copy.tm_sec = 0;
+                copy.tm_isdst = -1;
+                offset = static_cast<long>(mktime (&copy))
+                    - (days * 86400L + tm.tm_hour * 3600L);
+                hourKey = key;
+            }
+            return static_cast<time_t>(seconds + offset);
+        }
+
+    private:
+        long hourKey;
+        long offset;
+    };
+
+
+    bool
+    parseDigits (char const * & p, char const * end, int count, long & value,
+        bool exact = false)
+    {
+        value = 0;
+        int i = 0;
+        for (; i != count && p != end && *p >= '0' && *p <= '9'; ++i, ++p)
+            value = value * 10 + (*p - '0');
+        return i != 0 && (! exact || i == count);
+    }
+
+
+    //! Returns true if the date format uses only what parseDate() knows.
+    bool
+    checkDateFormat (string const & fmt)
+    {
+        for (size_t i = 0; i < fmt.size (); ++i)
+        {
+            if (fmt[i] != '%')
+                continue;
+            if (++i == fmt.size ()
+                || ! strchr ("YymdeHMSqQNsb%", fmt[i]))
+                return false;
+        }
+        return true;
+    }
+
+
+    //! Parses a timestamp written with the date format of a %d or %D
+    //! converter.
+    bool
+    parseDate (PatternItem const & item, char const * & p, char const * end,
+        LocalTimeCache & cache, Time & t)
+    {
+        struct tm tm;
+        memset (&tm, 0, sizeof (tm));
+        tm.tm_year = 70;
+        tm.tm_mday = 1;
+        long nsec = 0;
+        bool epoch = false;
+        long epochSec = 0;
+
+        string const & fmt = item.text;
+        for (size_t i = 0; i != fmt.size (); ++i)
+        {
+            if (fmt[i] != '%')
+            {
+                if (p == end || *p != fmt[i])
+                    return false;
+                ++p;
+                continue;
+            }
+
+            long v;
+            switch (fmt[++i])
+            {
+            case 'Y':
+                if (! parseDigits (p, end, 4, v, true))
+                    return false;
+                tm.tm_year = static_cast<int>(v - 1900);
+                break;
+
+            case 'y':
+                if (! parseDigits (p, end, 2, v, true))
+                    return false;
+                tm.tm_year = static_cast<int>(v < 69 ? v + 100 : v);
+                break;
+
+            case 'm':
+                if (! parseDigits (p, end, 2, v) || v < 1 || v > 12)
+                    return false;
+                tm.tm_mon = static_cast<int>(v - 1);
+                break;
+
+            case 'e':
+                if (p != end && *p == ' ')
+                    ++p;
+                // Fall through.
+            case 'd':
+                if (! parseDigits (p, end, 2, v) || v < 1 || v > 31)
+                    return false;
+                tm.tm_mday = static_cast<int>(v);
+                break;
+
+            case 'H':
+                if (! parseDigits (p, end, 2, v) || v > 23)
+                    return false;
+                tm.tm_hour = static_cast<int>(v);
+                break;
+
+            case 'M':
+                if (! parseDigits (p, end, 2, v) || v > 59)
+                    return false;
+                tm.tm_min = static_cast<int>(v);
+                break;
+
+            case 'S':
+                if (! parseDigits (p, end, 2, v) || v > 60)
+                    return false;
+                tm.tm_sec = static_cast<int>(v);
+                break;
+
+            case 'q':
+                if (! parseDigits (p, end, 3, v, true))
+                    return false;
+                nsec = v * 1000000;
+                break;
+
+            case 'Q':
+            {
+                long frac;
+                if (! parseDigits (p, end, 3, v, true) || p == end
+                    || *p++ != '.' || ! parseDigits (p, end, 3, frac, true))
+                    return false;
+                nsec = v * 1000000 + frac * 1000;
+                break;
+            }
+
+            case 'N':
+                if (! parseDigits (p, end, 9, v, true))
+                    return false;
+                nsec = v;
+                break;
+
+            case 's':
+                if (! parseDigits (p, end, 19, epochSec))
+                    return false;
+                epoch = true;
+                break;
+
+            case 'b':
+            {
+                if (end - p < 3)
+                    return false;
+                int m = 0;
+                while (m != 12 && memcmp (p, month_names[m], 3) != 0)
+                    ++m;
+                if (m == 12)
+                    return false;
+                tm.tm_mon = m;
+                p += 3;
+                break;
+            }
+
+            default:
+                if (p == end || *p != '%')
+                    return false;
+                ++p;
+            }
+        }
+
+        time_t sec;
+        if (epoch)
+            sec = static_cast<time_t>(epochSec);
+        else if (item.gmt)
+            sec = static_cast<time_t>(daysFromCivil (tm.tm_year + 1900,
+                    tm.tm_mon + 1, tm.tm_mday) * 86400L
+                + tm.tm_hour * 3600L + tm.tm_min * 60L + tm.tm_sec);
+        else
+            sec = cache.convert (tm);
+
+        t = Time (sec, 0);
+        t.nsec (nsec);
+        return true;
+    }
+
+
+    // Pattern
+
+    bool
+    compilePattern (string const & str, Pattern & pattern)
+    {
+        pattern.clear ();
+        for (size_t i = 0; i < str.size (); )
+        {
+            PatternItem item;
+            item.gmt = false;
+
+            if (str[i] != '%' || (i + 1 < str.size () && str[i + 1] == '%'))
+            {
+                char const ch = str[i];
+                i += ch == '%' ? 2 : 1;
+                if (pattern.empty () || pattern.back ().kind != PatternItem::LITERAL)
+                {
+                    item.kind = PatternItem::LITERAL;
+                    pattern.push_back (item);
+                }
+                pattern.back ().text += ch;
+                continue;
+            }
+
+            // Skip the format modifiers, e.g. "-5" or ".20".
+            ++i;
+            while (i < str.size () && strchr ("-.0123456789", str[i]))
+                ++i;
+            if (i == str.size ())
+                return false;
+
+            char const conv = str[i++];
+            string option;
+            if (i < str.size () && str[i] == '{')
+            {
+                size_t const close = str.find ('}', i);
+                if (close == string::npos)
+                    return false;
+                option = str.substr (i + 1, close - i - 1);
+                i = close + 1;
+            }
+
+            switch (conv)
+            {
+            case 'n':
+                continue;
+
+            case 'd':
+            case 'D':
+                item.kind = PatternItem::TIME;
+                item.gmt = conv == 'd';
+                item.text = option.empty () ? "%Y-%m-%d %H:%M:%S" : option;
+                if (! checkDateFormat (item.text))
+                    return false;
+                break;
+
+            case 'p':
+                item.kind = PatternItem::LEVEL;
+                break;
+
+            case 'c':
+                item.kind = PatternItem::LOGGER;
+                break;
+
+            case 'm':
+                item.kind = PatternItem::MESSAGE;
+                break;
+
+            default:
+                item.kind = PatternItem::OTHER;
+            }
+            pattern.push_back (item);
+        }
+        return true;
+    }
+
+
+    //! Header of a text record.
+    struct Header
+    {
+        Header ()
+            : hasTime (false)
+            , level (NOT_SET_LOG_LEVEL)
+            , logger (0)
+            , loggerLen (0)
+        { }
+
+        bool hasTime;
+        Time time;
+        LogLevel level;
+        char const * logger;
+        size_t loggerLen;
+    };
+
+
+    //! Parses the first line of a record.  Returns false for lines
+    //! that do not match the pattern, i.e. continuation lines.
+    bool
+    parseHeader (Pattern const & pattern, char const * p, char const * end,
+        LocalTimeCache & cache, Header & h)
+    {
+        for (Pattern::const_iterator it = pattern.begin ();
+             it != pattern.end (); ++it)
+        {
+            if (it->kind == PatternItem::LITERAL)
+            {
+                if (static_cast<size_t>(end - p) < it->text.size ()
+                    || memcmp (p, it->text.data (), it->text.size ()) != 0)
+                    return false;
+                p += it->text.size ();
+                continue;
+            }
+
+            // Padding of the converters.
+            while (p != end && *p == ' ')
+                ++p;
+
+            if (it->kind == PatternItem::TIME)
+            {
+                if (! parseDate (*it, p, end, cache, h.time))
+                    return false;
+                h.hasTime = true;
+                continue;
+            }
+
+            // Values run up to the following literal text.
+            char const * valueEnd = end;
+            Pattern::const_iterator const next = it + 1;
+            if (next != pattern.end () && next->kind == PatternItem::LITERAL)
+            {
+                valueEnd = findText (p, end - p, next->text);
+                if (! valueEnd)
+                    return false;
+            }
+            else if (next != pattern.end ())
+            {
+                valueEnd = p;
+                while (valueEnd != end && *valueEnd != ' ')
+                    ++valueEnd;
+            }
+
+            char const * valueLast = valueEnd;
+            while (valueLast != p && valueLast[-1] == ' ')
+                --valueLast;
+
+            if (it->kind == PatternItem::LEVEL)
+            {
+                h.level = getLogLevelManager ().fromString (
+                    LOG4CPLUS_STRING_TO_TSTRING (string (p, valueLast)));
+                if (h.level == NOT_SET_LOG_LEVEL)
+                    return false;
+            }
+            else if (it->kind == PatternItem::LOGGER)
+            {
+                h.logger = p;
+                h.loggerLen = valueLast - p;
+            }
+            p = valueEnd;
+        }
+        return true;
+    }
+
+
+    // Workers
+
+    //! Bytes of a file, mapped or read into memory.
+    class FileData
+    {
+    public:
+        explicit FileData (string const & filename)
+            : data (0)
+            , size (0)
+        {
+#if defined (LOGQUERY_READ_FILES)
+            ifstream in (filename.c_str (), ios::in | ios::binary);
+            buffer.assign (istreambuf_iterator<char> (in),
+                istreambuf_iterator<char> ());
+            data = buffer.data ();
+            size = buffer.size ();
+            ok = ! in.bad () && in.is_open ();
+#else
+            int const fd = open (filename.c_str (), O_RDONLY);
+            struct stat st;
+            ok = fd != -1 && fstat (fd, &st) == 0;
+            if (ok && st.st_size > 0)
+            {
+                size = static_cast<size_t>(st.st_size);
+                void * const addr = mmap (0, size, PROT_READ, MAP_PRIVATE,
+                    fd, 0);
+                ok = addr != MAP_FAILED;
+                if (ok)
+                {
+                    data = static_cast<char const *>(addr);
+#  if defined (MADV_SEQUENTIAL)
+                    madvise (addr, size, MADV_SEQUENTIAL);
+#  endif
+                }
+                else
+                    size = 0;
+            }
+            if (fd != -1)
+                close (fd);
+#endif
+        }
+
+        ~FileData ()
+        {
+#if ! defined (LOGQUERY_READ_FILES)
+            if (data)
+                munmap (const_cast<char *>(data), size);
+#endif
+        }
+
+        bool ok;
+        char const * data;
+        size_t size;
+
+    private:
+#if defined (LOGQUERY_READ_FILES)
+        string buffer;
+#endif
+        FileData (FileData const &);
+        FileData & operator = (FileData const &);
+    };
+
+
+    char const *
+    nextLine (char const * p, char const * end)
+    {
+        char const * const nl
+            = static_cast<char const *>(memchr (p, '\n', end - p));
+        return nl ? nl + 1 : end;
+    }
+
+
+    //! End of the text of a line that ends at <code>lineEnd</code>.
+    char const *
+    textEnd (char const * lineStart, char const * lineEnd)
+    {
+        return lineEnd != lineStart && lineEnd[-1] == '\n'
+            ? lineEnd - 1 : lineEnd;
+    }
+
+
+    //! Searches the text records starting in [unit.start, unit.end).
+    void
+    searchText (Query const & query, Pattern const & pattern,
+        string const & filename, WorkUnit & unit)
+    {
+        FileData file (filename);
+        if (! file.ok)
+        {
+            unit.error = "cannot read " + filename;
+            return;
+        }
+
+        LocalTimeCache cache;
+        char const * const fileEnd = file.data + file.size;
+        char const * p = file.data + unit.start;
+        char const * const end = file.data + (std::min) (
+            static_cast<size_t>(unit.end), file.size);
+
+        bool haveRecord = false;
+        bool keep = false;
+        Header h;
+        char const * recordStart = p;
+
+        // The record started last is finished past the unit's end.
+        while (p < end || (haveRecord && p < fileEnd))
+        {
+            char const * const lineEnd = nextLine (p, fileEnd);
+            Header next;
+            bool const header = parseHeader (pattern, p,
+                textEnd (p, lineEnd), cache, next);
+            if (header || ! haveRecord)
+            {
+                if (haveRecord && keep)
+                {
+                    Record r;
+                    r.time = h.time;
+                    r.text.assign (recordStart, p);
+                    unit.records.push_back (r);
+                }
+                if (p >= end)
+                {
+                    haveRecord = false;
+                    break;
+                }
+                h = next;
+                haveRecord = true;
+                recordStart = p;
+                keep = (! query.hasFrom && ! query.hasTo)
+                    || (h.hasTime && timeMatches (query, h.time));
+                keep = keep && (query.minLevel == NOT_SET_LOG_LEVEL
+                    || h.level >= query.minLevel);
+                keep = keep && (query.logger.empty ()
+                    || loggerMatches (query, h.logger, h.loggerLen));
+            }
+            p = lineEnd;
+        }
+        if (haveRecord && keep)
+        {
+            Record r;
+            r.time = h.time;
+            r.text.assign (recordStart, p);
+            unit.records.push_back (r);
+        }
+
+        // The text filter looks at the continuation lines too.
+        if (! query.text.empty ())
+        {
+            RecordList::iterator out = unit.records.begin ();
+            for (RecordList::iterator it = unit.records.begin ();
+                 it != unit.records.end (); ++it)
+                if (findText (it->text.data (), it->text.size (), query.text))
+                {
+                    if (out != it)
+                    {
+                        out->time = it->time;
+                        out->text.swap (it->text);
+                    }
+                    ++out;
+                }
+            unit.records.erase (out, unit.records.end ());
+        }
+    }
+
+
+    //! Renders a decoded event that passed the time and level filters
+    //! and keeps it if it passes the others.
+    void
+    addEvent (Query const & query, PatternLayout & layout,
+        spi::InternalLoggingEvent const & event, WorkUnit & unit)
+    {
+        string const logger (
+            LOG4CPLUS_TSTRING_TO_STRING (event.getLoggerName ()));
+        if (! loggerMatches (query, logger.data (), logger.size ()))
+            return;
+
+        tostringstream oss;
+        layout.formatAndAppend (oss, event);
+        Record r;
+        r.time = event.getTimestamp ();
+        r.text = LOG4CPLUS_TSTRING_TO_STRING (oss.str ());
+        if (! query.text.empty ()
+            && ! findText (r.text.data (), r.text.size (), query.text))
+            return;
+        unit.records.push_back (r);
+    }
+
+
+    template <typename Reader>
+    void
+    setFilters (Query const & query, Reader & reader)
+    {
+        if (query.hasFrom || query.hasTo)
+            reader.setTimeRange (
+                query.hasFrom ? query.from : Time (0, 0),
+                query.hasTo ? query.to
+                    : Time ((std::numeric_limits<long>::max) (), 0));
+        if (query.minLevel != NOT_SET_LOG_LEVEL)
+            reader.setMinLogLevel (query.minLevel);
+    }
+
+
+    void
+    searchSegment (Query const & query, string const & filename,
+        WorkUnit & unit)
+    {
+        SegmentReader reader (LOG4CPLUS_STRING_TO_TSTRING (filename));
+        setFilters (query, reader);
+
+        PatternLayout layout (LOG4CPLUS_STRING_TO_TSTRING (query.pattern));
+        vector<spi::InternalLoggingEvent> events;
+        while (reader.readRowGroup (events))
+        {
+            for (vector<spi::InternalLoggingEvent>::const_iterator it
+                     = events.begin (); it != events.end (); ++it)
+                addEvent (query, layout, *it, unit);
+            events.clear ();
+        }
+        if (reader.isDamaged ())
+            unit.error = filename + " is damaged; results may be incomplete";
+    }
+
+
+    //! Decodes and renders the wire frames of an archive written by
+    //! <tt>loggingserver -archive</tt>.
+    void
+    searchArchive (Query const & query, string const & filename,
+        WorkUnit & unit)
+    {
+        FrameArchiveReader reader (LOG4CPLUS_STRING_TO_TSTRING (filename));
+        setFilters (query, reader);
+
+        PatternLayout layout (LOG4CPLUS_STRING_TO_TSTRING (query.pattern));
+        vector<spi::InternalLoggingEvent> events;
+        while (reader.readEvent (events))
+        {
+            addEvent (query, layout, events.back (), unit);
+            events.clear ();
+        }
+        if (reader.isDamaged ())
+            unit.error = filename + " is damaged; results may be incomplete";
+    }
+
+
+    class Search
+    {
+    public:
+        Search (Query const & query_, Pattern const & pattern_,
+            vector<string> const & files_, vector<WorkUnit> & units_)
+            : query (query_)
+            , pattern (pattern_)
+            , files (files_)
+            , units (units_)
+            , nextUnit (0)
+        { }
+
+        //! Processes units until there are none left.
+        void work ()
+        {
+            for (;;)
+            {
+                size_t i;
+                {
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+                    thread::MutexGuard guard (mutex);
+#endif
+                    if (nextUnit == units.size ())
+                        return;
+                    i = nextUnit++;
+                }
+
+                WorkUnit & unit = units[i];
+                switch (unit.kind)
+                {
+                case SEGMENT_FILE:
+                    searchSegment (query, files[unit.file], unit);
+                    break;
+
+                case FRAME_ARCHIVE:
+                    searchArchive (query, files[unit.file], unit);
+                    break;
+
+                default:
+                    searchText (query, pattern, files[unit.file], unit);
+                }
+            }
+        }
+
+    private:
+        Query const & query;
+        Pattern const & pattern;
+        vector<string> const & files;
+        vector<WorkUnit> & units;
+        size_t nextUnit;
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+        thread::Mutex mutex;
+#endif
+    };
+
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    class WorkerThread : public thread::AbstractThread
+    {
+    public:
+        WorkerThread (Search & search_)
+            : search (search_)
+        { }
+
+        virtual void run ()
+        {
+            search.work ();
+        }
+
+    private:
+        Search & search;
+    };
+#endif
+
+
+    //! Splits a text file into units, using its sidecar index to skip
+    //! the parts outside of the time range.
+    void
+    planTextFile (Query const & query, Pattern const & pattern,
+        string const & filename, size_t fileNo, vector<WorkUnit> & units)
+    {
+        FileData file (filename);
+        if (! file.ok)
+        {
+            // An empty unit, for searchText() to report the error.
+            WorkUnit unit;
+            unit.file = fileNo;
+            unit.kind = TEXT_FILE;
+            unit.start = unit.end = 0;
+            units.push_back (unit);
+            return;
+        }
+
+        unsigned long start = 0;
+        unsigned long end = static_cast<unsigned long>(file.size);
+
+        FileIndex index;
+        if ((query.hasFrom || query.hasTo)
+            && index.read (LOG4CPLUS_STRING_TO_TSTRING (filename)
+                + FileIndex::SUFFIX)
+            && ! index.empty () && index.getEndOffset () <= end)
+        {
+            if ((query.hasFrom && index.getLastTime () < query.from)
+                || (query.hasTo && query.to < index.getFirstTime ()))
+                start = index.getEndOffset ();
+            else
+            {
+                if (query.hasFrom)
+                    start = index.findStartOffset (query.from);
+                if (query.hasTo
+                    && index.findEndOffset (query.to) < index.getEndOffset ())
+                    end = index.findEndOffset (query.to);
+            }
+        }
+
+        // Split at the starts of records.
+        LocalTimeCache cache;
+        char const * const data = file.data;
+        char const * const fileEnd = data + file.size;
+        while (start < end)
+        {
+            unsigned long split = end;
+            if (end - start > CHUNK_SIZE)
+            {
+                char const * p = nextLine (data + start + CHUNK_SIZE, fileEnd);
+                Header h;
+                while (p < data + end
+                       && ! parseHeader (pattern, p,
+                           textEnd (p, nextLine (p, fileEnd)), cache, h))
+                    p = nextLine (p, fileEnd);
+                split = (std::min) (end,
+                    static_cast<unsigned long>(p - data));
+            }
+
+            WorkUnit unit;
+            unit.file = fileNo;
+            unit.kind = TEXT_FILE;
+            unit.start = start;
+            unit.end = split;
+            units.push_back (unit);
+            start = split;
+        }
+    }
+
+
+    // Merging
+
+    struct MergeEntry
+    {
+        Time time;
+        size_t file;
+        size_t pos;
+
+        bool operator > (MergeEntry const & other) const
+        {
+            if (other.time < time)
+                return true;
+            if (time < other.time)
+                return false;
+            return file > other.file;
+        }
+    };
+
+
+    bool
+    recordBefore (Record const & a, Record const & b)
+    {
+        return a.time < b.time;
+    }
+
+
+    //! Prints the records of all files merged by time.
+    void
+    mergeOutput (vector<RecordList> & perFile)
+    {
+        priority_queue<MergeEntry, vector<MergeEntry>,
+            greater<MergeEntry> > heads;
+        for (size_t i = 0; i != perFile.size (); ++i)
+        {
+            // Threads may have logged slightly out of order.
+            stable_sort (perFile[i].begin (), perFile[i].end (),
+                recordBefore);
+            if (! perFile[i].empty ())
+            {
+                MergeEntry e = { perFile[i][0].time, i, 0 };
+                heads.push (e);
+            }
+        }
+
+        while (! heads.empty ())
+        {
+            MergeEntry e = heads.top ();
+            heads.pop ();
+            string const & text = perFile[e.file][e.pos].text;
+            fwrite (text.data (), 1, text.size (), stdout);
+            if (text.empty () || text[text.size () - 1] != '\n')
+                fputc ('\n', stdout);
+
+            if (++e.pos != perFile[e.file].size ())
+            {
+                e.time = perFile[e.file][e.pos].time;
+                heads.push (e);
+            }
+        }
+        fflush (stdout);
+    }
+
+
+    void
+    usage ()
+    {
+        cerr << "Usage: log4cplus-query [-from TIME] [-to TIME]"
+            " [-level LEVEL] [-logger NAME]\n"
+            "           [-text TEXT] [-pattern PATTERN] [-j THREADS]"
+            " FILE...\n"
+            "Prints the log records of the files that match all of the"
+            " filters, merged\nin time order.  FILEs are text logs written"
+            " with PatternLayout's PATTERN,\nby default \""
+            << DEFAULT_PATTERN << "\", SegmentAppender files or\n"
+            "loggingserver -archive files; the latter are printed with"
+            " PATTERN.  TIME is in"
+            " seconds since the\nepoch or local YYYY-MM-DD[THH:MM[:SS]]."
+            "  -logger selects a logger and its\ndescendants." << endl;
+    }
+
+
+    bool
+    parseTime (char const * str, Time & t)
+    {
+        char * end;
+        long const sec = strtol (str, &end, 10);
+        if (*end == 0 && end != str)
+        {
+            t = Time (sec, 0);
+            return true;
+        }
+
+        struct tm tm;
+        memset (&tm, 0, sizeof (tm));
+        char sep = 0;
+        int const n = sscanf (str, "%d-%d-%d%c%d:%d:%d", &tm.tm_year,
+            &tm.tm_mon, &tm.tm_mday, &sep, &tm.tm_hour, &tm.tm_min,
+            &tm.tm_sec);
+        if (n != 3 && n < 6)
+            return false;
+        if (n > 3 && sep != 'T' && sep != ' ')
+            return false;
+
+        tm.tm_year -= 1900;
+        tm.tm_mon -= 1;
+        tm.tm_isdst = -1;
+        return t.setTime (&tm) != -1;
+    }
+
+
+    unsigned
+    defaultThreads ()
+    {
+#if defined (_SC_NPROCESSORS_ONLN)
+        long const n = sysconf (_SC_NPROCESSORS_ONLN);
+        if (n > 0)
+            return static_cast<unsigned>(n);
+#endif
+        return 4;
+    }
+
+} // namespace logquery
+
+
+int
+main(int argc, char** argv)
+{
+    logquery::Query query;
+    vector<string> files;
+    unsigned threads = logquery::defaultThreads ();
+
+    for (int i = 1; i < argc; ++i)
+    {
+        string const arg (argv[i]);
+        bool const hasValue = i + 1 < argc;
+        if ((arg == "-from" || arg == "-to") && hasValue)
+        {
+            Time & t = arg == "-from" ? query.from : query.to;
+            if (! logquery::parseTime (argv[++i], t))
+            {
+                cerr << "log4cplus-query: invalid time " << argv[i] << endl;
+                return 2;
+            }
+            (arg == "-from" ? query.hasFrom : query.hasTo) = true;
+        }
+        else if (arg == "-level" && hasValue)
+        {
+            query.minLevel = getLogLevelManager ().fromString (
+                LOG4CPLUS_C_STR_TO_TSTRING (argv[++i]));
+            if (query.minLevel == NOT_SET_LOG_LEVEL)
+            {
+                cerr << "log4cplus-query: invalid level " << argv[i] << endl;
+                return 2;
+            }
+        }
+        else if (arg == "-logger" && hasValue)
+            query.logger = argv[++i];
+        else if (arg == "-text" && hasValue)
+            query.text = argv[++i];
+        else if (arg == "-pattern" && hasValue)
+            query.pattern = argv[++i];
+        else if (arg == "-j" && hasValue)
+            threads = (std::max) (atoi (argv[++i]), 1);
+        else if (! arg.empty () && arg[0] == '-')
+        {
+            logquery::usage ();
+            return 2;
+        }
+        else if (arg.size () > 4
+                 && arg.compare (arg.size () - 4, 4, ".idx") == 0)
+            // Sidecar indexes matched by a wildcard along with the logs.
+            continue;
+        else
+            files.push_back (arg);
+    }
+
+    logquery::Pattern pattern;
+    if (! logquery::compilePattern (query.pattern, pattern))
+    {
+        cerr << "log4cplus-query: unsupported pattern " << query.pattern
+             << endl;
+        return 2;
+    }
+    if (files.empty ())
+    {
+        logquery::usage ();
+        return 2;
+    }
+
+    vector<logquery::WorkUnit> units;
+    for (size_t i = 0; i != files.size (); ++i)
+    {
+        tstring const filename = LOG4CPLUS_STRING_TO_TSTRING (files[i]);
+        logquery::WorkUnit unit;
+        unit.file = i;
+        unit.start = unit.end = 0;
+        if (SegmentReader (filename).isOpen ())
+        {
+            unit.kind = logquery::SEGMENT_FILE;
+            units.push_back (unit);
+        }
+        else if (FrameArchiveReader (filename).isOpen ())
+        {
+            unit.kind = logquery::FRAME_ARCHIVE;
+            units.push_back (unit);
+        }
+        else
+            logquery::planTextFile (query, pattern, files[i], i, units);
+    }
+
+    logquery::Search search (query, pattern, files, units);
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    vector<SharedObjectPtr<logquery::WorkerThread> > workers;
+    threads = static_cast<unsigned>((std::min) (
+        static_cast<size_t>(threads), units.size ()));
+    for (unsigned i = 1; i < threads; ++i)
+    {
+        workers.push_back (SharedObjectPtr<logquery::WorkerThread> (
+            new logquery::WorkerThread (search)));
+        workers.back ()->start ();
+    }
+#else
+    (void) threads;
+#endif
+    search.work ();
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    for (size_t i = 0; i != workers.size (); ++i)
+        workers[i]->join ();
+#endif
+
+    // Units of a file are in file order, so the records of a file are
+    // just concatenated.
+    bool ok = true;
+    vector<logquery::RecordList> perFile (files.size ());
+    for (vector<logquery::WorkUnit>::iterator it = units.begin ();
+         it != units.end (); ++it)
+    {
+        if (! it->error.empty ())
+        {
+            cerr << "log4cplus-query: " << it->error << endl;
+            ok = false;
+        }
+        logquery::RecordList & records = perFile[it->file];
+        records.insert (records.end (), it->records.begin (),
+            it->records.end ());
+        logquery::RecordList ().swap (it->records);
+    }
+
+    logquery::mergeOutput (perFile);
+    return ok ? 0 : 1;
+}
@@ -208,6 +208,35 @@ Appender::doAppend(const log4cplus::spi::InternalLoggingEvent& event)
 
 
 
+void
+Appender::flush()
+{
+}
+
+
+void
+Appender::atforkPrepare()
+{
+    access_mutex.lock();
+    flush();
+}
+
+
+void
+Appender::atforkParent()
+{
+    access_mutex.unlock();
+}
+
+
+void
+Appender::atforkChild()
+{
+    access_mutex.reinitialize();
+}
+
+
+
 log4cplus::tstring
 Appender::getName()
 {
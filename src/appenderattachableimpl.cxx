@@ -158,6 +158,9 @@ AppenderAttachableImpl::appendLoopOnAppenders(const spi::InternalLoggingEvent& e
     int count = 0;
 
     LOG4CPLUS_BEGIN_SYNCHRONIZE_ON_MUTEX( appender_list_mutex )
+        if(appenderList.size() > 1) {
+            event.setOutputShared(true);
+        }
         for(ListType::const_iterator it=appenderList.begin();
             it!=appenderList.end();
             ++it)
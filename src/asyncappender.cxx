@@ -0,0 +1,676 @@
+// Module:  Log4CPLUS
+// File:    asyncappender.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <log4cplus/config.hxx>
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+
+#include <log4cplus/asyncappender.h>
+#include <log4cplus/loglevel.h>
+#include <log4cplus/streams.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/spi/factory.h>
+
+#include <exception>
+#include <sstream>
+#include <algorithm>
+#include <limits>
+#include <cerrno>
+#include <cstdlib>
+
+
+namespace log4cplus
+{
+
+
+namespace
+{
+
+//! Maximum number of normal lane events the dispatcher takes at once.
+//! Keeping batches small lets priority events overtake the backlog.
+static std::size_t const DISPATCH_BATCH = 64;
+
+//! Number of events a formatter thread takes at once.
+static std::size_t const FORMAT_BATCH = 16;
+
+
+static
+bool
+get_bool_property (helpers::Properties const & properties,
+    tchar const * key, bool def)
+{
+    if (! properties.exists (key))
+        return def;
+
+    tstring tmp = properties.getProperty (key);
+    return helpers::toLower (tmp) == LOG4CPLUS_TEXT ("true");
+}
+
+
+static
+unsigned
+get_unsigned_property (helpers::Properties const & properties,
+    tchar const * key, unsigned def)
+{
+    if (! properties.exists (key))
+        return def;
+
+    tstring tmp = properties.getProperty (key);
+    std::string const str = LOG4CPLUS_TSTRING_TO_STRING (tmp);
+    std::string::size_type const first = str.find_first_not_of (" \t");
+    char const * const begin = str.c_str ()
+        + (first == std::string::npos ? str.size () : first);
+    // strtoul() would accept a negative value and negate it.
+    char * end = const_cast<char *>(begin);
+    errno = 0;
+    unsigned long const value = *begin == '-' ? 0
+        : std::strtoul (begin, &end, 10);
+    if (end == begin || *end != 0 || errno == ERANGE
+        || value > (std::numeric_limits<unsigned>::max) ())
+    {
+        helpers::getLogLog ().warn (LOG4CPLUS_TEXT ("AsyncAppender: invalid ")
+            + tstring (key) + LOG4CPLUS_TEXT (" value \"") + tmp
+            + LOG4CPLUS_TEXT ("\", using ")
+            + helpers::convertIntegerToString (def));
+        return def;
+    }
+
+    return static_cast<unsigned>(value);
+}
+
+} // namespace
+
+
+//////////////////////////////////////////////////////////////////////////////
+// AsyncAppender::DispatcherThread
+//////////////////////////////////////////////////////////////////////////////
+
+AsyncAppender::DispatcherThread::DispatcherThread (AsyncAppender & async)
+    : aa (async)
+{ }
+
+
+AsyncAppender::DispatcherThread::~DispatcherThread ()
+{ }
+
+
+void
+AsyncAppender::DispatcherThread::run ()
+{
+    if (aa.formatterThreads == 0)
+        aa.dispatchEvents ();
+    else
+        aa.formatEvents ();
+}
+
+
+AsyncAppender::QueueEntry::QueueEntry (unsigned long seq_,
+    spi::InternalLoggingEvent const & event_)
+    : seq (seq_)
+    , event (event_)
+    , dropped (false)
+{ }
+
+
+//////////////////////////////////////////////////////////////////////////////
+// AsyncAppender ctors and dtor
+//////////////////////////////////////////////////////////////////////////////
+
+AsyncAppender::AsyncAppender (SharedAppenderPtr const & app,
+    unsigned queueLimit_)
+    : queueLimit (queueLimit_)
+    , priorityReserve (16)
+    , priorityThreshold (ERROR_LOG_LEVEL)
+    , blocking (true)
+    , flushOnPriority (true)
+    , formatterThreads (0)
+    , committing (false)
+    , queuedCount (0)
+    , doneCount (0)
+    , droppedCount (0)
+    , exit_flag (false)
+{
+    addAppender (app);
+    init (thread::ThreadPlacement ());
+}
+
+
+AsyncAppender::AsyncAppender (helpers::Properties const & properties)
+    : Appender (properties)
+    , queueLimit (100)
+    , priorityReserve (16)
+    , priorityThreshold (ERROR_LOG_LEVEL)
+    , blocking (true)
+    , flushOnPriority (true)
+    , formatterThreads (0)
+    , committing (false)
+    , queuedCount (0)
+    , doneCount (0)
+    , droppedCount (0)
+    , exit_flag (false)
+{
+    if (properties.exists (LOG4CPLUS_TEXT ("Appender")))
+    {
+        tstring const appender_name (
+            properties.getProperty (LOG4CPLUS_TEXT ("Appender")));
+        spi::AppenderFactory * factory
+            = spi::getAppenderFactoryRegistry ().get (appender_name);
+        if (! factory)
+            helpers::getLogLog ().error (
+                LOG4CPLUS_TEXT ("AsyncAppender::AsyncAppender()")
+                LOG4CPLUS_TEXT ("- Cannot find AppenderFactory: ")
+                + appender_name);
+        else
+        {
+            helpers::Properties appender_props
+                = properties.getPropertySubset (LOG4CPLUS_TEXT ("Appender."));
+            addAppender (factory->createObject (appender_props));
+        }
+    }
+
+    queueLimit = get_unsigned_property (properties,
+        LOG4CPLUS_TEXT ("QueueLimit"), queueLimit);
+    priorityReserve = get_unsigned_property (properties,
+        LOG4CPLUS_TEXT ("PriorityReserve"), priorityReserve);
+    blocking = get_bool_property (properties, LOG4CPLUS_TEXT ("Blocking"),
+        blocking);
+    flushOnPriority = get_bool_property (properties,
+        LOG4CPLUS_TEXT ("FlushOnPriority"), flushOnPriority);
+    formatterThreads = get_unsigned_property (properties,
+        LOG4CPLUS_TEXT ("FormatterThreads"), formatterThreads);
+
+    if (properties.exists (LOG4CPLUS_TEXT ("PriorityThreshold")))
+    {
+        tstring tmp = properties.getProperty (
+            LOG4CPLUS_TEXT ("PriorityThreshold"));
+        priorityThreshold
+            = getLogLevelManager ().fromString (helpers::toUpper (tmp));
+    }
+
+    thread::ThreadPlacement placement;
+    if (properties.exists (LOG4CPLUS_TEXT ("CPUs"))
+        && ! placement.addCpuList (
+            properties.getProperty (LOG4CPLUS_TEXT ("CPUs"))))
+        helpers::getLogLog ().error (
+            LOG4CPLUS_TEXT ("AsyncAppender::AsyncAppender()")
+            LOG4CPLUS_TEXT ("- Invalid CPUs property"));
+    if (properties.exists (LOG4CPLUS_TEXT ("NumaNode")))
+    {
+        tstring tmp = properties.getProperty (LOG4CPLUS_TEXT ("NumaNode"));
+        placement.setNumaNode (
+            std::atoi (LOG4CPLUS_TSTRING_TO_STRING (tmp).c_str ()));
+    }
+
+    init (placement);
+}
+
+
+AsyncAppender::~AsyncAppender ()
+{
+    destructorImpl ();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// AsyncAppender public methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+AsyncAppender::close ()
+{
+    {
+        thread::MutexGuard guard (queue_mutex);
+        if (exit_flag)
+            return;
+
+        exit_flag = true;
+        queue_ev.signal ();
+        space_ev.signal ();
+    }
+
+    // The dispatchers drain both lanes before they exit.
+    for (std::size_t i = 0; i != dispatchers.size (); ++i)
+        dispatchers[i]->join ();
+    closed = true;
+
+    SharedAppenderPtrList appenders = getAllAppenders ();
+    for (SharedAppenderPtrList::iterator it = appenders.begin ();
+         it != appenders.end (); ++it)
+        (*it)->close ();
+    removeAllAppenders ();
+
+    if (droppedCount != 0)
+    {
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("AsyncAppender::close()- dropped ")
+            << droppedCount << LOG4CPLUS_TEXT (" events");
+        helpers::getLogLog ().warn (oss.str ());
+    }
+}
+
+
+void
+AsyncAppender::flush ()
+{
+    {
+        thread::MutexGuard guard (queue_mutex);
+        unsigned long const target = queuedCount;
+        while (doneCount < target && ! exit_flag)
+        {
+            done_ev.reset ();
+            guard.unlock ();
+            done_ev.wait ();
+            guard.lock ();
+        }
+    }
+
+    flushAppenders ();
+}
+
+
+unsigned long
+AsyncAppender::getDroppedCount () const
+{
+    thread::MutexGuard guard (queue_mutex);
+    return droppedCount;
+}
+
+
+void
+AsyncAppender::atforkPrepare ()
+{
+    // Keeps new events out and waits until the queued ones have been
+    // passed on, so that only the parent passes them on.
+    Appender::atforkPrepare ();
+
+    LOG4CPLUS_MUTEX_LOCK (appender_list_mutex);
+    for (ListType::iterator it = appenderList.begin ();
+         it != appenderList.end (); ++it)
+        (*it)->atforkPrepare ();
+
+    queue_mutex.lock ();
+}
+
+
+void
+AsyncAppender::atforkParent ()
+{
+    queue_mutex.unlock ();
+
+    for (ListType::reverse_iterator it = appenderList.rbegin ();
+         it != appenderList.rend (); ++it)
+        (*it)->atforkParent ();
+    LOG4CPLUS_MUTEX_UNLOCK (appender_list_mutex);
+
+    Appender::atforkParent ();
+}
+
+
+void
+AsyncAppender::atforkChild ()
+{
+    queue_mutex.reinitialize ();
+    queue_ev.reinitialize ();
+    space_ev.reinitialize ();
+    done_ev.reinitialize ();
+
+    for (ListType::reverse_iterator it = appenderList.rbegin ();
+         it != appenderList.rend (); ++it)
+        (*it)->atforkChild ();
+    appender_list_mutex->reinitialize ();
+
+    Appender::atforkChild ();
+
+    // A formatter thread of the parent may have been about to clear the
+    // flag when the process forked.
+    committing = false;
+
+    if (exit_flag)
+        return;
+
+    // The background threads of the parent do not exist here.  Their
+    // objects are released without joining them.
+    thread::ThreadPlacement const placement = dispatchers.empty ()
+        ? thread::ThreadPlacement () : dispatchers.front ()->getPlacement ();
+    dispatchers.clear ();
+    startDispatchers (placement);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// AsyncAppender protected methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+AsyncAppender::init (thread::ThreadPlacement const & placement)
+{
+    // A blocking appender without room would wait forever.
+    if (queueLimit == 0)
+        queueLimit = 1;
+
+    for (std::size_t lane = 0; lane != LANE_COUNT; ++lane)
+    {
+        nextSeq[lane] = 0;
+        commitSeq[lane] = 0;
+    }
+
+    startDispatchers (placement);
+}
+
+
+void
+AsyncAppender::startDispatchers (thread::ThreadPlacement const & placement)
+{
+    std::size_t const threads = (std::max) (formatterThreads, 1u);
+    for (std::size_t i = 0; i != threads; ++i)
+    {
+        helpers::SharedObjectPtr<DispatcherThread> dispatcher (
+            new DispatcherThread (*this));
+        dispatcher->setPlacement (placement);
+        dispatcher->start ();
+        dispatchers.push_back (dispatcher);
+    }
+}
+
+
+void
+AsyncAppender::flushAppenders ()
+{
+    SharedAppenderPtrList appenders = getAllAppenders ();
+    for (SharedAppenderPtrList::iterator it = appenders.begin ();
+         it != appenders.end (); ++it)
+        (*it)->flush ();
+}
+
+
+void
+AsyncAppender::append (spi::InternalLoggingEvent const & event)
+{
+    std::size_t const lane = event.getLogLevel () >= priorityThreshold
+        ? PRIORITY_LANE : NORMAL_LANE;
+    bool const priority = lane == PRIORITY_LANE;
+
+    thread::MutexGuard guard (queue_mutex);
+    while (true)
+    {
+        if (exit_flag)
+            return;
+
+        std::size_t const queued = lanes[PRIORITY_LANE].size ()
+            + lanes[NORMAL_LANE].size ();
+        if (queued < queueLimit
+            || (priority && queued < queueLimit + priorityReserve))
+            break;
+
+        if (! blocking)
+        {
+            ++droppedCount;
+            if (! priority || lanes[NORMAL_LANE].empty ())
+                return;
+
+            // Make room by dropping the oldest lower priority event.
+            // Formatter threads still need its sequence number to keep
+            // the normal lane going.
+            QueueEntry & oldest = lanes[NORMAL_LANE].front ();
+            if (formatterThreads != 0)
+            {
+                oldest.dropped = true;
+                formattedEvents[NORMAL_LANE].insert (
+                    std::make_pair (oldest.seq, oldest));
+            }
+            else
+            {
+                ++doneCount;
+                done_ev.signal ();
+            }
+            lanes[NORMAL_LANE].pop_front ();
+            break;
+        }
+
+        space_ev.reset ();
+        guard.unlock ();
+        space_ev.wait ();
+        guard.lock ();
+    }
+
+    lanes[lane].push_back (QueueEntry (nextSeq[lane]++, event));
+    ++queuedCount;
+    queue_ev.signal ();
+}
+
+
+//! Runs in the only background thread when FormatterThreads is 0.
+void
+AsyncAppender::dispatchEvents ()
+{
+    EventQueue batch;
+
+    while (true)
+    {
+        bool priority = false;
+
+        {
+            thread::MutexGuard guard (queue_mutex);
+            while (lanes[PRIORITY_LANE].empty ()
+                && lanes[NORMAL_LANE].empty ())
+            {
+                if (exit_flag)
+                    return;
+
+                queue_ev.reset ();
+                guard.unlock ();
+                queue_ev.wait ();
+                guard.lock ();
+            }
+
+            if (! lanes[PRIORITY_LANE].empty ())
+            {
+                batch.swap (lanes[PRIORITY_LANE]);
+                priority = true;
+            }
+            else
+            {
+                EventQueue & lane = lanes[NORMAL_LANE];
+                EventQueue::iterator last = lane.begin ()
+                    + (std::min) (lane.size (), DISPATCH_BATCH);
+                batch.assign (lane.begin (), last);
+                lane.erase (lane.begin (), last);
+            }
+
+            space_ev.signal ();
+        }
+
+        passOn (batch, priority);
+        batch.clear ();
+    }
+}
+
+
+//! Runs in each of the FormatterThreads background threads.
+void
+AsyncAppender::formatEvents ()
+{
+    EventQueue batch;
+
+    while (true)
+    {
+        std::size_t lane;
+
+        {
+            thread::MutexGuard guard (queue_mutex);
+            while (lanes[PRIORITY_LANE].empty ()
+                && lanes[NORMAL_LANE].empty ())
+            {
+                if (exit_flag)
+                    return;
+
+                queue_ev.reset ();
+                guard.unlock ();
+                queue_ev.wait ();
+                guard.lock ();
+            }
+
+            lane = lanes[PRIORITY_LANE].empty ()
+                ? NORMAL_LANE : PRIORITY_LANE;
+            EventQueue & queue = lanes[lane];
+            EventQueue::iterator last = queue.begin ()
+                + (std::min) (queue.size (), FORMAT_BATCH);
+            batch.assign (queue.begin (), last);
+            queue.erase (queue.begin (), last);
+
+            space_ev.signal ();
+        }
+
+        for (EventQueue::const_iterator it = batch.begin ();
+             it != batch.end (); ++it)
+            formatEvent (it->event);
+
+        {
+            thread::MutexGuard guard (queue_mutex);
+            for (EventQueue::const_iterator it = batch.begin ();
+                 it != batch.end (); ++it)
+                formattedEvents[lane].insert (std::make_pair (it->seq, *it));
+
+            batch.clear ();
+
+            // Another thread is already passing events on; it will pick
+            // up ours as well.
+            if (committing)
+                continue;
+
+            committing = true;
+        }
+
+        commitEvents ();
+    }
+}
+
+
+//! Passes formatted events on in sequence.  Only one formatter thread
+//! at a time runs this, guarded by the committing flag.
+void
+AsyncAppender::commitEvents ()
+{
+    EventQueue batch;
+
+    while (true)
+    {
+        bool priority = false;
+
+        {
+            thread::MutexGuard guard (queue_mutex);
+            for (std::size_t lane = 0; lane != LANE_COUNT && batch.empty ();
+                 ++lane)
+            {
+                ReorderBuffer & ready = formattedEvents[lane];
+                ReorderBuffer::iterator it;
+                while ((it = ready.begin ()) != ready.end ()
+                    && it->first == commitSeq[lane])
+                {
+                    batch.push_back (it->second);
+                    ready.erase (it);
+                    ++commitSeq[lane];
+                }
+
+                priority = lane == PRIORITY_LANE;
+            }
+
+            if (batch.empty ())
+            {
+                committing = false;
+                return;
+            }
+        }
+
+        passOn (batch, priority);
+        batch.clear ();
+    }
+}
+
+
+void
+AsyncAppender::formatEvent (spi::InternalLoggingEvent const & event)
+{
+    SharedAppenderPtrList appenders = getAllAppenders ();
+    for (SharedAppenderPtrList::iterator it = appenders.begin ();
+         it != appenders.end (); ++it)
+    {
+        Layout * app_layout = (*it)->getLayout ();
+        tostringstream oss;
+        if (! app_layout
+            || event.getFormattedOutput (app_layout, oss.getloc ()))
+            continue;
+
+        try
+        {
+            app_layout->formatAndAppend (oss, event);
+        }
+        catch (std::exception const &)
+        {
+            // Leave it to the appender to format the event again and to
+            // report the failure.
+            continue;
+        }
+
+        // Layouts that share their output have stored it already.
+        if (! event.getFormattedOutput (app_layout, oss.getloc ()))
+            event.setFormattedOutput (app_layout, oss.getloc (), oss.str ());
+    }
+}
+
+
+void
+AsyncAppender::passOn (EventQueue const & batch, bool priority)
+{
+    for (EventQueue::const_iterator it = batch.begin ();
+         it != batch.end (); ++it)
+    {
+        if (it->dropped)
+            continue;
+
+        try
+        {
+            appendLoopOnAppenders (it->event);
+        }
+        catch (std::exception const & e)
+        {
+            helpers::getLogLog ().error (
+                LOG4CPLUS_TEXT ("AsyncAppender::passOn()- exception: ")
+                + LOG4CPLUS_C_STR_TO_TSTRING (e.what ()));
+        }
+        catch (...)
+        {
+            helpers::getLogLog ().error (
+                LOG4CPLUS_TEXT ("AsyncAppender::passOn()- unknown exception"));
+        }
+    }
+
+    if (priority && flushOnPriority)
+        flushAppenders ();
+
+    thread::MutexGuard guard (queue_mutex);
+    doneCount += static_cast<unsigned long>(batch.size ());
+    done_ev.signal ();
+}
+
+
+} // namespace log4cplus
+
+#endif // LOG4CPLUS_SINGLE_THREADED
@@ -0,0 +1,268 @@
+// Module:  Log4CPLUS
+// File:    backtrace.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <log4cplus/helpers/backtrace.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/thread/syncprims.h>
+
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined (__GLIBC__) || defined (__APPLE__)
+#  define LOG4CPLUS_HAVE_EXECINFO
+#  include <execinfo.h>
+#endif
+
+#if defined (__GNUC__)
+#  include <cxxabi.h>
+#endif
+
+
+namespace log4cplus { namespace helpers {
+
+
+namespace
+{
+
+//! Frames captured at most.
+static std::size_t const MAX_FRAMES = 64;
+
+static LogLevel volatile backtrace_threshold = NOT_SET_LOG_LEVEL;
+
+
+struct FrameInfo
+{
+    tstring text;
+    //! Set for functions of namespace log4cplus.
+    bool internal;
+    //! Set when backtrace_symbols() found a name for the address.
+    bool named;
+    //! File name of the module containing the address.
+    std::string module;
+};
+
+
+//! Symbolized frames by return address.  Programs have a limited number
+//! of call sites, so the cache is not trimmed.
+typedef std::map<void *, FrameInfo> SymbolCache;
+
+static thread::Mutex cache_mutex;
+static SymbolCache symbol_cache;
+
+
+static
+std::string
+demangle (std::string const & name)
+{
+#if defined (__GNUC__)
+    int status = 0;
+    char * const demangled
+        = abi::__cxa_demangle (name.c_str (), 0, 0, &status);
+    if (demangled)
+    {
+        std::string const result (demangled);
+        std::free (demangled);
+        return result;
+    }
+#endif
+
+    return name;
+}
+
+
+//! Looks up the function and module of addr.  glibc describes a frame
+//! as <tt>module(symbol+0x2a) [0x4005d6]</tt>, or without the symbol
+//! when it has none.
+static
+FrameInfo
+describe_frame (void * addr)
+{
+    std::string text;
+#if defined (LOG4CPLUS_HAVE_EXECINFO)
+    char ** const symbols = backtrace_symbols (&addr, 1);
+    if (symbols)
+    {
+        text = symbols[0];
+        std::free (symbols);
+    }
+#endif
+
+    FrameInfo info;
+    info.internal = false;
+    info.named = false;
+
+    std::string::size_type const open = text.find ('(');
+    std::string::size_type const close = open == std::string::npos
+        ? std::string::npos : text.find (')', open);
+    if (close != std::string::npos)
+    {
+        std::string module (text, 0, open);
+        std::string::size_type const slash = module.rfind ('/');
+        if (slash != std::string::npos)
+            module.erase (0, slash + 1);
+        info.module = module;
+
+        std::string symbol (text, open + 1, close - open - 1);
+        std::string offset;
+        std::string::size_type const plus = symbol.rfind ('+');
+        if (plus != std::string::npos)
+        {
+            offset.assign (symbol, plus, std::string::npos);
+            symbol.erase (plus);
+        }
+
+        if (symbol.empty ())
+            text = module + offset;
+        else
+        {
+            symbol = demangle (symbol);
+            info.named = true;
+            info.internal = symbol.compare (0, 11, "log4cplus::") == 0;
+            text = symbol + offset + " (" + module + ")";
+        }
+    }
+    else if (text.empty ())
+    {
+        std::ostringstream oss;
+        oss << addr;
+        text = oss.str ();
+    }
+
+    info.text = LOG4CPLUS_C_STR_TO_TSTRING (text);
+    return info;
+}
+
+} // namespace
+
+
+bool
+setBacktraceThreshold (LogLevel ll)
+{
+#if defined (LOG4CPLUS_HAVE_EXECINFO)
+    if (ll != NOT_SET_LOG_LEVEL)
+    {
+        // The first backtrace() call loads the unwinder.  Do that here
+        // rather than in the first logging call.
+        void * frame;
+        backtrace (&frame, 1);
+    }
+    backtrace_threshold = ll;
+    return true;
+
+#else
+    backtrace_threshold = NOT_SET_LOG_LEVEL;
+    return ll == NOT_SET_LOG_LEVEL;
+
+#endif
+}
+
+
+LogLevel
+getBacktraceThreshold ()
+{
+    return backtrace_threshold;
+}
+
+
+bool
+captureBacktrace (Backtrace & frames)
+{
+#if defined (LOG4CPLUS_HAVE_EXECINFO)
+    void * buffer[MAX_FRAMES + 1];
+    int const count = backtrace (buffer, static_cast<int>(MAX_FRAMES + 1));
+    if (count > 1)
+    {
+        frames.assign (buffer + 1, buffer + count);
+        return true;
+    }
+#endif
+
+    frames.clear ();
+    return false;
+}
+
+
+void
+symbolizeBacktrace (tstring & out, Backtrace const & frames,
+    unsigned maxDepth)
+{
+    thread::MutexGuard guard (cache_mutex);
+
+    std::vector<FrameInfo const *> infos;
+    infos.reserve (frames.size ());
+    for (Backtrace::const_iterator it = frames.begin ();
+         it != frames.end (); ++it)
+    {
+        SymbolCache::iterator frame = symbol_cache.find (*it);
+        if (frame == symbol_cache.end ())
+            frame = symbol_cache.insert (
+                std::make_pair (*it, describe_frame (*it))).first;
+        infos.push_back (&frame->second);
+    }
+
+    // Skip the leading frames up to the last one inside log4cplus.
+    // Functions with internal linkage have no name, so unnamed frames
+    // of the module of the innermost frame, which is the one that
+    // captured the backtrace, do not end the leading run.
+    std::size_t first = 0;
+    for (std::size_t i = 0; i != infos.size (); ++i)
+    {
+        if (infos[i]->internal)
+            first = i + 1;
+        else if (infos[i]->named || infos[i]->module != infos[0]->module)
+            break;
+    }
+
+    unsigned written = 0;
+    for (std::size_t i = first;
+         i != infos.size () && (maxDepth == 0 || written != maxDepth); ++i)
+    {
+        out += LOG4CPLUS_TEXT ("\n\tat ");
+        out += infos[i]->text;
+        ++written;
+    }
+}
+
+
+void
+backtraceAtforkPrepare ()
+{
+    cache_mutex.lock ();
+}
+
+
+void
+backtraceAtforkParent ()
+{
+    cache_mutex.unlock ();
+}
+
+
+void
+backtraceAtforkChild ()
+{
+    cache_mutex.reinitialize ();
+}
+
+
+} } // namespace log4cplus { namespace helpers {
@@ -20,6 +20,7 @@
 
 #include <log4cplus/configurator.h>
 #include <log4cplus/hierarchylocker.h>
+#include <log4cplus/helpers/backtrace.h>
 #include <log4cplus/helpers/loglog.h>
 #include <log4cplus/helpers/sleep.h>
 #include <log4cplus/helpers/stringhelper.h>
@@ -366,6 +367,9 @@ PropertyConfigurator::configure()
         helpers::toLower (val) == LOG4CPLUS_TEXT ("true"));
 
     initializeLog4cplus();
+    configureEventClock();
+    configureLoadGovernor();
+    configureBacktrace();
     configureAppenders();
     configureLoggers();
     configureAdditivity();
@@ -402,6 +406,67 @@ PropertyConfigurator::reconfigure()
 }
 
 
+void
+PropertyConfigurator::configureEventClock()
+{
+    tstring const val = helpers::toUpper (properties.getProperty (
+        LOG4CPLUS_TEXT ("eventClock")));
+    if (val.empty ())
+        return;
+
+    helpers::Time::EventClock clock;
+    if (val == LOG4CPLUS_TEXT ("REALTIME"))
+        clock = helpers::Time::REALTIME_CLOCK;
+    else if (val == LOG4CPLUS_TEXT ("REALTIME_COARSE"))
+        clock = helpers::Time::COARSE_REALTIME_CLOCK;
+    else if (val == LOG4CPLUS_TEXT ("TSC"))
+        clock = helpers::Time::TSC_CLOCK;
+    else
+    {
+        getLogLog ().error (LOG4CPLUS_TEXT ("Unknown eventClock: ") + val);
+        return;
+    }
+
+    if (! helpers::Time::setEventClock (clock))
+        getLogLog ().warn (LOG4CPLUS_TEXT ("Event clock ") + val
+            + LOG4CPLUS_TEXT (" is not available, using REALTIME"));
+}
+
+
+void
+PropertyConfigurator::configureLoadGovernor()
+{
+    Properties const governorProperties
+        = properties.getPropertySubset (LOG4CPLUS_TEXT ("governor."));
+    if (governorProperties.size () == 0)
+        return;
+
+    h.getLoadGovernor ().configure (governorProperties);
+}
+
+
+void
+PropertyConfigurator::configureBacktrace()
+{
+    tstring const val = properties.getProperty (
+        LOG4CPLUS_TEXT ("backtraceLevel"));
+    if (val.empty ())
+        return;
+
+    LogLevel const ll = getLogLevelManager ().fromString (val);
+    if (ll == NOT_SET_LOG_LEVEL)
+    {
+        getLogLog ().error (LOG4CPLUS_TEXT ("Unknown backtraceLevel: ")
+            + val);
+        return;
+    }
+
+    if (! helpers::setBacktraceThreshold (ll))
+        getLogLog ().warn (
+            LOG4CPLUS_TEXT ("Backtraces are not available on this platform"));
+}
+
+
 void
 PropertyConfigurator::replaceEnvironVariables()
 {
@@ -24,6 +24,19 @@
 #include <log4cplus/helpers/loglog.h>
 #include <log4cplus/helpers/stringhelper.h>
 #include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/internal/internal.h>
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#endif
+
+#include <cstdlib>
 
 using namespace std;
 using namespace log4cplus::helpers;
@@ -33,9 +46,33 @@ using namespace log4cplus::helpers;
 // log4cplus::ConsoleAppender ctors and dtor
 //////////////////////////////////////////////////////////////////////////////
 
+namespace
+{
+
+//! Size limit of DirectWrite batches.  Writes of up to PIPE_BUF bytes
+//! to a pipe are atomic, so batches of this size do not interleave
+//! with output of other processes.
+#if defined (PIPE_BUF)
+static std::size_t const DIRECT_WRITE_BATCH = PIPE_BUF;
+#else
+static std::size_t const DIRECT_WRITE_BATCH = 512;
+#endif
+
+//! Time a NonBlocking write waits for the reader to finish an event
+//! that has been partly written.
+static int const NONBLOCKING_WAIT_MS = 100;
+
+} // namespace
+
+
 log4cplus::ConsoleAppender::ConsoleAppender(bool logToStdErr_, bool immediateFlush_)
 : logToStdErr(logToStdErr_),
-  immediateFlush(immediateFlush_)
+  immediateFlush(immediateFlush_),
+  fd(-1),
+  ownFd(false),
+  bufferedEvents(0),
+  droppedCount(0),
+  unreportedDrops(0)
 {
 }
 
@@ -44,16 +81,42 @@ log4cplus::ConsoleAppender::ConsoleAppender(bool logToStdErr_, bool immediateFlu
 log4cplus::ConsoleAppender::ConsoleAppender(const log4cplus::helpers::Properties properties)
 : Appender(properties),
   logToStdErr(false),
-  immediateFlush(false)
+  immediateFlush(false),
+  fd(-1),
+  ownFd(false),
+  bufferedEvents(0),
+  droppedCount(0),
+  unreportedDrops(0)
 {
     tstring val = toLower(properties.getProperty(LOG4CPLUS_TEXT("logToStdErr")));
     if(val == LOG4CPLUS_TEXT("true")) {
         logToStdErr = true;
     }
+    bool const directWrite
+        = toLower(properties.getProperty(LOG4CPLUS_TEXT("DirectWrite")))
+            == LOG4CPLUS_TEXT("true");
     if(properties.exists( LOG4CPLUS_TEXT("ImmediateFlush") )) {
         tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("ImmediateFlush") );
         immediateFlush = (toLower(tmp) == LOG4CPLUS_TEXT("true"));
     }
+    else if (directWrite) {
+        // Batched events are lost if the process exits without
+        // shutdown(), so batching has to be asked for.
+        immediateFlush = true;
+    }
+
+    if (directWrite)
+    {
+        bool const nonBlocking = toLower(properties.getProperty(
+            LOG4CPLUS_TEXT("NonBlocking"))) == LOG4CPLUS_TEXT("true");
+        unsigned long pipeSize = 0;
+        if (properties.exists(LOG4CPLUS_TEXT("PipeSize"))) {
+            tstring tmp = properties.getProperty(LOG4CPLUS_TEXT("PipeSize"));
+            pipeSize = std::strtoul(
+                LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str(), 0, 10);
+        }
+        initDirectWrite(nonBlocking, pipeSize);
+    }
 }
 
 
@@ -73,11 +136,49 @@ void
 log4cplus::ConsoleAppender::close()
 {
     getLogLog().debug(LOG4CPLUS_TEXT("Entering ConsoleAppender::close().."));
+    thread::MutexGuard guard (access_mutex);
+    if (closed)
+        return;
+
+    if (fd != -1)
+    {
+        writeBuffer();
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+        if (ownFd)
+            ::close(fd);
+#endif
+        fd = -1;
+    }
     closed = true;
 }
 
 
 
+void
+log4cplus::ConsoleAppender::flush()
+{
+    if (fd != -1)
+    {
+        thread::MutexGuard guard (access_mutex);
+        writeBuffer();
+        return;
+    }
+
+    thread::MutexGuard guard (helpers::getLogLog().mutex);
+
+    (logToStdErr ? tcerr : tcout).flush();
+}
+
+
+unsigned long
+log4cplus::ConsoleAppender::getDroppedCount() const
+{
+    thread::MutexGuard guard (access_mutex);
+    return droppedCount;
+}
+
+
+
 //////////////////////////////////////////////////////////////////////////////
 // log4cplus::ConsoleAppender protected methods
 //////////////////////////////////////////////////////////////////////////////
@@ -89,6 +190,33 @@ log4cplus::ConsoleAppender::close()
 void
 log4cplus::ConsoleAppender::append(const spi::InternalLoggingEvent& event)
 {
+    if (fd != -1)
+    {
+        formatBuffer.str(internal::empty_str);
+        layout->formatAndAppend(formatBuffer, event);
+        std::size_t const batched = buffer.size();
+#ifdef UNICODE
+        tstring const & text = formatBuffer.str();
+        appendUTF8(buffer, text.data(), text.size());
+#else
+        buffer += formatBuffer.str();
+#endif
+
+        // Events batched so far go out on their own if this one would
+        // make the batch too long to be written atomically.
+        if (batched != 0 && buffer.size() > DIRECT_WRITE_BATCH)
+        {
+            writeBatch(batched, bufferedEvents);
+            buffer.erase(0, batched);
+            bufferedEvents = 0;
+        }
+
+        ++bufferedEvents;
+        if (immediateFlush || buffer.size() >= DIRECT_WRITE_BATCH)
+            writeBuffer();
+        return;
+    }
+
     thread::MutexGuard guard (helpers::getLogLog().mutex);
 
     log4cplus::tostream& output = (logToStdErr ? tcerr : tcout);
@@ -98,3 +226,138 @@ log4cplus::ConsoleAppender::append(const spi::InternalLoggingEvent& event)
 }
 
 
+
+void
+log4cplus::ConsoleAppender::initDirectWrite(bool nonBlocking,
+    unsigned long pipeSize)
+{
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    int const std_fd = logToStdErr ? STDERR_FILENO : STDOUT_FILENO;
+    fd = std_fd;
+
+    // Whatever went to the stream so far goes out first.
+    (logToStdErr ? tcerr : tcout).flush();
+
+    struct stat st;
+    bool const is_pipe = ::fstat(std_fd, &st) == 0 && S_ISFIFO(st.st_mode);
+
+    if (pipeSize != 0)
+    {
+#if defined (F_SETPIPE_SZ)
+        if (! is_pipe || ::fcntl(std_fd, F_SETPIPE_SZ,
+                static_cast<int>(pipeSize)) == -1)
+            getLogLog().warn(LOG4CPLUS_TEXT("ConsoleAppender: PipeSize ")
+                LOG4CPLUS_TEXT("could not be set"));
+#else
+        getLogLog().warn(LOG4CPLUS_TEXT("ConsoleAppender: PipeSize ")
+            LOG4CPLUS_TEXT("is not supported on this platform"));
+#endif
+    }
+
+    if (nonBlocking)
+    {
+        // O_NONBLOCK is shared by all descriptors of an open file
+        // description, so the pipe is opened anew instead of setting
+        // the flag on the standard descriptor.
+        int new_fd = -1;
+#if defined (__linux__)
+        if (is_pipe)
+        {
+            char path[32];
+            std::sprintf(path, "/proc/self/fd/%d", std_fd);
+            new_fd = ::open(path, O_WRONLY | O_NONBLOCK);
+        }
+#endif
+        if (new_fd != -1)
+        {
+            ::fcntl(new_fd, F_SETFD, FD_CLOEXEC);
+            fd = new_fd;
+            ownFd = true;
+        }
+        else
+            getLogLog().warn(LOG4CPLUS_TEXT("ConsoleAppender: NonBlocking ")
+                LOG4CPLUS_TEXT("is only supported for pipes on Linux"));
+    }
+
+    buffer.reserve(DIRECT_WRITE_BATCH * 2);
+
+#else
+    getLogLog().warn(LOG4CPLUS_TEXT("ConsoleAppender: DirectWrite ")
+        LOG4CPLUS_TEXT("is not supported on this platform"));
+    (void) nonBlocking;
+    (void) pipeSize;
+#endif
+}
+
+
+void
+log4cplus::ConsoleAppender::writeBuffer()
+{
+    writeBatch(buffer.size(), bufferedEvents);
+    buffer.clear();
+    bufferedEvents = 0;
+}
+
+
+void
+log4cplus::ConsoleAppender::writeBatch(std::size_t size,
+    unsigned long events)
+{
+#if defined (LOG4CPLUS_HAVE_UNISTD_H)
+    std::size_t written = 0;
+    while (written != size)
+    {
+        ssize_t const ret = ::write(fd, buffer.data() + written,
+            size - written);
+        if (ret >= 0)
+        {
+            written += ret;
+            continue;
+        }
+
+        int const eno = errno;
+        if (eno == EINTR)
+            continue;
+        else if (eno == EAGAIN || eno == EWOULDBLOCK)
+        {
+            // The reader has stalled.  A batch that has not been
+            // started is dropped.  Only a single event longer than
+            // PIPE_BUF can be written in part; the reader gets a
+            // moment to take the rest before it is cut off, too.
+            if (written != 0)
+            {
+                struct pollfd pfd;
+                pfd.fd = fd;
+                pfd.events = POLLOUT;
+                pfd.revents = 0;
+                int const ready = ::poll(&pfd, 1, NONBLOCKING_WAIT_MS);
+                if (ready > 0 || (ready < 0 && errno == EINTR))
+                    continue;
+            }
+
+            droppedCount += events;
+            unreportedDrops += events;
+            break;
+        }
+        else
+        {
+            getErrorHandler()->error(
+                LOG4CPLUS_TEXT("ConsoleAppender: write() failed: ")
+                + convertIntegerToString(eno));
+            break;
+        }
+    }
+
+    if (written == size && unreportedDrops != 0)
+    {
+        getLogLog().warn(LOG4CPLUS_TEXT("ConsoleAppender: dropped ")
+            + convertIntegerToString(unreportedDrops)
+            + LOG4CPLUS_TEXT(" events while the output was blocked"));
+        unreportedDrops = 0;
+    }
+
+#else
+    (void) size;
+    (void) events;
+#endif
+}
@@ -0,0 +1,559 @@
+// Module:  Log4CPLUS
+// File:    emergencylog.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <log4cplus/emergencylog.h>
+#include <log4cplus/appender.h>
+#include <log4cplus/logger.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/thread/threads.h>
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <set>
+
+#if defined (LOG4CPLUS_HAVE_SYS_TIME_H)
+#  include <sys/time.h>
+#endif
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H) && ! defined (_WIN32)
+#  define LOG4CPLUS_HAVE_FATAL_SIGNAL_HANDLERS
+#  include <fcntl.h>
+#  include <poll.h>
+#  include <signal.h>
+#  include <unistd.h>
+#elif defined (_WIN32)
+#  include <io.h>
+#endif
+
+
+namespace log4cplus
+{
+
+
+namespace
+{
+
+//! Longest record emergencyLog() writes, newline included.
+static std::size_t const MAX_RECORD = 512;
+
+static int volatile emergency_fd = 2;
+static char * buffer = 0;
+static std::size_t buffer_size = 0;
+static std::size_t volatile buffer_pos = 0;
+static unsigned long volatile drop_count = 0;
+
+
+static inline
+void
+count_drop ()
+{
+#if defined (LOG4CPLUS_HAVE___SYNC_ADD_AND_FETCH)
+    __sync_add_and_fetch (&drop_count, 1);
+#else
+    ++drop_count;
+#endif
+}
+
+
+//! Reserves size bytes of the buffer, if they fit, and sets pos to
+//! their offset.  Without atomic built-ins, concurrent records may
+//! overwrite each other.
+static inline
+bool
+reserve (std::size_t size, std::size_t & pos)
+{
+    for (;;)
+    {
+        std::size_t const cur = buffer_pos;
+        if (size > buffer_size - cur)
+            return false;
+
+#if defined (LOG4CPLUS_HAVE___SYNC_ADD_AND_FETCH)
+        if (! __sync_bool_compare_and_swap (&buffer_pos, cur, cur + size))
+            continue;
+#else
+        buffer_pos = cur + size;
+#endif
+        pos = cur;
+        return true;
+    }
+}
+
+
+//! Fills a fixed buffer with the text of a record.
+class RecordWriter
+{
+public:
+    RecordWriter (char * buf, std::size_t size)
+        : begin (buf)
+        , pos (buf)
+        , end (buf + size)
+    { }
+
+    void put (char const * str, std::size_t len)
+    {
+        while (len-- != 0 && pos != end)
+            *pos++ = *str++;
+    }
+
+    void put (char const * str)
+    {
+        while (*str && pos != end)
+            *pos++ = *str++;
+    }
+
+    void put (char ch)
+    {
+        if (pos != end)
+            *pos++ = ch;
+    }
+
+    //! Writes value in decimal, zero padded to width digits.
+    void put_uint (unsigned long value, int width)
+    {
+        char digits[24];
+        int n = 0;
+        do
+        {
+            digits[n++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+        while (value != 0);
+
+        while (width-- > n)
+            put ('0');
+        while (n != 0)
+            put (digits[--n]);
+    }
+
+    std::size_t size () const
+    {
+        return static_cast<std::size_t>(pos - begin);
+    }
+
+private:
+    char * begin;
+    char * pos;
+    char * end;
+};
+
+
+static
+char const *
+level_name (LogLevel ll)
+{
+    switch (ll)
+    {
+    case FATAL_LOG_LEVEL:
+        return "FATAL";
+
+    case ERROR_LOG_LEVEL:
+        return "ERROR";
+
+    case WARN_LOG_LEVEL:
+        return "WARN";
+
+    case INFO_LOG_LEVEL:
+        return "INFO";
+
+    case DEBUG_LOG_LEVEL:
+        return "DEBUG";
+
+    case TRACE_LOG_LEVEL:
+        return "TRACE";
+
+    default:
+        return 0;
+    }
+}
+
+
+static
+void
+get_time (std::time_t & sec, unsigned long & msec)
+{
+#if defined (LOG4CPLUS_HAVE_CLOCK_GETTIME)
+    struct timespec ts;
+    clock_gettime (CLOCK_REALTIME, &ts);
+    sec = ts.tv_sec;
+    msec = static_cast<unsigned long>(ts.tv_nsec / 1000000);
+
+#elif defined (LOG4CPLUS_HAVE_GETTIMEOFDAY)
+    struct timeval tv;
+    gettimeofday (&tv, 0);
+    sec = tv.tv_sec;
+    msec = static_cast<unsigned long>(tv.tv_usec / 1000);
+
+#else
+    sec = std::time (0);
+    msec = 0;
+
+#endif
+}
+
+
+//! Writes the UTC date and time of sec without the C library, as
+//! gmtime() is not async-signal-safe.
+static
+void
+put_timestamp (RecordWriter & out, std::time_t sec, unsigned long msec)
+{
+    long days = static_cast<long>(sec / 86400);
+    long secs = static_cast<long>(sec % 86400);
+    if (secs < 0)
+    {
+        secs += 86400;
+        --days;
+    }
+
+    // Civil date from days since 1970-01-01, for the proleptic
+    // Gregorian calendar.
+    long const z = days + 719468;
+    long const era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned long const doe = static_cast<unsigned long>(z - era * 146097);
+    unsigned long const yoe
+        = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned long const doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned long const mp = (5 * doy + 2) / 153;
+    unsigned long const day = doy - (153 * mp + 2) / 5 + 1;
+    unsigned long const month = mp < 10 ? mp + 3 : mp - 9;
+    long const year = static_cast<long>(yoe) + era * 400 + (month <= 2);
+
+    out.put_uint (static_cast<unsigned long>(year), 4);
+    out.put ('-');
+    out.put_uint (month, 2);
+    out.put ('-');
+    out.put_uint (day, 2);
+    out.put (' ');
+    out.put_uint (static_cast<unsigned long>(secs / 3600), 2);
+    out.put (':');
+    out.put_uint (static_cast<unsigned long>(secs / 60 % 60), 2);
+    out.put (':');
+    out.put_uint (static_cast<unsigned long>(secs % 60), 2);
+    out.put ('.');
+    out.put_uint (msec, 3);
+    out.put ('Z');
+}
+
+
+static
+bool
+write_all (int fd, char const * data, std::size_t len)
+{
+    while (len != 0)
+    {
+#if defined (_WIN32)
+        int const ret = _write (fd, data, static_cast<unsigned>(len));
+#else
+        long const ret = static_cast<long>(write (fd, data, len));
+#endif
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+
+        data += ret;
+        len -= static_cast<std::size_t>(ret);
+    }
+    return true;
+}
+
+
+#if defined (LOG4CPLUS_HAVE_FATAL_SIGNAL_HANDLERS)
+
+static int const fatal_signals[] = {
+    SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT
+};
+
+static char const * const fatal_signal_names[] = {
+    "SIGSEGV", "SIGBUS", "SIGFPE", "SIGILL", "SIGABRT"
+};
+
+static std::size_t const FATAL_SIGNAL_COUNT
+    = sizeof (fatal_signals) / sizeof (fatal_signals[0]);
+
+static int flush_timeout = 1000;
+//! The process that installed the handlers; the flush is skipped in
+//! forked children.
+static pid_t volatile handler_pid = 0;
+
+
+//! Flushes the appenders of the default hierarchy.
+static
+void
+flush_appenders ()
+{
+    try
+    {
+        std::set<Appender *> flushed;
+        LoggerList loggers = Logger::getCurrentLoggers ();
+        loggers.push_back (Logger::getRoot ());
+        for (LoggerList::iterator it = loggers.begin ();
+             it != loggers.end (); ++it)
+        {
+            SharedAppenderPtrList appenders = it->getAllAppenders ();
+            for (SharedAppenderPtrList::iterator app = appenders.begin ();
+                 app != appenders.end (); ++app)
+                if (flushed.insert (app->get ()).second)
+                    (*app)->flush ();
+        }
+    }
+    catch (...)
+    { }
+}
+
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+
+static int request_pipe[2] = { -1, -1 };
+static int done_pipe[2] = { -1, -1 };
+
+
+//! Flushes the appenders when a fatal signal handler asks for it
+//! through request_pipe, and answers through done_pipe.
+class FlusherThread
+    : public thread::AbstractThread
+{
+public:
+    virtual void run ()
+    {
+        char ch;
+        while (true)
+        {
+            long const ret = static_cast<long>(read (request_pipe[0], &ch, 1));
+            if (ret < 0 && errno == EINTR)
+                continue;
+            if (ret <= 0)
+                return;
+
+            flush_appenders ();
+            write_all (done_pipe[1], &ch, 1);
+        }
+    }
+};
+
+
+static
+bool
+open_pipe (int (& fds)[2])
+{
+    if (pipe (fds) != 0)
+        return false;
+
+    fcntl (fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl (fds[1], F_SETFD, FD_CLOEXEC);
+    return true;
+}
+
+#endif // LOG4CPLUS_SINGLE_THREADED
+
+
+static
+void
+flush_from_handler ()
+{
+    if (getpid () != handler_pid)
+        return;
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+    char const ch = 0;
+    if (! write_all (request_pipe[1], &ch, 1))
+        return;
+
+    struct pollfd pfd;
+    pfd.fd = done_pipe[0];
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    while (poll (&pfd, 1, flush_timeout) < 0 && errno == EINTR)
+        ;
+
+#else
+    // There are no locks to wait for in single threaded builds.
+    flush_appenders ();
+
+#endif
+}
+
+
+static
+void
+fatal_signal_handler (int sig)
+{
+    char message[64];
+    RecordWriter out (message, sizeof (message));
+    out.put ("Caught fatal signal ");
+    std::size_t i = 0;
+    while (i != FATAL_SIGNAL_COUNT && fatal_signals[i] != sig)
+        ++i;
+    if (i != FATAL_SIGNAL_COUNT)
+        out.put (fatal_signal_names[i]);
+    else
+        out.put_uint (static_cast<unsigned long>(sig), 0);
+    emergencyLog (FATAL_LOG_LEVEL, message, out.size ());
+
+    flush_from_handler ();
+
+    // SA_RESETHAND has restored the default action and SA_NODEFER keeps
+    // the signal from being blocked, so this terminates the process.
+    raise (sig);
+}
+
+#endif // LOG4CPLUS_HAVE_FATAL_SIGNAL_HANDLERS
+
+} // namespace
+
+
+void
+initEmergencyLog (int fd, std::size_t bufferSize)
+{
+    char * const old = buffer;
+    buffer_size = 0;
+    buffer = 0;
+    delete[] old;
+
+    if (fd < 0 && bufferSize != 0)
+    {
+        buffer = new char[bufferSize];
+        buffer_size = bufferSize;
+    }
+    buffer_pos = 0;
+    emergency_fd = fd;
+}
+
+
+void
+emergencyLog (LogLevel ll, char const * message)
+{
+    emergencyLog (ll, message, std::strlen (message));
+}
+
+
+void
+emergencyLog (LogLevel ll, char const * message, std::size_t len)
+{
+    int const saved_errno = errno;
+
+    char record[MAX_RECORD];
+    RecordWriter out (record, sizeof (record) - 1);
+
+    std::time_t sec;
+    unsigned long msec;
+    get_time (sec, msec);
+    put_timestamp (out, sec, msec);
+    out.put (' ');
+    if (char const * name = level_name (ll))
+        out.put (name);
+    else
+        out.put_uint (static_cast<unsigned long>(ll), 0);
+    out.put (' ');
+    out.put (message, len);
+    record[out.size ()] = '\n';
+    std::size_t const size = out.size () + 1;
+
+    int const fd = emergency_fd;
+    std::size_t pos = 0;
+    if (fd >= 0)
+    {
+        if (! write_all (fd, record, size))
+            count_drop ();
+    }
+    else if (reserve (size, pos))
+        std::memcpy (buffer + pos, record, size);
+    else
+        count_drop ();
+
+    errno = saved_errno;
+}
+
+
+std::string
+readEmergencyLog ()
+{
+    std::string records;
+    if (buffer)
+    {
+        records.assign (buffer, buffer_pos);
+        buffer_pos = 0;
+    }
+    return records;
+}
+
+
+unsigned long
+getEmergencyLogDropCount ()
+{
+    return drop_count;
+}
+
+
+bool
+installFatalSignalHandlers (unsigned long flushTimeout)
+{
+#if defined (LOG4CPLUS_HAVE_FATAL_SIGNAL_HANDLERS)
+    flush_timeout = static_cast<int>(flushTimeout);
+    handler_pid = getpid ();
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+    if (request_pipe[0] < 0)
+    {
+        if (! open_pipe (request_pipe) || ! open_pipe (done_pipe))
+        {
+            helpers::getLogLog ().error (
+                LOG4CPLUS_TEXT ("installFatalSignalHandlers()- pipe() failed"));
+            return false;
+        }
+
+        // The reference is never released, the thread runs until the
+        // process ends.
+        FlusherThread * flusher = new FlusherThread;
+        flusher->addReference ();
+        flusher->start ();
+    }
+#endif
+
+    for (std::size_t i = 0; i != FATAL_SIGNAL_COUNT; ++i)
+    {
+        struct sigaction old_action;
+        if (sigaction (fatal_signals[i], 0, &old_action) != 0
+            || (old_action.sa_handler != SIG_DFL
+                && old_action.sa_handler != fatal_signal_handler))
+            continue;
+
+        struct sigaction action;
+        std::memset (&action, 0, sizeof (action));
+        action.sa_handler = fatal_signal_handler;
+        sigemptyset (&action.sa_mask);
+        action.sa_flags = SA_RESETHAND | SA_NODEFER;
+        sigaction (fatal_signals[i], &action, 0);
+    }
+    return true;
+
+#else
+    (void) flushTimeout;
+    return false;
+
+#endif
+}
+
+
+} // namespace log4cplus
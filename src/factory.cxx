@@ -20,10 +20,15 @@
 
 #include <log4cplus/spi/factory.h>
 #include <log4cplus/spi/loggerfactory.h>
+#include <log4cplus/asyncappender.h>
 #include <log4cplus/consoleappender.h>
+#include <log4cplus/failoverappender.h>
 #include <log4cplus/fileappender.h>
 #include <log4cplus/nullappender.h>
+#include <log4cplus/segmentappender.h>
+#include <log4cplus/sharedmemoryappender.h>
 #include <log4cplus/socketappender.h>
+#include <log4cplus/socketpoolappender.h>
 #include <log4cplus/syslogappender.h>
 #include <log4cplus/helpers/loglog.h>
 #include <log4cplus/thread/threads.h>
@@ -155,6 +160,13 @@ void initializeFactoryRegistry()
     REG_APPENDER (reg, RollingFileAppender);
     REG_APPENDER (reg, DailyRollingFileAppender);
     REG_APPENDER (reg, SocketAppender);
+    REG_APPENDER (reg, SocketPoolAppender);
+    REG_APPENDER (reg, SegmentAppender);
+    REG_APPENDER (reg, SharedMemoryAppender);
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    REG_APPENDER (reg, AsyncAppender);
+    REG_APPENDER (reg, FailoverAppender);
+#endif
 #if defined(_WIN32)
 #  if defined(LOG4CPLUS_HAVE_NT_EVENT_LOG)
     REG_APPENDER (reg, NTEventLogAppender);
@@ -171,6 +183,7 @@ void initializeFactoryRegistry()
     REG_LAYOUT (reg2, SimpleLayout);
     REG_LAYOUT (reg2, TTCCLayout);
     REG_LAYOUT (reg2, PatternLayout);
+    REG_LAYOUT (reg2, JsonLayout);
 
     FilterFactoryRegistry& reg3 = getFilterFactoryRegistry();
     REG_FILTER (reg3, DenyAllFilter);
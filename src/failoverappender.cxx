@@ -0,0 +1,616 @@
+// Module:  Log4CPLUS
+// File:    failoverappender.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <log4cplus/config.hxx>
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+
+#include <log4cplus/failoverappender.h>
+#include <log4cplus/streams.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/spi/factory.h>
+
+#include <cstdlib>
+#include <sstream>
+
+
+namespace log4cplus
+{
+
+
+namespace
+{
+
+static tchar const * const health_names[] = {
+    LOG4CPLUS_TEXT ("HEALTHY"),
+    LOG4CPLUS_TEXT ("DEGRADED"),
+    LOG4CPLUS_TEXT ("FAILED")
+};
+
+
+static
+unsigned long
+get_ulong_property (helpers::Properties const & properties,
+    tchar const * key, unsigned long def)
+{
+    if (! properties.exists (key))
+        return def;
+
+    tstring tmp = properties.getProperty (key);
+    return static_cast<unsigned long>(
+        std::atol (LOG4CPLUS_TSTRING_TO_STRING (tmp).c_str ()));
+}
+
+
+static
+SharedAppenderPtr
+create_appender (helpers::Properties const & properties, tchar const * key)
+{
+    if (! properties.exists (key))
+        return SharedAppenderPtr ();
+
+    tstring const appender_name (properties.getProperty (key));
+    spi::AppenderFactory * factory
+        = spi::getAppenderFactoryRegistry ().get (appender_name);
+    if (! factory)
+    {
+        helpers::getLogLog ().error (
+            LOG4CPLUS_TEXT ("FailoverAppender::FailoverAppender()")
+            LOG4CPLUS_TEXT ("- Cannot find AppenderFactory: ")
+            + appender_name);
+        return SharedAppenderPtr ();
+    }
+
+    helpers::Properties appender_props
+        = properties.getPropertySubset (tstring (key) + LOG4CPLUS_TEXT ("."));
+    return factory->createObject (appender_props);
+}
+
+
+static
+helpers::Time
+from_millis (unsigned long millis)
+{
+    return helpers::Time (static_cast<long>(millis / 1000),
+        static_cast<long>(millis % 1000) * 1000);
+}
+
+
+static
+unsigned long
+to_millis (helpers::Time const & t)
+{
+    return t.sec () < 0 ? 0
+        : static_cast<unsigned long>(t.sec () * 1000 + t.usec () / 1000);
+}
+
+} // namespace
+
+
+//////////////////////////////////////////////////////////////////////////////
+// FailoverAppender::ErrorRecorder
+//////////////////////////////////////////////////////////////////////////////
+
+//! Passes the errors the primary appender reports to the writer
+//! thread, which charges them to the append in progress.
+class FailoverAppender::ErrorRecorder
+    : public ErrorHandler
+{
+public:
+    ErrorRecorder (WriterThread & writer_)
+        : writer (writer_)
+    { }
+
+    virtual void error (tstring const & err)
+    {
+        writer.recordError ();
+        inner.error (err);
+    }
+
+    virtual void reset ()
+    {
+        inner.reset ();
+    }
+
+private:
+    WriterThread & writer;
+    OnlyOnceErrorHandler inner;
+};
+
+
+//////////////////////////////////////////////////////////////////////////////
+// FailoverAppender::WriterThread
+//////////////////////////////////////////////////////////////////////////////
+
+FailoverAppender::WriterThread::WriterThread (
+    SharedAppenderPtr const & primary_)
+    : primary (primary_)
+    , submitted (0)
+    , completed (0)
+    , failed (0)
+    , exit_flag (false)
+    , recorder (new ErrorRecorder (*this))
+{
+    primary->setErrorHandler (std::auto_ptr<ErrorHandler> (recorder));
+}
+
+
+FailoverAppender::WriterThread::~WriterThread ()
+{
+    // The primary may be shared and outlive this thread.
+    if (primary->getErrorHandler () == recorder)
+        primary->setErrorHandler (
+            std::auto_ptr<ErrorHandler> (new OnlyOnceErrorHandler));
+}
+
+
+void
+FailoverAppender::WriterThread::run ()
+{
+    std::vector<spi::InternalLoggingEvent> event;
+    while (true)
+    {
+        {
+            thread::MutexGuard guard (mutex);
+            while (pending.empty () && ! exit_flag)
+            {
+                work_ev.reset ();
+                guard.unlock ();
+                work_ev.wait ();
+                guard.lock ();
+            }
+            if (pending.empty ())
+                return;
+
+            event.swap (pending);
+        }
+
+        primary->doAppend (event.front ());
+        event.clear ();
+
+        thread::MutexGuard guard (mutex);
+        ++completed;
+        done_ev.signal ();
+    }
+}
+
+
+bool
+FailoverAppender::WriterThread::submit (
+    spi::InternalLoggingEvent const & event, unsigned long & ticket)
+{
+    thread::MutexGuard guard (mutex);
+    if (submitted != completed || exit_flag)
+        return false;
+
+    pending.push_back (event);
+    ticket = ++submitted;
+    work_ev.signal ();
+    return true;
+}
+
+
+bool
+FailoverAppender::WriterThread::wait (unsigned long ticket,
+    unsigned long timeout)
+{
+    helpers::Time const deadline
+        = helpers::Time::gettimeofday () + from_millis (timeout);
+
+    thread::MutexGuard guard (mutex);
+    while (completed < ticket)
+    {
+        helpers::Time const now = helpers::Time::gettimeofday ();
+        if (deadline <= now)
+            return false;
+
+        done_ev.reset ();
+        guard.unlock ();
+        done_ev.timed_wait (to_millis (deadline - now) + 1);
+        guard.lock ();
+    }
+    return true;
+}
+
+
+bool
+FailoverAppender::WriterThread::isBusy () const
+{
+    thread::MutexGuard guard (mutex);
+    return submitted != completed;
+}
+
+
+bool
+FailoverAppender::WriterThread::isCompleted (unsigned long ticket) const
+{
+    thread::MutexGuard guard (mutex);
+    return completed >= ticket;
+}
+
+
+bool
+FailoverAppender::WriterThread::hasFailed (unsigned long ticket) const
+{
+    thread::MutexGuard guard (mutex);
+    return failed == ticket;
+}
+
+
+void
+FailoverAppender::WriterThread::recordError ()
+{
+    // Errors outside of an append, e.g. from flush(), are not charged.
+    thread::MutexGuard guard (mutex);
+    if (submitted != completed)
+        failed = completed + 1;
+}
+
+
+bool
+FailoverAppender::WriterThread::stop (unsigned long timeout)
+{
+    unsigned long ticket;
+    {
+        thread::MutexGuard guard (mutex);
+        exit_flag = true;
+        work_ev.signal ();
+        ticket = submitted;
+    }
+
+    if (! wait (ticket, timeout))
+        return false;
+
+    join ();
+    return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// FailoverAppender ctors and dtor
+//////////////////////////////////////////////////////////////////////////////
+
+FailoverAppender::FailoverAppender (SharedAppenderPtr const & primary,
+    SharedAppenderPtr const & fallback_, unsigned long timeout_)
+    : fallback (fallback_)
+    , timeout (timeout_)
+    , probeInterval (5000)
+    , failureThreshold (3)
+    , health (HEALTHY)
+    , failures (0)
+    , probeTicket (0)
+    , divertedCount (0)
+    , droppedCount (0)
+{
+    init (primary);
+}
+
+
+FailoverAppender::FailoverAppender (helpers::Properties const & properties)
+    : Appender (properties)
+    , timeout (1000)
+    , probeInterval (5000)
+    , failureThreshold (3)
+    , health (HEALTHY)
+    , failures (0)
+    , probeTicket (0)
+    , divertedCount (0)
+    , droppedCount (0)
+{
+    fallback = create_appender (properties, LOG4CPLUS_TEXT ("Fallback"));
+    timeout = get_ulong_property (properties, LOG4CPLUS_TEXT ("Timeout"),
+        timeout);
+    probeInterval = get_ulong_property (properties,
+        LOG4CPLUS_TEXT ("ProbeInterval"), probeInterval);
+    setFailureThreshold (static_cast<unsigned>(get_ulong_property (
+        properties, LOG4CPLUS_TEXT ("FailureThreshold"), failureThreshold)));
+
+    init (create_appender (properties, LOG4CPLUS_TEXT ("Appender")));
+}
+
+
+FailoverAppender::~FailoverAppender ()
+{
+    destructorImpl ();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// FailoverAppender public methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+FailoverAppender::close ()
+{
+    if (closed)
+        return;
+    closed = true;
+
+    if (writer.get ())
+    {
+        if (writer->stop (timeout))
+            writer->primary->close ();
+        else
+            helpers::getLogLog ().warn (
+                LOG4CPLUS_TEXT ("FailoverAppender::close()- primary appender")
+                LOG4CPLUS_TEXT (" is hung, leaving it to the writer thread"));
+    }
+
+    if (fallback.get ())
+        fallback->close ();
+
+    if (divertedCount != 0 || droppedCount != 0)
+    {
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("FailoverAppender::close()- diverted ")
+            << divertedCount << LOG4CPLUS_TEXT (" and dropped ")
+            << droppedCount << LOG4CPLUS_TEXT (" events");
+        helpers::getLogLog ().debug (oss.str ());
+    }
+}
+
+
+void
+FailoverAppender::flush ()
+{
+    if (writer.get () && getHealth () != FAILED && ! writer->isBusy ())
+        writer->primary->flush ();
+
+    if (fallback.get ())
+        fallback->flush ();
+}
+
+
+FailoverAppender::Health
+FailoverAppender::getHealth () const
+{
+    thread::MutexGuard guard (state_mutex);
+    return health;
+}
+
+
+unsigned long
+FailoverAppender::getDivertedCount () const
+{
+    thread::MutexGuard guard (state_mutex);
+    return divertedCount;
+}
+
+
+unsigned long
+FailoverAppender::getDroppedCount () const
+{
+    thread::MutexGuard guard (state_mutex);
+    return droppedCount;
+}
+
+
+void
+FailoverAppender::atforkChild ()
+{
+    state_mutex.reinitialize ();
+    if (fallback.get ())
+        fallback->atforkChild ();
+
+    Appender::atforkChild ();
+    if (! writer.get ())
+        return;
+
+    SharedAppenderPtr const primary = writer->primary;
+    primary->atforkChild ();
+
+    // The writer thread of the parent does not exist here.  Its object
+    // is released without joining it, along with its probe.
+    probeTicket = 0;
+    probeEvent.clear ();
+    writer = helpers::SharedObjectPtr<WriterThread> (
+        new WriterThread (primary));
+    if (! closed)
+        writer->start ();
+}
+
+
+void
+FailoverAppender::setProbeInterval (unsigned long interval)
+{
+    thread::MutexGuard guard (state_mutex);
+    probeInterval = interval;
+}
+
+
+void
+FailoverAppender::setFailureThreshold (unsigned limit)
+{
+    thread::MutexGuard guard (state_mutex);
+    failureThreshold = limit != 0 ? limit : 1;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// FailoverAppender protected methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+FailoverAppender::init (SharedAppenderPtr const & primary)
+{
+    if (! primary.get ())
+    {
+        helpers::getLogLog ().error (
+            LOG4CPLUS_TEXT ("FailoverAppender::init()- no primary appender"));
+        health = FAILED;
+        return;
+    }
+
+    writer = helpers::SharedObjectPtr<WriterThread> (
+        new WriterThread (primary));
+    writer->start ();
+}
+
+
+void
+FailoverAppender::setHealth (Health state, tstring const & reason)
+{
+    if (state == FAILED)
+        probeTime = helpers::Time::gettimeofday () + from_millis (probeInterval);
+    if (state == health)
+        return;
+
+    tstring const message = LOG4CPLUS_TEXT ("FailoverAppender [") + name
+        + LOG4CPLUS_TEXT ("]: primary appender ") + health_names[state]
+        + LOG4CPLUS_TEXT (", ") + reason;
+    if (state == HEALTHY)
+        helpers::getLogLog ().debug (message);
+    else
+        helpers::getLogLog ().warn (message);
+    health = state;
+}
+
+
+void
+FailoverAppender::divert (spi::InternalLoggingEvent const & event)
+{
+    {
+        thread::MutexGuard guard (state_mutex);
+        if (fallback.get ())
+            ++divertedCount;
+        else
+            ++droppedCount;
+    }
+
+    if (fallback.get ())
+        fallback->doAppend (event);
+}
+
+
+//! Picks up the outcome of a finished probe.  A failed probe event is
+//! moved to <code>failed</code>.  Called with state_mutex held.
+void
+FailoverAppender::checkProbe (std::vector<spi::InternalLoggingEvent> & failed)
+{
+    if (probeTicket == 0 || ! writer->isCompleted (probeTicket))
+        return;
+
+    if (writer->hasFailed (probeTicket))
+    {
+        setHealth (FAILED, LOG4CPLUS_TEXT ("a probe failed"));
+        failed.swap (probeEvent);
+    }
+    else
+    {
+        failures = 0;
+        setHealth (HEALTHY, LOG4CPLUS_TEXT ("a probe succeeded"));
+    }
+    probeEvent.clear ();
+    probeTicket = 0;
+}
+
+
+// This method does not need to be locked since it is called by
+// doAppend() which performs the locking
+void
+FailoverAppender::append (spi::InternalLoggingEvent const & event)
+{
+    if (! writer.get ())
+    {
+        divert (event);
+        return;
+    }
+
+    helpers::Time const start = helpers::Time::gettimeofday ();
+    std::vector<spi::InternalLoggingEvent> failedProbe;
+    bool skip;
+    bool probing = false;
+    {
+        thread::MutexGuard guard (state_mutex);
+        checkProbe (failedProbe);
+
+        // A failed primary is left alone until the next probe.  The
+        // probe is appended in the background, without waiting for it.
+        skip = health == FAILED;
+        if (skip && probeTicket == 0 && ! (start < probeTime))
+        {
+            unsigned long ticket = 0;
+            if (writer->submit (event, ticket))
+            {
+                probeTicket = ticket;
+                probeEvent.assign (1, event);
+                probing = true;
+            }
+            else
+                setHealth (FAILED,
+                    LOG4CPLUS_TEXT ("an append is still blocked"));
+        }
+    }
+    if (! failedProbe.empty ())
+        divert (failedProbe.front ());
+    if (probing)
+        return;
+
+    unsigned long ticket = 0;
+    if (! skip && ! writer->submit (event, ticket))
+    {
+        // The writer thread is still stuck in an earlier append.
+        thread::MutexGuard guard (state_mutex);
+        setHealth (FAILED, LOG4CPLUS_TEXT ("an append is still blocked"));
+        skip = true;
+    }
+
+    if (! skip)
+    {
+        // The watchdog: the logging thread waits for the primary only
+        // as long as the time budget allows.
+        bool const finished = writer->wait (ticket, timeout);
+        unsigned long const elapsed
+            = to_millis (helpers::Time::gettimeofday () - start);
+
+        thread::MutexGuard guard (state_mutex);
+        if (! finished)
+        {
+            failures = failureThreshold;
+            setHealth (FAILED,
+                LOG4CPLUS_TEXT ("an append exceeded the time budget"));
+            skip = true;
+        }
+        else if (writer->hasFailed (ticket))
+        {
+            ++failures;
+            setHealth (failures >= failureThreshold ? FAILED : DEGRADED,
+                LOG4CPLUS_TEXT ("an append failed"));
+            skip = true;
+        }
+        else
+        {
+            failures = 0;
+            if (elapsed > timeout / 2)
+                setHealth (DEGRADED, LOG4CPLUS_TEXT ("an append was slow"));
+            else
+                setHealth (HEALTHY, LOG4CPLUS_TEXT ("appends succeed"));
+        }
+    }
+
+    if (skip)
+        divert (event);
+}
+
+
+} // namespace log4cplus
+
+#endif // LOG4CPLUS_SINGLE_THREADED
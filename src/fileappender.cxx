@@ -25,6 +25,7 @@
 #include <log4cplus/helpers/stringhelper.h>
 #include <log4cplus/helpers/timehelper.h>
 #include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/internal/internal.h>
 #include <sstream>
 #include <algorithm>
 #include <cstdio>
@@ -163,9 +164,33 @@ loglog_opening_result (helpers::LogLog & loglog,
 }
 
 
+//! Renames the sidecar file of <code>src</code>, named with
+//! <code>suffix</code>, to that of <code>target</code>.
 static
 void
-rolloverFiles(const tstring& filename, unsigned int maxBackupIndex)
+rename_sidecar (helpers::LogLog & loglog, tstring const & src,
+    tstring const & target, tstring const & suffix)
+{
+    if (suffix.empty ())
+        return;
+
+    tstring const sidecarSrc (src + suffix);
+    tstring const sidecarTarget (target + suffix);
+    long ret;
+
+#if defined (WIN32)
+    ret = file_remove (sidecarTarget);
+#endif
+
+    ret = file_rename (sidecarSrc, sidecarTarget);
+    loglog_renaming_result (loglog, sidecarSrc, sidecarTarget, ret);
+}
+
+
+static
+void
+rolloverFiles(const tstring& filename, unsigned int maxBackupIndex,
+    tstring const & sidecarSuffix = tstring ())
 {
     log4cplus::helpers::SharedObjectPtr<helpers::LogLog> loglog = helpers::LogLog::getLogLog();
 
@@ -173,6 +198,8 @@ rolloverFiles(const tstring& filename, unsigned int maxBackupIndex)
     tostringstream buffer;
     buffer << filename << LOG4CPLUS_TEXT(".") << maxBackupIndex;
     long ret = file_remove (buffer.str ());
+    if (! sidecarSuffix.empty ())
+        ret = file_remove (buffer.str () + sidecarSuffix);
 
     tostringstream source_oss;
     tostringstream target_oss;
@@ -197,12 +224,51 @@ rolloverFiles(const tstring& filename, unsigned int maxBackupIndex)
 
         ret = file_rename (source, target);
         loglog_renaming_result (*loglog, source, target, ret);
+        rename_sidecar (*loglog, source, target, sidecarSuffix);
     }
 } // end rolloverFiles()
 
 }
 
 
+void
+internal::roll_file (tstring const & filename, unsigned maxBackupIndex,
+    tstring const & sidecarSuffix)
+{
+    helpers::LogLog & loglog = helpers::getLogLog();
+
+    // If maxBackups <= 0, then there is no file renaming to be done.
+    if (maxBackupIndex > 0)
+    {
+        rolloverFiles(filename, maxBackupIndex, sidecarSuffix);
+
+        // Rename fileName to fileName.1
+        tstring target = filename + LOG4CPLUS_TEXT(".1");
+
+        long ret;
+
+#if defined (WIN32)
+        // Try to remove the target first. It seems it is not
+        // possible to rename over existing file.
+        ret = file_remove (target);
+#endif
+
+        loglog.debug (
+            LOG4CPLUS_TEXT("Renaming file ") 
+            + filename 
+            + LOG4CPLUS_TEXT(" to ")
+            + target);
+        ret = file_rename (filename, target);
+        loglog_renaming_result (loglog, filename, target, ret);
+        rename_sidecar (loglog, filename, target, sidecarSuffix);
+    }
+    else
+    {
+        loglog.debug (filename + LOG4CPLUS_TEXT(" has no backups specified"));
+    }
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // FileAppender ctors and dtor
 ///////////////////////////////////////////////////////////////////////////////
@@ -213,6 +279,7 @@ FileAppender::FileAppender(const tstring& filename_,
     , reopenDelay(1)
     , bufferSize (0)
     , buffer (0)
+    , indexing (false)
 {
     init(filename_, mode);
 }
@@ -225,6 +292,7 @@ FileAppender::FileAppender(const Properties& properties,
     , reopenDelay(1)
     , bufferSize (0)
     , buffer (0)
+    , indexing (false)
 {
     bool append_ = (mode == std::ios::app);
     tstring filename_ = properties.getProperty( LOG4CPLUS_TEXT("File") );
@@ -249,6 +317,51 @@ FileAppender::FileAppender(const Properties& properties,
         tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("BufferSize") );
         bufferSize = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
     }
+    if(properties.exists( LOG4CPLUS_TEXT("Encoding") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("Encoding") );
+        if (helpers::toUpper(tmp) == LOG4CPLUS_TEXT("UTF-8"))
+            out.imbue(helpers::getUTF8Locale(out.getloc()));
+        else
+            getLogLog().warn(LOG4CPLUS_TEXT("Unknown Encoding: ") + tmp);
+    }
+    tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("Index") );
+    if(helpers::toLower(tmp) == LOG4CPLUS_TEXT("true")) {
+        unsigned long interval = 64 * 1024;
+        unsigned long bloomBits = 256 * 1024;
+        if(properties.exists( LOG4CPLUS_TEXT("IndexInterval") )) {
+            tmp = helpers::toUpper(
+                properties.getProperty( LOG4CPLUS_TEXT("IndexInterval") ));
+            interval = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+            if(tmp.find( LOG4CPLUS_TEXT("MB") ) == (tmp.length() - 2)) {
+                interval *= (1024 * 1024); // convert to megabytes
+            }
+            if(tmp.find( LOG4CPLUS_TEXT("KB") ) == (tmp.length() - 2)) {
+                interval *= 1024; // convert to kilobytes
+            }
+        }
+        if(properties.exists( LOG4CPLUS_TEXT("IndexBloomBits") )) {
+            tmp = properties.getProperty( LOG4CPLUS_TEXT("IndexBloomBits") );
+            bloomBits = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+        }
+        index.reset(new FileIndex(interval, bloomBits));
+    }
+    tmp = properties.getProperty( LOG4CPLUS_TEXT("ShipTo") );
+    if(! tmp.empty()) {
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+        tstring host = tmp;
+        int port = 9998;
+        tstring::size_type const colon = tmp.rfind(LOG4CPLUS_TEXT(':'));
+        if(colon != tstring::npos) {
+            host = tmp.substr(0, colon);
+            tstring const portStr = tmp.substr(colon + 1);
+            port = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(portStr).c_str());
+        }
+        shipper.reset(new FileShipper(host, static_cast<unsigned short>(port),
+            filename_, properties.getProperty( LOG4CPLUS_TEXT("ShipSource") )));
+#else
+        getLogLog().warn(LOG4CPLUS_TEXT("ShipTo needs a multi threaded build"));
+#endif
+    }
 
     init(filename_, (append_ ? std::ios::app : std::ios::trunc));
 }
@@ -276,6 +389,10 @@ FileAppender::init(const tstring& filename_,
         return;
     }
     getLogLog().debug(LOG4CPLUS_TEXT("Just opened file: ") + filename);
+
+    if(index.get()) {
+        loadIndex(mode);
+    }
 }
 
 
@@ -296,13 +413,29 @@ FileAppender::close()
 {
     log4cplus::thread::MutexGuard guard (access_mutex);
 
+    saveIndex();
     out.close();
     delete[] buffer;
     buffer = 0;
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    if (shipper.get())
+        shipper->close();
+#endif
     closed = true;
 }
 
 
+void
+FileAppender::flush()
+{
+    log4cplus::thread::MutexGuard guard (access_mutex);
+
+    if (out.is_open ())
+        out.flush();
+    saveIndex();
+}
+
+
 std::locale
 FileAppender::imbue(std::locale const& loc)
 {
@@ -317,6 +450,18 @@ FileAppender::getloc () const
 }
 
 
+void
+FileAppender::atforkChild()
+{
+    Appender::atforkChild();
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    if (shipper.get())
+        shipper->atforkChild();
+#endif
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // FileAppender protected methods
 ///////////////////////////////////////////////////////////////////////////////
@@ -338,6 +483,13 @@ FileAppender::append(const spi::InternalLoggingEvent& event)
             getErrorHandler()->reset();
     }
 
+    if(indexing) {
+        std::streamoff const offset = out.tellp();
+        if(offset >= 0) {
+            index->addEvent(event, static_cast<unsigned long>(offset));
+        }
+    }
+
     layout->formatAndAppend(out, event);
     if(immediateFlush) {
         out.flush();
@@ -383,6 +535,87 @@ FileAppender::reopen()
     return false;
 }
 
+
+void
+FileAppender::loadIndex(LOG4CPLUS_OPEN_MODE_TYPE mode)
+{
+    indexing = true;
+    index->clear();
+    if(! (mode & std::ios::app)) {
+        return;
+    }
+
+    out.seekp(0, std::ios::end);
+    std::streamoff const size = out.tellp();
+    if(size <= 0) {
+        return;
+    }
+
+    // The index of a file opened for appending has to cover it up to
+    // its current end, otherwise it would make searches skip events.
+    if(! index->read(filename + FileIndex::SUFFIX)
+       || index->getEndOffset() != static_cast<unsigned long>(size))
+    {
+        getLogLog().warn(LOG4CPLUS_TEXT("No usable index for ")
+            + filename + LOG4CPLUS_TEXT("; it will not be indexed"));
+        file_remove(filename + FileIndex::SUFFIX);
+        index->clear();
+        indexing = false;
+    }
+}
+
+
+void
+FileAppender::saveIndex()
+{
+    if(! indexing || index->empty()) {
+        return;
+    }
+
+    if(out.is_open()) {
+        std::streamoff const size = out.tellp();
+        if(size >= 0) {
+            index->setEndOffset(static_cast<unsigned long>(size));
+        }
+    }
+
+    tstring const indexFilename = filename + FileIndex::SUFFIX;
+    if(! index->write(indexFilename)) {
+        getLogLog().error(LOG4CPLUS_TEXT("Unable to write index file: ")
+            + indexFilename);
+    }
+}
+
+
+void
+FileAppender::resetIndex()
+{
+    if(index.get()) {
+        index->clear();
+        indexing = true;
+    }
+}
+
+
+tstring
+FileAppender::getIndexSuffix() const
+{
+    return index.get() ? tstring(FileIndex::SUFFIX) : tstring();
+}
+
+
+void
+FileAppender::shipFile(const tstring& completed)
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    if(shipper.get()) {
+        shipper->ship(completed);
+    }
+#else
+    (void) completed;
+#endif
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // RollingFileAppender ctors and dtor
 ///////////////////////////////////////////////////////////////////////////////
@@ -468,42 +701,18 @@ RollingFileAppender::rollover()
     helpers::LogLog & loglog = getLogLog();
 
     // Close the current file
+    saveIndex();
     out.close();
     out.clear(); // reset flags since the C++ standard specified that all the
                  // flags should remain unchanged on a close
 
-    // If maxBackups <= 0, then there is no file renaming to be done.
-    if (maxBackupIndex > 0)
-    {
-        rolloverFiles(filename, maxBackupIndex);
-
-        // Rename fileName to fileName.1
-        tstring target = filename + LOG4CPLUS_TEXT(".1");
-
-        long ret;
-
-#if defined (WIN32)
-        // Try to remove the target first. It seems it is not
-        // possible to rename over existing file.
-        ret = file_remove (target);
-#endif
-
-        loglog.debug (
-            LOG4CPLUS_TEXT("Renaming file ") 
-            + filename 
-            + LOG4CPLUS_TEXT(" to ")
-            + target);
-        ret = file_rename (filename, target);
-        loglog_renaming_result (loglog, filename, target, ret);
-    }
-    else
-    {
-        loglog.debug (filename + LOG4CPLUS_TEXT(" has no backups specified"));
-    }
+    internal::roll_file (filename, maxBackupIndex, getIndexSuffix());
+    shipFile(filename + LOG4CPLUS_TEXT(".1"));
 
     // Open it up again in truncation mode
     open(std::ios::out | std::ios::trunc);
     loglog_opening_result (loglog, out, filename);
+    resetIndex();
 }
 
 
@@ -683,15 +892,18 @@ void
 DailyRollingFileAppender::rollover()
 {
     // Close the current file
+    saveIndex();
     out.close();
     out.clear(); // reset flags since the C++ standard specified that all the
                  // flags should remain unchanged on a close
 
+    tstring const sidecarSuffix = getIndexSuffix();
+
     // If we've already rolled over this time period, we'll make sure that we
     // don't overwrite any of those previous files.
     // E.g. if "log.2009-11-07.1" already exists we rename it
     // to "log.2009-11-07.2", etc.
-    rolloverFiles(scheduledFilename, maxBackupIndex);
+    rolloverFiles(scheduledFilename, maxBackupIndex, sidecarSuffix);
 
     // Do not overwriet the newest file either, e.g. if "log.2009-11-07"
     // already exists rename it to "log.2009-11-07.1"
@@ -711,6 +923,7 @@ DailyRollingFileAppender::rollover()
     // Rename e.g. "log.2009-11-07" to "log.2009-11-07.1".
     ret = file_rename (scheduledFilename, backupTarget);
     loglog_renaming_result (loglog, scheduledFilename, backupTarget, ret);
+    rename_sidecar (loglog, scheduledFilename, backupTarget, sidecarSuffix);
 
 #if defined (WIN32)
     // Try to remove the target first. It seems it is not
@@ -727,10 +940,14 @@ DailyRollingFileAppender::rollover()
         + scheduledFilename);
     ret = file_rename (filename, scheduledFilename);
     loglog_renaming_result (loglog, filename, scheduledFilename, ret);
+    rename_sidecar (loglog, filename, scheduledFilename, sidecarSuffix);
+    if (ret == 0)
+        shipFile(scheduledFilename);
 
     // Open a new file, e.g. "log".
     open(std::ios::out | std::ios::trunc);
     loglog_opening_result (loglog, out, filename);
+    resetIndex();
 
     // Calculate the next rollover time
     log4cplus::helpers::Time now = Time::gettimeofday();
@@ -0,0 +1,420 @@
+// Module:  Log4CPLUS
+// File:    fileindex.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <log4cplus/fileindex.h>
+#include <log4cplus/fstreams.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/internal/segment.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+
+namespace log4cplus
+{
+
+using internal::put_varint;
+using internal::put_svarint;
+using internal::get_varint;
+using internal::get_svarint;
+
+
+namespace
+{
+
+//! File header: "L4CIDX", a zero byte and the format version.
+static char const index_magic[8] = { 'L', '4', 'C', 'I', 'D', 'X', 0, 1 };
+
+//! Number of bits set per token.
+static unsigned const default_hash_count = 4;
+
+//! Upper bound on the filter size accepted from a file, 64 MB.
+static unsigned long const max_bloom_bits = 512ul * 1024 * 1024;
+
+
+//! 32 bit FNV-1a of the UTF-8 bytes of <code>token</code>.
+static
+void
+hash_token (tstring const & token, unsigned long & h1, unsigned long & h2)
+{
+#if defined (UNICODE)
+    std::string const bytes (LOG4CPLUS_TSTRING_TO_UTF8 (token));
+#else
+    std::string const & bytes = token;
+#endif
+
+    unsigned long h = 2166136261ul;
+    for (std::string::const_iterator it = bytes.begin ();
+         it != bytes.end (); ++it)
+    {
+        h ^= static_cast<unsigned char>(*it);
+        h = (h * 16777619ul) & 0xFFFFFFFFul;
+    }
+    h1 = h;
+
+    // The second hash, for double hashing, is a mix of the first one;
+    // it is odd so that it never degenerates into a single bit.
+    h ^= h >> 16;
+    h = (h * 0x85EBCA6Bul) & 0xFFFFFFFFul;
+    h ^= h >> 13;
+    h = (h * 0xC2B2AE35ul) & 0xFFFFFFFFul;
+    h ^= h >> 16;
+    h2 = h | 1;
+}
+
+
+static
+void
+put_time (std::string & out, helpers::Time const & t)
+{
+    put_svarint (out, t.sec ());
+    put_varint (out, t.nsec ());
+}
+
+
+static
+bool
+get_time (char const * & p, char const * end, helpers::Time & t)
+{
+    long sec;
+    unsigned long nsec;
+    if (! get_svarint (p, end, sec) || ! get_varint (p, end, nsec)
+        || nsec >= 1000000000ul)
+        return false;
+
+    t.sec (sec);
+    t.nsec (static_cast<long>(nsec));
+    return true;
+}
+
+} // namespace
+
+
+tchar const FileIndex::SUFFIX[] = LOG4CPLUS_TEXT(".idx");
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FileIndex ctors
+///////////////////////////////////////////////////////////////////////////////
+
+FileIndex::FileIndex(unsigned long interval_, unsigned long bloomBits_)
+: interval(interval_),
+  bloomBits(bloomBits_ == 0 ? 0
+      : (bloomBits_ < 8 ? 8 : (bloomBits_ + 7) / 8 * 8)),
+  hashCount(default_hash_count),
+  bloom(bloomBits / 8),
+  endOffset(0),
+  eventCount(0)
+{
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FileIndex public methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+FileIndex::clear()
+{
+    std::fill(bloom.begin(), bloom.end(), 0);
+    checkpoints.clear();
+    firstTime = lastTime = helpers::Time();
+    endOffset = 0;
+    eventCount = 0;
+}
+
+
+bool
+FileIndex::empty() const
+{
+    return eventCount == 0;
+}
+
+
+bool
+FileIndex::addEvent(const spi::InternalLoggingEvent& event,
+    unsigned long offset)
+{
+    // Words of the NDC.
+    tstring const & ndc = event.getNDC();
+    tstring::size_type pos = 0;
+    for(;;) {
+        pos = ndc.find_first_not_of(LOG4CPLUS_TEXT(" \t"), pos);
+        if(pos == tstring::npos) {
+            break;
+        }
+        tstring::size_type const end
+            = ndc.find_first_of(LOG4CPLUS_TEXT(" \t"), pos);
+        addToken(ndc.substr(pos, end - pos));
+        pos = end;
+    }
+
+    // Values of the typed fields.
+    spi::EventFields const & fields = event.getFields();
+    for(spi::EventFields::const_iterator it = fields.begin();
+        it != fields.end(); ++it)
+    {
+        if(it->getType() == spi::EventField::STRING_FIELD) {
+            addToken(it->getString());
+        }
+        else {
+            tstring value;
+            it->appendValue(value);
+            addToken(value);
+        }
+    }
+
+    return addTime(event.getTimestamp(), offset);
+}
+
+
+bool
+FileIndex::addTime(const helpers::Time& t, unsigned long offset)
+{
+    if(eventCount == 0 || t < firstTime) {
+        firstTime = t;
+    }
+    if(eventCount == 0 || lastTime < t) {
+        lastTime = t;
+    }
+    ++eventCount;
+    if(endOffset < offset) {
+        endOffset = offset;
+    }
+
+    if(! checkpoints.empty()
+       && offset < checkpoints.back().offset + interval)
+    {
+        return false;
+    }
+
+    Checkpoint const cp = { t, offset };
+    checkpoints.push_back(cp);
+    return true;
+}
+
+
+void
+FileIndex::addToken(const tstring& token)
+{
+    if(bloomBits == 0) {
+        return;
+    }
+
+    unsigned long h1, h2;
+    hash_token(token, h1, h2);
+    for(unsigned i = 0; i != hashCount; ++i) {
+        setBit(((h1 + i * h2) & 0xFFFFFFFFul) % bloomBits);
+    }
+}
+
+
+void
+FileIndex::setEndOffset(unsigned long offset)
+{
+    endOffset = offset;
+}
+
+
+bool
+FileIndex::write(const tstring& filename) const
+{
+    std::string buf (index_magic, sizeof(index_magic));
+    put_varint(buf, interval);
+    put_varint(buf, hashCount);
+    put_varint(buf, bloomBits);
+    buf.append(bloom.begin(), bloom.end());
+    put_varint(buf, eventCount);
+    put_varint(buf, endOffset);
+    put_time(buf, firstTime);
+    put_time(buf, lastTime);
+
+    // Checkpoints are stored as deltas to the preceding one.
+    put_varint(buf, checkpoints.size());
+    helpers::Time prevTime = firstTime;
+    unsigned long prevOffset = 0;
+    for(CheckpointList::const_iterator it = checkpoints.begin();
+        it != checkpoints.end(); ++it)
+    {
+        put_svarint(buf, it->time.sec() - prevTime.sec());
+        put_varint(buf, it->time.nsec());
+        put_varint(buf, it->offset - prevOffset);
+        prevTime = it->time;
+        prevOffset = it->offset;
+    }
+
+    std::ofstream out(LOG4CPLUS_FSTREAM_PREFERED_FILE_NAME(filename).c_str(),
+        std::ios::out | std::ios::trunc | std::ios::binary);
+    out.write(buf.data(), buf.size());
+    out.close();
+    return ! out.fail();
+}
+
+
+bool
+FileIndex::read(const tstring& filename)
+{
+    clear();
+
+    std::ifstream in(LOG4CPLUS_FSTREAM_PREFERED_FILE_NAME(filename).c_str(),
+        std::ios::in | std::ios::binary);
+    if(! in) {
+        return false;
+    }
+    std::string const buf((std::istreambuf_iterator<char>(in)),
+        std::istreambuf_iterator<char>());
+
+    char const * p = buf.data();
+    char const * const end = p + buf.size();
+    if(buf.size() < sizeof(index_magic)
+       || buf.compare(0, sizeof(index_magic), index_magic,
+              sizeof(index_magic)) != 0)
+    {
+        return false;
+    }
+    p += sizeof(index_magic);
+
+    unsigned long interval_, hashCount_, bloomBits_, eventCount_,
+        endOffset_, count;
+    helpers::Time firstTime_, lastTime_;
+    if(! get_varint(p, end, interval_)
+       || ! get_varint(p, end, hashCount_)
+       || ! get_varint(p, end, bloomBits_)
+       || hashCount_ == 0 || hashCount_ > 32
+       || bloomBits_ % 8 != 0
+       || bloomBits_ > max_bloom_bits
+       || static_cast<unsigned long>(end - p) < bloomBits_ / 8)
+    {
+        return false;
+    }
+    std::vector<unsigned char> bloom_(p, p + bloomBits_ / 8);
+    p += bloomBits_ / 8;
+
+    if(! get_varint(p, end, eventCount_)
+       || ! get_varint(p, end, endOffset_)
+       || ! get_time(p, end, firstTime_)
+       || ! get_time(p, end, lastTime_)
+       || ! get_varint(p, end, count)
+       || count > static_cast<unsigned long>(end - p))
+    {
+        return false;
+    }
+
+    CheckpointList checkpoints_;
+    checkpoints_.reserve(count);
+    helpers::Time prevTime = firstTime_;
+    unsigned long prevOffset = 0;
+    for(unsigned long i = 0; i != count; ++i) {
+        long secDelta;
+        unsigned long nsec, offsetDelta;
+        if(! get_svarint(p, end, secDelta) || ! get_varint(p, end, nsec)
+           || nsec >= 1000000000ul || ! get_varint(p, end, offsetDelta))
+        {
+            return false;
+        }
+        Checkpoint cp;
+        cp.time.sec(prevTime.sec() + secDelta);
+        cp.time.nsec(static_cast<long>(nsec));
+        cp.offset = prevOffset + offsetDelta;
+        checkpoints_.push_back(cp);
+        prevTime = cp.time;
+        prevOffset = cp.offset;
+    }
+
+    interval = interval_;
+    hashCount = static_cast<unsigned>(hashCount_);
+    bloomBits = bloomBits_;
+    bloom.swap(bloom_);
+    eventCount = eventCount_;
+    endOffset = endOffset_;
+    firstTime = firstTime_;
+    lastTime = lastTime_;
+    checkpoints.swap(checkpoints_);
+    return true;
+}
+
+
+bool
+FileIndex::mightContain(const tstring& token) const
+{
+    // Without a filter nothing can be ruled out.
+    if(bloomBits == 0) {
+        return true;
+    }
+
+    unsigned long h1, h2;
+    hash_token(token, h1, h2);
+    for(unsigned i = 0; i != hashCount; ++i) {
+        if(! testBit(((h1 + i * h2) & 0xFFFFFFFFul) % bloomBits)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+unsigned long
+FileIndex::findStartOffset(const helpers::Time& time) const
+{
+    unsigned long offset = 0;
+    for(CheckpointList::const_iterator it = checkpoints.begin();
+        it != checkpoints.end() && ! (time < it->time); ++it)
+    {
+        offset = it->offset;
+    }
+    return offset;
+}
+
+
+unsigned long
+FileIndex::findEndOffset(const helpers::Time& time) const
+{
+    for(CheckpointList::const_iterator it = checkpoints.begin();
+        it != checkpoints.end(); ++it)
+    {
+        if(time < it->time) {
+            return it->offset;
+        }
+    }
+    return endOffset;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FileIndex protected methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+FileIndex::setBit(unsigned long bit)
+{
+    bloom[bit / 8] |= static_cast<unsigned char>(1u << (bit % 8));
+}
+
+
+bool
+FileIndex::testBit(unsigned long bit) const
+{
+    return (bloom[bit / 8] & (1u << (bit % 8))) != 0;
+}
+
+
+} // namespace log4cplus
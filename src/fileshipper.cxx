@@ -0,0 +1,855 @@
+// Module:  Log4CPLUS
+// File:    fileshipper.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <log4cplus/fileshipper.h>
+#include <log4cplus/socketappender.h>
+#include <log4cplus/streams.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/socketbuffer.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/helpers/timehelper.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+#if defined (LOG4CPLUS_HAVE_UNISTD_H) && defined (LOG4CPLUS_HAVE_SYS_STAT_H) \
+    && ! defined (_WIN32)
+#  define LOG4CPLUS_HAVE_FILE_SHIPPING
+#  include <dirent.h>
+#  include <fcntl.h>
+#  include <sys/socket.h>
+#  include <sys/stat.h>
+#  include <sys/types.h>
+#  include <unistd.h>
+#  if defined (__linux__)
+#    include <sys/sendfile.h>
+#    define LOG4CPLUS_HAVE_SENDFILE_SPLICE
+#  endif
+#endif
+
+
+namespace log4cplus
+{
+
+
+namespace
+{
+
+//! Version of the file shipping protocol.
+static unsigned char const FILE_SHIPPING_VERSION = 1;
+
+//! Bytes sent at a time, between checks whether the shipper is closed.
+static std::size_t const CHUNK_SIZE = 1024 * 1024;
+
+//! Longest delay between attempts to reach the server.
+static unsigned long const MAX_RETRY_DELAY = 5000;
+
+static tchar const PART_SUFFIX[] = LOG4CPLUS_TEXT (".part");
+
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+static
+tstring::size_type
+base_name_pos (tstring const & path)
+{
+    tstring::size_type const slash = path.rfind (LOG4CPLUS_TEXT ('/'));
+    return slash == tstring::npos ? 0 : slash + 1;
+}
+
+#endif
+
+
+static
+bool
+ends_with (tstring const & str, tstring const & suffix)
+{
+    return str.size () >= suffix.size ()
+        && str.compare (str.size () - suffix.size (), suffix.size (),
+            suffix) == 0;
+}
+
+
+//! A name the receiver accepts is a plain file name.
+static
+bool
+valid_file_name (tstring const & name)
+{
+    return ! name.empty () && name.size () < 256
+        && name[0] != LOG4CPLUS_TEXT ('.')
+        && name.find_first_of (LOG4CPLUS_TEXT ("/\\")) == tstring::npos
+        && ! ends_with (name, PART_SUFFIX);
+}
+
+
+#if defined (LOG4CPLUS_HAVE_FILE_SHIPPING)
+static
+void
+append_file_size (helpers::SocketBuffer & buffer, off_t size)
+{
+    buffer.appendInt (static_cast<unsigned>((size >> 16) >> 16));
+    buffer.appendInt (static_cast<unsigned>(size & 0xFFFFFFFFu));
+}
+
+
+static
+off_t
+read_file_size (helpers::SocketBuffer & buffer)
+{
+    off_t const high = static_cast<off_t>(buffer.readInt ());
+    off_t const low = static_cast<off_t>(buffer.readInt ());
+    return ((high << 16) << 16) | low;
+}
+
+
+static
+bool
+write_all (int sock, char const * data, std::size_t size)
+{
+#if defined (MSG_NOSIGNAL)
+    int const flags = MSG_NOSIGNAL;
+#else
+    int const flags = 0;
+#endif
+
+    while (size != 0)
+    {
+        ssize_t const ret = ::send (sock, data, size, flags);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+
+        data += ret;
+        size -= static_cast<std::size_t>(ret);
+    }
+    return true;
+}
+
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+//! Sends <code>size</code> bytes of the file from <code>offset</code>.
+static
+bool
+send_file_data (int sock, int fd, off_t offset, std::size_t size)
+{
+#if defined (LOG4CPLUS_HAVE_SENDFILE_SPLICE)
+    while (size != 0)
+    {
+        ssize_t const ret = ::sendfile (sock, fd, &offset, size);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+
+        size -= static_cast<std::size_t>(ret);
+    }
+    return true;
+
+#else
+    std::vector<char> buffer ((std::min) (size, std::size_t (64 * 1024)));
+    while (size != 0)
+    {
+        ssize_t const ret = ::pread (fd, &buffer[0],
+            (std::min) (size, buffer.size ()), offset);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0 || ! write_all (sock, &buffer[0],
+                static_cast<std::size_t>(ret)))
+            return false;
+
+        offset += ret;
+        size -= static_cast<std::size_t>(ret);
+    }
+    return true;
+
+#endif
+}
+
+#endif // LOG4CPLUS_SINGLE_THREADED
+
+
+//! Writes <code>size</code> bytes to the file at <code>offset</code>.
+static
+bool
+pwrite_all (int fd, char const * data, std::size_t size, off_t offset)
+{
+    while (size != 0)
+    {
+        ssize_t const ret = ::pwrite (fd, data, size, offset);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+
+        data += ret;
+        offset += ret;
+        size -= static_cast<std::size_t>(ret);
+    }
+    return true;
+}
+
+
+#if defined (LOG4CPLUS_HAVE_SENDFILE_SPLICE)
+//! Moves <code>size</code> bytes left in the pipe to the file at
+//! <code>pos</code>, when the file cannot be spliced to.
+static
+bool
+drain_pipe (int pipefd, int fd, loff_t & pos, std::size_t size)
+{
+    std::vector<char> buffer (size);
+    std::size_t done = 0;
+    while (done != size)
+    {
+        ssize_t const ret = ::read (pipefd, &buffer[done], size - done);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+        done += static_cast<std::size_t>(ret);
+    }
+
+    if (! pwrite_all (fd, &buffer[0], size, pos))
+        return false;
+    pos += static_cast<loff_t>(size);
+    return true;
+}
+
+#endif
+
+
+//! Stores <code>size</code> bytes read from the socket in the file at
+//! <code>offset</code>.
+static
+bool
+receive_file_data (int sock, int fd, off_t offset, off_t size)
+{
+#if defined (LOG4CPLUS_HAVE_SENDFILE_SPLICE)
+    int pipefd[2];
+    if (::pipe (pipefd) == 0)
+    {
+        loff_t pos = offset;
+        bool ok = true;
+        // Set when the socket or the file system does not support
+        // splice(); the rest is copied below.
+        bool copy = false;
+        while (ok && ! copy && size != 0)
+        {
+            ssize_t const in = ::splice (sock, 0, pipefd[1], 0,
+                static_cast<std::size_t>((std::min) (size, off_t (64 * 1024))),
+                SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (in < 0 && errno == EINTR)
+                continue;
+            if (in < 0 && (errno == EINVAL || errno == ENOSYS))
+            {
+                // Nothing was taken from the socket.
+                copy = true;
+                break;
+            }
+            if (in <= 0)
+            {
+                ok = false;
+                break;
+            }
+
+            ssize_t left = in;
+            while (left != 0)
+            {
+                ssize_t const out = ::splice (pipefd[0], 0, fd, &pos,
+                    static_cast<std::size_t>(left), SPLICE_F_MOVE);
+                if (out < 0 && errno == EINTR)
+                    continue;
+                if (out < 0 && (errno == EINVAL || errno == ENOSYS))
+                {
+                    // The data taken from the socket is still in the
+                    // pipe.
+                    ok = drain_pipe (pipefd[0], fd, pos,
+                        static_cast<std::size_t>(left));
+                    copy = true;
+                    break;
+                }
+                if (out <= 0)
+                {
+                    ok = false;
+                    break;
+                }
+                left -= out;
+            }
+            size -= in;
+        }
+
+        ::close (pipefd[0]);
+        ::close (pipefd[1]);
+        if (! ok || ! copy)
+            return ok;
+        offset = static_cast<off_t>(pos);
+    }
+
+#endif
+
+    std::vector<char> buffer (64 * 1024);
+    while (size != 0)
+    {
+        ssize_t const in = ::read (sock, &buffer[0],
+            static_cast<std::size_t>((std::min) (size,
+                static_cast<off_t>(buffer.size ()))));
+        if (in < 0 && errno == EINTR)
+            continue;
+        if (in <= 0 || ! pwrite_all (fd, &buffer[0],
+                static_cast<std::size_t>(in), offset))
+            return false;
+
+        offset += in;
+        size -= in;
+    }
+    return true;
+}
+
+#endif // LOG4CPLUS_HAVE_FILE_SHIPPING
+
+} // namespace
+
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+
+tchar const FileShipper::SPOOL_SUFFIX[] = LOG4CPLUS_TEXT (".ship");
+
+
+//////////////////////////////////////////////////////////////////////////////
+// FileShipper::ShipperThread
+//////////////////////////////////////////////////////////////////////////////
+
+FileShipper::ShipperThread::ShipperThread (FileShipper & shipper_)
+    : shipper (shipper_)
+{ }
+
+
+FileShipper::ShipperThread::~ShipperThread ()
+{ }
+
+
+void
+FileShipper::ShipperThread::run ()
+{
+    shipper.shipFiles ();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// FileShipper ctors and dtor
+//////////////////////////////////////////////////////////////////////////////
+
+FileShipper::FileShipper (tstring const & host_, unsigned short port_,
+    tstring const & filename_, tstring const & source_)
+    : host (host_)
+    , port (port_)
+    , filename (filename_)
+    , source (source_)
+    , shippedCount (0)
+    , exit_flag (false)
+{
+    if (source.empty ())
+        source = helpers::getHostname (false);
+
+#if defined (LOG4CPLUS_HAVE_FILE_SHIPPING)
+    scanSpool ();
+    startShipper ();
+
+#else
+    exit_flag = true;
+    helpers::getLogLog ().error (
+        LOG4CPLUS_TEXT ("FileShipper is not supported on this platform"));
+
+#endif
+}
+
+
+FileShipper::~FileShipper ()
+{
+    close ();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// FileShipper public methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+FileShipper::ship (tstring const & completed)
+{
+#if defined (LOG4CPLUS_HAVE_FILE_SHIPPING)
+    // The link keeps the data, under a name of its own, until it has
+    // been sent, whatever later rollovers do to the rolled file.
+    tstring const stamp = helpers::Time::gettimeofday ().getFormattedTime (
+        LOG4CPLUS_TEXT ("%Y%m%d-%H%M%S.%q"));
+    std::string const target = LOG4CPLUS_TSTRING_TO_STRING (completed);
+    tstring spoolName;
+    for (int attempt = 0; ; ++attempt)
+    {
+        tostringstream oss;
+        oss << filename << LOG4CPLUS_TEXT (".") << stamp;
+        if (attempt != 0)
+            oss << LOG4CPLUS_TEXT ("-") << attempt;
+        oss << SPOOL_SUFFIX;
+        spoolName = oss.str ();
+
+        std::string const link = LOG4CPLUS_TSTRING_TO_STRING (spoolName);
+        if (::link (target.c_str (), link.c_str ()) == 0)
+            break;
+
+        if (errno != EEXIST || attempt == 100)
+        {
+            helpers::getLogLog ().error (
+                LOG4CPLUS_TEXT ("Unable to spool file for shipping: ")
+                + completed);
+            return;
+        }
+    }
+
+    thread::MutexGuard guard (mutex);
+    queue.push_back (spoolName);
+    queue_ev.signal ();
+
+#else
+    helpers::getLogLog ().error (
+        LOG4CPLUS_TEXT ("FileShipper is not supported, not shipping ")
+        + completed);
+
+#endif
+}
+
+
+bool
+FileShipper::waitShipped (unsigned long timeout)
+{
+    helpers::Time const deadline = helpers::Time::gettimeofday ()
+        + helpers::Time (static_cast<long>(timeout / 1000),
+            static_cast<long>(timeout % 1000) * 1000);
+
+    thread::MutexGuard guard (mutex);
+    while (! queue.empty () && ! exit_flag)
+    {
+        helpers::Time const now = helpers::Time::gettimeofday ();
+        if (deadline <= now)
+            break;
+
+        helpers::Time const left = deadline - now;
+        done_ev.reset ();
+        guard.unlock ();
+        done_ev.timed_wait (static_cast<unsigned long>(
+            left.sec () * 1000 + left.usec () / 1000 + 1));
+        guard.lock ();
+    }
+    return queue.empty ();
+}
+
+
+void
+FileShipper::close ()
+{
+    {
+        thread::MutexGuard guard (mutex);
+        if (exit_flag)
+            return;
+
+        exit_flag = true;
+        queue_ev.signal ();
+        done_ev.signal ();
+        exit_ev.signal ();
+    }
+
+    thread->join ();
+
+    thread::MutexGuard guard (mutex);
+    if (! queue.empty ())
+    {
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("FileShipper::close()- ") << queue.size ()
+            << LOG4CPLUS_TEXT (" files left spooled for ") << filename;
+        helpers::getLogLog ().debug (oss.str ());
+    }
+}
+
+
+unsigned long
+FileShipper::getShippedCount () const
+{
+    thread::MutexGuard guard (mutex);
+    return shippedCount;
+}
+
+
+void
+FileShipper::atforkChild ()
+{
+    mutex.reinitialize ();
+    queue_ev.reinitialize ();
+    done_ev.reinitialize ();
+    exit_ev.reinitialize ();
+
+    // The parent goes on sending the files queued so far.
+    queue.clear ();
+    if (exit_flag)
+        return;
+
+    // The thread of the parent does not exist here.  Its object is
+    // released without joining it.
+    startShipper ();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// FileShipper protected methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+FileShipper::scanSpool ()
+{
+#if defined (LOG4CPLUS_HAVE_FILE_SHIPPING)
+    tstring::size_type const pos = base_name_pos (filename);
+    tstring const dir = filename.substr (0, pos);
+    tstring const prefix = filename.substr (pos) + LOG4CPLUS_TEXT (".");
+
+    std::string const dirName = dir.empty () ? std::string (".")
+        : LOG4CPLUS_TSTRING_TO_STRING (dir);
+    DIR * const d = ::opendir (dirName.c_str ());
+    if (! d)
+        return;
+
+    std::vector<tstring> names;
+    while (struct dirent const * entry = ::readdir (d))
+    {
+        tstring const name = LOG4CPLUS_C_STR_TO_TSTRING (entry->d_name);
+        if (name.size () > prefix.size () && name.compare (0,
+                prefix.size (), prefix) == 0 && ends_with (name, SPOOL_SUFFIX))
+            names.push_back (dir + name);
+    }
+    ::closedir (d);
+
+    // The time stamps in the names sort the files oldest first.
+    std::sort (names.begin (), names.end ());
+    queue.insert (queue.end (), names.begin (), names.end ());
+    if (! names.empty ())
+    {
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("Shipping ") << names.size ()
+            << LOG4CPLUS_TEXT (" spooled files of ") << filename;
+        helpers::getLogLog ().debug (oss.str ());
+    }
+
+#endif
+}
+
+
+FileShipper::ShipResult
+FileShipper::shipFile (helpers::SOCKET_TYPE sock, tstring const & spoolName)
+{
+#if defined (LOG4CPLUS_HAVE_FILE_SHIPPING)
+    int const sockfd = static_cast<int>(sock);
+    std::string const path = LOG4CPLUS_TSTRING_TO_STRING (spoolName);
+    int const fd = ::open (path.c_str (), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || ::fstat (fd, &st) != 0)
+    {
+        helpers::getLogLog ().error (
+            LOG4CPLUS_TEXT ("Unable to read spooled file: ") + spoolName);
+        if (fd >= 0)
+            ::close (fd);
+        return DROPPED;
+    }
+    off_t const size = st.st_size;
+
+    tstring::size_type const pos = base_name_pos (spoolName);
+    tstring const name = source + LOG4CPLUS_TEXT (".") + spoolName.substr (
+        pos, spoolName.size () - pos - (sizeof (SPOOL_SUFFIX) / sizeof (tchar) - 1));
+
+    helpers::SocketBuffer header (LOG4CPLUS_MAX_MESSAGE_SIZE
+        - sizeof (unsigned int));
+    header.appendByte (FILE_SHIPPING_VERSION);
+    header.appendByte (static_cast<unsigned char>(sizeof (tchar)));
+    header.appendString (name);
+    append_file_size (header, size);
+    helpers::SocketBuffer request (LOG4CPLUS_MAX_MESSAGE_SIZE);
+    request.appendInt (static_cast<unsigned>(header.getSize ()));
+    request.appendBuffer (header);
+
+    // The server answers with the size it already has, which is where
+    // the transfer resumes.
+    helpers::SocketBuffer reply (2 * sizeof (unsigned int));
+    if (! write_all (sockfd, request.getBuffer (), request.getSize ())
+        || helpers::read (sock, reply) <= 0)
+    {
+        ::close (fd);
+        return RETRY;
+    }
+
+    off_t offset = read_file_size (reply);
+    if (offset > size)
+    {
+        ::close (fd);
+        helpers::getLogLog ().error (
+            LOG4CPLUS_TEXT ("Server has a longer file than ") + spoolName);
+        return DROPPED;
+    }
+
+    while (offset != size)
+    {
+        {
+            thread::MutexGuard guard (mutex);
+            if (exit_flag)
+            {
+                ::close (fd);
+                return RETRY;
+            }
+        }
+
+        std::size_t const chunk = static_cast<std::size_t>(
+            (std::min) (size - offset, static_cast<off_t>(CHUNK_SIZE)));
+        if (! send_file_data (sockfd, fd, offset, chunk))
+        {
+            ::close (fd);
+            return RETRY;
+        }
+        offset += static_cast<off_t>(chunk);
+    }
+    ::close (fd);
+
+    helpers::SocketBuffer status (sizeof (unsigned int));
+    if (helpers::read (sock, status) <= 0 || status.readInt () != 1)
+        return RETRY;
+
+    ::unlink (path.c_str ());
+    helpers::getLogLog ().debug (LOG4CPLUS_TEXT ("Shipped ") + spoolName);
+    return SHIPPED;
+
+#else
+    return DROPPED;
+
+#endif
+}
+
+
+void
+FileShipper::shipFiles ()
+{
+    helpers::SOCKET_TYPE sock = helpers::INVALID_SOCKET_VALUE;
+    unsigned long delay = 0;
+
+    while (true)
+    {
+        tstring spoolName;
+        {
+            thread::MutexGuard guard (mutex);
+            while (queue.empty () && ! exit_flag)
+            {
+                done_ev.signal ();
+                queue_ev.reset ();
+                guard.unlock ();
+                queue_ev.wait ();
+                guard.lock ();
+            }
+
+            // Files not sent yet stay spooled for the next shipper.
+            if (exit_flag)
+                break;
+
+            spoolName = queue.front ();
+        }
+
+        if (sock == helpers::INVALID_SOCKET_VALUE)
+        {
+            helpers::SocketState state;
+            sock = helpers::connectSocket (host, port, state);
+        }
+
+        ShipResult const result = sock == helpers::INVALID_SOCKET_VALUE
+            ? RETRY : shipFile (sock, spoolName);
+        if (result == RETRY)
+        {
+            if (sock != helpers::INVALID_SOCKET_VALUE)
+            {
+                helpers::closeSocket (sock);
+                sock = helpers::INVALID_SOCKET_VALUE;
+            }
+
+            delay = delay == 0 ? 100 : (std::min) (delay * 2, MAX_RETRY_DELAY);
+            exit_ev.timed_wait (delay);
+            continue;
+        }
+
+        delay = 0;
+        thread::MutexGuard guard (mutex);
+        queue.pop_front ();
+        if (result == SHIPPED)
+            ++shippedCount;
+    }
+
+    if (sock != helpers::INVALID_SOCKET_VALUE)
+        helpers::closeSocket (sock);
+}
+
+
+void
+FileShipper::startShipper ()
+{
+    thread = helpers::SharedObjectPtr<ShipperThread> (
+        new ShipperThread (*this));
+    thread->start ();
+}
+
+#endif // LOG4CPLUS_SINGLE_THREADED
+
+
+//////////////////////////////////////////////////////////////////////////////
+// FileReceiver
+//////////////////////////////////////////////////////////////////////////////
+
+FileReceiver::FileReceiver (tstring const & directory_)
+    : directory (directory_)
+{
+    if (directory.empty ())
+        directory = LOG4CPLUS_TEXT (".");
+}
+
+
+bool
+FileReceiver::receive (helpers::SOCKET_TYPE sock)
+{
+#if defined (LOG4CPLUS_HAVE_FILE_SHIPPING)
+    helpers::LogLog & loglog = helpers::getLogLog ();
+    int const sockfd = static_cast<int>(sock);
+
+    while (true)
+    {
+        helpers::SocketBuffer sizeBuffer (sizeof (unsigned int));
+        long const ret = helpers::read (sock, sizeBuffer);
+        if (ret == 0)
+            return true;
+        if (ret < 0)
+            return false;
+
+        unsigned const headerSize = sizeBuffer.readInt ();
+        if (headerSize == 0 || headerSize > LOG4CPLUS_MAX_MESSAGE_SIZE)
+            return false;
+
+        helpers::SocketBuffer header (headerSize);
+        if (helpers::read (sock, header) <= 0)
+            return false;
+
+        if (header.readByte () != FILE_SHIPPING_VERSION)
+        {
+            loglog.error (LOG4CPLUS_TEXT ("FileReceiver: unknown protocol version"));
+            return false;
+        }
+        unsigned char const sizeOfChar = header.readByte ();
+        tstring const name = header.readString (sizeOfChar);
+        off_t const size = read_file_size (header);
+        if (! valid_file_name (name) || size < 0)
+        {
+            loglog.error (LOG4CPLUS_TEXT ("FileReceiver: invalid file name ")
+                + name);
+            return false;
+        }
+
+        tstring const target = directory + LOG4CPLUS_TEXT ("/") + name;
+        tstring const part = target + PART_SUFFIX;
+        std::string const targetName = LOG4CPLUS_TSTRING_TO_STRING (target);
+        std::string const partName = LOG4CPLUS_TSTRING_TO_STRING (part);
+
+        // A file received completely before is confirmed again, as the
+        // shipper may have missed the confirmation.
+        struct stat st;
+        int fd = -1;
+        off_t offset = size;
+        if (::stat (targetName.c_str (), &st) != 0 || st.st_size != size)
+        {
+            fd = ::open (partName.c_str (), O_WRONLY | O_CREAT, 0644);
+            if (fd < 0 || ::fstat (fd, &st) != 0)
+            {
+                loglog.error (LOG4CPLUS_TEXT ("FileReceiver: unable to open ")
+                    + part);
+                if (fd >= 0)
+                    ::close (fd);
+                return false;
+            }
+
+            offset = st.st_size;
+            if (offset > size)
+            {
+                offset = 0;
+                if (::ftruncate (fd, 0) != 0)
+                {
+                    ::close (fd);
+                    return false;
+                }
+            }
+        }
+
+        helpers::SocketBuffer reply (2 * sizeof (unsigned int));
+        append_file_size (reply, offset);
+        if (! write_all (sockfd, reply.getBuffer (), reply.getSize ()))
+        {
+            if (fd >= 0)
+                ::close (fd);
+            return false;
+        }
+
+        if (fd >= 0)
+        {
+            // What has been received is kept for the shipper to resume.
+            bool const received
+                = receive_file_data (sockfd, fd, offset, size - offset);
+            bool const stored = received && ::fsync (fd) == 0;
+            ::close (fd);
+            if (! received)
+                return false;
+
+            if (! stored || std::rename (partName.c_str (),
+                    targetName.c_str ()) != 0)
+            {
+                loglog.error (LOG4CPLUS_TEXT ("FileReceiver: unable to store ")
+                    + target);
+                helpers::SocketBuffer status (sizeof (unsigned int));
+                status.appendInt (0);
+                write_all (sockfd, status.getBuffer (), status.getSize ());
+                return false;
+            }
+            loglog.debug (LOG4CPLUS_TEXT ("FileReceiver: received ") + target);
+        }
+
+        helpers::SocketBuffer status (sizeof (unsigned int));
+        status.appendInt (1);
+        if (! write_all (sockfd, status.getBuffer (), status.getSize ()))
+            return false;
+    }
+
+#else
+    (void) sock;
+    helpers::getLogLog ().error (
+        LOG4CPLUS_TEXT ("FileReceiver is not supported on this platform"));
+    return false;
+
+#endif
+}
+
+
+} // namespace log4cplus
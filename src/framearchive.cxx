@@ -0,0 +1,487 @@
+// Module:  Log4CPLUS
+// File:    framearchive.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <log4cplus/framearchive.h>
+#include <log4cplus/fstreams.h>
+#include <log4cplus/socketappender.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/socketbuffer.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/internal/internal.h>
+#include <log4cplus/internal/segment.h>
+#include <cstring>
+
+
+namespace log4cplus
+{
+
+using internal::put_varint;
+
+
+namespace
+{
+
+//! File header: "L4CFRM", a zero byte and the format version.
+static char const frame_archive_magic[8]
+    = { 'L', '4', 'C', 'F', 'R', 'M', 0, 1 };
+
+//! Record types.  Each record is its type, the source id and the size
+//! of the payload as varints, and the payload.
+static char const SOURCE_RECORD = 'S';
+static char const FRAME_RECORD = 'F';
+
+
+//! Reads a big endian int of the socket protocol.
+static inline
+bool
+get_wire_int (char const * & p, char const * end, unsigned & value)
+{
+    if (end - p < 4)
+        return false;
+
+    unsigned char const * const u = reinterpret_cast<unsigned char const *>(p);
+    value = (static_cast<unsigned>(u[0]) << 24)
+        | (static_cast<unsigned>(u[1]) << 16)
+        | (static_cast<unsigned>(u[2]) << 8) | u[3];
+    p += 4;
+    return true;
+}
+
+
+static inline
+bool
+skip_wire_string (char const * & p, char const * end, unsigned char charSize)
+{
+    unsigned length;
+    if (! get_wire_int (p, end, length)
+        || length > static_cast<unsigned long>(end - p) / charSize)
+        return false;
+
+    p += length * charSize;
+    return true;
+}
+
+
+//! Takes the timestamp out of a frame without decoding the rest of it.
+//! See helpers::convertToBuffer() for the layout.
+static
+bool
+peek_timestamp (char const * frame, std::size_t size, helpers::Time & t)
+{
+    char const * p = frame;
+    char const * const end = frame + size;
+    if (size < 2)
+        return false;
+
+    unsigned char const charSize = static_cast<unsigned char>(p[1]);
+    if (charSize != 1 && charSize != 2)
+        return false;
+    p += 2;
+
+    unsigned level, sec, usec;
+    if (! skip_wire_string (p, end, charSize)       // server name
+        || ! skip_wire_string (p, end, charSize)    // logger
+        || ! get_wire_int (p, end, level)
+        || ! skip_wire_string (p, end, charSize)    // NDC
+        || ! skip_wire_string (p, end, charSize)    // message
+        || ! skip_wire_string (p, end, charSize)    // thread
+        || ! get_wire_int (p, end, sec)
+        || ! get_wire_int (p, end, usec))
+        return false;
+
+    t = helpers::Time (static_cast<time_t>(sec), static_cast<long>(usec));
+    return true;
+}
+
+
+//! Reads a varint from the stream, for the record headers.
+static
+bool
+read_varint (std::istream & in, unsigned long & value)
+{
+    value = 0;
+    for (unsigned shift = 0; shift < sizeof (value) * 8; shift += 7)
+    {
+        int const ch = in.get ();
+        if (ch == std::char_traits<char>::eof ())
+            return false;
+
+        value |= static_cast<unsigned long>(ch & 0x7F) << shift;
+        if (! (ch & 0x80))
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FrameArchiveWriter ctors and dtor
+///////////////////////////////////////////////////////////////////////////////
+
+FrameArchiveWriter::FrameArchiveWriter(const tstring& filename_,
+    long maxFileSize_, int maxBackupIndex_, unsigned long indexInterval)
+: filename(filename_),
+  maxFileSize(maxFileSize_),
+  maxBackupIndex(maxBackupIndex_),
+  fileSize(0),
+  index(indexInterval, 0),
+  nextSource(1)
+{
+    // Each file has to be covered by its index, so appending to a file
+    // of an earlier run is not possible.
+    std::ifstream existing(LOG4CPLUS_FSTREAM_PREFERED_FILE_NAME(filename).c_str(),
+        std::ios::in | std::ios::binary);
+    bool const exists = existing.is_open()
+        && existing.peek() != std::char_traits<char>::eof();
+    existing.close();
+    if(exists) {
+        internal::roll_file(filename, maxBackupIndex, FileIndex::SUFFIX);
+    }
+
+    open();
+}
+
+
+FrameArchiveWriter::~FrameArchiveWriter()
+{
+    close();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FrameArchiveWriter public methods
+///////////////////////////////////////////////////////////////////////////////
+
+bool
+FrameArchiveWriter::isOpen() const
+{
+    return out.is_open();
+}
+
+
+unsigned long
+FrameArchiveWriter::addSource(const tstring& description)
+{
+    thread::MutexGuard guard (mutex);
+
+    unsigned long const source = nextSource++;
+    std::string const utf8 = LOG4CPLUS_TSTRING_TO_UTF8(description);
+    sources[source] = utf8;
+    writeRecord(SOURCE_RECORD, source, utf8.data(), utf8.size());
+    return source;
+}
+
+
+void
+FrameArchiveWriter::removeSource(unsigned long source)
+{
+    thread::MutexGuard guard (mutex);
+
+    sources.erase(source);
+}
+
+
+void
+FrameArchiveWriter::append(unsigned long source, const char* frame,
+    std::size_t size)
+{
+    thread::MutexGuard guard (mutex);
+
+    if(! out.is_open()) {
+        return;
+    }
+
+    // Checkpoints carry the latest time seen so far, so that no event
+    // before a checkpoint is later than its time.
+    helpers::Time t;
+    bool const timed = peek_timestamp(frame, size, t);
+    if(timed && (index.empty() || latestTime < t)) {
+        latestTime = t;
+    }
+
+    bool checkpoint = false;
+    unsigned long const offset = fileSize;
+    if(timed && index.addTime(latestTime, offset)) {
+        // A reader starting at the checkpoint learns the sources first.
+        writeSources();
+        checkpoint = true;
+    }
+
+    writeRecord(FRAME_RECORD, source, frame, size);
+
+    if(checkpoint) {
+        out.flush();
+        saveIndex();
+    }
+    if(fileSize >= static_cast<unsigned long>(maxFileSize)) {
+        rollover();
+    }
+}
+
+
+void
+FrameArchiveWriter::flush()
+{
+    thread::MutexGuard guard (mutex);
+
+    if(out.is_open()) {
+        out.flush();
+        saveIndex();
+    }
+}
+
+
+void
+FrameArchiveWriter::close()
+{
+    thread::MutexGuard guard (mutex);
+
+    if(out.is_open()) {
+        out.flush();
+        saveIndex();
+        out.close();
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FrameArchiveWriter protected methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+FrameArchiveWriter::open()
+{
+    out.open(LOG4CPLUS_FSTREAM_PREFERED_FILE_NAME(filename).c_str(),
+        std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!out.good()) {
+        helpers::getLogLog().error(LOG4CPLUS_TEXT("Unable to open file: ")
+            + filename);
+        out.close();
+        return;
+    }
+
+    out.write(frame_archive_magic, sizeof(frame_archive_magic));
+    fileSize = sizeof(frame_archive_magic);
+    index.clear();
+    latestTime = helpers::Time();
+    helpers::getLogLog().debug(LOG4CPLUS_TEXT("Just opened file: ")
+        + filename);
+}
+
+
+void
+FrameArchiveWriter::rollover()
+{
+    saveIndex();
+    out.close();
+    out.clear();
+    internal::roll_file(filename, maxBackupIndex, FileIndex::SUFFIX);
+    open();
+}
+
+
+void
+FrameArchiveWriter::writeRecord(char type, unsigned long source,
+    const char* data, std::size_t size)
+{
+    if(! out.is_open()) {
+        return;
+    }
+
+    header.clear();
+    header += type;
+    put_varint(header, source);
+    put_varint(header, size);
+    out.write(header.data(), header.size());
+    out.write(data, size);
+    if(!out.good()) {
+        helpers::getLogLog().error(LOG4CPLUS_TEXT("Unable to write to file: ")
+            + filename);
+        return;
+    }
+
+    fileSize += static_cast<unsigned long>(header.size() + size);
+}
+
+
+void
+FrameArchiveWriter::writeSources()
+{
+    for(SourceMap::const_iterator it = sources.begin(); it != sources.end();
+        ++it)
+    {
+        writeRecord(SOURCE_RECORD, it->first, it->second.data(),
+            it->second.size());
+    }
+}
+
+
+void
+FrameArchiveWriter::saveIndex()
+{
+    if(index.empty()) {
+        return;
+    }
+
+    index.setEndOffset(fileSize);
+    tstring const indexFilename = filename + FileIndex::SUFFIX;
+    if(! index.write(indexFilename)) {
+        helpers::getLogLog().error(
+            LOG4CPLUS_TEXT("Unable to write index file: ") + indexFilename);
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FrameArchiveReader ctors and dtor
+///////////////////////////////////////////////////////////////////////////////
+
+FrameArchiveReader::FrameArchiveReader(const tstring& filename_)
+: filename(filename_),
+  in(LOG4CPLUS_FSTREAM_PREFERED_FILE_NAME(filename).c_str(),
+     std::ios::in | std::ios::binary),
+  valid(false),
+  damaged(false),
+  started(false),
+  timeFilter(false),
+  minLogLevel(NOT_SET_LOG_LEVEL)
+{
+    char magic[sizeof(frame_archive_magic)];
+    in.read(magic, sizeof(magic));
+    valid = in.gcount() == static_cast<std::streamsize>(sizeof(magic))
+        && std::memcmp(magic, frame_archive_magic, sizeof(magic)) == 0;
+}
+
+
+FrameArchiveReader::~FrameArchiveReader()
+{
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FrameArchiveReader public methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+FrameArchiveReader::setTimeRange(const helpers::Time& from_,
+                                 const helpers::Time& to_)
+{
+    from = from_;
+    to = to_;
+    timeFilter = true;
+}
+
+
+bool
+FrameArchiveReader::readEvent(std::vector<spi::InternalLoggingEvent>& events)
+{
+    if(! started) {
+        started = true;
+        // No event before a checkpoint is later than its time, so
+        // reading starts at the last checkpoint earlier than the start.
+        FileIndex index;
+        if(valid && timeFilter
+           && index.read(filename + FileIndex::SUFFIX))
+        {
+            helpers::Time before = from;
+            before -= helpers::Time(0, 1);
+            unsigned long const offset = index.findStartOffset(before);
+            if(offset > sizeof(frame_archive_magic)) {
+                in.seekg(static_cast<std::streamoff>(offset));
+            }
+        }
+    }
+
+    char type;
+    unsigned long sourceId;
+    while(valid && !damaged && readRecord(type, sourceId)) {
+        if(type == SOURCE_RECORD) {
+            sources[sourceId] = LOG4CPLUS_UTF8_TO_TSTRING(payload.data(),
+                payload.size());
+            continue;
+        }
+
+        helpers::SocketBuffer buffer(payload.size());
+        std::memcpy(buffer.getBuffer(), payload.data(), payload.size());
+        buffer.setSize(payload.size());
+        spi::InternalLoggingEvent const decoded
+            = helpers::readFromBuffer(buffer);
+
+        if(decoded.getLogLevel() < minLogLevel
+           || (timeFilter && (decoded.getTimestamp() < from
+                              || to < decoded.getTimestamp())))
+        {
+            continue;
+        }
+
+        SourceMap::const_iterator const it = sources.find(sourceId);
+        source = it != sources.end() ? it->second : tstring();
+        events.push_back(decoded);
+        return true;
+    }
+
+    return false;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FrameArchiveReader protected methods
+///////////////////////////////////////////////////////////////////////////////
+
+bool
+FrameArchiveReader::readRecord(char& type, unsigned long& sourceId)
+{
+    int const ch = in.get();
+    if(ch == std::char_traits<char>::eof()) {
+        return false;
+    }
+
+    type = static_cast<char>(ch);
+    unsigned long size;
+    if(type != SOURCE_RECORD && type != FRAME_RECORD) {
+        damaged = true;
+        return false;
+    }
+    // A record cut short at the end is still being written.
+    if(! read_varint(in, sourceId) || ! read_varint(in, size)) {
+        return false;
+    }
+    if(size > LOG4CPLUS_MAX_MESSAGE_SIZE
+       || (type == FRAME_RECORD && size == 0))
+    {
+        damaged = true;
+        return false;
+    }
+
+    payload.resize(size);
+    if(size != 0) {
+        in.read(&payload[0], static_cast<std::streamsize>(size));
+    }
+    return in.gcount() == static_cast<std::streamsize>(size) || size == 0;
+}
+
+
+} // namespace log4cplus
@@ -0,0 +1,481 @@
+// Module:  Log4CPLUS
+// File:    framerelay.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <log4cplus/config.hxx>
+
+#ifndef LOG4CPLUS_SINGLE_THREADED
+
+#include <log4cplus/framerelay.h>
+#include <log4cplus/fstreams.h>
+#include <log4cplus/socketappender.h>
+#include <log4cplus/streams.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/socketbuffer.h>
+#include <log4cplus/helpers/stringhelper.h>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+
+namespace log4cplus
+{
+
+
+namespace
+{
+
+//! Size of the length prefix of each frame.
+static std::size_t const PREFIX_SIZE = 4;
+
+//! Smallest queue and batch size, which fits the largest frame.
+static std::size_t const MIN_BUFFER_SIZE
+    = LOG4CPLUS_MAX_MESSAGE_SIZE + PREFIX_SIZE;
+
+//! Longest delay between attempts to reach the upstream server.
+static unsigned long const MAX_RETRY_DELAY = 5000;
+
+
+//! Writes the length prefix in network byte order, as SocketAppender
+//! does.
+static inline
+void
+put_frame_size (char * prefix, std::size_t size)
+{
+    prefix[0] = static_cast<char>((size >> 24) & 0xFF);
+    prefix[1] = static_cast<char>((size >> 16) & 0xFF);
+    prefix[2] = static_cast<char>((size >> 8) & 0xFF);
+    prefix[3] = static_cast<char>(size & 0xFF);
+}
+
+
+static inline
+std::size_t
+get_frame_size (char const * prefix)
+{
+    unsigned char const * const u
+        = reinterpret_cast<unsigned char const *>(prefix);
+    return (static_cast<std::size_t>(u[0]) << 24)
+        | (static_cast<std::size_t>(u[1]) << 16)
+        | (static_cast<std::size_t>(u[2]) << 8) | u[3];
+}
+
+
+//! Returns the size of the longest run of whole frames at the start of
+//! [data, data + size) that fits into <code>limit</code> bytes, and
+//! their number in <code>frames</code>.
+static
+std::size_t
+whole_frames (char const * data, std::size_t size, std::size_t limit,
+    unsigned long & frames)
+{
+    std::size_t pos = 0;
+    frames = 0;
+    while (size - pos >= PREFIX_SIZE)
+    {
+        std::size_t const frameSize = get_frame_size (data + pos);
+        std::size_t const next = pos + PREFIX_SIZE + frameSize;
+        if (frameSize == 0 || frameSize > LOG4CPLUS_MAX_MESSAGE_SIZE
+            || next > size || next > limit)
+            break;
+
+        pos = next;
+        ++frames;
+    }
+    return pos;
+}
+
+} // namespace
+
+
+//////////////////////////////////////////////////////////////////////////////
+// FrameRelay::ForwarderThread
+//////////////////////////////////////////////////////////////////////////////
+
+FrameRelay::ForwarderThread::ForwarderThread (FrameRelay & relay_)
+    : relay (relay_)
+{ }
+
+
+FrameRelay::ForwarderThread::~ForwarderThread ()
+{ }
+
+
+void
+FrameRelay::ForwarderThread::run ()
+{
+    relay.forwardFrames ();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// FrameRelay ctors and dtor
+//////////////////////////////////////////////////////////////////////////////
+
+FrameRelay::FrameRelay (tstring const & host_, unsigned short port_,
+    std::size_t memoryLimit_, tstring const & spoolFile_,
+    unsigned long spoolLimit_, std::size_t batchSize_)
+    : host (host_)
+    , port (port_)
+    , memoryLimit ((std::max) (memoryLimit_, MIN_BUFFER_SIZE))
+    , spoolFile (spoolFile_)
+    , spoolLimit (spoolLimit_)
+    , batchSize ((std::max) (batchSize_, MIN_BUFFER_SIZE))
+    , spoolRead (0)
+    , spoolWrite (0)
+    , spooling (false)
+    , queuedCount (0)
+    , forwardedCount (0)
+    , exit_flag (false)
+{
+    if (! spoolFile.empty ())
+        openSpool ();
+
+    forwarder = helpers::SharedObjectPtr<ForwarderThread> (
+        new ForwarderThread (*this));
+    forwarder->start ();
+}
+
+
+FrameRelay::~FrameRelay ()
+{
+    close ();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// FrameRelay public methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+FrameRelay::append (char const * frame, std::size_t size)
+{
+    if (size == 0 || size > LOG4CPLUS_MAX_MESSAGE_SIZE)
+        return;
+
+    char prefix[PREFIX_SIZE];
+    put_frame_size (prefix, size);
+    std::size_t const needed = PREFIX_SIZE + size;
+
+    thread::MutexGuard guard (mutex);
+    while (true)
+    {
+        if (exit_flag)
+            return;
+
+        // Once frames go to the spool, later ones follow them there
+        // until it has been forwarded, which keeps them in order.
+        if (! spooling && memory.size () + needed <= memoryLimit)
+        {
+            memory.append (prefix, PREFIX_SIZE);
+            memory.append (frame, size);
+            break;
+        }
+
+        if (spool.is_open () && spoolWrite + needed <= spoolLimit)
+        {
+            spool.seekp (static_cast<std::streamoff>(spoolWrite));
+            spool.write (prefix, PREFIX_SIZE);
+            spool.write (frame, static_cast<std::streamsize>(size));
+            if (! spool.good ())
+            {
+                helpers::getLogLog ().error (
+                    LOG4CPLUS_TEXT ("Unable to write to spool file: ")
+                    + spoolFile);
+                spool.clear ();
+                return;
+            }
+            spoolWrite += static_cast<unsigned long>(needed);
+            spooling = true;
+            break;
+        }
+
+        // Not reading on lets the clients feel the backpressure.
+        space_ev.reset ();
+        guard.unlock ();
+        space_ev.wait ();
+        guard.lock ();
+    }
+
+    ++queuedCount;
+    queue_ev.signal ();
+}
+
+
+void
+FrameRelay::flush ()
+{
+    thread::MutexGuard guard (mutex);
+    unsigned long const target = queuedCount;
+    while (forwardedCount < target && ! exit_flag)
+    {
+        done_ev.reset ();
+        guard.unlock ();
+        done_ev.wait ();
+        guard.lock ();
+    }
+}
+
+
+void
+FrameRelay::close ()
+{
+    {
+        thread::MutexGuard guard (mutex);
+        if (exit_flag)
+            return;
+
+        exit_flag = true;
+        queue_ev.signal ();
+        space_ev.signal ();
+        done_ev.signal ();
+        exit_ev.signal ();
+    }
+
+    // The forwarder empties the queue before it exits.
+    forwarder->join ();
+    upstream.close ();
+
+    thread::MutexGuard guard (mutex);
+    if (spool.is_open ())
+        spool.close ();
+    if (queuedCount > forwardedCount)
+    {
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("FrameRelay::close()- ")
+            << (queuedCount - forwardedCount)
+            << LOG4CPLUS_TEXT (" frames not forwarded");
+        helpers::getLogLog ().warn (oss.str ());
+    }
+}
+
+
+unsigned long
+FrameRelay::getForwardedCount () const
+{
+    thread::MutexGuard guard (mutex);
+    return forwardedCount;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// FrameRelay protected methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+FrameRelay::openSpool ()
+{
+    std::string const name = LOG4CPLUS_FSTREAM_PREFERED_FILE_NAME (spoolFile);
+    spool.open (name.c_str (), std::ios::in | std::ios::out
+        | std::ios::binary);
+    if (! spool.is_open ())
+    {
+        resetSpool ();
+        return;
+    }
+
+    // Frames left behind by an earlier relay are forwarded first.  A
+    // frame cut short at the end is dropped.
+    spool.seekg (0, std::ios::end);
+    std::streamoff const fileSize = spool.tellg ();
+    char prefix[PREFIX_SIZE];
+    unsigned long pos = 0;
+    while (static_cast<std::streamoff>(pos + PREFIX_SIZE) <= fileSize)
+    {
+        spool.seekg (static_cast<std::streamoff>(pos));
+        if (! spool.read (prefix, PREFIX_SIZE))
+            break;
+
+        std::size_t const frameSize = get_frame_size (prefix);
+        unsigned long const next
+            = pos + static_cast<unsigned long>(PREFIX_SIZE + frameSize);
+        if (frameSize == 0 || frameSize > LOG4CPLUS_MAX_MESSAGE_SIZE
+            || static_cast<std::streamoff>(next) > fileSize)
+            break;
+
+        pos = next;
+        ++queuedCount;
+    }
+    spool.clear ();
+
+    if (pos == 0)
+    {
+        resetSpool ();
+        return;
+    }
+
+    spoolWrite = pos;
+    spooling = true;
+    tostringstream oss;
+    oss << LOG4CPLUS_TEXT ("Forwarding ") << queuedCount
+        << LOG4CPLUS_TEXT (" spooled frames from ") << spoolFile;
+    helpers::getLogLog ().debug (oss.str ());
+}
+
+
+void
+FrameRelay::resetSpool ()
+{
+    spool.close ();
+    spool.clear ();
+    std::string const name = LOG4CPLUS_FSTREAM_PREFERED_FILE_NAME (spoolFile);
+    spool.open (name.c_str (), std::ios::in | std::ios::out
+        | std::ios::binary | std::ios::trunc);
+    if (! spool.is_open ())
+        helpers::getLogLog ().error (
+            LOG4CPLUS_TEXT ("Unable to open spool file: ") + spoolFile);
+
+    spoolRead = spoolWrite = 0;
+    spooling = false;
+}
+
+
+//! Copies the oldest frames, up to the batch size, into
+//! <code>batch</code> without removing them from the queue.
+bool
+FrameRelay::takeBatch (std::string & batch, unsigned long & frames,
+    bool & fromSpool)
+{
+    // The frames in memory are older than those in the spool.
+    if (! memory.empty ())
+    {
+        std::size_t const size = whole_frames (memory.data (),
+            memory.size (), batchSize, frames);
+        batch.assign (memory, 0, size);
+        fromSpool = false;
+        return true;
+    }
+
+    if (spoolRead == spoolWrite)
+        return false;
+
+    std::size_t const want = static_cast<std::size_t>((std::min) (
+        static_cast<unsigned long>(batchSize), spoolWrite - spoolRead));
+    batch.resize (want);
+    spool.seekg (static_cast<std::streamoff>(spoolRead));
+    spool.read (&batch[0], static_cast<std::streamsize>(want));
+    std::size_t const size = spool.gcount () == static_cast<std::streamsize>(want)
+        ? whole_frames (batch.data (), want, batchSize, frames) : 0;
+    if (size == 0)
+    {
+        helpers::getLogLog ().error (
+            LOG4CPLUS_TEXT ("Damaged spool file: ") + spoolFile);
+        spool.clear ();
+        resetSpool ();
+        return false;
+    }
+
+    batch.resize (size);
+    fromSpool = true;
+    return true;
+}
+
+
+void
+FrameRelay::commitBatch (std::size_t size, unsigned long frames,
+    bool fromSpool)
+{
+    if (fromSpool)
+    {
+        spoolRead += static_cast<unsigned long>(size);
+        if (spoolRead == spoolWrite)
+            resetSpool ();
+    }
+    else
+        memory.erase (0, size);
+
+    forwardedCount += frames;
+    done_ev.signal ();
+    space_ev.signal ();
+}
+
+
+bool
+FrameRelay::send (std::string const & batch)
+{
+    if (! upstream.isOpen ())
+    {
+        upstream = helpers::Socket (host, port);
+        if (! upstream.isOpen ())
+            return false;
+
+        helpers::getLogLog ().debug (
+            LOG4CPLUS_TEXT ("FrameRelay connected to ") + host);
+    }
+
+    helpers::SocketBuffer buffer (batch.size ());
+    std::memcpy (buffer.getBuffer (), batch.data (), batch.size ());
+    buffer.setSize (batch.size ());
+    return upstream.write (buffer);
+}
+
+
+void
+FrameRelay::forwardFrames ()
+{
+    std::string batch;
+    unsigned long frames = 0;
+    bool fromSpool = false;
+    unsigned long delay = 0;
+
+    while (true)
+    {
+        {
+            thread::MutexGuard guard (mutex);
+            while (! takeBatch (batch, frames, fromSpool))
+            {
+                if (exit_flag)
+                    return;
+
+                queue_ev.reset ();
+                guard.unlock ();
+                queue_ev.wait ();
+                guard.lock ();
+            }
+        }
+
+        if (! send (batch))
+        {
+            {
+                thread::MutexGuard guard (mutex);
+                if (exit_flag)
+                {
+                    helpers::getLogLog ().error (
+                        LOG4CPLUS_TEXT ("FrameRelay: unable to reach ")
+                        + host);
+                    return;
+                }
+            }
+
+            // The batch stays queued and is taken again.
+            delay = delay == 0 ? 100 : (std::min) (delay * 2, MAX_RETRY_DELAY);
+            exit_ev.timed_wait (delay);
+            continue;
+        }
+
+        delay = 0;
+        thread::MutexGuard guard (mutex);
+        commitBatch (batch.size (), frames, fromSpool);
+    }
+}
+
+
+} // namespace log4cplus
+
+#endif // LOG4CPLUS_SINGLE_THREADED
@@ -20,6 +20,7 @@
 
 #include <log4cplus/config.hxx>
 #include <log4cplus/config/windowsh-inc.h>
+#include <log4cplus/hierarchy.h>
 #include <log4cplus/logger.h>
 #include <log4cplus/ndc.h>
 #include <log4cplus/helpers/loglog.h>
@@ -27,6 +28,9 @@
 #include <log4cplus/thread/impl/tls.h>
 #include <cstdio>
 #include <iostream>
+#if defined (LOG4CPLUS_USE_PTHREADS)
+#  include <pthread.h>
+#endif
 
 
 // Forward Declarations
@@ -52,7 +56,19 @@ namespace internal
 {
 
 
+tz_cache::tz_cache ()
+    : from (0)
+    , until (0)
+    , offset (0)
+    , templ ()
+    , tz_set (false)
+{ }
+
+
 per_thread_data::per_thread_data ()
+    : tsc_anchor_ticks (0)
+    , gmt_templ ()
+    , gmt_templ_valid (false)
 { }
 
 
@@ -102,9 +118,61 @@ alloc_ptd ()
 
 void initializeFactoryRegistry();
 void initializeLayout ();
+void initializeProcessId ();
 void threadCleanup ();
 
 
+#if defined (LOG4CPLUS_USE_PTHREADS)
+//! Fork handlers registered with pthread_atfork().  They keep the
+//! default hierarchy consistent across fork() in multi-threaded
+//! programs.
+extern "C"
+{
+
+static
+void
+log4cplus_atfork_prepare ()
+{
+    try
+    {
+        Logger::getDefaultHierarchy ().atforkPrepare ();
+    }
+    catch (...)
+    { }
+}
+
+
+static
+void
+log4cplus_atfork_parent ()
+{
+    try
+    {
+        Logger::getDefaultHierarchy ().atforkParent ();
+    }
+    catch (...)
+    { }
+}
+
+
+static
+void
+log4cplus_atfork_child ()
+{
+    try
+    {
+        initializeProcessId ();
+        Logger::getDefaultHierarchy ().atforkChild ();
+    }
+    catch (...)
+    { }
+}
+
+} // extern "C"
+
+#endif
+
+
 //! Thread local storage clean up function for POSIX threads.
 static 
 void 
@@ -140,6 +208,14 @@ void initializeLog4cplus()
     Logger::getRoot();
     initializeFactoryRegistry();
     initializeLayout ();
+    initializeProcessId ();
+
+#if defined (LOG4CPLUS_USE_PTHREADS)
+    if (pthread_atfork (log4cplus_atfork_prepare, log4cplus_atfork_parent,
+            log4cplus_atfork_child) != 0)
+        helpers::getLogLog ().error (
+            LOG4CPLUS_TEXT ("initializeLog4cplus()- pthread_atfork() failed"));
+#endif
 
     initialized = true;
 }
@@ -20,8 +20,12 @@
 
 #include <log4cplus/hierarchy.h>
 #include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/backtrace.h>
+#include <log4cplus/spi/appenderattachable.h>
 #include <log4cplus/spi/loggerimpl.h>
 #include <log4cplus/spi/rootlogger.h>
+#include <algorithm>
+#include <set>
 #include <utility>
 #include <stdexcept>
 
@@ -47,6 +51,25 @@ bool startsWith(tstring const & teststr, tstring const & substr)
     return val;
 }
 
+
+static
+void
+collectNestedAppenders(Appender & appender, std::set<Appender*> & nested)
+{
+    spi::AppenderAttachable * attachable
+        = dynamic_cast<spi::AppenderAttachable*>(&appender);
+    if(! attachable) {
+        return;
+    }
+
+    SharedAppenderPtrList list = attachable->getAllAppenders();
+    for(SharedAppenderPtrList::iterator it = list.begin(); it != list.end(); ++it) {
+        if(nested.insert(it->get()).second) {
+            collectNestedAppenders(**it, nested);
+        }
+    }
+}
+
 }
 
 
@@ -69,7 +92,8 @@ Hierarchy::Hierarchy()
     root(NULL),
     disableValue(DISABLE_OFF),  // Don't disable any LogLevel level by default.
     emittedNoAppenderWarning(false),
-    emittedNoResourceBundleWarning(false)
+    emittedNoResourceBundleWarning(false),
+    governor(*this)
 {
     root = Logger( new spi::RootLogger(*this, DEBUG_LOG_LEVEL) );
 }
@@ -199,6 +223,7 @@ Hierarchy::getRoot() const
 void 
 Hierarchy::resetConfiguration()
 {
+    governor.reset();
     getRoot().setLogLevel(DEBUG_LOG_LEVEL);
     disableValue = DISABLE_OFF;
 
@@ -242,6 +267,91 @@ Hierarchy::shutdown()
 }
 
 
+void
+Hierarchy::atforkPrepare()
+{
+    LOG4CPLUS_MUTEX_LOCK(hashtable_mutex);
+
+    forkLoggers.clear();
+    initializeLoggerList(forkLoggers);
+    forkLoggers.push_back(root);
+
+    // Appenders nested in other appenders are left to those, which
+    // have to drain into them first.
+    SharedAppenderPtrList appenders;
+    std::set<Appender*> nested;
+    for(LoggerList::iterator it = forkLoggers.begin(); it != forkLoggers.end(); ++it) {
+        SharedAppenderPtrList list = it->getAllAppenders();
+        for(SharedAppenderPtrList::iterator app = list.begin(); app != list.end(); ++app) {
+            if(std::find(appenders.begin(), appenders.end(), *app) == appenders.end()) {
+                appenders.push_back(*app);
+                collectNestedAppenders(**app, nested);
+            }
+        }
+    }
+
+    forkAppenders.clear();
+    for(SharedAppenderPtrList::iterator it = appenders.begin(); it != appenders.end(); ++it) {
+        if(nested.find(it->get()) == nested.end()) {
+            forkAppenders.push_back(*it);
+        }
+    }
+
+    for(LoggerList::iterator it = forkLoggers.begin(); it != forkLoggers.end(); ++it) {
+        LOG4CPLUS_MUTEX_LOCK(it->value->appender_list_mutex);
+    }
+    for(SharedAppenderPtrList::iterator it = forkAppenders.begin(); it != forkAppenders.end(); ++it) {
+        (*it)->atforkPrepare();
+    }
+
+    governor.atforkPrepare();
+    backtraceAtforkPrepare();
+
+    // ConsoleAppender and LogLog share this one.
+    getLogLog().mutex.lock();
+}
+
+
+void
+Hierarchy::atforkParent()
+{
+    getLogLog().mutex.unlock();
+    backtraceAtforkParent();
+    governor.atforkParent();
+
+    for(SharedAppenderPtrList::reverse_iterator it = forkAppenders.rbegin(); it != forkAppenders.rend(); ++it) {
+        (*it)->atforkParent();
+    }
+    for(LoggerList::reverse_iterator it = forkLoggers.rbegin(); it != forkLoggers.rend(); ++it) {
+        LOG4CPLUS_MUTEX_UNLOCK(it->value->appender_list_mutex);
+    }
+    forkAppenders.clear();
+    forkLoggers.clear();
+
+    LOG4CPLUS_MUTEX_UNLOCK(hashtable_mutex);
+}
+
+
+void
+Hierarchy::atforkChild()
+{
+    getLogLog().mutex.reinitialize();
+    backtraceAtforkChild();
+    governor.atforkChild();
+
+    for(SharedAppenderPtrList::reverse_iterator it = forkAppenders.rbegin(); it != forkAppenders.rend(); ++it) {
+        (*it)->atforkChild();
+    }
+    for(LoggerList::reverse_iterator it = forkLoggers.rbegin(); it != forkLoggers.rend(); ++it) {
+        it->value->appender_list_mutex->reinitialize();
+    }
+    forkAppenders.clear();
+    forkLoggers.clear();
+
+    hashtable_mutex->reinitialize();
+}
+
+
 
 //////////////////////////////////////////////////////////////////////////////
 // log4cplus::Hierarchy private methods
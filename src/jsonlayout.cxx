@@ -0,0 +1,393 @@
+// Module:  Log4CPLUS
+// File:    jsonlayout.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <log4cplus/layout.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/internal/internal.h>
+
+#if defined (__SSE2__) || defined (_M_X64) \
+    || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define LOG4CPLUS_HAVE_SSE2_JSON_ESCAPE
+#  include <emmintrin.h>
+#endif
+
+
+namespace log4cplus
+{
+
+
+namespace
+{
+
+static tchar const DEFAULT_FIELDS[]
+    = LOG4CPLUS_TEXT ("time,level,logger,thread,ndc,message,fields");
+
+static tchar const DEFAULT_DATE_FORMAT[]
+    = LOG4CPLUS_TEXT ("%Y-%m-%dT%H:%M:%S.%qZ");
+
+static tchar const * const field_names[] = {
+    LOG4CPLUS_TEXT ("time"),
+    LOG4CPLUS_TEXT ("level"),
+    LOG4CPLUS_TEXT ("logger"),
+    LOG4CPLUS_TEXT ("thread"),
+    LOG4CPLUS_TEXT ("ndc"),
+    LOG4CPLUS_TEXT ("file"),
+    LOG4CPLUS_TEXT ("line"),
+    LOG4CPLUS_TEXT ("message"),
+    LOG4CPLUS_TEXT ("fields")
+};
+
+static tchar const hex_digits[] = LOG4CPLUS_TEXT ("0123456789abcdef");
+
+
+static inline
+bool
+needs_escape (tchar ch)
+{
+    return (ch >= 0 && ch < 0x20) || ch == LOG4CPLUS_TEXT ('"')
+        || ch == LOG4CPLUS_TEXT ('\\');
+}
+
+
+//! Returns the length of the prefix of [str, str + len) that needs no
+//! escaping.
+static inline
+std::size_t
+clean_prefix (tchar const * str, std::size_t len)
+{
+    std::size_t i = 0;
+
+#if defined (LOG4CPLUS_HAVE_SSE2_JSON_ESCAPE) && ! defined (UNICODE)
+    __m128i const quote = _mm_set1_epi8 ('"');
+    __m128i const backslash = _mm_set1_epi8 ('\\');
+    __m128i const control_max = _mm_set1_epi8 (0x1F);
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i const chunk = _mm_loadu_si128 (
+            reinterpret_cast<__m128i const *>(str + i));
+        // Unsigned chunk <= 0x1F, as chunk == min (chunk, 0x1F).
+        __m128i const special = _mm_or_si128 (
+            _mm_or_si128 (_mm_cmpeq_epi8 (chunk, quote),
+                _mm_cmpeq_epi8 (chunk, backslash)),
+            _mm_cmpeq_epi8 (_mm_min_epu8 (chunk, control_max), chunk));
+        int const mask = _mm_movemask_epi8 (special);
+        if (mask != 0)
+        {
+            while (! (mask & (1 << (i & 15))))
+                ++i;
+            return i;
+        }
+    }
+#endif
+
+    while (i != len && ! needs_escape (str[i]))
+        ++i;
+
+    return i;
+}
+
+
+//! Appends str as a JSON string, quotes included.
+static
+void
+append_json_string (tstring & out, tchar const * str, std::size_t len)
+{
+    out += LOG4CPLUS_TEXT ('"');
+
+    std::size_t pos = 0;
+    for (;;)
+    {
+        std::size_t const clean = clean_prefix (str + pos, len - pos);
+        out.append (str + pos, clean);
+        pos += clean;
+        if (pos == len)
+            break;
+
+        tchar const ch = str[pos++];
+        out += LOG4CPLUS_TEXT ('\\');
+        switch (ch)
+        {
+        case LOG4CPLUS_TEXT ('"'):
+        case LOG4CPLUS_TEXT ('\\'):
+            out += ch;
+            break;
+
+        case LOG4CPLUS_TEXT ('\n'):
+            out += LOG4CPLUS_TEXT ('n');
+            break;
+
+        case LOG4CPLUS_TEXT ('\r'):
+            out += LOG4CPLUS_TEXT ('r');
+            break;
+
+        case LOG4CPLUS_TEXT ('\t'):
+            out += LOG4CPLUS_TEXT ('t');
+            break;
+
+        case LOG4CPLUS_TEXT ('\b'):
+            out += LOG4CPLUS_TEXT ('b');
+            break;
+
+        case LOG4CPLUS_TEXT ('\f'):
+            out += LOG4CPLUS_TEXT ('f');
+            break;
+
+        default:
+            out += LOG4CPLUS_TEXT ("u00");
+            out += hex_digits[(ch >> 4) & 0xF];
+            out += hex_digits[ch & 0xF];
+        }
+    }
+
+    out += LOG4CPLUS_TEXT ('"');
+}
+
+
+static inline
+void
+append_json_string (tstring & out, tstring const & str)
+{
+    append_json_string (out, str.data (), str.size ());
+}
+
+//! Appends the typed event fields as a JSON object.  Numbers and
+//! booleans are written unquoted, except for non-finite doubles, which
+//! JSON cannot represent.
+static
+void
+append_event_fields (tstring & out, spi::EventFields const & fields)
+{
+    out += LOG4CPLUS_TEXT ('{');
+    for (spi::EventFields::const_iterator it = fields.begin ();
+         it != fields.end (); ++it)
+    {
+        if (it != fields.begin ())
+            out += LOG4CPLUS_TEXT (',');
+        append_json_string (out, it->getKey ());
+        out += LOG4CPLUS_TEXT (':');
+
+        switch (it->getType ())
+        {
+        case spi::EventField::STRING_FIELD:
+            append_json_string (out, it->getString ());
+            break;
+
+        case spi::EventField::DOUBLE_FIELD:
+        {
+            double const value = it->getDouble ();
+            if (value != value || value - value != 0)
+            {
+                tstring text;
+                it->appendValue (text);
+                append_json_string (out, text);
+                break;
+            }
+            it->appendValue (out);
+            break;
+        }
+
+        default:
+            it->appendValue (out);
+        }
+    }
+    out += LOG4CPLUS_TEXT ('}');
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// log4cplus::JsonLayout ctors and dtor
+///////////////////////////////////////////////////////////////////////////////
+
+JsonLayout::JsonLayout()
+: dateFormat(DEFAULT_DATE_FORMAT),
+  use_gmtime(true)
+{
+    init(DEFAULT_FIELDS);
+}
+
+
+JsonLayout::JsonLayout(const helpers::Properties& properties)
+: Layout(properties),
+  dateFormat(DEFAULT_DATE_FORMAT),
+  use_gmtime(true)
+{
+    if(properties.exists( LOG4CPLUS_TEXT("DateFormat") )) {
+        dateFormat = properties.getProperty( LOG4CPLUS_TEXT("DateFormat") );
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("Use_gmtime") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("Use_gmtime") );
+        use_gmtime = (helpers::toLower(tmp) == LOG4CPLUS_TEXT("true"));
+    }
+
+    init(properties.getProperty( LOG4CPLUS_TEXT("Fields"), DEFAULT_FIELDS ));
+}
+
+
+JsonLayout::~JsonLayout()
+{
+}
+
+
+void
+JsonLayout::init(const tstring& fieldList)
+{
+    std::vector<tstring> names;
+    helpers::tokenize(fieldList, LOG4CPLUS_TEXT(','),
+        std::back_inserter(names));
+
+    fields.clear();
+    fingerprint = LOG4CPLUS_TEXT("JsonLayout ");
+    for(std::vector<tstring>::const_iterator it = names.begin();
+        it != names.end(); ++it)
+    {
+        tstring::size_type const first = it->find_first_not_of(LOG4CPLUS_TEXT(" \t"));
+        if(first == tstring::npos) {
+            continue;
+        }
+        tstring::size_type const last = it->find_last_not_of(LOG4CPLUS_TEXT(" \t"));
+        tstring const name = helpers::toLower(it->substr(first, last - first + 1));
+
+        std::size_t i = 0;
+        std::size_t const count = sizeof(field_names) / sizeof(field_names[0]);
+        while(i != count && name != field_names[i]) {
+            ++i;
+        }
+        if(i == count) {
+            getLogLog().warn(LOG4CPLUS_TEXT("JsonLayout: unknown field ")
+                + name);
+            continue;
+        }
+
+        fields.push_back(static_cast<Field>(i));
+        fingerprint += name;
+        fingerprint += LOG4CPLUS_TEXT(',');
+    }
+
+    compiledDateFormat.compile(dateFormat, use_gmtime);
+    fingerprint += use_gmtime ? LOG4CPLUS_TEXT(" gmtime ") : LOG4CPLUS_TEXT(" localtime ");
+    fingerprint += dateFormat;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// log4cplus::JsonLayout public methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+JsonLayout::formatAndAppend(tostream& output,
+                            const spi::InternalLoggingEvent& event)
+{
+    if(appendPreformatted(output, event)) {
+        return;
+    }
+
+    // The line is built in a per thread buffer and written out at once.
+    // It is kept for appenders with equivalent layouts if there may be
+    // any.
+    tstring& buf = internal::get_ptd()->layout_buf;
+    buf.clear();
+    format(buf, event);
+    if(shareOutput(event)) {
+        event.setFormattedOutput(this, output.getloc(), buf);
+    }
+    output.write(buf.data(), buf.size());
+}
+
+
+void
+JsonLayout::format(tstring& out, const spi::InternalLoggingEvent& event) const
+{
+    out += LOG4CPLUS_TEXT('{');
+    bool first = true;
+    for(std::vector<Field>::const_iterator it = fields.begin();
+        it != fields.end(); ++it)
+    {
+        // Events without typed fields do not get an empty object.
+        if(*it == EVENT_FIELDS && event.getFields().empty()) {
+            continue;
+        }
+        if(! first) {
+            out += LOG4CPLUS_TEXT(',');
+        }
+        first = false;
+        out += LOG4CPLUS_TEXT('"');
+        out += field_names[*it];
+        out += LOG4CPLUS_TEXT("\":");
+
+        switch(*it)
+        {
+        case TIME_FIELD:
+        {
+            tstring& date = internal::get_ptd()->date_buf;
+            date.clear();
+            compiledDateFormat.formatTo(date, event.getTimestamp());
+            append_json_string(out, date);
+            break;
+        }
+
+        case LEVEL_FIELD:
+            append_json_string(out, llmCache.toString(event.getLogLevel()));
+            break;
+
+        case LOGGER_FIELD:
+            append_json_string(out, event.getLoggerName());
+            break;
+
+        case THREAD_FIELD:
+            append_json_string(out, event.getThread());
+            break;
+
+        case NDC_FIELD:
+            append_json_string(out, event.getNDC());
+            break;
+
+        case FILE_FIELD:
+            append_json_string(out, event.getFile());
+            break;
+
+        case LINE_FIELD:
+        {
+            tchar buffer[std::numeric_limits<int>::digits10 + 2];
+            tchar* const buf_end = buffer + sizeof(buffer) / sizeof(buffer[0]);
+            tchar const* const digits
+                = helpers::convertIntegerToChars(buf_end, event.getLine());
+            out.append(digits, static_cast<tchar const*>(buf_end));
+            break;
+        }
+
+        case MESSAGE_FIELD:
+            append_json_string(out, event.getMessage());
+            break;
+
+        case EVENT_FIELDS:
+            append_event_fields(out, event.getFields());
+            break;
+        }
+    }
+    out += LOG4CPLUS_TEXT("}\n");
+}
+
+
+} // namespace log4cplus
@@ -22,7 +22,7 @@
 #include <log4cplus/helpers/stringhelper.h>
 #include <log4cplus/helpers/timehelper.h>
 #include <log4cplus/spi/loggingevent.h>
-#include <iomanip>
+#include <log4cplus/internal/internal.h>
 
 
 namespace log4cplus
@@ -39,6 +39,62 @@ initializeLayout ()
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// log4cplus::Layout protected methods
+///////////////////////////////////////////////////////////////////////////////
+
+tostream&
+Layout::beginFormat(tostream& output,
+                    const spi::InternalLoggingEvent& event) const
+{
+    if(! shareOutput(event)) {
+        return output;
+    }
+
+    tostringstream& oss = internal::get_ptd()->layout_oss;
+    oss.str(internal::empty_str);
+    oss.clear();
+    if(oss.getloc() != output.getloc()) {
+        oss.imbue(output.getloc());
+    }
+    return oss;
+}
+
+
+void
+Layout::endFormat(tostream& output,
+                  const spi::InternalLoggingEvent& event) const
+{
+    if(! shareOutput(event)) {
+        return;
+    }
+
+    tostringstream& oss = internal::get_ptd()->layout_oss;
+    std::locale const loc(output.getloc());
+    event.setFormattedOutput(this, loc, oss.str());
+    output << *event.getFormattedOutput(this, loc);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// log4cplus::SimpleLayout ctors
+///////////////////////////////////////////////////////////////////////////////
+
+SimpleLayout::SimpleLayout()
+{
+    fingerprint = LOG4CPLUS_TEXT("SimpleLayout");
+}
+
+
+SimpleLayout::SimpleLayout(const helpers::Properties& properties)
+: Layout(properties)
+{
+    fingerprint = LOG4CPLUS_TEXT("SimpleLayout");
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // log4cplus::SimpleLayout public methods
 ///////////////////////////////////////////////////////////////////////////////
@@ -47,10 +103,16 @@ void
 SimpleLayout::formatAndAppend(log4cplus::tostream& output, 
                               const log4cplus::spi::InternalLoggingEvent& event)
 {
-    output << llmCache.toString(event.getLogLevel()) 
-           << LOG4CPLUS_TEXT(" - ")
-           << event.getMessage() 
-           << LOG4CPLUS_TEXT("\n");
+    if(appendPreformatted(output, event)) {
+        return;
+    }
+
+    tostream& out = beginFormat(output, event);
+    out << llmCache.toString(event.getLogLevel()) 
+        << LOG4CPLUS_TEXT(" - ")
+        << event.getMessage() 
+        << LOG4CPLUS_TEXT("\n");
+    endFormat(output, event);
 }
 
 
@@ -63,6 +125,7 @@ TTCCLayout::TTCCLayout(bool use_gmtime_)
 : dateFormat(),
   use_gmtime(use_gmtime_)
 {
+    init();
 }
 
 
@@ -77,6 +140,7 @@ TTCCLayout::TTCCLayout(const log4cplus::helpers::Properties& properties)
 
     tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("Use_gmtime") );
     use_gmtime = (helpers::toLower(tmp) == LOG4CPLUS_TEXT("true"));
+    init();
 }
 
 
@@ -85,6 +149,17 @@ TTCCLayout::~TTCCLayout()
 }
 
 
+void
+TTCCLayout::init()
+{
+    compiledDateFormat.compile(dateFormat, use_gmtime);
+
+    fingerprint = LOG4CPLUS_TEXT("TTCCLayout ");
+    fingerprint += use_gmtime ? LOG4CPLUS_TEXT("gmtime ") : LOG4CPLUS_TEXT("localtime ");
+    fingerprint += dateFormat;
+}
+
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // log4cplus::TTCCLayout public methods
@@ -94,33 +169,47 @@ void
 TTCCLayout::formatAndAppend(log4cplus::tostream& output, 
                             const log4cplus::spi::InternalLoggingEvent& event)
 {
+    if (appendPreformatted (output, event))
+        return;
+
+    tostream& out = beginFormat (output, event);
+
     if (dateFormat.empty ())
     {
         helpers::Time const rel_time = event.getTimestamp () - TTCCLayout_time_base;
-        tchar const old_fill = output.fill ();
         helpers::time_t const sec = rel_time.sec ();
+        long const msec = rel_time.usec () / 1000;
 
         if (sec != 0)
-            output << sec << std::setfill (LOG4CPLUS_TEXT ('0'))
-                   << std::setw (3);
+        {
+            out << helpers::decimal (sec);
+            if (msec < 100)
+                out << (msec < 10 ? LOG4CPLUS_TEXT ("00") : LOG4CPLUS_TEXT ("0"));
+        }
 
-        output << rel_time.usec () / 1000;
-        output.fill (old_fill);
+        out << helpers::decimal (msec);
     }
     else
-        output << event.getTimestamp().getFormattedTime(dateFormat, use_gmtime);
-
-    output << LOG4CPLUS_TEXT(" [")
-           << event.getThread()
-           << LOG4CPLUS_TEXT("] ")
-           << llmCache.toString(event.getLogLevel()) 
-           << LOG4CPLUS_TEXT(" ")
-           << event.getLoggerName()
-           << LOG4CPLUS_TEXT(" <")
-           << event.getNDC() 
-           << LOG4CPLUS_TEXT("> - ")
-           << event.getMessage()
-           << LOG4CPLUS_TEXT("\n");
+    {
+        tstring & buf = internal::get_ptd ()->date_buf;
+        buf.clear ();
+        compiledDateFormat.formatTo (buf, event.getTimestamp ());
+        out << buf;
+    }
+
+    out << LOG4CPLUS_TEXT(" [")
+        << event.getThread()
+        << LOG4CPLUS_TEXT("] ")
+        << llmCache.toString(event.getLogLevel()) 
+        << LOG4CPLUS_TEXT(" ")
+        << event.getLoggerName()
+        << LOG4CPLUS_TEXT(" <")
+        << event.getNDC() 
+        << LOG4CPLUS_TEXT("> - ")
+        << event.getMessage()
+        << LOG4CPLUS_TEXT("\n");
+
+    endFormat (output, event);
 }
 
 
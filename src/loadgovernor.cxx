@@ -0,0 +1,576 @@
+// Module:  Log4CPLUS
+// File:    loadgovernor.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <log4cplus/loadgovernor.h>
+#include <log4cplus/hierarchy.h>
+#include <log4cplus/logger.h>
+#include <log4cplus/streams.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/spi/loggerimpl.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/config/windowsh-inc.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+
+
+// Without atomic operations the counters and the window end are only
+// accessed under the lock.
+#if defined (LOG4CPLUS_SINGLE_THREADED) \
+    || defined (LOG4CPLUS_HAVE___SYNC_ADD_AND_FETCH) || defined (_WIN32)
+#  define LOG4CPLUS_GOVERNOR_ATOMIC_COUNTERS
+#endif
+
+
+namespace log4cplus
+{
+
+
+namespace
+{
+
+static tchar const GOVERNOR_LOGGER[] = LOG4CPLUS_TEXT ("log4cplus.governor");
+
+//! Distance between the standard levels.
+static LogLevel const LEVEL_STEP = DEBUG_LOG_LEVEL - TRACE_LOG_LEVEL;
+
+
+static
+unsigned long
+get_ulong_property (helpers::Properties const & properties,
+    tchar const * key, unsigned long def)
+{
+    if (! properties.exists (key))
+        return def;
+
+    tstring tmp = properties.getProperty (key);
+    return static_cast<unsigned long>(
+        std::atol (LOG4CPLUS_TSTRING_TO_STRING (tmp).c_str ()));
+}
+
+
+static inline
+void
+add_to (unsigned long volatile & counter, unsigned long value)
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED) \
+    && defined (LOG4CPLUS_HAVE___SYNC_ADD_AND_FETCH)
+    __sync_add_and_fetch (&counter, value);
+
+#elif ! defined (LOG4CPLUS_SINGLE_THREADED) && defined (_WIN32)
+    InterlockedExchangeAdd (reinterpret_cast<LONG volatile *>(&counter),
+        static_cast<LONG>(value));
+
+#else
+    counter += value;
+
+#endif
+}
+
+
+//! Reads a value written by other threads without the lock.
+static inline
+unsigned long
+load (unsigned long volatile const & value)
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED) \
+    && defined (LOG4CPLUS_HAVE___SYNC_ADD_AND_FETCH)
+    return __sync_add_and_fetch (const_cast<unsigned long volatile *>(&value),
+        0);
+
+#elif ! defined (LOG4CPLUS_SINGLE_THREADED) && defined (_WIN32)
+    return static_cast<unsigned long>(InterlockedExchangeAdd (
+        reinterpret_cast<LONG volatile *>(
+            const_cast<unsigned long volatile *>(&value)), 0));
+
+#else
+    return value;
+
+#endif
+}
+
+
+static inline
+void
+store (unsigned long volatile & target, unsigned long value)
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED) \
+    && defined (LOG4CPLUS_HAVE___SYNC_ADD_AND_FETCH)
+    unsigned long old = target;
+    while (! __sync_bool_compare_and_swap (&target, old, value))
+        old = target;
+
+#elif ! defined (LOG4CPLUS_SINGLE_THREADED) && defined (_WIN32)
+    InterlockedExchange (reinterpret_cast<LONG volatile *>(&target),
+        static_cast<LONG>(value));
+
+#else
+    target = value;
+
+#endif
+}
+
+
+//! Whether <code>now</code> is at or past <code>end</code>; both wrap
+//! around.
+static inline
+bool
+reached (unsigned long now, unsigned long end)
+{
+    return now - end <= (std::numeric_limits<unsigned long>::max) () / 2;
+}
+
+
+//! Orders volumes by the measure that exceeds the budget, largest first.
+struct NoisierThan
+{
+    explicit NoisierThan (bool bytes_)
+        : bytes (bytes_)
+    { }
+
+    template <typename Volume>
+    bool operator () (Volume const * a, Volume const * b) const
+    {
+        return bytes ? a->bytes > b->bytes : a->events > b->events;
+    }
+
+    bool bytes;
+};
+
+} // namespace
+
+
+//////////////////////////////////////////////////////////////////////////////
+// LoadGovernor ctor and dtor
+//////////////////////////////////////////////////////////////////////////////
+
+LoadGovernor::Volume::Volume ()
+    : events (0)
+    , bytes (0)
+{ }
+
+
+LoadGovernor::LoadGovernor (Hierarchy & h)
+    : hierarchy (h)
+    , enabled (0)
+    , eventsPerSecond (0)
+    , bytesPerSecond (0)
+    , interval (1000)
+    , maxLevel (WARN_LOG_LEVEL)
+    , restoreRatio (50)
+    , restoreAfter (5)
+    , origin (helpers::Time::gettimeofday ())
+    , windowEnd (0)
+    , started (false)
+    , quietWindows (0)
+{ }
+
+
+LoadGovernor::~LoadGovernor ()
+{ }
+
+
+//////////////////////////////////////////////////////////////////////////////
+// LoadGovernor public methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+LoadGovernor::configure (helpers::Properties const & properties)
+{
+    setInterval (get_ulong_property (properties, LOG4CPLUS_TEXT ("Interval"),
+        1000));
+    setRestoreThreshold (
+        static_cast<unsigned>(get_ulong_property (properties,
+            LOG4CPLUS_TEXT ("RestoreRatio"), 50)),
+        static_cast<unsigned>(get_ulong_property (properties,
+            LOG4CPLUS_TEXT ("RestoreAfter"), 5)));
+
+    if (properties.exists (LOG4CPLUS_TEXT ("MaxLevel")))
+    {
+        tstring const name = properties.getProperty (
+            LOG4CPLUS_TEXT ("MaxLevel"));
+        LogLevel const level = getLogLevelManager ().fromString (name);
+        if (level == NOT_SET_LOG_LEVEL)
+            helpers::getLogLog ().error (
+                LOG4CPLUS_TEXT ("LoadGovernor::configure()- unknown MaxLevel: ")
+                + name);
+        else
+            setMaxLevel (level);
+    }
+
+    setBudget (
+        get_ulong_property (properties, LOG4CPLUS_TEXT ("EventsPerSecond"), 0),
+        get_ulong_property (properties, LOG4CPLUS_TEXT ("BytesPerSecond"), 0));
+}
+
+
+void
+LoadGovernor::setBudget (unsigned long events, unsigned long bytes)
+{
+    thread::MutexGuard guard (mutex);
+    eventsPerSecond = events;
+    bytesPerSecond = bytes;
+    store (enabled, events != 0 || bytes != 0);
+    if (! load (enabled))
+        restoreAll ();
+}
+
+
+void
+LoadGovernor::setInterval (unsigned long millis)
+{
+    thread::MutexGuard guard (mutex);
+    interval = millis != 0 ? millis : 1;
+}
+
+
+void
+LoadGovernor::setMaxLevel (LogLevel level)
+{
+    thread::MutexGuard guard (mutex);
+    maxLevel = level;
+}
+
+
+void
+LoadGovernor::setRestoreThreshold (unsigned ratio, unsigned windows)
+{
+    thread::MutexGuard guard (mutex);
+    restoreRatio = ratio;
+    restoreAfter = windows != 0 ? windows : 1;
+}
+
+
+void
+LoadGovernor::reset ()
+{
+    thread::MutexGuard guard (mutex);
+    store (enabled, 0);
+    eventsPerSecond = 0;
+    bytesPerSecond = 0;
+    restoreAll ();
+}
+
+
+bool
+LoadGovernor::isEnabled () const
+{
+    return load (enabled) != 0;
+}
+
+
+std::size_t
+LoadGovernor::getShedCount () const
+{
+    thread::MutexGuard guard (mutex);
+    return shedLoggers.size ();
+}
+
+
+void
+LoadGovernor::record (spi::LoggerImpl & logger,
+    spi::InternalLoggingEvent const & event)
+{
+    unsigned long const now = millisOf (event.getTimestamp ());
+    std::vector<tstring> messages;
+
+    // Only the first event of a logger and the first one past the end
+    // of a window take the lock; the others just add to the counters
+    // of their logger.
+#if defined (LOG4CPLUS_GOVERNOR_ATOMIC_COUNTERS)
+    if (! load (logger.governed) || reached (now, load (windowEnd)))
+#endif
+    {
+        thread::MutexGuard guard (mutex);
+        if (! load (enabled))
+            return;
+
+        if (! load (logger.governed))
+        {
+            counted.push_back (LoggerImplPtr (&logger));
+            store (logger.governed, 1);
+        }
+        if (! started || reached (now, windowEnd))
+            rollover (now, messages);
+    }
+
+    {
+#if ! defined (LOG4CPLUS_GOVERNOR_ATOMIC_COUNTERS)
+        thread::MutexGuard guard (mutex);
+#endif
+        add_to (logger.governorEvents, 1);
+        add_to (logger.governorBytes, static_cast<unsigned long>(
+            event.getMessage ().size () * sizeof (tchar)));
+    }
+
+    // The adjustments are logged without the lock held, as they are
+    // recorded themselves.
+    if (! messages.empty ())
+    {
+        Logger governor = hierarchy.getInstance (GOVERNOR_LOGGER);
+        for (std::vector<tstring>::const_iterator it = messages.begin ();
+             it != messages.end (); ++it)
+            LOG4CPLUS_WARN_STR (governor, *it);
+    }
+}
+
+
+void
+LoadGovernor::atforkPrepare ()
+{
+    mutex.lock ();
+}
+
+
+void
+LoadGovernor::atforkParent ()
+{
+    mutex.unlock ();
+}
+
+
+void
+LoadGovernor::atforkChild ()
+{
+    mutex.reinitialize ();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// LoadGovernor protected methods
+//////////////////////////////////////////////////////////////////////////////
+
+unsigned long
+LoadGovernor::millisOf (helpers::Time const & time) const
+{
+    helpers::Time const elapsed = time - origin;
+    return static_cast<unsigned long>(elapsed.sec ()) * 1000
+        + static_cast<unsigned long>(elapsed.usec () / 1000);
+}
+
+
+//! Ends the current window at <code>now</code> and starts the next one.
+void
+LoadGovernor::rollover (unsigned long now, std::vector<tstring> & messages)
+{
+    if (started)
+    {
+        collect ();
+        evaluate (messages);
+
+        // No events at all were logged in the windows since.
+        addQuietWindows ((now - windowEnd) / interval, messages);
+    }
+    started = true;
+    store (windowEnd, now + interval);
+}
+
+
+//! Moves the counters of the loggers into volumes.
+void
+LoadGovernor::collect ()
+{
+    volumes.clear ();
+    for (std::vector<LoggerImplPtr>::const_iterator it = counted.begin ();
+         it != counted.end (); ++it)
+    {
+        spi::LoggerImpl & logger = **it;
+        Volume volume;
+        volume.events = load (logger.governorEvents);
+        volume.bytes = load (logger.governorBytes);
+        if (volume.events == 0 && volume.bytes == 0)
+            continue;
+
+        // Events counted meanwhile are left for the next window.
+        add_to (logger.governorEvents, 0 - volume.events);
+        add_to (logger.governorBytes, 0 - volume.bytes);
+        volume.logger = *it;
+        volumes.push_back (volume);
+    }
+}
+
+
+void
+LoadGovernor::evaluate (std::vector<tstring> & messages)
+{
+    unsigned long events = 0;
+    unsigned long bytes = 0;
+    for (VolumeList::const_iterator it = volumes.begin ();
+         it != volumes.end (); ++it)
+    {
+        events += it->events;
+        bytes += it->bytes;
+    }
+
+    unsigned long const eventLimit = eventsPerSecond * interval / 1000;
+    unsigned long const byteLimit = bytesPerSecond * interval / 1000;
+    bool const overEvents = eventsPerSecond != 0 && events > eventLimit;
+    bool const overBytes = bytesPerSecond != 0 && bytes > byteLimit;
+    if (overEvents)
+    {
+        quietWindows = 0;
+        shed (events - eventLimit, 0, messages);
+    }
+    else if (overBytes)
+    {
+        quietWindows = 0;
+        shed (0, bytes - byteLimit, messages);
+    }
+    else if (! shedLoggers.empty ())
+    {
+        bool const quiet
+            = (eventsPerSecond == 0
+                || events * 100.0 <= eventLimit * static_cast<double>(restoreRatio))
+            && (bytesPerSecond == 0
+                || bytes * 100.0 <= byteLimit * static_cast<double>(restoreRatio));
+        if (quiet)
+            addQuietWindows (1, messages);
+        else
+            quietWindows = 0;
+    }
+}
+
+
+//! Counts quiet windows and restores a level for each
+//! <code>RestoreAfter</code> of them.
+void
+LoadGovernor::addQuietWindows (unsigned long windows,
+    std::vector<tstring> & messages)
+{
+    while (windows != 0 && ! shedLoggers.empty ())
+    {
+        unsigned long const needed = quietWindows < restoreAfter
+            ? restoreAfter - quietWindows : 1;
+        unsigned long const step = (std::min) (windows, needed);
+        windows -= step;
+        quietWindows += static_cast<unsigned>(step);
+        if (step == needed)
+        {
+            quietWindows = 0;
+            restore (messages);
+        }
+    }
+}
+
+
+void
+LoadGovernor::shed (unsigned long events, unsigned long bytes,
+    std::vector<tstring> & messages)
+{
+    std::vector<Volume *> noisiest;
+    noisiest.reserve (volumes.size ());
+    for (VolumeList::iterator it = volumes.begin (); it != volumes.end (); ++it)
+        noisiest.push_back (&*it);
+    std::sort (noisiest.begin (), noisiest.end (), NoisierThan (bytes != 0));
+
+    unsigned long const excess = bytes != 0 ? bytes : events;
+    unsigned long covered = 0;
+    for (std::vector<Volume *>::const_iterator it = noisiest.begin ();
+         it != noisiest.end () && covered < excess; ++it)
+    {
+        spi::LoggerImpl & logger = *(*it)->logger;
+        if (logger.getName () == GOVERNOR_LOGGER)
+            continue;
+
+        LogLevel const current = logger.getChainedLogLevel ();
+        if (current >= maxLevel)
+            continue;
+
+        LogLevel const raised
+            = (std::min) ((current / LEVEL_STEP + 1) * LEVEL_STEP, maxLevel);
+
+        std::vector<ShedLogger>::iterator shed = shedLoggers.begin ();
+        while (shed != shedLoggers.end () && shed->logger.get () != &logger)
+            ++shed;
+        if (shed == shedLoggers.end ())
+        {
+            ShedLogger entry;
+            entry.logger = (*it)->logger;
+            entry.original = logger.getLogLevel ();
+            entry.applied = raised;
+            shed = shedLoggers.insert (shedLoggers.end (), entry);
+        }
+        shed->applied = raised;
+        logger.setLogLevel (raised);
+        covered += bytes != 0 ? (*it)->bytes : (*it)->events;
+
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("Log volume over budget, raised level of [")
+            << logger.getName () << LOG4CPLUS_TEXT ("] to ")
+            << getLogLevelManager ().toString (raised)
+            << LOG4CPLUS_TEXT (", ")
+            << (bytes != 0 ? (*it)->bytes : (*it)->events)
+            << (bytes != 0 ? LOG4CPLUS_TEXT (" bytes") : LOG4CPLUS_TEXT (" events"))
+            << LOG4CPLUS_TEXT (" in ") << interval << LOG4CPLUS_TEXT (" ms");
+        messages.push_back (oss.str ());
+    }
+}
+
+
+void
+LoadGovernor::restore (std::vector<tstring> & messages)
+{
+    ShedLogger const entry = shedLoggers.back ();
+    shedLoggers.pop_back ();
+
+    spi::LoggerImpl & logger = *entry.logger;
+    if (logger.getLogLevel () != entry.applied)
+        return;
+
+    logger.setLogLevel (entry.original);
+    messages.push_back (LOG4CPLUS_TEXT ("Log volume within budget, restored")
+        LOG4CPLUS_TEXT (" level of [") + logger.getName ()
+        + LOG4CPLUS_TEXT ("] to ")
+        + (entry.original == NOT_SET_LOG_LEVEL
+            ? tstring (LOG4CPLUS_TEXT ("the inherited level"))
+            : getLogLevelManager ().toString (entry.original)));
+}
+
+
+void
+LoadGovernor::restoreAll ()
+{
+    std::vector<tstring> messages;
+    while (! shedLoggers.empty ())
+        restore (messages);
+
+    for (std::vector<LoggerImplPtr>::const_iterator it = counted.begin ();
+         it != counted.end (); ++it)
+    {
+        spi::LoggerImpl & logger = **it;
+        store (logger.governed, 0);
+        add_to (logger.governorEvents, 0 - load (logger.governorEvents));
+        add_to (logger.governorBytes, 0 - load (logger.governorBytes));
+    }
+    counted.clear ();
+    volumes.clear ();
+
+    // The next event starts a window.
+    started = false;
+    store (windowEnd, millisOf (helpers::Time::gettimeofday ()));
+    quietWindows = 0;
+}
+
+
+} // namespace log4cplus
@@ -250,6 +250,14 @@ Logger::log (LogLevel ll, const log4cplus::tstring& message, const char* file,
 }
 
 
+void
+Logger::log (LogLevel ll, const log4cplus::tstring& message,
+    const spi::EventFields& fields, const char* file, int line) const
+{
+    value->log (ll, message, fields, file, line);
+}
+
+
 void
 Logger::forcedLog (LogLevel ll, const log4cplus::tstring& message,
     const char* file, int line) const
@@ -258,6 +266,14 @@ Logger::forcedLog (LogLevel ll, const log4cplus::tstring& message,
 }
 
 
+void
+Logger::forcedLog (LogLevel ll, const log4cplus::tstring& message,
+    const spi::EventFields& fields, const char* file, int line) const
+{
+    value->forcedLog (ll, message, fields, file, line);
+}
+
+
 void
 Logger::callAppenders (const spi::InternalLoggingEvent& event) const
 {
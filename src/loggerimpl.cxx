@@ -21,6 +21,7 @@
 #include <log4cplus/spi/loggerimpl.h>
 #include <log4cplus/appender.h>
 #include <log4cplus/hierarchy.h>
+#include <log4cplus/helpers/backtrace.h>
 #include <log4cplus/helpers/loglog.h>
 #include <log4cplus/spi/loggingevent.h>
 #include <log4cplus/spi/rootlogger.h>
@@ -31,6 +32,29 @@ using namespace log4cplus::helpers;
 using namespace log4cplus::spi;
 
 
+namespace
+{
+
+//! Attaches the backtrace of the logging call to events at or above
+//! the backtrace threshold.
+static
+void
+attachBacktrace(InternalLoggingEvent& event)
+{
+    LogLevel const threshold = getBacktraceThreshold();
+    if(threshold == NOT_SET_LOG_LEVEL || event.getLogLevel() < threshold) {
+        return;
+    }
+
+    Backtrace frames;
+    if(captureBacktrace(frames)) {
+        event.setBacktrace(frames);
+    }
+}
+
+}
+
+
 
 //////////////////////////////////////////////////////////////////////////////
 // Logger Constructors and Destructor
@@ -40,7 +64,10 @@ LoggerImpl::LoggerImpl(const log4cplus::tstring& name_, Hierarchy& h)
     ll(NOT_SET_LOG_LEVEL),
     parent(NULL),
     additive(true), 
-    hierarchy(h)
+    hierarchy(h),
+    governorEvents(0),
+    governorBytes(0),
+    governed(0)
 {
 }
 
@@ -57,8 +84,14 @@ LoggerImpl::~LoggerImpl()
 void 
 LoggerImpl::callAppenders(const InternalLoggingEvent& event)
 {
+    if(hierarchy.governor.isEnabled()) {
+        hierarchy.governor.record(*this, event);
+    }
+
     int writes = 0;
     for(const LoggerImpl* c = this; c != NULL; c=c->parent.get()) {
+        // Appenders of the ancestors may see the event, too.
+        event.setOutputShared(c->additive && c->parent.get() != NULL);
         writes += c->appendLoopOnAppenders(event);
         if(!c->additive) {
             break;
@@ -109,6 +142,19 @@ LoggerImpl::log(LogLevel ll_,
 }
 
 
+void 
+LoggerImpl::log(LogLevel ll_, 
+                const log4cplus::tstring& message,
+                const EventFields& fields,
+                const char* file, 
+                int line)
+{
+    if(isEnabledFor(ll_)) {
+        forcedLog(ll_, message, fields, file, line);
+    }
+}
+
+
 
 LogLevel 
 LoggerImpl::getChainedLogLevel() const
@@ -151,7 +197,23 @@ LoggerImpl::forcedLog(LogLevel ll_,
                       const char* file,
                       int line)
 {
-    callAppenders(spi::InternalLoggingEvent(this->getName(), ll_, message, file, line));
+    spi::InternalLoggingEvent event(this->getName(), ll_, message, file, line);
+    attachBacktrace(event);
+    callAppenders(event);
+}
+
+
+void
+LoggerImpl::forcedLog(LogLevel ll_,
+                      const log4cplus::tstring& message,
+                      const EventFields& fields,
+                      const char* file,
+                      int line)
+{
+    spi::InternalLoggingEvent event(this->getName(), ll_, message, file, line);
+    event.setFields(fields);
+    attachBacktrace(event);
+    callAppenders(event);
 }
 
 
@@ -19,6 +19,9 @@
 // limitations under the License.
 
 #include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/layout.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <limits>
 
 
 using namespace log4cplus;
@@ -69,6 +72,56 @@ InternalLoggingEvent::getType() const
 
 
 
+bool
+InternalLoggingEvent::FormattedOutput::matches(const Layout* layout_,
+                                               const std::locale& loc) const
+{
+    const log4cplus::tstring& fingerprint_ = layout_->getFingerprint();
+    if(fingerprint_.empty()) {
+        return layout == layout_ && locale == loc;
+    }
+    return *type == typeid(*layout_) && fingerprint == fingerprint_
+        && locale == loc;
+}
+
+
+void
+InternalLoggingEvent::setFormattedOutput(const Layout* layout,
+                                         const std::locale& loc,
+                                         const log4cplus::tstring& text) const
+{
+    for(std::size_t i = 0; i < formatted.size(); ++i) {
+        if(formatted[i].matches(layout, loc)) {
+            formatted[i].text = text;
+            return;
+        }
+    }
+
+    formatted.push_back(FormattedOutput());
+    FormattedOutput& entry = formatted.back();
+    entry.layout = layout;
+    entry.type = &typeid(*layout);
+    entry.fingerprint = layout->getFingerprint();
+    entry.locale = loc;
+    entry.text = text;
+}
+
+
+
+const log4cplus::tstring*
+InternalLoggingEvent::getFormattedOutput(const Layout* layout,
+                                         const std::locale& loc) const
+{
+    for(std::size_t i = 0; i < formatted.size(); ++i) {
+        if(formatted[i].matches(layout, loc)) {
+            return &formatted[i].text;
+        }
+    }
+    return 0;
+}
+
+
+
 std::auto_ptr<InternalLoggingEvent>
 InternalLoggingEvent::clone() const
 {
@@ -93,8 +146,186 @@ InternalLoggingEvent::operator=(const log4cplus::spi::InternalLoggingEvent& rhs)
     timestamp = rhs.timestamp;
     file = rhs.file;
     line = rhs.line;
+    fields = rhs.fields;
+    backtrace = rhs.backtrace;
+    outputShared = rhs.outputShared;
+    formatted = rhs.formatted;
+
+    return *this;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// EventField implementation
+///////////////////////////////////////////////////////////////////////////////
+
+EventField::EventField(const log4cplus::tstring& key_, long value_)
+: key(key_),
+  type(INTEGER_FIELD)
+{
+    value.integer = value_;
+}
+
+
+EventField::EventField(const log4cplus::tstring& key_, unsigned long value_)
+: key(key_),
+  type(UNSIGNED_FIELD)
+{
+    value.uinteger = value_;
+}
+
+
+EventField::EventField(const log4cplus::tstring& key_, double value_)
+: key(key_),
+  type(DOUBLE_FIELD)
+{
+    value.dbl = value_;
+}
+
+
+EventField::EventField(const log4cplus::tstring& key_, bool value_)
+: key(key_),
+  type(BOOL_FIELD)
+{
+    value.boolean = value_;
+}
+
+
+EventField::EventField(const log4cplus::tstring& key_,
+                       const log4cplus::tstring& value_)
+: key(key_),
+  type(STRING_FIELD),
+  str(value_)
+{
+    value.integer = 0;
+}
+
+
+void
+EventField::appendValue(log4cplus::tstring& out) const
+{
+    switch(type)
+    {
+    case INTEGER_FIELD:
+    {
+        tchar buffer[std::numeric_limits<long>::digits10 + 3];
+        tchar* const buf_end = buffer + sizeof(buffer) / sizeof(buffer[0]);
+        tchar const* const digits
+            = helpers::convertIntegerToChars(buf_end, value.integer);
+        out.append(digits, static_cast<tchar const*>(buf_end));
+        break;
+    }
+
+    case UNSIGNED_FIELD:
+    {
+        tchar buffer[std::numeric_limits<unsigned long>::digits10 + 2];
+        tchar* const buf_end = buffer + sizeof(buffer) / sizeof(buffer[0]);
+        tchar const* const digits
+            = helpers::convertIntegerToChars(buf_end, value.uinteger);
+        out.append(digits, static_cast<tchar const*>(buf_end));
+        break;
+    }
+
+    case DOUBLE_FIELD:
+    {
+        tchar buffer[helpers::DOUBLE_CHARS_BUFFER_SIZE];
+        std::size_t const len
+            = helpers::convertDoubleToChars(buffer, value.dbl);
+        out.append(buffer, len);
+        break;
+    }
 
+    case STRING_FIELD:
+        out += str;
+        break;
+
+    case BOOL_FIELD:
+        out += value.boolean ? LOG4CPLUS_TEXT("true") : LOG4CPLUS_TEXT("false");
+        break;
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// EventFields implementation
+///////////////////////////////////////////////////////////////////////////////
+
+EventFields&
+EventFields::operator()(const log4cplus::tstring& key, int value)
+{
+    fields.push_back(EventField(key, static_cast<long>(value)));
+    return *this;
+}
+
+
+EventFields&
+EventFields::operator()(const log4cplus::tstring& key, unsigned value)
+{
+    fields.push_back(EventField(key, static_cast<unsigned long>(value)));
+    return *this;
+}
+
+
+EventFields&
+EventFields::operator()(const log4cplus::tstring& key, long value)
+{
+    fields.push_back(EventField(key, value));
+    return *this;
+}
+
+
+EventFields&
+EventFields::operator()(const log4cplus::tstring& key, unsigned long value)
+{
+    fields.push_back(EventField(key, value));
     return *this;
 }
 
 
+EventFields&
+EventFields::operator()(const log4cplus::tstring& key, double value)
+{
+    fields.push_back(EventField(key, value));
+    return *this;
+}
+
+
+EventFields&
+EventFields::operator()(const log4cplus::tstring& key, bool value)
+{
+    fields.push_back(EventField(key, value));
+    return *this;
+}
+
+
+EventFields&
+EventFields::operator()(const log4cplus::tstring& key,
+                        const log4cplus::tstring& value)
+{
+    fields.push_back(EventField(key, value));
+    return *this;
+}
+
+
+EventFields&
+EventFields::operator()(const log4cplus::tstring& key,
+                        const log4cplus::tchar* value)
+{
+    fields.push_back(EventField(key, log4cplus::tstring(value)));
+    return *this;
+}
+
+
+const EventField*
+EventFields::find(const log4cplus::tstring& key) const
+{
+    for(const_iterator it = fields.begin(); it != fields.end(); ++it) {
+        if(it->getKey() == key) {
+            return &*it;
+        }
+    }
+    return 0;
+}
+
@@ -0,0 +1,213 @@
+// Module:  Log4CPLUS
+// File:    lzcodec.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <log4cplus/helpers/lzcodec.h>
+#include <cstring>
+
+
+namespace log4cplus { namespace helpers {
+
+
+namespace
+{
+
+static std::size_t const MIN_MATCH = 4;
+static std::size_t const MAX_OFFSET = 0xFFFF;
+static unsigned const HASH_BITS = 12;
+//! Matches are not searched for in the last bytes of the input.
+static std::size_t const END_LITERALS = 5;
+
+
+static inline
+unsigned
+read_u32 (char const * p)
+{
+    unsigned value;
+    std::memcpy (&value, p, 4);
+    return value;
+}
+
+
+static inline
+unsigned
+hash_u32 (unsigned value)
+{
+    return ((value * 2654435761u) & 0xFFFFFFFFu) >> (32 - HASH_BITS);
+}
+
+
+static
+void
+put_length (std::string & out, std::size_t len)
+{
+    while (len >= 255)
+    {
+        out += static_cast<char>(255);
+        len -= 255;
+    }
+    out += static_cast<char>(len);
+}
+
+
+static
+void
+put_block (std::string & out, char const * literals, std::size_t literals_len,
+    std::size_t offset, std::size_t match_len)
+{
+    std::size_t const match_code = match_len - MIN_MATCH;
+    unsigned char token = static_cast<unsigned char>(
+        (literals_len < 15 ? literals_len : 15) << 4);
+    token |= static_cast<unsigned char>(match_code < 15 ? match_code : 15);
+    out += static_cast<char>(token);
+    if (literals_len >= 15)
+        put_length (out, literals_len - 15);
+    out.append (literals, literals_len);
+
+    out += static_cast<char>(offset & 0xFF);
+    out += static_cast<char>((offset >> 8) & 0xFF);
+    if (match_code >= 15)
+        put_length (out, match_code - 15);
+}
+
+
+static
+void
+put_last_block (std::string & out, char const * literals, std::size_t len)
+{
+    out += static_cast<char>((len < 15 ? len : 15) << 4);
+    if (len >= 15)
+        put_length (out, len - 15);
+    out.append (literals, len);
+}
+
+
+//! Reads an extended length; returns false at the end of the input.
+static
+bool
+get_length (std::size_t & len, unsigned char const * & src,
+    unsigned char const * src_end)
+{
+    unsigned char byte;
+    do
+    {
+        if (src == src_end)
+            return false;
+
+        byte = *src++;
+        len += byte;
+    }
+    while (byte == 255);
+
+    return true;
+}
+
+} // namespace
+
+
+void
+lzCompress (std::string & out, char const * src, std::size_t size)
+{
+    // Positions plus one, so that zero means an empty slot.
+    std::size_t table[1 << HASH_BITS] = { 0 };
+
+    out.reserve (out.size () + size / 2 + 16);
+
+    std::size_t anchor = 0;
+    std::size_t pos = 0;
+    std::size_t const limit = size > END_LITERALS ? size - END_LITERALS : 0;
+    while (pos < limit)
+    {
+        unsigned const seq = read_u32 (src + pos);
+        std::size_t & slot = table[hash_u32 (seq)];
+        std::size_t const candidate = slot;
+        slot = pos + 1;
+
+        if (candidate == 0 || pos - (candidate - 1) > MAX_OFFSET
+            || read_u32 (src + candidate - 1) != seq)
+        {
+            ++pos;
+            continue;
+        }
+
+        std::size_t const match = candidate - 1;
+        std::size_t len = MIN_MATCH;
+        while (pos + len < size && src[match + len] == src[pos + len])
+            ++len;
+
+        put_block (out, src + anchor, pos - anchor, pos - match, len);
+        pos += len;
+        anchor = pos;
+    }
+
+    put_last_block (out, src + anchor, size - anchor);
+}
+
+
+bool
+lzDecompress (std::string & out, char const * src_, std::size_t size,
+    std::size_t expectedSize)
+{
+    unsigned char const * src = reinterpret_cast<unsigned char const *>(src_);
+    unsigned char const * const src_end = src + size;
+    std::size_t const start = out.size ();
+    std::size_t const end = start + expectedSize;
+    out.resize (end);
+    std::size_t pos = start;
+
+    while (src != src_end)
+    {
+        unsigned const token = *src++;
+        std::size_t literals_len = token >> 4;
+        if (literals_len == 15 && ! get_length (literals_len, src, src_end))
+            return false;
+
+        if (literals_len > static_cast<std::size_t>(src_end - src)
+            || literals_len > end - pos)
+            return false;
+
+        std::memcpy (&out[pos], src, literals_len);
+        pos += literals_len;
+        src += literals_len;
+        if (src == src_end)
+            break;
+
+        if (src_end - src < 2)
+            return false;
+
+        std::size_t const offset = src[0] | (src[1] << 8);
+        src += 2;
+        std::size_t match_len = token & 0xF;
+        if (match_len == 15 && ! get_length (match_len, src, src_end))
+            return false;
+
+        match_len += MIN_MATCH;
+        if (offset == 0 || offset > pos - start || match_len > end - pos)
+            return false;
+
+        // The match may overlap the bytes it produces.
+        for (std::size_t i = 0; i != match_len; ++i, ++pos)
+            out[pos] = out[pos - offset];
+    }
+
+    return pos == end;
+}
+
+
+} } // namespace log4cplus { namespace helpers {
@@ -19,6 +19,7 @@
 // limitations under the License.
 
 #include <log4cplus/layout.h>
+#include <log4cplus/helpers/backtrace.h>
 #include <log4cplus/helpers/loglog.h>
 #include <log4cplus/helpers/timehelper.h>
 #include <log4cplus/helpers/stringhelper.h>
@@ -87,9 +88,28 @@ get_basename (const log4cplus::tstring& filename)
 }
 
 
+//! Process id used by %i.  It is set by initializeProcessId().
+static unsigned long cached_process_id;
+
+
 } // namespace
 
 
+namespace log4cplus
+{
+
+
+//! Called by initializeLog4cplus() and in a child process after fork().
+void
+initializeProcessId ()
+{
+    cached_process_id = static_cast<unsigned long>(get_process_id ());
+}
+
+
+} // namespace log4cplus
+
+
 using namespace std;
 using namespace log4cplus;
 using namespace log4cplus::helpers;
@@ -216,8 +236,7 @@ namespace log4cplus {
             virtual log4cplus::tstring convert(const InternalLoggingEvent& event);
 
         private:
-            bool use_gmtime;
-            log4cplus::tstring format;
+            helpers::CompiledTimeFormat format;
         };
 
 
@@ -252,6 +271,41 @@ namespace log4cplus {
 
 
 
+        /**
+         * This PatternConverter is used to format the typed fields of
+         * the InternalLoggingEvent object: the value of the field
+         * \c key, or all fields as space separated <code>key=value</code>
+         * pairs when \c key is empty.
+         */
+        class FieldsPatternConverter : public PatternConverter {
+        public:
+            FieldsPatternConverter(const FormattingInfo& info,
+                                   const log4cplus::tstring& key);
+            virtual log4cplus::tstring convert(const InternalLoggingEvent& event);
+
+        private:
+            log4cplus::tstring key;
+        };
+
+
+
+        /**
+         * This PatternConverter is used to format the backtrace attached
+         * to the InternalLoggingEvent object, see
+         * helpers::symbolizeBacktrace().
+         */
+        class BacktracePatternConverter : public PatternConverter {
+        public:
+            BacktracePatternConverter(const FormattingInfo& info,
+                                      unsigned maxDepth);
+            virtual log4cplus::tstring convert(const InternalLoggingEvent& event);
+
+        private:
+            unsigned maxDepth;
+        };
+
+
+
         /**
          * This class parses a "pattern" string into an array of
          * PatternConverter objects.
@@ -396,7 +450,10 @@ log4cplus::pattern::BasicPatternConverter::convert
     case BASENAME_CONVERTER: return get_basename(event.getFile());
     case FILE_CONVERTER:     return event.getFile();
     case THREAD_CONVERTER:   return event.getThread(); 
-    case PROCESS_CONVERTER:  return convertIntegerToString(get_process_id ()); 
+    case PROCESS_CONVERTER:
+        return convertIntegerToString(cached_process_id != 0
+            ? cached_process_id
+            : static_cast<unsigned long>(get_process_id ()));
 
     case LINE_CONVERTER:
         {
@@ -478,8 +535,7 @@ log4cplus::pattern::DatePatternConverter::DatePatternConverter
                                                 const log4cplus::tstring& pattern,
                                                 bool use_gmtime_)
 : PatternConverter(info),
-  use_gmtime(use_gmtime_),
-  format(pattern)
+  format(pattern, use_gmtime_)
 {
 }
 
@@ -489,7 +545,7 @@ log4cplus::tstring
 log4cplus::pattern::DatePatternConverter::convert
                                             (const InternalLoggingEvent& event)
 {
-    return event.getTimestamp().getFormattedTime(format, use_gmtime);
+    return format.formatTime(event.getTimestamp());
 }
 
 
@@ -545,6 +601,63 @@ log4cplus::pattern::NDCPatternConverter::convert (
 
 
 
+////////////////////////////////////////////////
+// FieldsPatternConverter methods:
+////////////////////////////////////////////////
+
+log4cplus::pattern::FieldsPatternConverter::FieldsPatternConverter (
+    const FormattingInfo& info, const log4cplus::tstring& key_)
+    : PatternConverter(info)
+    , key(key_)
+{ }
+
+
+log4cplus::tstring
+log4cplus::pattern::FieldsPatternConverter::convert (
+    const InternalLoggingEvent& event)
+{
+    const spi::EventFields& fields = event.getFields();
+    log4cplus::tstring text;
+    if (! key.empty ())
+    {
+        const spi::EventField* field = fields.find(key);
+        if (field)
+            field->appendValue(text);
+        return text;
+    }
+
+    for (spi::EventFields::const_iterator it = fields.begin();
+         it != fields.end(); ++it)
+    {
+        if (it != fields.begin())
+            text += LOG4CPLUS_TEXT(' ');
+        text += it->getKey();
+        text += LOG4CPLUS_TEXT('=');
+        it->appendValue(text);
+    }
+    return text;
+}
+
+
+
+log4cplus::pattern::BacktracePatternConverter::BacktracePatternConverter (
+    const FormattingInfo& info, unsigned maxDepth_)
+    : PatternConverter(info)
+    , maxDepth(maxDepth_)
+{ }
+
+
+log4cplus::tstring
+log4cplus::pattern::BacktracePatternConverter::convert (
+    const InternalLoggingEvent& event)
+{
+    log4cplus::tstring text;
+    helpers::symbolizeBacktrace(text, event.getBacktrace(), maxDepth);
+    return text;
+}
+
+
+
 ////////////////////////////////////////////////
 // PatternParser methods:
 ////////////////////////////////////////////////
@@ -839,10 +952,18 @@ log4cplus::pattern::PatternParser::finalizeConverter(log4cplus::tchar c)
             //getLogLog().debug("NDC converter.");      
             break;
 
-        // 'X' is MDC in log4j.
-        // Not implemented.
+        // 'X' is MDC in log4j; here it prints the typed event fields.
         case LOG4CPLUS_TEXT('X'):
-            goto not_implemented;
+            pc = new FieldsPatternConverter(formattingInfo, extractOption());
+            //getLogLog().debug("FIELDS converter.");
+            break;
+
+        case LOG4CPLUS_TEXT('S'):
+            pc = new BacktracePatternConverter
+                          (formattingInfo,
+                           static_cast<unsigned>(extractPrecisionOption()));
+            //getLogLog().debug("BACKTRACE converter.");
+            break;
 
 not_implemented:;
         default:
@@ -911,6 +1032,11 @@ PatternLayout::init(const log4cplus::tstring& pattern_, unsigned ndcMaxDepth)
     this->pattern = pattern_;
     this->parsedPattern = PatternParser(pattern, ndcMaxDepth).parse();
 
+    tostringstream oss;
+    oss << LOG4CPLUS_TEXT("PatternLayout ") << ndcMaxDepth
+        << LOG4CPLUS_TEXT(' ') << pattern;
+    fingerprint = oss.str();
+
     // Let's validate that our parser didn't give us any NULLs.  If it did,
     // we will convert them to a valid PatternConverter that does nothing so
     // at least we don't core.
@@ -949,12 +1075,18 @@ void
 PatternLayout::formatAndAppend(log4cplus::tostream& output, 
                                const InternalLoggingEvent& event)
 {
+    if(appendPreformatted(output, event)) {
+        return;
+    }
+
+    tostream& out = beginFormat(output, event);
     for(PatternConverterList::iterator it=parsedPattern.begin(); 
         it!=parsedPattern.end(); 
         ++it)
     {
-        (*it)->formatAndAppend(output, event);
+        (*it)->formatAndAppend(out, event);
     }
+    endFormat(output, event);
 }
 
 
@@ -0,0 +1,398 @@
+// Module:  Log4CPLUS
+// File:    segmentappender.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <log4cplus/segmentappender.h>
+#include <log4cplus/fstreams.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/lzcodec.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/internal/internal.h>
+#include <log4cplus/internal/segment.h>
+#include <cstdlib>
+#include <map>
+
+
+namespace log4cplus
+{
+
+using internal::put_varint;
+using internal::put_svarint;
+using internal::put_string;
+
+
+namespace
+{
+
+typedef const tstring& (spi::InternalLoggingEvent::* string_getter)() const;
+
+
+static
+void
+append_column (std::string & body, std::string const & column)
+{
+    put_varint (body, column.size ());
+    body += column;
+}
+
+
+//! Stores the distinct values of the column in the order they first
+//! appear, followed by the index of each row's value.
+static
+void
+encode_dictionary (std::string & column,
+    std::vector<spi::InternalLoggingEvent> const & rows, string_getter get)
+{
+    typedef std::map<tstring, unsigned long> dictionary_type;
+    dictionary_type ids;
+    std::string entries;
+    std::string indices;
+    for (std::vector<spi::InternalLoggingEvent>::const_iterator it
+             = rows.begin (); it != rows.end (); ++it)
+    {
+        tstring const & value = ((*it).*get) ();
+        std::pair<dictionary_type::iterator, bool> const ret
+            = ids.insert (std::make_pair (value, ids.size ()));
+        if (ret.second)
+            put_string (entries, value);
+        put_varint (indices, ret.first->second);
+    }
+
+    put_varint (column, ids.size ());
+    column += entries;
+    column += indices;
+}
+
+
+static
+void
+encode_levels (std::string & column,
+    std::vector<spi::InternalLoggingEvent> const & rows)
+{
+    typedef std::map<LogLevel, unsigned long> dictionary_type;
+    dictionary_type ids;
+    std::string entries;
+    std::string indices;
+    for (std::vector<spi::InternalLoggingEvent>::const_iterator it
+             = rows.begin (); it != rows.end (); ++it)
+    {
+        std::pair<dictionary_type::iterator, bool> const ret
+            = ids.insert (std::make_pair (it->getLogLevel (), ids.size ()));
+        if (ret.second)
+            put_varint (entries, static_cast<unsigned long>(it->getLogLevel ()));
+        put_varint (indices, ret.first->second);
+    }
+
+    put_varint (column, ids.size ());
+    column += entries;
+    column += indices;
+}
+
+
+static
+void
+encode_fields (std::string & column, spi::EventFields const & fields)
+{
+    put_varint (column, fields.size ());
+    for (spi::EventFields::const_iterator it = fields.begin ();
+         it != fields.end (); ++it)
+    {
+        put_string (column, it->getKey ());
+        column += static_cast<char>(it->getType ());
+        switch (it->getType ())
+        {
+        case spi::EventField::INTEGER_FIELD:
+            put_svarint (column, it->getInteger ());
+            break;
+
+        case spi::EventField::UNSIGNED_FIELD:
+            put_varint (column, it->getUnsigned ());
+            break;
+
+        case spi::EventField::DOUBLE_FIELD:
+            internal::put_double (column, it->getDouble ());
+            break;
+
+        case spi::EventField::STRING_FIELD:
+            put_string (column, it->getString ());
+            break;
+
+        case spi::EventField::BOOL_FIELD:
+            column += static_cast<char>(it->getBool () ? 1 : 0);
+            break;
+        }
+    }
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SegmentAppender ctors and dtor
+///////////////////////////////////////////////////////////////////////////////
+
+SegmentAppender::SegmentAppender(const tstring& filename_,
+                                 unsigned rowGroupSize_,
+                                 long maxFileSize_,
+                                 int maxBackupIndex_)
+{
+    init(filename_, rowGroupSize_, maxFileSize_, maxBackupIndex_);
+}
+
+
+SegmentAppender::SegmentAppender(const helpers::Properties& properties)
+: Appender(properties)
+{
+    unsigned rowGroupSize_ = 4096;
+    long maxFileSize_ = 64 * 1024 * 1024;
+    int maxBackupIndex_ = 1;
+
+    if(properties.exists( LOG4CPLUS_TEXT("RowGroupSize") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("RowGroupSize") );
+        rowGroupSize_ = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+    }
+
+    if(properties.exists( LOG4CPLUS_TEXT("MaxFileSize") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("MaxFileSize") );
+        tmp = helpers::toUpper(tmp);
+        maxFileSize_ = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+        if(tmp.find( LOG4CPLUS_TEXT("MB") ) == (tmp.length() - 2)) {
+            maxFileSize_ *= (1024 * 1024); // convert to megabytes
+        }
+        if(tmp.find( LOG4CPLUS_TEXT("KB") ) == (tmp.length() - 2)) {
+            maxFileSize_ *= 1024; // convert to kilobytes
+        }
+    }
+
+    if(properties.exists( LOG4CPLUS_TEXT("MaxBackupIndex") )) {
+        tstring tmp = properties.getProperty(LOG4CPLUS_TEXT("MaxBackupIndex"));
+        maxBackupIndex_ = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+    }
+
+    init(properties.getProperty(LOG4CPLUS_TEXT("File")), rowGroupSize_,
+        maxFileSize_, maxBackupIndex_);
+}
+
+
+SegmentAppender::~SegmentAppender()
+{
+    destructorImpl();
+}
+
+
+void
+SegmentAppender::init(const tstring& filename_, unsigned rowGroupSize_,
+                      long maxFileSize_, int maxBackupIndex_)
+{
+    filename = filename_;
+    rowGroupSize = (std::max)(rowGroupSize_, 1u);
+    maxFileSize = maxFileSize_;
+    maxBackupIndex = (std::max)(maxBackupIndex_, 1);
+    fileSize = 0;
+    rows.reserve(rowGroupSize);
+
+    open();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SegmentAppender public methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+SegmentAppender::close()
+{
+    thread::MutexGuard guard (access_mutex);
+    if (closed)
+        return;
+
+    writeRowGroup();
+    out.close();
+    closed = true;
+}
+
+
+void
+SegmentAppender::flush()
+{
+    thread::MutexGuard guard (access_mutex);
+    writeRowGroup();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SegmentAppender protected methods
+///////////////////////////////////////////////////////////////////////////////
+
+// This method does not need to be locked since it is called by
+// doAppend() which performs the locking
+void
+SegmentAppender::append(const spi::InternalLoggingEvent& event)
+{
+    // The copy takes the NDC and the thread name of the logging thread.
+    rows.push_back(event);
+    if(rows.size() >= rowGroupSize) {
+        writeRowGroup();
+    }
+}
+
+
+void
+SegmentAppender::open()
+{
+    out.open(LOG4CPLUS_FSTREAM_PREFERED_FILE_NAME(filename).c_str(),
+        std::ios::out | std::ios::binary | std::ios::app);
+    if(!out.good()) {
+        getErrorHandler()->error(  LOG4CPLUS_TEXT("Unable to open file: ") 
+                                 + filename);
+        return;
+    }
+
+    out.seekp(0, std::ios::end);
+    fileSize = static_cast<long>(out.tellp());
+    if(fileSize == 0) {
+        out.write(internal::segment_magic, sizeof(internal::segment_magic));
+        out.flush();
+        fileSize = sizeof(internal::segment_magic);
+    }
+    getLogLog().debug(LOG4CPLUS_TEXT("Just opened file: ") + filename);
+}
+
+
+void
+SegmentAppender::writeRowGroup()
+{
+    if(rows.empty()) {
+        return;
+    }
+    if(!out.good()) {
+        getErrorHandler()->error(  LOG4CPLUS_TEXT("file is not open: ") 
+                                 + filename);
+        rows.clear();
+        return;
+    }
+
+    std::vector<spi::InternalLoggingEvent>::const_iterator it;
+    helpers::time_t minSec = rows.front().getTimestamp().sec();
+    helpers::time_t maxSec = minSec;
+    LogLevel minLevel = rows.front().getLogLevel();
+    LogLevel maxLevel = minLevel;
+    for(it = rows.begin(); it != rows.end(); ++it) {
+        minSec = (std::min)(minSec, it->getTimestamp().sec());
+        maxSec = (std::max)(maxSec, it->getTimestamp().sec());
+        minLevel = (std::min)(minLevel, it->getLogLevel());
+        maxLevel = (std::max)(maxLevel, it->getLogLevel());
+    }
+
+    std::string& body = buffer;
+    body.clear();
+    put_varint(body, internal::SEGMENT_COLUMN_COUNT);
+
+    // Timestamps, as deltas from the previous row.
+    std::string column;
+    long prevSec = minSec;
+    long prevNsec = 0;
+    for(it = rows.begin(); it != rows.end(); ++it) {
+        long const sec = it->getTimestamp().sec();
+        long const nsec = it->getTimestamp().nsec();
+        put_svarint(column, sec - prevSec);
+        put_svarint(column, nsec - prevNsec);
+        prevSec = sec;
+        prevNsec = nsec;
+    }
+    append_column(body, column);
+
+    column.clear();
+    encode_levels(column, rows);
+    append_column(body, column);
+
+    string_getter const getters[] = {
+        &spi::InternalLoggingEvent::getLoggerName,
+        &spi::InternalLoggingEvent::getThread,
+        &spi::InternalLoggingEvent::getNDC,
+        &spi::InternalLoggingEvent::getFile
+    };
+    for(std::size_t i = 0; i != sizeof(getters) / sizeof(getters[0]); ++i) {
+        column.clear();
+        encode_dictionary(column, rows, getters[i]);
+        append_column(body, column);
+    }
+
+    column.clear();
+    for(it = rows.begin(); it != rows.end(); ++it) {
+        put_svarint(column, it->getLine());
+    }
+    append_column(body, column);
+
+    // Messages: the uncompressed size, then the compressed strings.
+    std::string messages;
+    for(it = rows.begin(); it != rows.end(); ++it) {
+        put_string(messages, it->getMessage());
+    }
+    column.clear();
+    put_varint(column, messages.size());
+    helpers::lzCompress(column, messages.data(), messages.size());
+    append_column(body, column);
+
+    column.clear();
+    for(it = rows.begin(); it != rows.end(); ++it) {
+        encode_fields(column, it->getFields());
+    }
+    append_column(body, column);
+
+    std::string header(internal::row_group_marker,
+        sizeof(internal::row_group_marker));
+    put_varint(header, rows.size());
+    put_varint(header, static_cast<unsigned long>(minLevel));
+    put_varint(header, static_cast<unsigned long>(maxLevel));
+    put_svarint(header, minSec);
+    put_varint(header, static_cast<unsigned long>(maxSec - minSec));
+    put_varint(header, body.size());
+
+    out.write(header.data(), header.size());
+    out.write(body.data(), body.size());
+    out.flush();
+    rows.clear();
+    if(!out.good()) {
+        getErrorHandler()->error(  LOG4CPLUS_TEXT("Unable to write to file: ") 
+                                 + filename);
+        return;
+    }
+
+    fileSize += static_cast<long>(header.size() + body.size());
+    if(fileSize >= maxFileSize) {
+        rollover();
+    }
+}
+
+
+void
+SegmentAppender::rollover()
+{
+    out.close();
+    out.clear();
+    internal::roll_file(filename, maxBackupIndex);
+    open();
+}
+
+
+} // namespace log4cplus
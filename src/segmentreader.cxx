@@ -0,0 +1,390 @@
+// Module:  Log4CPLUS
+// File:    segmentreader.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <log4cplus/segmentappender.h>
+#include <log4cplus/fstreams.h>
+#include <log4cplus/helpers/lzcodec.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/internal/segment.h>
+#include <cstring>
+
+
+namespace log4cplus
+{
+
+using internal::get_varint;
+using internal::get_svarint;
+using internal::get_string;
+
+
+namespace
+{
+
+//! Reads a varint from the stream, for the row group headers.
+static
+bool
+read_varint (std::istream & in, unsigned long & value)
+{
+    value = 0;
+    for (unsigned shift = 0; shift < sizeof (value) * 8; shift += 7)
+    {
+        int const ch = in.get ();
+        if (ch == std::char_traits<char>::eof ())
+            return false;
+
+        value |= static_cast<unsigned long>(ch & 0x7F) << shift;
+        if (! (ch & 0x80))
+            return true;
+    }
+    return false;
+}
+
+
+struct column
+{
+    char const * begin;
+    char const * end;
+};
+
+
+static
+bool
+decode_dictionary (column col, unsigned long rows,
+    std::vector<tstring> & values)
+{
+    unsigned long count;
+    if (! get_varint (col.begin, col.end, count)
+        || count > static_cast<unsigned long>(col.end - col.begin))
+        return false;
+
+    std::vector<tstring> dictionary (count);
+    for (unsigned long i = 0; i != count; ++i)
+        if (! get_string (col.begin, col.end, dictionary[i]))
+            return false;
+
+    values.resize (rows);
+    for (unsigned long i = 0; i != rows; ++i)
+    {
+        unsigned long index;
+        if (! get_varint (col.begin, col.end, index) || index >= count)
+            return false;
+
+        values[i] = dictionary[index];
+    }
+    return true;
+}
+
+
+static
+bool
+decode_fields (char const * & p, char const * end, spi::EventFields & fields)
+{
+    unsigned long count;
+    if (! get_varint (p, end, count))
+        return false;
+
+    for (unsigned long i = 0; i != count; ++i)
+    {
+        tstring key;
+        if (! get_string (p, end, key) || p == end)
+            return false;
+
+        switch (static_cast<unsigned char>(*p++))
+        {
+        case spi::EventField::INTEGER_FIELD:
+        {
+            long value;
+            if (! get_svarint (p, end, value))
+                return false;
+            fields.add (spi::EventField (key, value));
+            break;
+        }
+
+        case spi::EventField::UNSIGNED_FIELD:
+        {
+            unsigned long value;
+            if (! get_varint (p, end, value))
+                return false;
+            fields.add (spi::EventField (key, value));
+            break;
+        }
+
+        case spi::EventField::DOUBLE_FIELD:
+        {
+            double value;
+            if (! internal::get_double (p, end, value))
+                return false;
+            fields.add (spi::EventField (key, value));
+            break;
+        }
+
+        case spi::EventField::STRING_FIELD:
+        {
+            tstring value;
+            if (! get_string (p, end, value))
+                return false;
+            fields.add (spi::EventField (key, value));
+            break;
+        }
+
+        case spi::EventField::BOOL_FIELD:
+            if (p == end)
+                return false;
+            fields.add (spi::EventField (key, *p++ != 0));
+            break;
+
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SegmentReader ctors and dtor
+///////////////////////////////////////////////////////////////////////////////
+
+SegmentReader::SegmentReader(const tstring& filename)
+: in(LOG4CPLUS_FSTREAM_PREFERED_FILE_NAME(filename).c_str(),
+     std::ios::in | std::ios::binary),
+  valid(false),
+  damaged(false),
+  timeFilter(false),
+  minLogLevel(NOT_SET_LOG_LEVEL),
+  skippedRowGroups(0)
+{
+    char magic[sizeof(internal::segment_magic)];
+    in.read(magic, sizeof(magic));
+    valid = in.gcount() == static_cast<std::streamsize>(sizeof(magic))
+        && std::memcmp(magic, internal::segment_magic, sizeof(magic)) == 0;
+}
+
+
+SegmentReader::~SegmentReader()
+{
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SegmentReader public methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+SegmentReader::setTimeRange(const helpers::Time& from_,
+                            const helpers::Time& to_)
+{
+    from = from_;
+    to = to_;
+    timeFilter = true;
+}
+
+
+bool
+SegmentReader::readRowGroup(std::vector<spi::InternalLoggingEvent>& events)
+{
+    while(valid && !damaged) {
+        char marker[sizeof(internal::row_group_marker)];
+        in.read(marker, sizeof(marker));
+        if(in.gcount() == 0 && in.eof()) {
+            return false;
+        }
+
+        unsigned long rowCount, minLevel, maxLevel, minSecCode, secSpan;
+        unsigned long bodySize;
+        if(in.gcount() != static_cast<std::streamsize>(sizeof(marker))
+           || std::memcmp(marker, internal::row_group_marker, sizeof(marker)) != 0
+           || !read_varint(in, rowCount)
+           || !read_varint(in, minLevel)
+           || !read_varint(in, maxLevel)
+           || !read_varint(in, minSecCode)
+           || !read_varint(in, secSpan)
+           || !read_varint(in, bodySize)
+           || rowCount > bodySize) {
+            damaged = true;
+            return false;
+        }
+        long const minSec = internal::unzigzag(minSecCode);
+        long const maxSec = minSec + static_cast<long>(secSpan);
+
+        if(static_cast<LogLevel>(maxLevel) < minLogLevel
+           || (timeFilter && (maxSec < from.sec() || minSec > to.sec()))) {
+            in.seekg(static_cast<std::streamoff>(bodySize), std::ios::cur);
+            ++skippedRowGroups;
+            continue;
+        }
+
+        body.resize(bodySize);
+        if(bodySize != 0) {
+            in.read(&body[0], static_cast<std::streamsize>(bodySize));
+        }
+        if(in.gcount() != static_cast<std::streamsize>(bodySize)
+           || !decodeRowGroup(rowCount, minSec, events)) {
+            damaged = true;
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SegmentReader protected methods
+///////////////////////////////////////////////////////////////////////////////
+
+bool
+SegmentReader::decodeRowGroup(unsigned long rowCount, long minSec,
+                              std::vector<spi::InternalLoggingEvent>& events)
+{
+    char const* p = body.data();
+    char const* const end = p + body.size();
+
+    unsigned long columnCount;
+    if(!get_varint(p, end, columnCount)
+       || columnCount < internal::SEGMENT_COLUMN_COUNT) {
+        return false;
+    }
+
+    column columns[internal::SEGMENT_COLUMN_COUNT];
+    for(unsigned long i = 0; i != columnCount; ++i) {
+        unsigned long size;
+        if(!get_varint(p, end, size)
+           || size > static_cast<unsigned long>(end - p)) {
+            return false;
+        }
+        if(i < internal::SEGMENT_COLUMN_COUNT) {
+            columns[i].begin = p;
+            columns[i].end = p + size;
+        }
+        p += size;
+    }
+
+    std::vector<helpers::Time> times(rowCount);
+    column col = columns[internal::TIME_COLUMN];
+    long sec = minSec;
+    long nsec = 0;
+    for(unsigned long i = 0; i != rowCount; ++i) {
+        long secDelta, nsecDelta;
+        if(!get_svarint(col.begin, col.end, secDelta)
+           || !get_svarint(col.begin, col.end, nsecDelta)) {
+            return false;
+        }
+        sec += secDelta;
+        nsec += nsecDelta;
+        times[i] = helpers::Time(sec, 0);
+        times[i].nsec(nsec);
+    }
+
+    col = columns[internal::LEVEL_COLUMN];
+    unsigned long levelCount;
+    if(!get_varint(col.begin, col.end, levelCount)
+       || levelCount > static_cast<unsigned long>(col.end - col.begin)) {
+        return false;
+    }
+    std::vector<LogLevel> levelDictionary(levelCount);
+    for(unsigned long i = 0; i != levelCount; ++i) {
+        unsigned long level;
+        if(!get_varint(col.begin, col.end, level)) {
+            return false;
+        }
+        levelDictionary[i] = static_cast<LogLevel>(level);
+    }
+    std::vector<LogLevel> levels(rowCount);
+    for(unsigned long i = 0; i != rowCount; ++i) {
+        unsigned long index;
+        if(!get_varint(col.begin, col.end, index) || index >= levelCount) {
+            return false;
+        }
+        levels[i] = levelDictionary[index];
+    }
+
+    std::vector<tstring> loggers, threads, ndcs, files;
+    if(!decode_dictionary(columns[internal::LOGGER_COLUMN], rowCount, loggers)
+       || !decode_dictionary(columns[internal::THREAD_COLUMN], rowCount, threads)
+       || !decode_dictionary(columns[internal::NDC_COLUMN], rowCount, ndcs)
+       || !decode_dictionary(columns[internal::FILE_COLUMN], rowCount, files)) {
+        return false;
+    }
+
+    col = columns[internal::LINE_COLUMN];
+    std::vector<long> lines(rowCount);
+    for(unsigned long i = 0; i != rowCount; ++i) {
+        if(!get_svarint(col.begin, col.end, lines[i])) {
+            return false;
+        }
+    }
+
+    // Compressed messages.  A block of the compressed data expands to
+    // at most about 255 times its size, which bounds the allocation for
+    // damaged input.
+    col = columns[internal::MESSAGE_COLUMN];
+    unsigned long rawSize;
+    if(!get_varint(col.begin, col.end, rawSize)
+       || rawSize / 256 > static_cast<unsigned long>(col.end - col.begin)) {
+        return false;
+    }
+    std::string messages;
+    if(!helpers::lzDecompress(messages, col.begin, col.end - col.begin,
+                              rawSize)) {
+        return false;
+    }
+    char const* mp = messages.data();
+    char const* const mend = mp + messages.size();
+
+    col = columns[internal::FIELDS_COLUMN];
+    for(unsigned long i = 0; i != rowCount; ++i) {
+        tstring message;
+        spi::EventFields fields;
+        if(!get_string(mp, mend, message)
+           || !decode_fields(col.begin, col.end, fields)) {
+            return false;
+        }
+
+        spi::InternalLoggingEvent event(loggers[i], levels[i], ndcs[i],
+            message, threads[i], times[i], files[i],
+            static_cast<int>(lines[i]));
+        if(!fields.empty()) {
+            event.setFields(fields);
+        }
+        if(matches(event)) {
+            events.push_back(event);
+        }
+    }
+    return true;
+}
+
+
+bool
+SegmentReader::matches(const spi::InternalLoggingEvent& event) const
+{
+    if(event.getLogLevel() < minLogLevel) {
+        return false;
+    }
+    return !timeFilter
+        || (from <= event.getTimestamp() && event.getTimestamp() <= to);
+}
+
+
+} // namespace log4cplus
@@ -0,0 +1,334 @@
+// Module:  Log4CPLUS
+// File:    sharedmemoryappender.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <log4cplus/sharedmemoryappender.h>
+#include <log4cplus/socketappender.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/socketbuffer.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/internal/shmring.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#if defined (LOG4CPLUS_HAVE_SHM_RING)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+
+namespace log4cplus
+{
+
+using internal::ShmRingHeader;
+
+
+namespace
+{
+
+//! Parses a size with an optional <tt>KB</tt> or <tt>MB</tt> suffix, as
+//! RollingFileAppender's MaxFileSize.  Returns false for negative or
+//! malformed values; values too large for unsigned long saturate.
+static
+bool
+parse_size(tstring const & text, unsigned long & size)
+{
+    std::string const str
+        = LOG4CPLUS_TSTRING_TO_STRING(helpers::toUpper(text));
+    std::string::size_type const first = str.find_first_not_of(" \t");
+    if(first == std::string::npos || str[first] == '-')
+        return false;
+
+    char const * const begin = str.c_str() + first;
+    char * end = 0;
+    errno = 0;
+    unsigned long value = std::strtoul(begin, &end, 10);
+    if(end == begin)
+        return false;
+
+    std::string suffix(end);
+    suffix.erase(0, suffix.find_first_not_of(" \t"));
+    unsigned long unit = 1;
+    if(suffix == "MB")
+        unit = 1024 * 1024;
+    else if(suffix == "KB")
+        unit = 1024;
+    else if(! suffix.empty())
+        return false;
+
+    unsigned long const max_value = (std::numeric_limits<unsigned long>::max)();
+    if(errno == ERANGE || value > max_value / unit)
+        value = max_value;
+    else
+        value *= unit;
+    size = value;
+    return true;
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SharedMemoryAppender ctors and dtor
+///////////////////////////////////////////////////////////////////////////////
+
+SharedMemoryAppender::SharedMemoryAppender(const tstring& prefix_,
+    unsigned long ringSize_, bool hugePages_)
+: prefix(prefix_),
+  ringSize(ringSize_),
+  hugePages(hugePages_),
+  ring(0),
+  data(0)
+{
+    init();
+}
+
+
+SharedMemoryAppender::SharedMemoryAppender(const helpers::Properties& properties)
+: Appender(properties),
+  prefix(LOG4CPLUS_TEXT("/log4cplus-")),
+  ringSize(4 * 1024 * 1024),
+  hugePages(false),
+  ring(0),
+  data(0)
+{
+    if(properties.exists( LOG4CPLUS_TEXT("Prefix") )) {
+        prefix = properties.getProperty( LOG4CPLUS_TEXT("Prefix") );
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("RingSize") )) {
+        tstring const tmp = properties.getProperty( LOG4CPLUS_TEXT("RingSize") );
+        if(! parse_size(tmp, ringSize)) {
+            helpers::getLogLog().warn(
+                LOG4CPLUS_TEXT("SharedMemoryAppender: invalid RingSize \"")
+                + tmp + LOG4CPLUS_TEXT("\", using ")
+                + helpers::convertIntegerToString(ringSize));
+        }
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("HugePages") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("HugePages") );
+        hugePages = (helpers::toLower(tmp) == LOG4CPLUS_TEXT("true"));
+    }
+    serverName = properties.getProperty( LOG4CPLUS_TEXT("ServerName") );
+
+    init();
+}
+
+
+SharedMemoryAppender::~SharedMemoryAppender()
+{
+    destructorImpl();
+}
+
+
+void
+SharedMemoryAppender::init()
+{
+    // The ring size is a power of two, so that positions wrap around
+    // at 2^32 in step with it.
+    unsigned long size = internal::shm_ring_min_size;
+    while(size < ringSize && size < internal::shm_ring_max_size) {
+        size *= 2;
+    }
+    if(size != ringSize) {
+        helpers::getLogLog().debug(
+            LOG4CPLUS_TEXT("SharedMemoryAppender: RingSize ")
+            + helpers::convertIntegerToString(ringSize)
+            + LOG4CPLUS_TEXT(" rounded to ")
+            + helpers::convertIntegerToString(size));
+    }
+    ringSize = size;
+
+    openRing();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SharedMemoryAppender public methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+SharedMemoryAppender::close()
+{
+    log4cplus::thread::MutexGuard guard (access_mutex);
+
+    closeRing(true);
+    closed = true;
+}
+
+
+void
+SharedMemoryAppender::atforkChild()
+{
+    Appender::atforkChild();
+
+    // The mapping is shared with the parent, which keeps using it.
+    closeRing(false);
+    if(! closed) {
+        openRing();
+    }
+}
+
+
+unsigned long
+SharedMemoryAppender::getDroppedCount() const
+{
+    return ring ? ring->dropped : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SharedMemoryAppender protected methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+SharedMemoryAppender::openRing()
+{
+#if defined (LOG4CPLUS_HAVE_SHM_RING)
+    std::ostringstream oss;
+    oss << LOG4CPLUS_TSTRING_TO_STRING(prefix) << getpid();
+    ringName = oss.str();
+    tstring const ring_name = LOG4CPLUS_STRING_TO_TSTRING(ringName);
+
+    // A ring left behind by an earlier process with the same id is
+    // replaced.
+    shm_unlink(ringName.c_str());
+    int const fd = shm_open(ringName.c_str(), O_CREAT | O_EXCL | O_RDWR,
+        0600);
+    if(fd == -1) {
+        getErrorHandler()->error(
+            LOG4CPLUS_TEXT("Unable to create shared memory ring: ") + ring_name);
+        return;
+    }
+
+    std::size_t const total = sizeof(ShmRingHeader) + ringSize;
+    void* addr = MAP_FAILED;
+    if(ftruncate(fd, static_cast<off_t>(total)) == 0) {
+        int flags = MAP_SHARED;
+#  if defined (MAP_POPULATE)
+        // Fault the pages in now rather than on the logging path.
+        flags |= MAP_POPULATE;
+#  endif
+        addr = mmap(0, total, PROT_READ | PROT_WRITE, flags, fd, 0);
+    }
+    ::close(fd);
+    if(addr == MAP_FAILED) {
+        shm_unlink(ringName.c_str());
+        getErrorHandler()->error(
+            LOG4CPLUS_TEXT("Unable to map shared memory ring: ") + ring_name);
+        return;
+    }
+
+#  if defined (MADV_HUGEPAGE)
+    if(hugePages) {
+        madvise(addr, total, MADV_HUGEPAGE);
+    }
+#  endif
+
+    ring = static_cast<ShmRingHeader*>(addr);
+    data = static_cast<char*>(addr) + sizeof(ShmRingHeader);
+    ring->capacity = static_cast<unsigned>(ringSize);
+    ring->pid = static_cast<unsigned>(getpid());
+
+    // The collector only attaches to rings with a complete header.
+    internal::shm_ring_barrier();
+    std::memcpy(ring->magic, internal::shm_ring_magic, sizeof(ring->magic));
+
+    getLogLog().debug(LOG4CPLUS_TEXT("Created shared memory ring ") + ring_name);
+
+#else
+    getErrorHandler()->error(LOG4CPLUS_TEXT("SharedMemoryAppender is not")
+        LOG4CPLUS_TEXT(" supported on this platform"));
+
+#endif
+}
+
+
+void
+SharedMemoryAppender::closeRing(bool markClosed)
+{
+    if(! ring) {
+        return;
+    }
+
+    if(markClosed) {
+        internal::shm_ring_barrier();
+        ring->closed = 1;
+    }
+
+#if defined (LOG4CPLUS_HAVE_SHM_RING)
+    munmap(ring, sizeof(ShmRingHeader) + ringSize);
+#endif
+    ring = 0;
+    data = 0;
+}
+
+
+// This method does not need to be locked since it is called by
+// doAppend() which performs the locking
+void
+SharedMemoryAppender::append(const spi::InternalLoggingEvent& event)
+{
+    if(! ring) {
+        return;
+    }
+
+    helpers::SocketBuffer buffer(LOG4CPLUS_MAX_MESSAGE_SIZE - sizeof(unsigned int));
+    helpers::convertToBuffer(buffer, event, serverName);
+
+    unsigned const size = static_cast<unsigned>(buffer.getSize());
+    unsigned const frame = internal::shm_ring_align(
+        static_cast<unsigned>(sizeof(unsigned)) + size);
+    unsigned const capacity = ring->capacity;
+    unsigned const head = ring->head;
+    unsigned const tail = ring->tail;
+    // Do not write into space the collector may still be reading.
+    internal::shm_ring_barrier();
+
+    unsigned const offset = head & (capacity - 1);
+    unsigned const contiguous = capacity - offset;
+    unsigned const needed = frame <= contiguous ? frame : contiguous + frame;
+    if(capacity - (head - tail) < needed) {
+        ring->dropped = ring->dropped + 1;
+        return;
+    }
+
+    unsigned pos = offset;
+    if(frame > contiguous) {
+        std::memcpy(data + offset, &internal::shm_ring_wrap,
+            sizeof(internal::shm_ring_wrap));
+        pos = 0;
+    }
+    std::memcpy(data + pos, &size, sizeof(size));
+    std::memcpy(data + pos + sizeof(size), buffer.getBuffer(), size);
+
+    // Publish the frame only after its bytes.
+    internal::shm_ring_barrier();
+    ring->head = head + needed;
+}
+
+
+} // namespace log4cplus
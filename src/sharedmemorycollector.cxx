@@ -0,0 +1,299 @@
+// Module:  Log4CPLUS
+// File:    sharedmemorycollector.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <log4cplus/sharedmemoryappender.h>
+#include <log4cplus/logger.h>
+#include <log4cplus/socketappender.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/socketbuffer.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/internal/shmring.h>
+#include <cstring>
+
+#if defined (LOG4CPLUS_HAVE_SHM_RING)
+#  include <cerrno>
+#  include <dirent.h>
+#  include <fcntl.h>
+#  include <signal.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+
+namespace log4cplus
+{
+
+using internal::ShmRingHeader;
+
+
+namespace
+{
+
+#if defined (LOG4CPLUS_HAVE_SHM_RING)
+//! Returns true if the process that created a ring has exited.
+static
+bool
+producer_exited (ShmRingHeader const * header)
+{
+    return kill(static_cast<pid_t>(header->pid), 0) == -1 && errno == ESRCH;
+}
+#endif
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SharedMemoryCollector ctors and dtor
+///////////////////////////////////////////////////////////////////////////////
+
+SharedMemoryCollector::SharedMemoryCollector(const tstring& prefix_)
+: prefix(LOG4CPLUS_TSTRING_TO_STRING(prefix_))
+{
+    rescan();
+}
+
+
+SharedMemoryCollector::~SharedMemoryCollector()
+{
+    for(std::vector<Ring>::iterator it = rings.begin(); it != rings.end();
+        ++it)
+    {
+        detach(*it, false);
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SharedMemoryCollector public methods
+///////////////////////////////////////////////////////////////////////////////
+
+void
+SharedMemoryCollector::rescan()
+{
+#if defined (LOG4CPLUS_HAVE_SHM_RING) && defined (__linux__)
+    // Shared memory objects are the files of /dev/shm on Linux.
+    std::string const base = prefix.substr(
+        ! prefix.empty() && prefix[0] == '/' ? 1 : 0);
+    DIR* dir = opendir("/dev/shm");
+    if(! dir) {
+        return;
+    }
+
+    while(struct dirent const* entry = readdir(dir)) {
+        std::string const name = entry->d_name;
+        if(name.compare(0, base.size(), base) != 0) {
+            continue;
+        }
+
+        std::string const shmName = "/" + name;
+        std::vector<Ring>::const_iterator it = rings.begin();
+        while(it != rings.end() && it->name != shmName) {
+            ++it;
+        }
+        if(it == rings.end()) {
+            attach(shmName);
+        }
+    }
+    closedir(dir);
+#endif
+}
+
+
+std::size_t
+SharedMemoryCollector::drain()
+{
+    std::size_t count = 0;
+    for(std::size_t i = 0; i < rings.size(); ) {
+        Ring& ring = rings[i];
+
+        // Look at the state before draining, so that the events
+        // written before the producer finished are not left behind.
+        bool finished = ring.header->closed != 0;
+#if defined (LOG4CPLUS_HAVE_SHM_RING)
+        finished = finished || producer_exited(ring.header);
+#endif
+        internal::shm_ring_barrier();
+
+        count += drainRing(ring);
+        if(finished) {
+            detach(ring, true);
+            rings.erase(rings.begin() + i);
+        }
+        else {
+            ++i;
+        }
+    }
+    return count;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SharedMemoryCollector protected methods
+///////////////////////////////////////////////////////////////////////////////
+
+bool
+SharedMemoryCollector::attach(const std::string& name)
+{
+#if defined (LOG4CPLUS_HAVE_SHM_RING)
+    int const fd = shm_open(name.c_str(), O_RDWR, 0);
+    if(fd == -1) {
+        return false;
+    }
+
+    struct stat st;
+    void* addr = MAP_FAILED;
+    if(fstat(fd, &st) == 0
+       && st.st_size >= static_cast<off_t>(sizeof(ShmRingHeader)))
+    {
+        addr = mmap(0, static_cast<std::size_t>(st.st_size),
+            PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if(addr == MAP_FAILED) {
+        return false;
+    }
+
+    Ring ring;
+    ring.name = name;
+    ring.header = static_cast<ShmRingHeader*>(addr);
+    ring.data = static_cast<char*>(addr) + sizeof(ShmRingHeader);
+    ring.mappedSize = static_cast<std::size_t>(st.st_size);
+
+    // The producer may still be setting the ring up; a later rescan()
+    // attaches to it then.
+    if(std::memcmp(ring.header->magic, internal::shm_ring_magic,
+           sizeof(ring.header->magic)) != 0)
+    {
+        munmap(addr, ring.mappedSize);
+        return false;
+    }
+    internal::shm_ring_barrier();
+
+    unsigned const capacity = ring.header->capacity;
+    if(capacity == 0 || (capacity & (capacity - 1)) != 0
+       || sizeof(ShmRingHeader) + capacity > ring.mappedSize)
+    {
+        munmap(addr, ring.mappedSize);
+        helpers::getLogLog().warn(
+            LOG4CPLUS_TEXT("Invalid shared memory ring: ")
+            + LOG4CPLUS_STRING_TO_TSTRING(name));
+        return false;
+    }
+
+    ring.dropped = ring.header->dropped;
+    rings.push_back(ring);
+    helpers::getLogLog().debug(
+        LOG4CPLUS_TEXT("Attached to shared memory ring ")
+        + LOG4CPLUS_STRING_TO_TSTRING(name));
+    return true;
+
+#else
+    (void) name;
+    return false;
+
+#endif
+}
+
+
+std::size_t
+SharedMemoryCollector::drainRing(Ring& ring)
+{
+    ShmRingHeader* const header = ring.header;
+    unsigned const capacity = header->capacity;
+    unsigned const head = header->head;
+    unsigned tail = header->tail;
+    // Read the frames only after their publication.
+    internal::shm_ring_barrier();
+
+    std::size_t count = 0;
+    while(tail != head) {
+        unsigned const offset = tail & (capacity - 1);
+        unsigned size;
+        std::memcpy(&size, ring.data + offset, sizeof(size));
+        if(size == internal::shm_ring_wrap) {
+            tail += capacity - offset;
+            continue;
+        }
+
+        unsigned const frame = internal::shm_ring_align(
+            static_cast<unsigned>(sizeof(size)) + size);
+        if(size == 0 || frame > capacity - offset || frame > head - tail) {
+            helpers::getLogLog().error(
+                LOG4CPLUS_TEXT("Damaged shared memory ring: ")
+                + LOG4CPLUS_STRING_TO_TSTRING(ring.name));
+            tail = head;
+            break;
+        }
+
+        helpers::SocketBuffer buffer(size);
+        std::memcpy(buffer.getBuffer(), ring.data + offset + sizeof(size),
+            size);
+        buffer.setSize(size);
+        spi::InternalLoggingEvent event = helpers::readFromBuffer(buffer);
+
+        // Hand the space back before the appenders run.
+        tail += frame;
+        internal::shm_ring_barrier();
+        header->tail = tail;
+
+        Logger logger = Logger::getInstance(event.getLoggerName());
+        logger.callAppenders(event);
+        ++count;
+    }
+    internal::shm_ring_barrier();
+    header->tail = tail;
+
+    unsigned const dropped = header->dropped;
+    if(dropped != ring.dropped) {
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT("Shared memory ring ")
+            << LOG4CPLUS_STRING_TO_TSTRING(ring.name)
+            << LOG4CPLUS_TEXT(" dropped ") << (dropped - ring.dropped)
+            << LOG4CPLUS_TEXT(" events");
+        helpers::getLogLog().warn(oss.str());
+        ring.dropped = dropped;
+    }
+
+    return count;
+}
+
+
+void
+SharedMemoryCollector::detach(Ring& ring, bool remove)
+{
+#if defined (LOG4CPLUS_HAVE_SHM_RING)
+    munmap(ring.header, ring.mappedSize);
+    if(remove) {
+        shm_unlink(ring.name.c_str());
+        helpers::getLogLog().debug(
+            LOG4CPLUS_TEXT("Removed shared memory ring ")
+            + LOG4CPLUS_STRING_TO_TSTRING(ring.name));
+    }
+#else
+    (void) ring;
+    (void) remove;
+#endif
+}
+
+
+} // namespace log4cplus
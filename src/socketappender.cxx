@@ -19,6 +19,7 @@
 // limitations under the License.
 
 #include <cstdlib>
+#include <cstring>
 #include <log4cplus/socketappender.h>
 #include <log4cplus/layout.h>
 #include <log4cplus/helpers/loglog.h>
@@ -26,7 +27,7 @@
 #include <log4cplus/helpers/sleep.h>
 
 
-int const LOG4CPLUS_MESSAGE_VERSION = 2;
+int const LOG4CPLUS_MESSAGE_VERSION = 4;
 
 
 namespace log4cplus
@@ -118,6 +119,14 @@ SocketAppender::ConnectorThread::trigger ()
     trigger_ev.signal ();
 }
 
+
+void
+SocketAppender::ConnectorThread::reinitialize ()
+{
+    access_mutex.reinitialize ();
+    trigger_ev.reinitialize ();
+}
+
 #endif
 
 
@@ -183,6 +192,32 @@ SocketAppender::close()
 }
 
 
+void
+SocketAppender::atforkChild()
+{
+    Appender::atforkChild();
+
+    // The parent keeps the connection; closing the inherited descriptor
+    // does not shut it down.
+    socket.close();
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    // The connector thread of the parent does not exist here.
+    connector->reinitialize ();
+    if (closed)
+        return;
+
+    openSocket();
+    initConnector ();
+
+#else
+    if (! closed)
+        openSocket();
+
+#endif
+}
+
+
 
 //////////////////////////////////////////////////////////////////////////////
 // SocketAppender protected methods
@@ -254,12 +289,174 @@ SocketAppender::append(const spi::InternalLoggingEvent& event)
 namespace helpers
 {
 
+namespace
+{
+
+//! Doubles go over the wire as their IEEE 754 bits, high word first.
+static
+void
+double_to_words(double value, unsigned int & hi, unsigned int & lo)
+{
+    unsigned int words[2];
+    std::memcpy(words, &value, sizeof(words));
+    unsigned int const one = 1;
+    bool const little_endian = *reinterpret_cast<unsigned char const *>(&one) == 1;
+    hi = words[little_endian ? 1 : 0];
+    lo = words[little_endian ? 0 : 1];
+}
+
+
+static
+double
+words_to_double(unsigned int hi, unsigned int lo)
+{
+    unsigned int const one = 1;
+    bool const little_endian = *reinterpret_cast<unsigned char const *>(&one) == 1;
+    unsigned int words[2];
+    words[little_endian ? 1 : 0] = hi;
+    words[little_endian ? 0 : 1] = lo;
+    double value;
+    std::memcpy(&value, words, sizeof(value));
+    return value;
+}
+
+
+static
+void
+appendFields(SocketBuffer & buffer, spi::EventFields const & fields)
+{
+    buffer.appendInt(static_cast<unsigned int>(fields.size()));
+    for(spi::EventFields::const_iterator it = fields.begin();
+        it != fields.end(); ++it)
+    {
+        buffer.appendString(it->getKey());
+        buffer.appendByte(static_cast<unsigned char>(it->getType()));
+        switch(it->getType())
+        {
+        case spi::EventField::INTEGER_FIELD:
+        {
+            // Integers are sent as 64 bits, high word first.
+            long const value = it->getInteger();
+            buffer.appendInt(static_cast<unsigned int>((value >> 16) >> 16));
+            buffer.appendInt(static_cast<unsigned int>(value & 0xFFFFFFFFul));
+            break;
+        }
+
+        case spi::EventField::UNSIGNED_FIELD:
+        {
+            unsigned long const value = it->getUnsigned();
+            buffer.appendInt(static_cast<unsigned int>((value >> 16) >> 16));
+            buffer.appendInt(static_cast<unsigned int>(value & 0xFFFFFFFFul));
+            break;
+        }
+
+        case spi::EventField::DOUBLE_FIELD:
+        {
+            unsigned int hi, lo;
+            double_to_words(it->getDouble(), hi, lo);
+            buffer.appendInt(hi);
+            buffer.appendInt(lo);
+            break;
+        }
+
+        case spi::EventField::STRING_FIELD:
+            buffer.appendString(it->getString());
+            break;
+
+        case spi::EventField::BOOL_FIELD:
+            buffer.appendByte(it->getBool() ? 1 : 0);
+            break;
+        }
+    }
+}
+
+
+//! Bytes of the smallest field on the wire: the key length, the type
+//! and a bool value.
+static std::size_t const MIN_FIELD_SIZE = 4 + 1 + 1;
+
+
+static
+spi::EventFields
+readFields(SocketBuffer & buffer, unsigned char sizeOfChar)
+{
+    spi::EventFields fields;
+    unsigned int const count = buffer.readInt();
+    std::size_t const remaining = buffer.getMaxSize() - buffer.getPos();
+    if(count > remaining / MIN_FIELD_SIZE) {
+        getLogLog().warn(LOG4CPLUS_TEXT("readFromBuffer() received more event fields than the message can hold"));
+        return fields;
+    }
+
+    for(unsigned int i = 0; i < count; ++i)
+    {
+        if(buffer.getMaxSize() - buffer.getPos() < MIN_FIELD_SIZE) {
+            getLogLog().warn(LOG4CPLUS_TEXT("readFromBuffer() received a truncated event field"));
+            return fields;
+        }
+
+        tstring key = buffer.readString(sizeOfChar);
+        unsigned char const type = buffer.readByte();
+        switch(type)
+        {
+        case spi::EventField::INTEGER_FIELD:
+        {
+            unsigned long const hi = buffer.readInt();
+            unsigned long const lo = buffer.readInt();
+            fields.add(spi::EventField(key,
+                static_cast<long>(((hi << 16) << 16) | lo)));
+            break;
+        }
+
+        case spi::EventField::UNSIGNED_FIELD:
+        {
+            unsigned long const hi = buffer.readInt();
+            unsigned long const lo = buffer.readInt();
+            fields.add(spi::EventField(key, ((hi << 16) << 16) | lo));
+            break;
+        }
+
+        case spi::EventField::DOUBLE_FIELD:
+        {
+            unsigned int const hi = buffer.readInt();
+            unsigned int const lo = buffer.readInt();
+            fields.add(spi::EventField(key, words_to_double(hi, lo)));
+            break;
+        }
+
+        case spi::EventField::STRING_FIELD:
+            fields.add(spi::EventField(key, buffer.readString(sizeOfChar)));
+            break;
+
+        case spi::EventField::BOOL_FIELD:
+            fields.add(spi::EventField(key, buffer.readByte() != 0));
+            break;
+
+        default:
+            getLogLog().warn(LOG4CPLUS_TEXT("readFromBuffer() received an event field of unknown type"));
+            return fields;
+        }
+    }
+    return fields;
+}
+
+} // namespace
+
+
 void
 convertToBuffer(SocketBuffer & buffer,
     const spi::InternalLoggingEvent& event,
     const tstring& serverName)
 {
-    buffer.appendByte(LOG4CPLUS_MESSAGE_VERSION);
+    // Send the oldest version that carries the event, so that readers
+    // of version 2 keep working as long as the newer parts are unused.
+    unsigned const nsec
+        = static_cast<unsigned>(event.getTimestamp().nsec() % 1000);
+    unsigned char const version = ! event.getFields().empty() ? 4
+        : nsec != 0 ? 3
+        : 2;
+
+    buffer.appendByte(version);
 #ifndef UNICODE
     buffer.appendByte(1);
 #else
@@ -276,6 +473,12 @@ convertToBuffer(SocketBuffer & buffer,
     buffer.appendInt( static_cast<unsigned int>(event.getTimestamp().usec()) );
     buffer.appendString(event.getFile());
     buffer.appendInt(event.getLine());
+    // Version 3: nanoseconds beyond the microseconds sent above.
+    if(version >= 3)
+        buffer.appendInt(nsec);
+    // Version 4: the typed event fields.
+    if(version >= 4)
+        appendFields(buffer, event.getFields());
 }
 
 
@@ -283,7 +486,7 @@ spi::InternalLoggingEvent
 readFromBuffer(SocketBuffer& buffer)
 {
     unsigned char msgVersion = buffer.readByte();
-    if(msgVersion != LOG4CPLUS_MESSAGE_VERSION) {
+    if(msgVersion > LOG4CPLUS_MESSAGE_VERSION || msgVersion < 2) {
         log4cplus::helpers::SharedObjectPtr<helpers::LogLog> loglog
             = LogLog::getLogLog();
         loglog->warn(LOG4CPLUS_TEXT("readFromBuffer() received socket message with an invalid version"));
@@ -310,14 +513,29 @@ readFromBuffer(SocketBuffer& buffer)
     tstring file = buffer.readString(sizeOfChar);
     int line = buffer.readInt();
 
-    return spi::InternalLoggingEvent(loggerName,
-                                                ll,
-                                                ndc,
-                                                message,
-                                                thread,
-                                                Time(sec, usec),
-                                                file,
-                                                line);
+    Time timestamp(sec, usec);
+    if(msgVersion >= 3) {
+        // Only the nanoseconds below the microseconds are sent; anything
+        // else would carry into the microseconds, so it is dropped.
+        unsigned int const nsec = buffer.readInt();
+        if(nsec < 1000)
+            timestamp.nsec(timestamp.nsec() + static_cast<long>(nsec));
+        else
+            getLogLog().warn(LOG4CPLUS_TEXT("readFromBuffer() received an invalid sub-microsecond timestamp part"));
+    }
+
+    spi::InternalLoggingEvent event(loggerName,
+                                    ll,
+                                    ndc,
+                                    message,
+                                    thread,
+                                    timestamp,
+                                    file,
+                                    line);
+    if(msgVersion >= 4)
+        event.setFields(readFields(buffer, sizeOfChar));
+
+    return event;
 }
 
 } // namespace helpers
@@ -0,0 +1,535 @@
+// Module:  Log4CPLUS
+// File:    socketpoolappender.cxx
+// Created: 10/2026
+//
+//
+// Copyright 2026 log4cplus contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <log4cplus/socketpoolappender.h>
+#include <log4cplus/socketappender.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/helpers/socketbuffer.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/spi/loggingevent.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+
+
+namespace log4cplus
+{
+
+
+namespace
+{
+
+static int const DEFAULT_PORT = 9998;
+
+
+//! FNV-1a over the characters of str, with a final avalanche step so
+//! that similar keys land far apart on the ring.
+static
+unsigned long
+hash_key (tstring const & str)
+{
+    unsigned long h = 2166136261UL;
+    for (tstring::const_iterator it = str.begin (); it != str.end (); ++it)
+    {
+        unsigned long ch = static_cast<unsigned long>(*it);
+        do
+        {
+            h = ((h ^ (ch & 0xFF)) * 16777619UL) & 0xFFFFFFFFUL;
+            ch >>= 8;
+        }
+        while (ch != 0);
+    }
+
+    h ^= h >> 16;
+    h = (h * 0x85EBCA6BUL) & 0xFFFFFFFFUL;
+    h ^= h >> 13;
+    h = (h * 0xC2B2AE35UL) & 0xFFFFFFFFUL;
+    h ^= h >> 16;
+    return h;
+}
+
+
+static
+tstring
+trim (tstring const & str)
+{
+    tstring::size_type const first
+        = str.find_first_not_of (LOG4CPLUS_TEXT (" \t"));
+    if (first == tstring::npos)
+        return tstring ();
+
+    tstring::size_type const last
+        = str.find_last_not_of (LOG4CPLUS_TEXT (" \t"));
+    return str.substr (first, last - first + 1);
+}
+
+
+static
+tstring
+endpoint_name (SocketPoolAppender::EndpointStats const & stats)
+{
+    return stats.host + LOG4CPLUS_TEXT (":")
+        + helpers::convertIntegerToString (stats.port);
+}
+
+} // namespace
+
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+SocketPoolAppender::ConnectorThread::ConnectorThread (
+    SocketPoolAppender & appender)
+    : spa (appender)
+    , exit_flag (false)
+{ }
+
+
+SocketPoolAppender::ConnectorThread::~ConnectorThread ()
+{ }
+
+
+void
+SocketPoolAppender::ConnectorThread::run ()
+{
+    long wait = spa.retryDelay;
+    while (true)
+    {
+        trigger_ev.timed_wait (wait);
+
+        {
+            log4cplus::thread::MutexGuard guard (access_mutex);
+            if (exit_flag)
+                return;
+            trigger_ev.reset ();
+        }
+
+        wait = spa.reconnect ();
+    }
+}
+
+
+void
+SocketPoolAppender::ConnectorThread::terminate ()
+{
+    {
+        log4cplus::thread::MutexGuard guard (access_mutex);
+        exit_flag = true;
+        trigger_ev.signal ();
+    }
+    join ();
+}
+
+
+void
+SocketPoolAppender::ConnectorThread::trigger ()
+{
+    trigger_ev.signal ();
+}
+
+
+void
+SocketPoolAppender::ConnectorThread::reinitialize ()
+{
+    access_mutex.reinitialize ();
+    trigger_ev.reinitialize ();
+}
+
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////////
+// SocketPoolAppender ctors and dtor
+//////////////////////////////////////////////////////////////////////////////
+
+SocketPoolAppender::SocketPoolAppender(const tstring& servers,
+    const tstring& serverName_)
+: virtualNodes(64),
+  retryDelay(5000),
+  maxLatency(0),
+  serverName(serverName_),
+  droppedCount(0)
+{
+    init(servers);
+}
+
+
+
+SocketPoolAppender::SocketPoolAppender(const helpers::Properties & properties)
+ : Appender(properties),
+   virtualNodes(64),
+   retryDelay(5000),
+   maxLatency(0),
+   droppedCount(0)
+{
+    hashKey = properties.getProperty( LOG4CPLUS_TEXT("HashKey") );
+    if(properties.exists( LOG4CPLUS_TEXT("VirtualNodes") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("VirtualNodes") );
+        int const nodes = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+        virtualNodes = nodes > 0 ? static_cast<unsigned>(nodes) : 1;
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("RetryDelay") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("RetryDelay") );
+        long const delay = std::atol(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+        retryDelay = delay > 0 ? delay : 1;
+    }
+    if(properties.exists( LOG4CPLUS_TEXT("MaxLatency") )) {
+        tstring tmp = properties.getProperty( LOG4CPLUS_TEXT("MaxLatency") );
+        long const latency = std::atol(LOG4CPLUS_TSTRING_TO_STRING(tmp).c_str());
+        maxLatency = latency > 0 ? static_cast<unsigned long>(latency) : 0;
+    }
+    serverName = properties.getProperty( LOG4CPLUS_TEXT("ServerName") );
+
+    init(properties.getProperty( LOG4CPLUS_TEXT("Servers") ));
+}
+
+
+
+SocketPoolAppender::~SocketPoolAppender()
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    connector->terminate ();
+#endif
+
+    destructorImpl();
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+// SocketPoolAppender public methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+SocketPoolAppender::close()
+{
+    getLogLog().debug(LOG4CPLUS_TEXT("Entering SocketPoolAppender::close()..."));
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    connector->terminate ();
+#endif
+
+    for(std::vector<Endpoint>::iterator it = endpoints.begin();
+        it != endpoints.end(); ++it)
+    {
+        it->socket.close();
+    }
+    closed = true;
+}
+
+
+std::vector<SocketPoolAppender::EndpointStats>
+SocketPoolAppender::getEndpointStats()
+{
+    std::vector<EndpointStats> stats;
+    thread::MutexGuard guard(access_mutex);
+    stats.reserve(endpoints.size());
+    for(std::vector<Endpoint>::const_iterator it = endpoints.begin();
+        it != endpoints.end(); ++it)
+    {
+        stats.push_back(it->stats);
+    }
+    return stats;
+}
+
+
+unsigned long
+SocketPoolAppender::getDroppedCount()
+{
+    thread::MutexGuard guard(access_mutex);
+    return droppedCount;
+}
+
+
+void
+SocketPoolAppender::atforkChild()
+{
+    Appender::atforkChild();
+
+    // The parent keeps the connections; closing the inherited
+    // descriptors does not shut them down.
+    for(std::vector<Endpoint>::iterator it = endpoints.begin();
+        it != endpoints.end(); ++it)
+    {
+        it->socket.close();
+    }
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    // The connector thread of the parent does not exist here.
+    connector->reinitialize ();
+    if (closed)
+        return;
+
+    openSockets();
+    initConnector ();
+
+#else
+    if (! closed)
+        openSockets();
+
+#endif
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+// SocketPoolAppender protected methods
+//////////////////////////////////////////////////////////////////////////////
+
+void
+SocketPoolAppender::init(const tstring& servers)
+{
+    std::vector<tstring> names;
+    helpers::tokenize(servers, LOG4CPLUS_TEXT(','),
+        std::back_inserter(names));
+
+    for(std::vector<tstring>::const_iterator it = names.begin();
+        it != names.end(); ++it)
+    {
+        tstring const server = trim(*it);
+        if(server.empty()) {
+            continue;
+        }
+
+        Endpoint endpoint;
+        endpoint.stats.host = server;
+        endpoint.stats.port = DEFAULT_PORT;
+        tstring::size_type const colon = server.rfind(LOG4CPLUS_TEXT(':'));
+        if(colon != tstring::npos) {
+            endpoint.stats.host = server.substr(0, colon);
+            tstring const port = server.substr(colon + 1);
+            endpoint.stats.port
+                = std::atoi(LOG4CPLUS_TSTRING_TO_STRING(port).c_str());
+        }
+        endpoint.stats.healthy = false;
+        endpoint.stats.sent = 0;
+        endpoint.stats.failures = 0;
+        endpoint.stats.failovers = 0;
+        endpoint.stats.avgLatency = 0;
+        endpoint.stats.maxLatency = 0;
+        endpoints.push_back(endpoint);
+    }
+
+    if(endpoints.empty()) {
+        getLogLog().error(LOG4CPLUS_TEXT("SocketPoolAppender: no servers configured"));
+    }
+
+    ring.reserve(endpoints.size() * virtualNodes);
+    for(std::size_t i = 0; i != endpoints.size(); ++i) {
+        tstring const key = endpoint_name(endpoints[i].stats)
+            + LOG4CPLUS_TEXT("#");
+        for(unsigned node = 0; node != virtualNodes; ++node) {
+            ring.push_back(std::make_pair(
+                hash_key(key + helpers::convertIntegerToString(node)), i));
+        }
+    }
+    std::sort(ring.begin(), ring.end());
+
+    openSockets();
+    initConnector ();
+}
+
+
+void
+SocketPoolAppender::openSockets()
+{
+    helpers::Time const now = helpers::Time::gettimeofday();
+    for(std::vector<Endpoint>::iterator it = endpoints.begin();
+        it != endpoints.end(); ++it)
+    {
+        it->socket = helpers::Socket(it->stats.host,
+            static_cast<unsigned short>(it->stats.port));
+        it->stats.healthy = it->socket.isOpen();
+        it->stats.avgLatency = 0;
+        if(! it->stats.healthy) {
+            ++it->stats.failures;
+            it->retryTime = now + helpers::Time(retryDelay / 1000,
+                (retryDelay % 1000) * 1000);
+            getLogLog().error(LOG4CPLUS_TEXT("SocketPoolAppender: cannot connect to ")
+                + endpoint_name(it->stats));
+        }
+    }
+}
+
+
+void
+SocketPoolAppender::initConnector ()
+{
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    connector = new ConnectorThread (*this);
+    connector->start ();
+#endif
+}
+
+
+void
+SocketPoolAppender::markFailed(std::size_t index, const tstring& reason)
+{
+    Endpoint& endpoint = endpoints[index];
+    endpoint.socket.close();
+    endpoint.stats.healthy = false;
+    ++endpoint.stats.failures;
+    endpoint.retryTime = helpers::Time::gettimeofday()
+        + helpers::Time(retryDelay / 1000, (retryDelay % 1000) * 1000);
+
+    getLogLog().warn(LOG4CPLUS_TEXT("SocketPoolAppender: server ")
+        + endpoint_name(endpoint.stats) + LOG4CPLUS_TEXT(" ") + reason
+        + LOG4CPLUS_TEXT(", its events go to the next server"));
+
+#if ! defined (LOG4CPLUS_SINGLE_THREADED)
+    connector->trigger ();
+#endif
+}
+
+
+long
+SocketPoolAppender::reconnect()
+{
+    helpers::Time const now = helpers::Time::gettimeofday();
+    std::vector<std::size_t> due;
+    {
+        thread::MutexGuard guard(access_mutex);
+        for(std::size_t i = 0; i != endpoints.size(); ++i) {
+            if(! endpoints[i].stats.healthy && endpoints[i].retryTime <= now) {
+                due.push_back(i);
+            }
+        }
+    }
+
+    // Connecting may take a while, so it is done without holding the
+    // lock.  The host and port of a server do not change.
+    for(std::vector<std::size_t>::const_iterator it = due.begin();
+        it != due.end(); ++it)
+    {
+        Endpoint& endpoint = endpoints[*it];
+        helpers::Socket socket(endpoint.stats.host,
+            static_cast<unsigned short>(endpoint.stats.port));
+
+        thread::MutexGuard guard(access_mutex);
+        if(closed) {
+            return retryDelay;
+        }
+        if(socket.isOpen()) {
+            endpoint.socket = socket;
+            endpoint.stats.healthy = true;
+            endpoint.stats.avgLatency = 0;
+            getLogLog().debug(LOG4CPLUS_TEXT("SocketPoolAppender: reconnected to ")
+                + endpoint_name(endpoint.stats));
+        }
+        else {
+            ++endpoint.stats.failures;
+            endpoint.retryTime = now + helpers::Time(retryDelay / 1000,
+                (retryDelay % 1000) * 1000);
+        }
+    }
+
+    long wait = retryDelay;
+    thread::MutexGuard guard(access_mutex);
+    for(std::vector<Endpoint>::const_iterator it = endpoints.begin();
+        it != endpoints.end(); ++it)
+    {
+        if(! it->stats.healthy && now < it->retryTime) {
+            helpers::Time const left = it->retryTime - now;
+            wait = (std::min)(wait,
+                static_cast<long>(left.sec() * 1000 + left.usec() / 1000 + 1));
+        }
+    }
+    return wait;
+}
+
+
+void
+SocketPoolAppender::append(const spi::InternalLoggingEvent& event)
+{
+    if(ring.empty()) {
+        return;
+    }
+
+#if defined (LOG4CPLUS_SINGLE_THREADED)
+    reconnect();
+
+#endif
+
+    helpers::SocketBuffer buffer(LOG4CPLUS_MAX_MESSAGE_SIZE - sizeof(unsigned int));
+    helpers::convertToBuffer(buffer, event, serverName);
+    helpers::SocketBuffer msgBuffer(LOG4CPLUS_MAX_MESSAGE_SIZE);
+
+    msgBuffer.appendInt(static_cast<unsigned>(buffer.getSize()));
+    msgBuffer.appendBuffer(buffer);
+
+    unsigned long hash;
+    spi::EventField const * field
+        = hashKey.empty() ? 0 : event.getFields().find(hashKey);
+    if(field) {
+        tstring value;
+        field->appendValue(value);
+        hash = hash_key(value);
+    }
+    else {
+        hash = hash_key(event.getLoggerName());
+    }
+
+    // Walk the ring clockwise from the key until a healthy server takes
+    // the event.  Failed servers are marked, so each is tried once.
+    Ring::const_iterator point = std::lower_bound(ring.begin(), ring.end(),
+        std::make_pair(hash, static_cast<std::size_t>(0)));
+    bool primary = true;
+    for(std::size_t n = 0; n != ring.size(); ++n, ++point) {
+        if(point == ring.end()) {
+            point = ring.begin();
+        }
+
+        Endpoint& endpoint = endpoints[point->second];
+        if(! endpoint.stats.healthy) {
+            primary = false;
+            continue;
+        }
+
+        helpers::Time const start = helpers::Time::gettimeofday();
+        if(! endpoint.socket.write(msgBuffer)) {
+            markFailed(point->second, LOG4CPLUS_TEXT("failed"));
+            primary = false;
+            continue;
+        }
+        helpers::Time const spent = helpers::Time::gettimeofday() - start;
+
+        unsigned long const latency = spent.sec() < 0 ? 0
+            : static_cast<unsigned long>(spent.sec() * 1000000 + spent.usec());
+        endpoint.stats.avgLatency
+            = (endpoint.stats.avgLatency * 7 + latency) / 8;
+        endpoint.stats.maxLatency
+            = (std::max)(endpoint.stats.maxLatency, latency);
+        ++endpoint.stats.sent;
+        if(! primary) {
+            ++endpoint.stats.failovers;
+        }
+
+        if(maxLatency != 0 && endpoint.stats.avgLatency > maxLatency * 1000) {
+            markFailed(point->second, LOG4CPLUS_TEXT("is too slow"));
+        }
+        return;
+    }
+
+    ++droppedCount;
+    getErrorHandler()->error(LOG4CPLUS_TEXT("SocketPoolAppender: no healthy server, events are dropped"));
+}
+
+
+} // namespace log4cplus
@@ -29,12 +29,22 @@
 #include <cwchar>
 #include <cwctype>
 #include <cctype>
+#include <cmath>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
 
 #ifdef UNICODE
 #  include <cassert>
 #  include <vector>
 #endif
 
+#if defined (__SSE2__) || defined (_M_X64) \
+    || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define LOG4CPLUS_HAVE_SSE2_TRANSCODER
+#  include <emmintrin.h>
+#endif
+
 
 namespace log4cplus { namespace internal {
 
@@ -352,6 +362,516 @@ log4cplus::helpers::towstring(char const * src)
 #endif // UNICODE
 
 
+//////////////////////////////////////////////////////////////////////////////
+// Number formatting
+//////////////////////////////////////////////////////////////////////////////
+
+#define LOG4CPLUS_DIGIT_PAIRS(X) \
+    LOG4CPLUS_TEXT (X "0" X "1" X "2" X "3" X "4" X "5" X "6" X "7" X "8" X "9")
+
+log4cplus::tchar const log4cplus::helpers::digitPairs[201]
+    = LOG4CPLUS_DIGIT_PAIRS ("0") LOG4CPLUS_DIGIT_PAIRS ("1")
+    LOG4CPLUS_DIGIT_PAIRS ("2") LOG4CPLUS_DIGIT_PAIRS ("3")
+    LOG4CPLUS_DIGIT_PAIRS ("4") LOG4CPLUS_DIGIT_PAIRS ("5")
+    LOG4CPLUS_DIGIT_PAIRS ("6") LOG4CPLUS_DIGIT_PAIRS ("7")
+    LOG4CPLUS_DIGIT_PAIRS ("8") LOG4CPLUS_DIGIT_PAIRS ("9");
+
+#undef LOG4CPLUS_DIGIT_PAIRS
+
+
+std::size_t
+log4cplus::helpers::convertDoubleToChars (tchar * buf, double value)
+{
+    char tmp[64];
+    std::size_t len;
+
+    if (value != value)
+        len = std::strlen (std::strcpy (tmp, "nan"));
+    else if (value > (std::numeric_limits<double>::max) ())
+        len = std::strlen (std::strcpy (tmp, "inf"));
+    else if (value < -(std::numeric_limits<double>::max) ())
+        len = std::strlen (std::strcpy (tmp, "-inf"));
+    else if (value == std::floor (value) && std::fabs (value) < 1e15
+        && (value != 0 || 1 / value > 0))
+    {
+        // Integral values that fit into a long on every platform.
+        tchar * const buf_end = buf + DOUBLE_CHARS_BUFFER_SIZE;
+        tchar * it;
+        if (std::fabs (value) < 2147483648.0)
+            it = convertIntegerToChars (buf_end, static_cast<long>(value));
+        else
+        {
+            // Split into two parts, both of which fit into a long.
+            double const high = std::floor (std::fabs (value) / 1e9);
+            long const low = static_cast<long>(std::fabs (value) - high * 1e9);
+            it = convertIntegerToChars (buf_end, low);
+            while (buf_end - it < 9)
+                *--it = LOG4CPLUS_TEXT ('0');
+            it = convertIntegerToChars (it, static_cast<long>(high));
+            if (value < 0)
+                *--it = LOG4CPLUS_TEXT ('-');
+        }
+
+        len = buf_end - it;
+        std::copy (static_cast<tchar const *>(it),
+            static_cast<tchar const *>(buf_end), buf);
+        return len;
+    }
+    else
+    {
+        // Any decimal of up to 15 significant digits survives a round
+        // trip through a normal double, so the correctly rounded 15
+        // digit form is the shortest one whenever that is not longer.
+        // Otherwise 16 or at most 17 digits are needed.  Subnormal
+        // values have fewer significant bits and are searched from 1.
+        int precision = std::fabs (value) < (std::numeric_limits<double>::min) ()
+            ? 1 : 15;
+        for (; ; ++precision)
+        {
+            std::sprintf (tmp, "%.*g", precision, value);
+            if (precision == 17 || std::strtod (tmp, 0) == value)
+                break;
+        }
+        len = std::strlen (tmp);
+
+        // sprintf() and strtod() use the locale's decimal point.
+        char const point = *std::localeconv ()->decimal_point;
+        if (point != '.')
+            std::replace (tmp, tmp + len, point, '.');
+    }
+
+    std::copy (tmp, tmp + len, buf);
+    return len;
+}
+
+
+void
+log4cplus::helpers::convertDoubleToString (tstring & str, double value)
+{
+    tchar buf[DOUBLE_CHARS_BUFFER_SIZE];
+    str.assign (buf, convertDoubleToChars (buf, value));
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// UTF-8 conversion
+//////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+static unsigned const REPLACEMENT_CHAR = 0xFFFD;
+
+
+//! Writes code point cp, which must be valid, as UTF-8 and returns the
+//! number of bytes written.
+static inline
+std::size_t
+put_utf8 (char * dst, unsigned cp)
+{
+    if (cp < 0x80)
+    {
+        dst[0] = static_cast<char>(cp);
+        return 1;
+    }
+    else if (cp < 0x800)
+    {
+        dst[0] = static_cast<char>(0xC0 | (cp >> 6));
+        dst[1] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    else if (cp < 0x10000)
+    {
+        dst[0] = static_cast<char>(0xE0 | (cp >> 12));
+        dst[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        dst[2] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    else
+    {
+        dst[0] = static_cast<char>(0xF0 | (cp >> 18));
+        dst[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        dst[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        dst[3] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 4;
+    }
+}
+
+
+#if defined (LOG4CPLUS_HAVE_SSE2_TRANSCODER)
+//! Converts 16 characters if all of them are ASCII.
+static inline
+bool
+ascii_block_to_utf8 (char * dst, wchar_t const * src)
+{
+    __m128i bytes;
+    if (sizeof (wchar_t) == 2)
+    {
+        __m128i const a = _mm_loadu_si128 (
+            reinterpret_cast<__m128i const *>(src));
+        __m128i const b = _mm_loadu_si128 (
+            reinterpret_cast<__m128i const *>(src + 8));
+        __m128i const high = _mm_and_si128 (_mm_or_si128 (a, b),
+            _mm_set1_epi16 (static_cast<short>(0xFF80)));
+        if (_mm_movemask_epi8 (_mm_cmpeq_epi16 (high,
+                _mm_setzero_si128 ())) != 0xFFFF)
+            return false;
+
+        bytes = _mm_packus_epi16 (a, b);
+    }
+    else
+    {
+        __m128i const a = _mm_loadu_si128 (
+            reinterpret_cast<__m128i const *>(src));
+        __m128i const b = _mm_loadu_si128 (
+            reinterpret_cast<__m128i const *>(src + 4));
+        __m128i const c = _mm_loadu_si128 (
+            reinterpret_cast<__m128i const *>(src + 8));
+        __m128i const d = _mm_loadu_si128 (
+            reinterpret_cast<__m128i const *>(src + 12));
+        __m128i const high = _mm_and_si128 (
+            _mm_or_si128 (_mm_or_si128 (a, b), _mm_or_si128 (c, d)),
+            _mm_set1_epi32 (~0x7F));
+        if (_mm_movemask_epi8 (_mm_cmpeq_epi32 (high,
+                _mm_setzero_si128 ())) != 0xFFFF)
+            return false;
+
+        bytes = _mm_packus_epi16 (_mm_packs_epi32 (a, b),
+            _mm_packs_epi32 (c, d));
+    }
+
+    _mm_storeu_si128 (reinterpret_cast<__m128i *>(dst), bytes);
+    return true;
+}
+#endif
+
+
+//! Converts as much of [src, src_end) to UTF-8 as fits into
+//! [dst, dst_end).  A high surrogate at the end of the input is left
+//! unconverted unless <code>final</code> is set.  Returns true when the
+//! whole input has been consumed.
+static
+bool
+encode_utf8 (wchar_t const * & src, wchar_t const * src_end, char * & dst,
+    char * dst_end, bool final)
+{
+    while (src != src_end)
+    {
+#if defined (LOG4CPLUS_HAVE_SSE2_TRANSCODER)
+        while (src_end - src >= 16 && dst_end - dst >= 16
+            && ascii_block_to_utf8 (dst, src))
+        {
+            src += 16;
+            dst += 16;
+        }
+
+        if (src == src_end)
+            break;
+#endif
+
+        unsigned cp = static_cast<unsigned>(src[0]);
+        if (sizeof (wchar_t) == 2)
+            cp &= 0xFFFF;
+        std::size_t consumed = 1;
+
+        if (cp < 0x80)
+        {
+            if (dst == dst_end)
+                return false;
+
+            *dst++ = static_cast<char>(cp);
+            ++src;
+            continue;
+        }
+
+        if (cp >= 0xD800 && cp < 0xDC00 && sizeof (wchar_t) == 2)
+        {
+            if (src_end - src < 2)
+            {
+                if (! final)
+                    return false;
+
+                cp = REPLACEMENT_CHAR;
+            }
+            else
+            {
+                unsigned const low = static_cast<unsigned>(src[1]) & 0xFFFF;
+                if (low >= 0xDC00 && low < 0xE000)
+                {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    consumed = 2;
+                }
+                else
+                    cp = REPLACEMENT_CHAR;
+            }
+        }
+        else if ((cp >= 0xD800 && cp < 0xE000) || cp > 0x10FFFF)
+            cp = REPLACEMENT_CHAR;
+
+        char tmp[4];
+        std::size_t const len = put_utf8 (tmp, cp);
+        if (static_cast<std::size_t>(dst_end - dst) < len)
+            return false;
+
+        std::memcpy (dst, tmp, len);
+        dst += len;
+        src += consumed;
+    }
+
+    return true;
+}
+
+
+//! Decodes one UTF-8 sequence.  Returns the number of bytes used, 0
+//! when the input ends within the sequence.  Malformed sequences
+//! decode to U+FFFD.
+static
+std::size_t
+decode_utf8 (unsigned & cp, char const * src, char const * src_end)
+{
+    unsigned char const lead = static_cast<unsigned char>(*src);
+    std::size_t len;
+    unsigned min;
+    if (lead < 0x80)
+    {
+        cp = lead;
+        return 1;
+    }
+    else if (lead >= 0xC2 && lead < 0xE0)
+    {
+        len = 2;
+        min = 0x80;
+        cp = lead & 0x1F;
+    }
+    else if (lead >= 0xE0 && lead < 0xF0)
+    {
+        len = 3;
+        min = 0x800;
+        cp = lead & 0x0F;
+    }
+    else if (lead >= 0xF0 && lead < 0xF5)
+    {
+        len = 4;
+        min = 0x10000;
+        cp = lead & 0x07;
+    }
+    else
+    {
+        cp = REPLACEMENT_CHAR;
+        return 1;
+    }
+
+    for (std::size_t i = 1; i != len; ++i)
+    {
+        if (src + i == src_end)
+            return 0;
+
+        unsigned char const cont = static_cast<unsigned char>(src[i]);
+        if ((cont & 0xC0) != 0x80)
+        {
+            cp = REPLACEMENT_CHAR;
+            return i;
+        }
+
+        cp = (cp << 6) | (cont & 0x3F);
+    }
+
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp < 0xE000))
+        cp = REPLACEMENT_CHAR;
+
+    return len;
+}
+
+
+class utf8_codecvt
+    : public std::codecvt<wchar_t, char, std::mbstate_t>
+{
+public:
+    explicit utf8_codecvt (std::size_t refs = 0)
+        : std::codecvt<wchar_t, char, std::mbstate_t> (refs)
+    { }
+
+protected:
+    virtual
+    result
+    do_out (state_type &, intern_type const * from,
+        intern_type const * from_end, intern_type const * & from_next,
+        extern_type * to, extern_type * to_end, extern_type * & to_next)
+        const
+    {
+        from_next = from;
+        to_next = to;
+        encode_utf8 (from_next, from_end, to_next, to_end, false);
+        return from_next == from_end ? ok : partial;
+    }
+
+    virtual
+    result
+    do_in (state_type &, extern_type const * from,
+        extern_type const * from_end, extern_type const * & from_next,
+        intern_type * to, intern_type * to_end, intern_type * & to_next)
+        const
+    {
+        from_next = from;
+        to_next = to;
+        while (from_next != from_end && to_next != to_end)
+        {
+            unsigned cp;
+            std::size_t const len = decode_utf8 (cp, from_next, from_end);
+            if (len == 0)
+                break;
+
+            if (sizeof (wchar_t) == 2 && cp >= 0x10000)
+            {
+                if (to_end - to_next < 2)
+                    break;
+
+                cp -= 0x10000;
+                *to_next++ = static_cast<intern_type>(0xD800 + (cp >> 10));
+                *to_next++ = static_cast<intern_type>(0xDC00 + (cp & 0x3FF));
+            }
+            else
+                *to_next++ = static_cast<intern_type>(cp);
+
+            from_next += len;
+        }
+
+        return from_next == from_end ? ok : partial;
+    }
+
+    virtual
+    result
+    do_unshift (state_type &, extern_type * to, extern_type *,
+        extern_type * & to_next) const
+    {
+        to_next = to;
+        return noconv;
+    }
+
+    virtual
+    int
+    do_encoding () const throw ()
+    {
+        return 0;
+    }
+
+    virtual
+    bool
+    do_always_noconv () const throw ()
+    {
+        return false;
+    }
+
+    virtual
+    int
+    do_length (state_type &, extern_type const * from,
+        extern_type const * from_end, std::size_t max) const
+    {
+        extern_type const * it = from;
+        for (std::size_t count = 0; it != from_end && count < max; ++count)
+        {
+            unsigned cp;
+            std::size_t const len = decode_utf8 (cp, it, from_end);
+            if (len == 0
+                || (sizeof (wchar_t) == 2 && cp >= 0x10000
+                    && ++count == max))
+                break;
+
+            it += len;
+        }
+
+        return static_cast<int>(it - from);
+    }
+
+    virtual
+    int
+    do_max_length () const throw ()
+    {
+        return 4;
+    }
+};
+
+} // namespace
+
+
+void
+log4cplus::helpers::appendUTF8 (std::string & out, wchar_t const * src,
+    std::size_t size)
+{
+    if (size == 0)
+        return;
+
+    std::size_t pos = out.size ();
+    wchar_t const * const src_end = src + size;
+    // Sized for ASCII first; grown only when other characters show up.
+    std::size_t room = size;
+    for (;;)
+    {
+        out.resize (pos + room);
+        char * const dst_begin = &out[0] + pos;
+        char * dst = dst_begin;
+        bool const done = encode_utf8 (src, src_end, dst, dst_begin + room,
+            true);
+        pos += dst - dst_begin;
+        if (done)
+            break;
+
+        room = (src_end - src) * 3 + 4;
+    }
+
+    out.resize (pos);
+}
+
+
+std::string
+log4cplus::helpers::toUTF8 (const std::wstring& src)
+{
+    std::string ret;
+    appendUTF8 (ret, src.data (), src.size ());
+    return ret;
+}
+
+
+std::wstring
+log4cplus::helpers::fromUTF8 (char const * src, std::size_t size)
+{
+    std::wstring ret;
+    ret.reserve (size);
+    char const * const src_end = src + size;
+    while (src != src_end)
+    {
+        unsigned cp;
+        std::size_t len = decode_utf8 (cp, src, src_end);
+        if (len == 0)
+        {
+            // Truncated sequence at the end of the input.
+            cp = REPLACEMENT_CHAR;
+            len = src_end - src;
+        }
+
+        if (sizeof (wchar_t) == 2 && cp >= 0x10000)
+        {
+            cp -= 0x10000;
+            ret += static_cast<wchar_t>(0xD800 + (cp >> 10));
+            ret += static_cast<wchar_t>(0xDC00 + (cp & 0x3FF));
+        }
+        else
+            ret += static_cast<wchar_t>(cp);
+
+        src += len;
+    }
+
+    return ret;
+}
+
+
+std::locale
+log4cplus::helpers::getUTF8Locale (std::locale const & loc)
+{
+    return std::locale (loc, new utf8_codecvt);
+}
+
+
 namespace
 {
 
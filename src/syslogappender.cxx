@@ -237,7 +237,7 @@ log4cplus::SysLogAppender::append(const spi::InternalLoggingEvent& event)
         log4cplus::tostringstream buf;
         layout->formatAndAppend(buf, event);
         ::syslog(facility | level, "%s",
-            LOG4CPLUS_TSTRING_TO_STRING(buf.str()).c_str());
+            LOG4CPLUS_TSTRING_TO_UTF8(buf.str()).c_str());
     }
 }
 
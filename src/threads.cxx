@@ -22,6 +22,8 @@
 
 #include <exception>
 #include <sstream>
+#include <fstream>
+#include <cstdlib>
 
 #ifdef LOG4CPLUS_HAVE_SYS_TYPES_H
 #include <sys/types.h>
@@ -373,6 +375,129 @@ namespace
 {
 
 
+#if defined (CPU_SETSIZE)
+static unsigned long const MAX_CPUS = CPU_SETSIZE;
+#else
+static unsigned long const MAX_CPUS = 1024;
+#endif
+
+
+//! Appends CPUs given in the kernel's "cpulist" format (e.g.
+//! "0-3,8") to <code>cpus</code>.  Numbers at or above MAX_CPUS are
+//! rejected, as no CPU set could hold them.
+static
+bool
+parse_cpu_list (std::vector<unsigned> & cpus, std::string const & list)
+{
+    char const * p = list.c_str ();
+    for (;;)
+    {
+        while (*p == ' ' || *p == '\t' || *p == '\n')
+            ++p;
+        if (! *p)
+            return true;
+        if (*p < '0' || *p > '9')
+            return false;
+
+        char * end = 0;
+        unsigned long const first = std::strtoul (p, &end, 10);
+        unsigned long last = first;
+        p = end;
+        if (*p == '-')
+        {
+            ++p;
+            if (*p < '0' || *p > '9')
+                return false;
+            last = std::strtoul (p, &end, 10);
+            p = end;
+            if (last < first)
+                return false;
+        }
+        if (last >= MAX_CPUS)
+            return false;
+
+        for (unsigned long cpu = first; cpu <= last; ++cpu)
+            cpus.push_back (static_cast<unsigned>(cpu));
+
+        while (*p == ' ' || *p == '\t' || *p == '\n')
+            ++p;
+        if (*p == ',')
+            ++p;
+        else if (*p)
+            return false;
+    }
+}
+
+
+#if defined (__linux__)
+static
+std::string
+read_first_line (std::string const & path)
+{
+    std::string line;
+    std::ifstream file (path.c_str ());
+    std::getline (file, line);
+    return line;
+}
+#endif
+
+
+static
+void
+apply_placement (ThreadPlacement const & placement)
+{
+    if (placement.empty ())
+        return;
+
+#if defined (LOG4CPLUS_USE_PTHREADS) && defined (__linux__) \
+    && defined (CPU_SET)
+    helpers::SharedObjectPtr<helpers::LogLog> loglog
+        = helpers::LogLog::getLogLog ();
+
+    std::vector<unsigned> cpus (placement.getCpus ());
+    int const node = placement.getNumaNode ();
+    if (node >= 0)
+    {
+        std::ostringstream path;
+        path << "/sys/devices/system/node/node" << node << "/cpulist";
+        std::string const list (read_first_line (path.str ()));
+        if (list.empty () || ! parse_cpu_list (cpus, list))
+        {
+            tostringstream oss;
+            oss << LOG4CPLUS_TEXT ("Cannot read CPUs of NUMA node ") << node;
+            loglog->warn (oss.str ());
+        }
+    }
+
+    cpu_set_t set;
+    CPU_ZERO (&set);
+    bool any = false;
+    for (std::vector<unsigned>::const_iterator it = cpus.begin ();
+         it != cpus.end (); ++it)
+        if (*it < CPU_SETSIZE)
+        {
+            CPU_SET (*it, &set);
+            any = true;
+        }
+
+    if (! any)
+    {
+        loglog->warn (LOG4CPLUS_TEXT ("Thread placement has no usable CPU"));
+        return;
+    }
+
+    int ret = pthread_setaffinity_np (pthread_self (), sizeof (set), &set);
+    if (ret != 0)
+    {
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT ("pthread_setaffinity_np() failed: ") << ret;
+        loglog->warn (oss.str ());
+    }
+
+#endif
+}
+
+
 class ThreadImpl
     : public impl::Thread
 {
@@ -388,6 +513,7 @@ public:
     void
     run ()
     {
+        apply_placement (placement);
         abs_thread->run ();
     }
 
@@ -397,14 +523,106 @@ public:
         abs_thread = at;
     }
 
+    void
+    set_placement (ThreadPlacement const & p)
+    {
+        placement = p;
+    }
+
 protected:
     AbstractThread * abs_thread;
+    ThreadPlacement placement;
 };
 
 
 } // namespace
 
 
+//
+//
+//
+
+ThreadPlacement::ThreadPlacement ()
+    : numaNode (-1)
+{ }
+
+
+bool
+ThreadPlacement::empty () const
+{
+    return cpus.empty () && numaNode < 0;
+}
+
+
+void
+ThreadPlacement::addCpu (unsigned cpu)
+{
+    cpus.push_back (cpu);
+}
+
+
+bool
+ThreadPlacement::addCpuList (log4cplus::tstring const & list)
+{
+    std::vector<unsigned> parsed;
+    if (! parse_cpu_list (parsed, LOG4CPLUS_TSTRING_TO_STRING (list)))
+        return false;
+
+    cpus.insert (cpus.end (), parsed.begin (), parsed.end ());
+    return true;
+}
+
+
+std::vector<unsigned> const &
+ThreadPlacement::getCpus () const
+{
+    return cpus;
+}
+
+
+void
+ThreadPlacement::setNumaNode (int node)
+{
+    numaNode = node < 0 ? -1 : node;
+}
+
+
+int
+ThreadPlacement::getNumaNode () const
+{
+    return numaNode;
+}
+
+
+int
+getNumaNodeCount ()
+{
+#if defined (__linux__)
+    std::vector<unsigned> nodes;
+    std::string const list (
+        read_first_line ("/sys/devices/system/node/online"));
+    if (parse_cpu_list (nodes, list) && ! nodes.empty ())
+        return static_cast<int>(nodes.back ()) + 1;
+#endif
+
+    return 1;
+}
+
+
+int
+getCurrentNumaNode ()
+{
+#if defined (__linux__) && defined (SYS_getcpu)
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall (SYS_getcpu, &cpu, &node, 0) == 0)
+        return static_cast<int>(node);
+#endif
+
+    return -1;
+}
+
+
 //
 //
 //
@@ -426,7 +644,23 @@ AbstractThread::isRunning() const
 void
 AbstractThread::start()
 {
-    static_cast<ThreadImpl *>(thread.get ())->start ();
+    ThreadImpl * impl = static_cast<ThreadImpl *>(thread.get ());
+    impl->set_placement (placement);
+    impl->start ();
+}
+
+
+void
+AbstractThread::setPlacement (ThreadPlacement const & p)
+{
+    placement = p;
+}
+
+
+ThreadPlacement const &
+AbstractThread::getPlacement () const
+{
+    return placement;
 }
 
 
@@ -22,12 +22,16 @@
 #include <log4cplus/helpers/loglog.h>
 #include <log4cplus/streams.h>
 #include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/helpers/sleep.h>
+#include <log4cplus/internal/internal.h>
 
 #include <algorithm>
 #include <stdexcept>
 #include <vector>
 #include <iomanip>
 #include <cassert>
+#include <cstdlib>
+#include <ctime>
 #if ! defined (_WIN32_WCE)
 #include <cerrno>
 #endif
@@ -55,10 +59,17 @@
 #define LOG4CPLUS_NEED_LOCALTIME_R
 #endif
 
+#if defined (__GNUC__) && defined (__x86_64__) \
+    && defined (LOG4CPLUS_HAVE_CLOCK_GETTIME)
+#define LOG4CPLUS_HAVE_TSC_CLOCK
+#include <cpuid.h>
+#endif
+
 
 namespace log4cplus { namespace helpers {
 
 const int ONE_SEC_IN_USEC = 1000000;
+const long ONE_SEC_IN_NSEC = 1000000000L;
 
 
 #if defined (_WIN32_WCE)
@@ -91,22 +102,22 @@ using std::strftime;
 
 Time::Time()
 : tv_sec(0),
-  tv_usec(0)
+  tv_nsec(0)
 {
 }
 
 
 Time::Time(time_t tv_sec_, long tv_usec_)
 : tv_sec(tv_sec_),
-  tv_usec(tv_usec_)
+  tv_nsec(tv_usec_ * 1000)
 {
-    assert (tv_usec < ONE_SEC_IN_USEC);
+    assert (tv_usec_ < ONE_SEC_IN_USEC);
 }
 
 
 Time::Time(time_t time)
 : tv_sec(time),
-  tv_usec(0)
+  tv_nsec(0)
 {
 }
 
@@ -121,7 +132,9 @@ Time::gettimeofday()
     if (res != 0)
         throw std::runtime_error ("clock_gettime() has failed");
 
-    return Time (ts.tv_sec, ts.tv_nsec / 1000);
+    Time t (ts.tv_sec);
+    t.tv_nsec = ts.tv_nsec;
+    return t;
 #elif defined(LOG4CPLUS_HAVE_GETTIMEOFDAY)
     timeval tp;
     ::gettimeofday(&tp, 0);
@@ -139,6 +152,164 @@ Time::gettimeofday()
 }
 
 
+//////////////////////////////////////////////////////////////////////////////
+// Event clock
+//////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+static Time::EventClock event_clock = Time::REALTIME_CLOCK;
+
+
+#if defined (LOG4CPLUS_HAVE_TSC_CLOCK)
+//! TSC ticks per nanosecond, measured by calibrate_tsc().
+static double tsc_ticks_per_nsec;
+
+//! TSC ticks after which a thread reads the real time clock again.
+static unsigned long tsc_resync_ticks;
+
+
+static inline
+unsigned long
+read_tsc ()
+{
+    unsigned lo, hi;
+    __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+    return (static_cast<unsigned long>(hi) << 32) | lo;
+}
+
+
+//! Only an invariant TSC ticks at a constant rate, independent of
+//! frequency scaling and sleep states.
+static
+bool
+calibrate_tsc ()
+{
+    unsigned eax, ebx, ecx, edx;
+    if (! __get_cpuid (0x80000007, &eax, &ebx, &ecx, &edx)
+        || (edx & (1u << 8)) == 0)
+        return false;
+
+    Time const t0 = Time::gettimeofday ();
+    unsigned long const ticks0 = read_tsc ();
+    sleepmillis (20);
+    Time const t1 = Time::gettimeofday ();
+    unsigned long const ticks1 = read_tsc ();
+
+    Time const elapsed = t1 - t0;
+    double const nsecs = static_cast<double>(elapsed.sec ()) * ONE_SEC_IN_NSEC
+        + elapsed.nsec ();
+    if (nsecs <= 0 || ticks1 <= ticks0)
+        return false;
+
+    tsc_ticks_per_nsec = (ticks1 - ticks0) / nsecs;
+    tsc_resync_ticks = static_cast<unsigned long>(
+        tsc_ticks_per_nsec * ONE_SEC_IN_NSEC);
+    return true;
+}
+
+
+static
+Time
+tsc_time ()
+{
+    internal::per_thread_data * ptd = internal::get_ptd ();
+    unsigned long const elapsed = read_tsc () - ptd->tsc_anchor_ticks;
+    if (ptd->tsc_anchor_ticks == 0 || elapsed >= tsc_resync_ticks)
+    {
+        ptd->tsc_anchor_time = Time::gettimeofday ();
+        ptd->tsc_anchor_ticks = read_tsc ();
+        return ptd->tsc_anchor_time;
+    }
+
+    Time t (ptd->tsc_anchor_time);
+    long nsec = t.nsec () + static_cast<long>(elapsed / tsc_ticks_per_nsec);
+    if (nsec >= ONE_SEC_IN_NSEC)
+    {
+        t.sec (t.sec () + 1);
+        nsec -= ONE_SEC_IN_NSEC;
+    }
+    t.nsec (nsec);
+    return t;
+}
+
+#endif
+
+} // namespace
+
+
+bool
+Time::setEventClock (EventClock clock)
+{
+    switch (clock)
+    {
+    case COARSE_REALTIME_CLOCK:
+#if defined (LOG4CPLUS_HAVE_CLOCK_GETTIME) && defined (CLOCK_REALTIME_COARSE)
+        event_clock = clock;
+        return true;
+#else
+        break;
+#endif
+
+    case TSC_CLOCK:
+#if defined (LOG4CPLUS_HAVE_TSC_CLOCK)
+        if (calibrate_tsc ())
+        {
+            event_clock = clock;
+            return true;
+        }
+#endif
+        break;
+
+    default:
+        event_clock = REALTIME_CLOCK;
+        return clock == REALTIME_CLOCK;
+    }
+
+    event_clock = REALTIME_CLOCK;
+    return false;
+}
+
+
+Time::EventClock
+Time::getEventClock ()
+{
+    return event_clock;
+}
+
+
+Time
+Time::eventTime ()
+{
+    switch (event_clock)
+    {
+#if defined (LOG4CPLUS_HAVE_CLOCK_GETTIME) && defined (CLOCK_REALTIME_COARSE)
+    case COARSE_REALTIME_CLOCK:
+    {
+        struct timespec ts;
+        if (clock_gettime (CLOCK_REALTIME_COARSE, &ts) != 0)
+            break;
+
+        Time t (ts.tv_sec);
+        t.tv_nsec = ts.tv_nsec;
+        return t;
+    }
+#endif
+
+#if defined (LOG4CPLUS_HAVE_TSC_CLOCK)
+    case TSC_CLOCK:
+        return tsc_time ();
+#endif
+
+    default:
+        break;
+    }
+
+    return gettimeofday ();
+}
+
+
 //////////////////////////////////////////////////////////////////////////////
 // Time methods
 //////////////////////////////////////////////////////////////////////////////
@@ -161,10 +332,19 @@ Time::getTime() const
 }
 
 
+namespace
+{
+
+static time_t const SECS_PER_DAY = 86400;
+
+//! Span over which a local time offset is looked up at once.
+static time_t const TZ_CACHE_SPAN = 3600;
+
+
+static
 void
-Time::gmtime(tm* t) const
+libc_gmtime (time_t clock, tm * t)
 {
-    time_t clock = tv_sec;
 #ifdef LOG4CPLUS_NEED_GMTIME_R
     ::gmtime_r(&clock, t);
 #else
@@ -174,10 +354,10 @@ Time::gmtime(tm* t) const
 }
 
 
+static
 void
-Time::localtime(tm* t) const
+libc_localtime (time_t clock, tm * t)
 {
-    time_t clock = tv_sec;
 #ifdef LOG4CPLUS_NEED_LOCALTIME_R
     ::localtime_r(&clock, t);
 #else
@@ -187,6 +367,187 @@ Time::localtime(tm* t) const
 }
 
 
+//! Days since 1970-01-01 of the given proleptic Gregorian date, with
+//! month 1-12.
+static
+time_t
+days_from_civil (time_t y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    time_t const era = (y >= 0 ? y : y - 399) / 400;
+    unsigned const yoe = static_cast<unsigned>(y - era * 400);
+    unsigned const doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned const doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<time_t>(doe) - 719468;
+}
+
+
+//! Fills in the date and time fields of t from seconds since the
+//! Epoch, without consulting the C library.
+static
+void
+break_down (time_t clock, tm * t)
+{
+    time_t days = clock / SECS_PER_DAY;
+    time_t secs = clock % SECS_PER_DAY;
+    if (secs < 0)
+    {
+        secs += SECS_PER_DAY;
+        --days;
+    }
+
+    t->tm_hour = static_cast<int>(secs / 3600);
+    t->tm_min = static_cast<int>(secs / 60 % 60);
+    t->tm_sec = static_cast<int>(secs % 60);
+
+    // 1970-01-01 was a Thursday.
+    int wday = static_cast<int>((days + 4) % 7);
+    t->tm_wday = wday < 0 ? wday + 7 : wday;
+
+    time_t const z = days + 719468;
+    time_t const era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned const doe = static_cast<unsigned>(z - era * 146097);
+    unsigned const yoe
+        = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned const doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned const mp = (5 * doy + 2) / 153;
+    unsigned const d = doy - (153 * mp + 2) / 5 + 1;
+    unsigned const m = mp < 10 ? mp + 3 : mp - 9;
+    time_t const y = static_cast<time_t>(yoe) + era * 400 + (m <= 2);
+
+    t->tm_year = static_cast<int>(y - 1900);
+    t->tm_mon = static_cast<int>(m - 1);
+    t->tm_mday = static_cast<int>(d);
+    t->tm_yday = static_cast<int>(days - days_from_civil (y, 1, 1));
+}
+
+
+//! Local time offset of the C library at the given time.
+static
+long
+libc_offset (time_t clock, tm * t)
+{
+    libc_localtime (clock, t);
+    time_t const local = days_from_civil (t->tm_year + 1900,
+        t->tm_mon + 1, t->tm_mday) * SECS_PER_DAY
+        + t->tm_hour * 3600 + t->tm_min * 60 + t->tm_sec;
+    return static_cast<long>(local - clock);
+}
+
+
+//! Returns true if TZ is not what the cached offset was looked up
+//! with, so that the offset of another time zone is used at once.
+static
+bool
+tz_changed (internal::tz_cache const & cache, char const * tz)
+{
+    return (tz != 0) != cache.tz_set || (tz && cache.tz != tz);
+}
+
+
+//! Looks up the offset in effect at the given time and the range of
+//! time over which it holds.  Offsets change at most once within
+//! TZ_CACHE_SPAN, so when both ends of the span agree, the offset
+//! holds over all of it.  Otherwise the transition is found by
+//! bisection.  <code>tz</code> is the current value of the TZ
+//! environment variable.
+static
+void
+refresh_tz_cache (internal::tz_cache & cache, time_t clock, char const * tz)
+{
+    // localtime_r() does not have to notice a changed TZ, so let the C
+    // library read it first, as localtime() would.
+    if (tz_changed (cache, tz))
+    {
+#if defined (_WIN32)
+        _tzset ();
+#else
+        tzset ();
+#endif
+        cache.tz_set = tz != 0;
+        cache.tz = tz ? tz : "";
+    }
+
+    time_t from = clock - clock % TZ_CACHE_SPAN;
+    if (from > clock)
+        from -= TZ_CACHE_SPAN;
+    time_t until = from + TZ_CACHE_SPAN;
+
+    tm first;
+    long const first_offset = libc_offset (from, &first);
+    tm last;
+    long const last_offset = libc_offset (until - 1, &last);
+
+    if (first_offset != last_offset)
+    {
+        // Find the first second with the new offset.
+        time_t lo = from;
+        time_t hi = until - 1;
+        tm tmp;
+        while (hi - lo > 1)
+        {
+            time_t const mid = lo + (hi - lo) / 2;
+            if (libc_offset (mid, &tmp) == first_offset)
+                lo = mid;
+            else
+                hi = mid;
+        }
+
+        if (clock < hi)
+        {
+            until = hi;
+            cache.offset = first_offset;
+            cache.templ = first;
+        }
+        else
+        {
+            from = hi;
+            cache.offset = last_offset;
+            cache.templ = last;
+        }
+    }
+    else
+    {
+        cache.offset = first_offset;
+        cache.templ = first;
+    }
+
+    cache.from = from;
+    cache.until = until;
+}
+
+} // namespace
+
+
+void
+Time::gmtime(tm* t) const
+{
+    internal::per_thread_data * ptd = internal::get_ptd ();
+    if (! ptd->gmt_templ_valid)
+    {
+        libc_gmtime (0, &ptd->gmt_templ);
+        ptd->gmt_templ_valid = true;
+    }
+
+    *t = ptd->gmt_templ;
+    break_down (tv_sec, t);
+}
+
+
+void
+Time::localtime(tm* t) const
+{
+    internal::tz_cache & cache = internal::get_ptd ()->local_tz;
+    char const * const tz = std::getenv ("TZ");
+    if (tv_sec < cache.from || tv_sec >= cache.until
+        || tz_changed (cache, tz))
+        refresh_tz_cache (cache, tv_sec, tz);
+
+    *t = cache.templ;
+    break_down (tv_sec + cache.offset, t);
+}
+
+
 namespace 
 {
 
@@ -212,7 +573,7 @@ static log4cplus::tstring const uc_q_padding_zeros[4] =
 void
 Time::build_q_value (log4cplus::tstring & q_str) const
 {
-    q_str = convertIntegerToString(tv_usec / 1000);
+    q_str = convertIntegerToString(tv_nsec / 1000000);
     size_t const len = q_str.length();
     if (len <= 2)
         q_str.insert (0, padding_zeros[q_str.length()]);
@@ -224,7 +585,7 @@ Time::build_uc_q_value (log4cplus::tstring & uc_q_str) const
 {
     build_q_value (uc_q_str);
 
-    log4cplus::tstring usecs (convertIntegerToString(tv_usec % 1000));
+    log4cplus::tstring usecs (convertIntegerToString(tv_nsec / 1000 % 1000));
     size_t usecs_len = usecs.length();
     usecs.insert (0, usecs_len <= 3 
                   ? uc_q_padding_zeros[usecs_len] : uc_q_padding_zeros[3]);
@@ -232,6 +593,15 @@ Time::build_uc_q_value (log4cplus::tstring & uc_q_str) const
 }
 
 
+void
+Time::build_n_value (log4cplus::tstring & n_str) const
+{
+    n_str = convertIntegerToString(tv_nsec);
+    if (n_str.length () < 9)
+        n_str.insert (0, 9 - n_str.length (), LOG4CPLUS_TEXT ('0'));
+}
+
+
 log4cplus::tstring
 Time::getFormattedTime(const log4cplus::tstring& fmt_orig, bool use_gmtime) const
 {
@@ -265,7 +635,11 @@ Time::getFormattedTime(const log4cplus::tstring& fmt_orig, bool use_gmtime) cons
     log4cplus::tstring s_str;
     bool s_str_valid = false;
 
-    // Walk the format string and process all occurences of %q and %Q.
+    log4cplus::tstring n_str;
+    bool n_str_valid = false;
+
+    // Walk the format string and process all occurences of %q, %Q, %s
+    // and %N.
     
     for (log4cplus::tstring::const_iterator fmt_it = fmt.begin ();
          fmt_it != fmt.end (); ++fmt_it)
@@ -309,6 +683,18 @@ Time::getFormattedTime(const log4cplus::tstring& fmt_orig, bool use_gmtime) cons
             }
             break;
 
+            case LOG4CPLUS_TEXT ('N'):
+            {
+                if (! n_str_valid)
+                {
+                    build_n_value (n_str);
+                    n_str_valid = true;
+                }
+                ret.append (n_str);
+                state = TEXT;
+            }
+            break;
+
             // Windows do not support %s format specifier
             // (seconds since epoch).
             case LOG4CPLUS_TEXT ('s'):
@@ -383,11 +769,11 @@ Time&
 Time::operator+=(const Time& rhs)
 {
     tv_sec += rhs.tv_sec;
-    tv_usec += rhs.tv_usec;
+    tv_nsec += rhs.tv_nsec;
 
-    if(tv_usec > ONE_SEC_IN_USEC) {
+    if(tv_nsec >= ONE_SEC_IN_NSEC) {
         ++tv_sec;
-        tv_usec -= ONE_SEC_IN_USEC;
+        tv_nsec -= ONE_SEC_IN_NSEC;
     }
 
     return *this;
@@ -398,11 +784,11 @@ Time&
 Time::operator-=(const Time& rhs)
 {
     tv_sec -= rhs.tv_sec;
-    tv_usec -= rhs.tv_usec;
+    tv_nsec -= rhs.tv_nsec;
 
-    if(tv_usec < 0) {
+    if(tv_nsec < 0) {
         --tv_sec;
-        tv_usec += ONE_SEC_IN_USEC;
+        tv_nsec += ONE_SEC_IN_NSEC;
     }
 
     return *this;
@@ -415,8 +801,9 @@ Time::operator/=(long rhs)
     long rem_secs = static_cast<long>(tv_sec % rhs);
     tv_sec /= rhs;
     
-    tv_usec /= rhs;
-    tv_usec += static_cast<long>((rem_secs * ONE_SEC_IN_USEC) / rhs);
+    tv_nsec /= rhs;
+    tv_nsec += static_cast<long>(
+        (static_cast<double>(rem_secs) * ONE_SEC_IN_NSEC) / rhs);
 
     return *this;
 }
@@ -425,9 +812,10 @@ Time::operator/=(long rhs)
 Time&
 Time::operator*=(long rhs)
 {
-    long new_usec = tv_usec * rhs;
-    long overflow_sec = new_usec / ONE_SEC_IN_USEC;
-    tv_usec = new_usec % ONE_SEC_IN_USEC;
+    double new_nsec = static_cast<double>(tv_nsec) * rhs;
+    long overflow_sec = static_cast<long>(new_nsec / ONE_SEC_IN_NSEC);
+    tv_nsec = static_cast<long>(
+        new_nsec - static_cast<double>(overflow_sec) * ONE_SEC_IN_NSEC);
 
     tv_sec *= rhs;
     tv_sec += overflow_sec;
@@ -474,7 +862,7 @@ operator<(const Time& lhs, const Time& rhs)
 {
     return (   (lhs.sec() < rhs.sec())
             || (   (lhs.sec() == rhs.sec()) 
-                && (lhs.usec() < rhs.usec())) );
+                && (lhs.nsec() < rhs.nsec())) );
 }
 
 
@@ -490,7 +878,7 @@ operator>(const Time& lhs, const Time& rhs)
 {
     return (   (lhs.sec() > rhs.sec())
             || (   (lhs.sec() == rhs.sec()) 
-                && (lhs.usec() > rhs.usec())) );
+                && (lhs.nsec() > rhs.nsec())) );
 }
 
 
@@ -505,7 +893,7 @@ bool
 operator==(const Time& lhs, const Time& rhs)
 {
     return (   lhs.sec() == rhs.sec()
-            && lhs.usec() == rhs.usec());
+            && lhs.nsec() == rhs.nsec());
 }
 
 
@@ -516,4 +904,299 @@ operator!=(const Time& lhs, const Time& rhs)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////
+// CompiledTimeFormat
+//////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+//! Appends value in decimal, padded to width with pad characters.
+static
+void
+append_decimal (log4cplus::tstring & out, unsigned long value,
+    std::size_t width, tchar pad = LOG4CPLUS_TEXT ('0'))
+{
+    tchar buf[24];
+    tchar * const buf_end = buf + sizeof (buf) / sizeof (buf[0]);
+    tchar * it = buf_end;
+    do
+    {
+        *--it = static_cast<tchar>(LOG4CPLUS_TEXT ('0') + value % 10);
+        value /= 10;
+    }
+    while (value != 0);
+
+    while (static_cast<std::size_t>(buf_end - it) < width)
+        *--it = pad;
+
+    out.append (it, buf_end);
+}
+
+} // namespace
+
+
+CompiledTimeFormat::CompiledTimeFormat ()
+    : use_gmtime (false)
+    , needs_tm (false)
+{ }
+
+
+CompiledTimeFormat::CompiledTimeFormat (const log4cplus::tstring& fmt,
+    bool use_gmtime_)
+    : use_gmtime (false)
+    , needs_tm (false)
+{
+    compile (fmt, use_gmtime_);
+}
+
+
+void
+CompiledTimeFormat::addField (FieldType type)
+{
+    Field field;
+    field.type = type;
+    fields.push_back (field);
+
+    switch (type)
+    {
+    case EPOCH_SECONDS:
+    case MILLISECONDS:
+    case FRACTIONAL_MILLISECONDS:
+    case NANOSECONDS:
+        break;
+
+    default:
+        needs_tm = true;
+    }
+}
+
+
+void
+CompiledTimeFormat::addLiteral (log4cplus::tchar ch)
+{
+    if (fields.empty () || fields.back ().type != LITERAL)
+    {
+        Field field;
+        field.type = LITERAL;
+        fields.push_back (field);
+    }
+
+    fields.back ().text.push_back (ch);
+}
+
+
+void
+CompiledTimeFormat::compile (const log4cplus::tstring& fmt,
+    bool use_gmtime_)
+{
+    format = fmt;
+    use_gmtime = use_gmtime_;
+    needs_tm = false;
+    fields.clear ();
+
+    log4cplus::tstring::size_type const len = fmt.size ();
+    for (log4cplus::tstring::size_type i = 0; i != len; ++i)
+    {
+        tchar const ch = fmt[i];
+        if (ch == 0)
+            break;
+        else if (ch != LOG4CPLUS_TEXT ('%'))
+        {
+            addLiteral (ch);
+            continue;
+        }
+
+        // A trailing lone % is dropped, as by getFormattedTime().
+        if (++i == len)
+            break;
+
+        switch (fmt[i])
+        {
+        case LOG4CPLUS_TEXT ('Y'): addField (YEAR); break;
+        case LOG4CPLUS_TEXT ('y'): addField (YEAR_OF_CENTURY); break;
+        case LOG4CPLUS_TEXT ('m'): addField (MONTH); break;
+        case LOG4CPLUS_TEXT ('d'): addField (DAY); break;
+        case LOG4CPLUS_TEXT ('e'): addField (DAY_SPACE_PADDED); break;
+        case LOG4CPLUS_TEXT ('H'): addField (HOUR); break;
+        case LOG4CPLUS_TEXT ('I'): addField (HOUR_12); break;
+        case LOG4CPLUS_TEXT ('M'): addField (MINUTE); break;
+        case LOG4CPLUS_TEXT ('S'): addField (SECOND); break;
+        case LOG4CPLUS_TEXT ('j'): addField (DAY_OF_YEAR); break;
+        case LOG4CPLUS_TEXT ('s'): addField (EPOCH_SECONDS); break;
+        case LOG4CPLUS_TEXT ('q'): addField (MILLISECONDS); break;
+        case LOG4CPLUS_TEXT ('Q'): addField (FRACTIONAL_MILLISECONDS); break;
+        case LOG4CPLUS_TEXT ('N'): addField (NANOSECONDS); break;
+        case LOG4CPLUS_TEXT ('%'): addLiteral (LOG4CPLUS_TEXT ('%')); break;
+        case LOG4CPLUS_TEXT ('n'): addLiteral (LOG4CPLUS_TEXT ('\n')); break;
+        case LOG4CPLUS_TEXT ('t'): addLiteral (LOG4CPLUS_TEXT ('\t')); break;
+
+        case LOG4CPLUS_TEXT ('F'):
+            addField (YEAR);
+            addLiteral (LOG4CPLUS_TEXT ('-'));
+            addField (MONTH);
+            addLiteral (LOG4CPLUS_TEXT ('-'));
+            addField (DAY);
+            break;
+
+        case LOG4CPLUS_TEXT ('T'):
+            addField (HOUR);
+            addLiteral (LOG4CPLUS_TEXT (':'));
+            addField (MINUTE);
+            addLiteral (LOG4CPLUS_TEXT (':'));
+            addField (SECOND);
+            break;
+
+        case LOG4CPLUS_TEXT ('R'):
+            addField (HOUR);
+            addLiteral (LOG4CPLUS_TEXT (':'));
+            addField (MINUTE);
+            break;
+
+        case LOG4CPLUS_TEXT ('D'):
+            addField (MONTH);
+            addLiteral (LOG4CPLUS_TEXT ('/'));
+            addField (DAY);
+            addLiteral (LOG4CPLUS_TEXT ('/'));
+            addField (YEAR_OF_CENTURY);
+            break;
+
+        default:
+        {
+            addField (STRFTIME);
+            Field & field = fields.back ();
+            field.text.push_back (LOG4CPLUS_TEXT ('%'));
+            field.text.push_back (fmt[i]);
+            // E and O modifiers take the following conversion.
+            if ((fmt[i] == LOG4CPLUS_TEXT ('E')
+                    || fmt[i] == LOG4CPLUS_TEXT ('O'))
+                && i + 1 != len)
+                field.text.push_back (fmt[++i]);
+        }
+        }
+    }
+}
+
+
+void
+CompiledTimeFormat::formatTo (log4cplus::tstring& out,
+    const Time& time) const
+{
+    tm t;
+    if (needs_tm)
+    {
+        if (use_gmtime)
+            time.gmtime (&t);
+        else
+            time.localtime (&t);
+    }
+
+    for (std::vector<Field>::const_iterator it = fields.begin ();
+        it != fields.end (); ++it)
+    {
+        switch (it->type)
+        {
+        case LITERAL:
+            out.append (it->text);
+            break;
+
+        case YEAR:
+            if (t.tm_year + 1900 < 0)
+            {
+                out.push_back (LOG4CPLUS_TEXT ('-'));
+                append_decimal (out, -(t.tm_year + 1900), 4);
+            }
+            else
+                append_decimal (out, t.tm_year + 1900, 4);
+            break;
+
+        case YEAR_OF_CENTURY:
+            append_decimal (out, ((t.tm_year + 1900) % 100 + 100) % 100, 2);
+            break;
+
+        case MONTH:
+            append_decimal (out, t.tm_mon + 1, 2);
+            break;
+
+        case DAY:
+            append_decimal (out, t.tm_mday, 2);
+            break;
+
+        case DAY_SPACE_PADDED:
+            append_decimal (out, t.tm_mday, 2, LOG4CPLUS_TEXT (' '));
+            break;
+
+        case HOUR:
+            append_decimal (out, t.tm_hour, 2);
+            break;
+
+        case HOUR_12:
+            append_decimal (out, t.tm_hour % 12 == 0 ? 12 : t.tm_hour % 12,
+                2);
+            break;
+
+        case MINUTE:
+            append_decimal (out, t.tm_min, 2);
+            break;
+
+        case SECOND:
+            append_decimal (out, t.tm_sec, 2);
+            break;
+
+        case DAY_OF_YEAR:
+            append_decimal (out, t.tm_yday + 1, 3);
+            break;
+
+        case EPOCH_SECONDS:
+            if (time.sec () < 0)
+            {
+                out.push_back (LOG4CPLUS_TEXT ('-'));
+                append_decimal (out, -time.sec (), 1);
+            }
+            else
+                append_decimal (out, time.sec (), 1);
+            break;
+
+        case MILLISECONDS:
+            append_decimal (out, time.nsec () / 1000000, 3);
+            break;
+
+        case FRACTIONAL_MILLISECONDS:
+            append_decimal (out, time.nsec () / 1000000, 3);
+            out.push_back (LOG4CPLUS_TEXT ('.'));
+            append_decimal (out, time.nsec () / 1000 % 1000, 3);
+            break;
+
+        case NANOSECONDS:
+            append_decimal (out, time.nsec (), 9);
+            break;
+
+        case STRFTIME:
+        {
+            tchar buf[128];
+#ifdef UNICODE
+            std::size_t const len = helpers::wcsftime (buf,
+                sizeof (buf) / sizeof (buf[0]), it->text.c_str (), &t);
+#else
+            std::size_t const len = helpers::strftime (buf,
+                sizeof (buf) / sizeof (buf[0]), it->text.c_str (), &t);
+#endif
+            out.append (buf, len);
+            break;
+        }
+        }
+    }
+}
+
+
+log4cplus::tstring
+CompiledTimeFormat::formatTime (const Time& time) const
+{
+    log4cplus::tstring ret;
+    ret.reserve (format.size () * 2);
+    formatTo (ret, time);
+    return ret;
+}
+
+
 } } // namespace log4cplus { namespace helpers {
@@ -0,0 +1,247 @@
+
+#include <log4cplus/logger.h>
+#include <log4cplus/asyncappender.h>
+#include <log4cplus/configurator.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/thread/threads.h>
+#include <log4cplus/streams.h>
+#include <exception>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#if defined (LOG4CPLUS_USE_PTHREADS)
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+
+using namespace std;
+using namespace log4cplus;
+using namespace log4cplus::helpers;
+using namespace log4cplus::thread;
+
+
+#define NUM_THREADS 4
+#define NUM_LOOPS 10000
+
+
+class LoggingThread : public AbstractThread {
+public:
+    LoggingThread(int n, tstring const & name)
+        : number(n), logger(Logger::getInstance(name))
+    { }
+
+    virtual void run() {
+        for(int i=0; i<NUM_LOOPS; ++i) {
+            LOG4CPLUS_DEBUG(logger, "Thread " << number << " debug #" << i);
+            if(i % 1000 == 0) {
+                LOG4CPLUS_ERROR(logger, "Thread " << number << " error #" << i);
+            }
+        }
+    }
+
+private:
+    int number;
+    Logger logger;
+};
+
+
+// Checks that parallel.log has the messages of each thread in order.
+bool
+checkOrder()
+{
+    std::ifstream file("parallel.log");
+    std::string line;
+    long last[NUM_THREADS];
+    int lines = 0;
+    for(int i=0; i<NUM_THREADS; ++i) {
+        last[i] = -1;
+    }
+
+    while(std::getline(file, line)) {
+        std::string::size_type pos = line.find("Thread ");
+        std::string::size_type hash = line.find('#');
+        if(line.compare(0, 5, "DEBUG") != 0
+           || pos == std::string::npos || hash == std::string::npos) {
+            continue;
+        }
+        int number = std::atoi(line.c_str() + pos + 7);
+        long index = std::atol(line.c_str() + hash + 1);
+        if(index != last[number] + 1) {
+            return false;
+        }
+        last[number] = index;
+        ++lines;
+    }
+
+    return lines == NUM_THREADS * NUM_LOOPS;
+}
+
+
+// Checks that async.log has every ERROR and FATAL event, as priority
+// events are not dropped while less important ones are queued.
+bool
+checkPriorityEvents()
+{
+    std::ifstream file("async.log");
+    std::string line;
+    bool seen[NUM_THREADS][NUM_LOOPS / 1000];
+    bool fatal = false;
+    for(int i=0; i<NUM_THREADS; ++i) {
+        for(int j=0; j<NUM_LOOPS / 1000; ++j) {
+            seen[i][j] = false;
+        }
+    }
+
+    while(std::getline(file, line)) {
+        if(line.find(" FATAL ") != std::string::npos
+           && line.find("All threads finished") != std::string::npos) {
+            fatal = true;
+            continue;
+        }
+        std::string::size_type pos = line.find(" ERROR ");
+        std::string::size_type thread = line.find("Thread ", pos);
+        std::string::size_type hash = line.find("error #", pos);
+        if(pos == std::string::npos || thread == std::string::npos
+           || hash == std::string::npos) {
+            continue;
+        }
+        int number = std::atoi(line.c_str() + thread + 7);
+        long index = std::atol(line.c_str() + hash + 7);
+        if(number >= 0 && number < NUM_THREADS && index % 1000 == 0
+           && index / 1000 < NUM_LOOPS / 1000) {
+            seen[number][index / 1000] = true;
+        }
+    }
+
+    bool complete = fatal;
+    for(int i=0; i<NUM_THREADS; ++i) {
+        for(int j=0; j<NUM_LOOPS / 1000; ++j) {
+            complete = complete && seen[i][j];
+        }
+    }
+    return complete;
+}
+
+
+// Negative counts are ignored instead of being taken as huge unsigned
+// values, which would start billions of formatter threads.
+bool
+checkNegativeProperties()
+{
+    Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("Appender"),
+        LOG4CPLUS_TEXT("log4cplus::NullAppender"));
+    props.setProperty(LOG4CPLUS_TEXT("QueueLimit"), LOG4CPLUS_TEXT("-1"));
+    props.setProperty(LOG4CPLUS_TEXT("FormatterThreads"),
+        LOG4CPLUS_TEXT("-1"));
+    SharedAppenderPtr appender(new AsyncAppender(props));
+    Logger logger = Logger::getInstance(LOG4CPLUS_TEXT("negative"));
+    logger.setAdditivity(false);
+    logger.addAppender(appender);
+    for(int i=0; i<1000; ++i) {
+        LOG4CPLUS_INFO(logger, "Negative properties #" << i);
+    }
+    AsyncAppender * async = static_cast<AsyncAppender *>(appender.get());
+    async->flush();
+    bool const ok = async->getDroppedCount() == 0;
+    logger.removeAllAppenders();
+    appender->close();
+    return ok;
+}
+
+
+#if defined (LOG4CPLUS_USE_PTHREADS)
+// Forks while the threads are logging.  The child has to be able to log
+// and shut down without the threads of the parent.
+bool
+forkWhileLogging()
+{
+    pid_t pid = fork();
+    if(pid < 0) {
+        return false;
+    }
+    else if(pid == 0) {
+        // A deadlock kills the child.
+        alarm(30);
+        Logger logger = Logger::getInstance(LOG4CPLUS_TEXT("test.parallel"));
+        LOG4CPLUS_INFO(logger, "Forked child");
+        LOG4CPLUS_INFO(Logger::getRoot(), "Forked child");
+        Logger::shutdown();
+        _exit(0);
+    }
+
+    int status = 0;
+    if(waitpid(pid, &status, 0) != pid) {
+        return false;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+#endif
+
+
+int
+main()
+{
+    tcout << LOG4CPLUS_TEXT("Entering main()...") << endl;
+    LogLog::getLogLog()->setInternalDebugging(true);
+    bool forked = true;
+    try {
+        PropertyConfigurator::doConfigure(LOG4CPLUS_TEXT("log4cplus.properties"));
+        Logger root = Logger::getRoot();
+
+        helpers::SharedObjectPtr<LoggingThread> threads[NUM_THREADS];
+        helpers::SharedObjectPtr<LoggingThread> parallel[NUM_THREADS];
+        int i = 0;
+        for(i=0; i<NUM_THREADS; ++i) {
+            threads[i] = new LoggingThread(i, LOG4CPLUS_TEXT("test.async"));
+            threads[i]->start();
+            parallel[i] = new LoggingThread(i, LOG4CPLUS_TEXT("test.parallel"));
+            parallel[i]->start();
+        }
+
+#if defined (LOG4CPLUS_USE_PTHREADS)
+        forked = forkWhileLogging();
+        tcout << LOG4CPLUS_TEXT("Child process logged after fork: ")
+              << (forked ? LOG4CPLUS_TEXT("yes") : LOG4CPLUS_TEXT("no")) << endl;
+#endif
+
+        for(i=0; i<NUM_THREADS; ++i) {
+            threads[i]->join();
+            parallel[i]->join();
+        }
+
+        LOG4CPLUS_FATAL(root, "All threads finished");
+
+        SharedAppenderPtr appender = root.getAppender(LOG4CPLUS_TEXT("ASYNC"));
+        AsyncAppender * async = dynamic_cast<AsyncAppender *>(appender.get());
+        if(async) {
+            async->flush();
+            tcout << LOG4CPLUS_TEXT("Dropped events: ")
+                  << async->getDroppedCount() << endl;
+        }
+    }
+    catch(std::exception const & e) {
+        tcout << LOG4CPLUS_TEXT("Exception: ") << e.what() << endl;
+        return 1;
+    }
+
+    bool negative = checkNegativeProperties();
+    Logger::shutdown();
+
+    bool ordered = checkOrder();
+    tcout << LOG4CPLUS_TEXT("Parallel formatting kept order: ")
+          << (ordered ? LOG4CPLUS_TEXT("yes") : LOG4CPLUS_TEXT("no")) << endl;
+
+    bool priority = checkPriorityEvents();
+    tcout << LOG4CPLUS_TEXT("No ERROR or FATAL event lost: ")
+          << (priority ? LOG4CPLUS_TEXT("yes") : LOG4CPLUS_TEXT("no")) << endl;
+
+    tcout << LOG4CPLUS_TEXT("Negative properties ignored: ")
+          << (negative ? LOG4CPLUS_TEXT("yes") : LOG4CPLUS_TEXT("no")) << endl;
+
+    tcout << LOG4CPLUS_TEXT("Exiting main()...") << endl;
+    return ordered && forked && priority && negative ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+
+#include <log4cplus/logger.h>
+#include <log4cplus/appender.h>
+#include <log4cplus/configurator.h>
+#include <log4cplus/layout.h>
+#include <log4cplus/streams.h>
+#include <log4cplus/helpers/backtrace.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <iostream>
+#include <vector>
+
+
+using namespace log4cplus;
+using namespace log4cplus::helpers;
+
+
+// Keeps the formatted text and a copy of each event it gets.
+class RecordingAppender : public Appender
+{
+public:
+    virtual ~RecordingAppender()
+    {
+        destructorImpl();
+    }
+
+    virtual void close()
+    {
+        closed = true;
+    }
+
+    std::vector<tstring> lines;
+    std::vector<spi::InternalLoggingEvent> events;
+
+protected:
+    virtual void append(spi::InternalLoggingEvent const & event)
+    {
+        tostringstream buf;
+        layout->formatAndAppend(buf, event);
+        lines.push_back(buf.str());
+        events.push_back(event);
+    }
+};
+
+
+static int failures = 0;
+
+
+static void
+check(bool ok, char const * what)
+{
+    std::cout << (ok ? "ok: " : "FAILED: ") << what << std::endl;
+    if(! ok) {
+        ++failures;
+    }
+}
+
+
+// Counts the frame lines written by %S.
+static std::size_t
+countFrames(tstring const & text)
+{
+    tstring const marker = LOG4CPLUS_TEXT("\n\tat ");
+    std::size_t count = 0;
+    for(tstring::size_type pos = text.find(marker); pos != tstring::npos;
+        pos = text.find(marker, pos + marker.size()))
+    {
+        ++count;
+    }
+    return count;
+}
+
+
+// Returns the depth it was called with.  The result is read back
+// after the recursive call, so that the compiler cannot turn the
+// recursion into a loop and every level keeps its frame.
+#if defined (__GNUC__)
+__attribute__((noinline))
+#endif
+static int
+logFromNestedCall(Logger & logger, int depth)
+{
+    if(depth > 0) {
+        int volatile nested = logFromNestedCall(logger, depth - 1);
+        return nested + 1;
+    }
+    LOG4CPLUS_ERROR(logger, "nested error");
+    return 0;
+}
+
+
+int
+main()
+{
+    LogLog::getLogLog()->setInternalDebugging(true);
+
+    Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("log4cplus.rootLogger"),
+        LOG4CPLUS_TEXT("DEBUG"));
+    props.setProperty(LOG4CPLUS_TEXT("log4cplus.backtraceLevel"),
+        LOG4CPLUS_TEXT("ERROR"));
+    PropertyConfigurator config(props);
+    config.configure();
+    check(getBacktraceThreshold() == ERROR_LOG_LEVEL,
+        "backtraceLevel is read by PropertyConfigurator");
+
+    Logger logger = Logger::getInstance(LOG4CPLUS_TEXT("test"));
+
+    RecordingAppender * full = new RecordingAppender;
+    full->setLayout(std::auto_ptr<Layout>(
+        new PatternLayout(LOG4CPLUS_TEXT("%p %m%S%n"))));
+    SharedAppenderPtr fullPtr(full);
+    logger.addAppender(fullPtr);
+
+    RecordingAppender * shallow = new RecordingAppender;
+    shallow->setLayout(std::auto_ptr<Layout>(
+        new PatternLayout(LOG4CPLUS_TEXT("%p %m%S{2}%n"))));
+    SharedAppenderPtr shallowPtr(shallow);
+    logger.addAppender(shallowPtr);
+
+    LOG4CPLUS_INFO(logger, "plain info");
+    int const levels = logFromNestedCall(logger, 5)
+        + logFromNestedCall(logger, 5);
+
+    check(full->lines.size() == 3 && levels == 10,
+        "all events are appended");
+    if(full->lines.size() != 3 || shallow->lines.size() != 3) {
+        return 1;
+    }
+
+    check(full->lines[0] == LOG4CPLUS_TEXT("INFO plain info\n"),
+        "events below the threshold carry no backtrace");
+    check(full->events[0].getBacktrace().empty(),
+        "no frames are captured below the threshold");
+
+    std::size_t const frames = countFrames(full->lines[1]);
+    check(frames >= 6, "error events carry the nested frames");
+    check(full->lines[1].compare(0, 18,
+            LOG4CPLUS_TEXT("ERROR nested error")) == 0,
+        "the backtrace follows the message");
+    check(full->lines[1].find(LOG4CPLUS_TEXT("log4cplus::"))
+            == tstring::npos,
+        "frames inside log4cplus are left out");
+    check(countFrames(shallow->lines[1]) == 2, "%S{2} limits the depth");
+
+    // The second stack comes from the same call site; apart from the
+    // innermost frames it resolves to the same text, from the cache.
+    check(countFrames(full->lines[2]) == frames,
+        "repeated stacks format the same number of frames");
+
+    // Copies of the event keep the captured frames.
+    spi::InternalLoggingEvent copy(full->events[1]);
+    spi::InternalLoggingEvent assigned(full->events[0]);
+    assigned = full->events[1];
+    check(copy.getBacktrace() == full->events[1].getBacktrace()
+        && assigned.getBacktrace() == full->events[1].getBacktrace(),
+        "copies of the event keep the backtrace");
+
+    tstring text;
+    symbolizeBacktrace(text, copy.getBacktrace(), 3);
+    check(countFrames(text) == 3, "symbolizeBacktrace limits the depth");
+
+    setBacktraceThreshold(NOT_SET_LOG_LEVEL);
+    logFromNestedCall(logger, 1);
+    check(full->events.back().getBacktrace().empty(),
+        "setBacktraceThreshold(NOT_SET_LOG_LEVEL) turns capturing off");
+
+    logger.removeAllAppenders();
+
+    std::cout << (failures == 0 ? "All tests passed." : "Some tests failed.")
+              << std::endl;
+    return failures == 0 ? 0 : 1;
+}
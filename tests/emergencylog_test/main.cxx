@@ -0,0 +1,207 @@
+
+#include <log4cplus/logger.h>
+#include <log4cplus/emergencylog.h>
+#include <log4cplus/asyncappender.h>
+#include <log4cplus/fileappender.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/sleep.h>
+#include <log4cplus/helpers/timehelper.h>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#if defined (LOG4CPLUS_USE_PTHREADS)
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+
+using namespace log4cplus;
+using namespace log4cplus::helpers;
+
+
+static int failures = 0;
+
+
+static void
+check(bool ok, char const * what)
+{
+    std::cout << (ok ? "ok: " : "FAILED: ") << what << std::endl;
+    if(! ok) {
+        ++failures;
+    }
+}
+
+
+#if defined (LOG4CPLUS_USE_PTHREADS)
+
+const int LINE_COUNT = 100;
+
+
+// Stands in for an appender whose lock is held by the crashing thread.
+class HangingAppender : public Appender
+{
+public:
+    virtual ~HangingAppender()
+    {
+        destructorImpl();
+    }
+
+    virtual void close()
+    {
+        closed = true;
+    }
+
+    virtual void flush()
+    {
+        for(;;) {
+            sleepmillis(1000);
+        }
+    }
+
+protected:
+    virtual void append(spi::InternalLoggingEvent const &)
+    { }
+};
+
+
+static std::string
+readFile(char const * name)
+{
+    std::ifstream file(name);
+    return std::string(std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>());
+}
+
+
+static int
+countLines(char const * name)
+{
+    std::string const text = readFile(name);
+    int lines = 0;
+    for(std::string::size_type i = 0; i != text.size(); ++i) {
+        lines += text[i] == '\n';
+    }
+    return lines;
+}
+
+
+// Logs to a buffered file through an AsyncAppender and crashes.  With
+// hang set, another appender never finishes its flush.
+static void
+crashingChild(bool hang)
+{
+    struct rlimit no_core = { 0, 0 };
+    setrlimit(RLIMIT_CORE, &no_core);
+
+    int const fd = ::open(hang ? "emergency-hang.log" : "emergency.log",
+        O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    initEmergencyLog(fd);
+
+    SharedAppenderPtr file(new FileAppender(
+        hang ? LOG4CPLUS_TEXT("crash-hang.log") : LOG4CPLUS_TEXT("crash.log"),
+        std::ios_base::trunc, false));
+    SharedAppenderPtr async(new AsyncAppender(file, 1000));
+    Logger logger = Logger::getInstance(LOG4CPLUS_TEXT("test.crash"));
+    logger.addAppender(async);
+    if(hang) {
+        Logger::getRoot().addAppender(SharedAppenderPtr(new HangingAppender));
+    }
+
+    installFatalSignalHandlers(300);
+    for(int i = 0; i < LINE_COUNT; ++i) {
+        LOG4CPLUS_INFO(logger, "line " << i);
+    }
+
+    raise(SIGSEGV);
+    _exit(0);
+}
+
+
+static bool
+runCrashingChild(bool hang, int & status)
+{
+    pid_t const pid = fork();
+    if(pid == 0) {
+        crashingChild(hang);
+    }
+    return pid > 0 && waitpid(pid, &status, 0) == pid;
+}
+
+#endif
+
+
+int
+main()
+{
+    LogLog::getLogLog()->setInternalDebugging(true);
+
+#if defined (LOG4CPLUS_USE_PTHREADS)
+    // Records written to a file descriptor.
+    int fds[2];
+    if(pipe(fds) != 0) {
+        return 1;
+    }
+    initEmergencyLog(fds[1]);
+    std::time_t const now = std::time(0);
+    emergencyLog(ERROR_LOG_LEVEL, "disk gone");
+    char record[1024];
+    long n = read(fds[0], record, sizeof(record));
+    std::string const text(record, n > 0 ? n : 0);
+
+    char expected[32];
+    std::strftime(expected, sizeof(expected), "%Y-%m-%d %H:", std::gmtime(&now));
+    check(text.size() == 41
+        && text.compare(0, 14, expected) == 0
+        && text[16] == ':' && text[19] == '.' && text[23] == 'Z'
+        && text.compare(23, std::string::npos, "Z ERROR disk gone\n") == 0,
+        "a record has a UTC timestamp, the level and the message");
+
+    std::string const longMessage(1000, 'x');
+    emergencyLog(FATAL_LOG_LEVEL, longMessage.c_str());
+    n = read(fds[0], record, sizeof(record));
+    check(n == 512 && record[511] == '\n', "long records are truncated");
+    close(fds[0]);
+    close(fds[1]);
+
+    // Records kept in a preallocated buffer.
+    initEmergencyLog(-1, 100);
+    emergencyLog(WARN_LOG_LEVEL, "first");
+    emergencyLog(INFO_LOG_LEVEL, "second");
+    emergencyLog(INFO_LOG_LEVEL, "third does not fit");
+    std::string const buffered = readEmergencyLog();
+    check(buffered.size() == 2 * 24 + 12 + 13
+        && buffered.find(" WARN first\n") != std::string::npos
+        && buffered.find(" INFO second\n") != std::string::npos
+        && getEmergencyLogDropCount() == 1,
+        "records are buffered until the buffer is full");
+    check(readEmergencyLog().empty(), "reading empties the buffer");
+
+    // A fatal signal flushes buffered and queued events.
+    int status = 0;
+    bool const ran = runCrashingChild(false, status);
+    check(ran && WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV,
+        "the signal still terminates the process");
+    check(countLines("crash.log") == LINE_COUNT,
+        "the appenders are flushed on the fatal signal");
+    check(readFile("emergency.log").find(
+            " FATAL Caught fatal signal SIGSEGV\n") != std::string::npos,
+        "the fatal signal is logged");
+
+    // A flush that hangs does not keep the process from dying.
+    Time const start = Time::gettimeofday();
+    bool const hung = runCrashingChild(true, status);
+    Time const elapsed = Time::gettimeofday() - start;
+    check(hung && WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV
+        && elapsed.sec() < 5,
+        "a hanging flush is abandoned after the timeout");
+#endif
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,269 @@
+
+#include <log4cplus/logger.h>
+#include <log4cplus/failoverappender.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/helpers/sleep.h>
+#include <log4cplus/helpers/timehelper.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/thread/syncprims.h>
+#include <iostream>
+#include <vector>
+
+
+using namespace log4cplus;
+using namespace log4cplus::helpers;
+
+
+// Stands in for a destination that can fail or hang on demand.
+class StallingAppender : public Appender
+{
+public:
+    StallingAppender()
+        : failing(false), stalling(false)
+    { }
+
+    virtual ~StallingAppender()
+    {
+        destructorImpl();
+    }
+
+    virtual void close()
+    {
+        closed = true;
+    }
+
+    void setFailing(bool f)
+    {
+        thread::MutexGuard guard(mutex);
+        failing = f;
+    }
+
+    void stall()
+    {
+        thread::MutexGuard guard(mutex);
+        stalling = true;
+        release_ev.reset();
+    }
+
+    void release()
+    {
+        thread::MutexGuard guard(mutex);
+        stalling = false;
+        release_ev.signal();
+    }
+
+    std::vector<tstring> received()
+    {
+        thread::MutexGuard guard(mutex);
+        return messages;
+    }
+
+protected:
+    virtual void append(spi::InternalLoggingEvent const & event)
+    {
+        bool fail;
+        {
+            thread::MutexGuard guard(mutex);
+            while(stalling) {
+                guard.unlock();
+                release_ev.wait();
+                guard.lock();
+            }
+            fail = failing;
+            if(! fail) {
+                messages.push_back(event.getMessage());
+            }
+        }
+        if(fail) {
+            getErrorHandler()->error(LOG4CPLUS_TEXT("StallingAppender failed"));
+        }
+    }
+
+    thread::Mutex mutex;
+    thread::ManualResetEvent release_ev;
+    bool failing;
+    bool stalling;
+    std::vector<tstring> messages;
+};
+
+
+class RecordingAppender : public Appender
+{
+public:
+    virtual ~RecordingAppender()
+    {
+        destructorImpl();
+    }
+
+    virtual void close()
+    {
+        closed = true;
+    }
+
+    std::vector<tstring> messages;
+
+protected:
+    virtual void append(spi::InternalLoggingEvent const & event)
+    {
+        messages.push_back(event.getMessage());
+    }
+};
+
+
+static int failures = 0;
+
+
+static void
+check(bool ok, char const * what)
+{
+    std::cout << (ok ? "ok: " : "FAILED: ") << what << std::endl;
+    if(! ok) {
+        ++failures;
+    }
+}
+
+
+static void
+log(Logger & logger, int n)
+{
+    for(int i = 0; i < n; ++i) {
+        LOG4CPLUS_INFO(logger, "message " << i);
+    }
+}
+
+
+int
+main()
+{
+    LogLog::getLogLog()->setInternalDebugging(true);
+
+    StallingAppender * primary = new StallingAppender;
+    RecordingAppender * fallback = new RecordingAppender;
+    FailoverAppender * failover = new FailoverAppender(
+        SharedAppenderPtr(primary), SharedAppenderPtr(fallback), 200);
+    SharedAppenderPtr failoverPtr(failover);
+    failover->setProbeInterval(300);
+
+    Logger logger = Logger::getInstance(LOG4CPLUS_TEXT("test.failover"));
+    logger.addAppender(failoverPtr);
+    logger.setAdditivity(false);
+
+    // Healthy: everything reaches the primary.
+    log(logger, 10);
+    check(primary->received().size() == 10
+        && fallback->messages.empty()
+        && failover->getHealth() == FailoverAppender::HEALTHY,
+        "healthy events reach the primary");
+
+    // Errors degrade the primary and then fail it.
+    primary->setFailing(true);
+    log(logger, 1);
+    check(failover->getHealth() == FailoverAppender::DEGRADED,
+        "one error degrades the primary");
+    log(logger, 2);
+    check(failover->getHealth() == FailoverAppender::FAILED,
+        "three errors fail the primary");
+    check(fallback->messages.size() == 3, "failed events are diverted");
+
+    primary->setFailing(false);
+    log(logger, 5);
+    check(primary->received().size() == 10
+        && fallback->messages.size() == 8,
+        "a failed primary is skipped until the probe");
+
+    // Recovery through the probe, which the next event picks up.
+    sleepmillis(400);
+    log(logger, 1);
+    sleepmillis(50);
+    log(logger, 5);
+    check(failover->getHealth() == FailoverAppender::HEALTHY
+        && primary->received().size() == 16
+        && fallback->messages.size() == 8,
+        "the probe recovers the primary");
+
+    // A failed probe event goes to the fallback.
+    primary->setFailing(true);
+    log(logger, 3);
+    sleepmillis(400);
+    log(logger, 1);
+    sleepmillis(50);
+    log(logger, 1);
+    check(failover->getHealth() == FailoverAppender::FAILED
+        && fallback->messages.size() == 8 + 3 + 2,
+        "a failed probe is diverted");
+
+    // A probe does not make the logging thread wait for the primary.
+    primary->setFailing(false);
+    primary->stall();
+    sleepmillis(400);
+    Time start = Time::gettimeofday();
+    log(logger, 1);
+    Time elapsed = Time::gettimeofday() - start;
+    check(elapsed.getTime() * 1000 + elapsed.usec() / 1000 < 100,
+        "the probe runs in the background");
+    primary->release();
+    sleepmillis(50);
+    log(logger, 1);
+    check(failover->getHealth() == FailoverAppender::HEALTHY
+        && primary->received().size() == 18,
+        "a delayed probe recovers the primary");
+
+    // Errors of an append that timed out are not charged to later ones.
+    primary->setFailing(true);
+    primary->stall();
+    log(logger, 1);
+    primary->release();
+    sleepmillis(50);
+    primary->setFailing(false);
+    sleepmillis(400);
+    log(logger, 1);
+    sleepmillis(50);
+    log(logger, 1);
+    check(failover->getHealth() == FailoverAppender::HEALTHY
+        && primary->received().size() == 20,
+        "errors are charged to their own append");
+    std::size_t const diverted = failover->getDivertedCount();
+
+    // A hang costs one time budget, then events are diverted at once.
+    primary->stall();
+    start = Time::gettimeofday();
+    log(logger, 1);
+    elapsed = Time::gettimeofday() - start;
+    check(failover->getHealth() == FailoverAppender::FAILED
+        && elapsed.getTime() * 1000 + elapsed.usec() / 1000 >= 190,
+        "a hung append fails the primary after the time budget");
+
+    start = Time::gettimeofday();
+    log(logger, 100);
+    sleepmillis(400);
+    log(logger, 100);
+    elapsed = Time::gettimeofday() - start;
+    check(elapsed.getTime() * 1000 + elapsed.usec() / 1000 < 600,
+        "a hung primary does not block logging threads");
+    check(failover->getDivertedCount() == diverted + 1 + 200,
+        "events are diverted while the primary hangs");
+
+    primary->release();
+    sleepmillis(400);
+    log(logger, 1);
+    sleepmillis(50);
+    log(logger, 1);
+    check(failover->getHealth() == FailoverAppender::HEALTHY
+        && primary->received().size() == 23,
+        "a released primary recovers");
+
+    // close() returns although the primary hangs.
+    primary->stall();
+    log(logger, 1);
+    start = Time::gettimeofday();
+    logger.removeAllAppenders();
+    failover->close();
+    elapsed = Time::gettimeofday() - start;
+    check(elapsed.getTime() * 1000 + elapsed.usec() / 1000 < 1000,
+        "close() returns with a hung primary");
+    primary->release();
+    sleepmillis(100);
+
+    return failures == 0 ? 0 : 1;
+}
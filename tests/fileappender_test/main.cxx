@@ -1,8 +1,15 @@
 #include <log4cplus/logger.h>
 #include <log4cplus/fileappender.h>
+#include <log4cplus/fileindex.h>
 #include <log4cplus/layout.h>
 #include <log4cplus/ndc.h>
 #include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
 
 
 using namespace log4cplus;
@@ -10,6 +17,184 @@ using namespace log4cplus;
 const int LOOP_COUNT = 20000;
 
 
+// Converts a mix of ASCII runs and multi-byte characters with
+// toUTF8() and through a wide stream imbued with getUTF8Locale().
+static bool
+checkUTF8()
+{
+    std::wstring wide;
+    std::string expected;
+    for (int i = 0; i != 100; ++i)
+    {
+        wide += L"ASCII run longer than sixteen characters ";
+        expected += "ASCII run longer than sixteen characters ";
+        wide += static_cast<wchar_t>(0xE9);
+        expected += "\xC3\xA9";
+        wide += static_cast<wchar_t>(0x20AC);
+        expected += "\xE2\x82\xAC";
+        if (sizeof (wchar_t) == 2)
+        {
+            wide += static_cast<wchar_t>(0xD83D);
+            wide += static_cast<wchar_t>(0xDE00);
+        }
+        else
+            wide += static_cast<wchar_t>(0x1F600);
+        expected += "\xF0\x9F\x98\x80";
+    }
+    wide += static_cast<wchar_t>(0xD800);
+    expected += "\xEF\xBF\xBD";
+
+    if (helpers::toUTF8(wide) != expected)
+    {
+        std::cout << "toUTF8() failed" << std::endl;
+        return false;
+    }
+
+    {
+        std::wofstream out;
+        out.imbue(helpers::getUTF8Locale());
+        out.open("utf8.log");
+        out << wide.substr(0, wide.size() - 1) << std::flush;
+    }
+    std::ifstream in("utf8.log", std::ios::binary);
+    std::string const written((std::istreambuf_iterator<char>(in)),
+        std::istreambuf_iterator<char>());
+    if (written != expected.substr(0, expected.size() - 3))
+    {
+        std::cout << "UTF-8 locale failed" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+static SharedAppenderPtr
+makeIndexedAppender()
+{
+    helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("File"), LOG4CPLUS_TEXT("Indexed.log"));
+    props.setProperty(LOG4CPLUS_TEXT("MaxFileSize"), LOG4CPLUS_TEXT("200KB"));
+    props.setProperty(LOG4CPLUS_TEXT("MaxBackupIndex"), LOG4CPLUS_TEXT("5"));
+    props.setProperty(LOG4CPLUS_TEXT("Index"), LOG4CPLUS_TEXT("true"));
+    props.setProperty(LOG4CPLUS_TEXT("IndexInterval"), LOG4CPLUS_TEXT("4KB"));
+    SharedAppenderPtr app(new RollingFileAppender(props));
+    app->setLayout(std::auto_ptr<Layout>(
+        new PatternLayout(LOG4CPLUS_TEXT("%x %m%n"))));
+    return app;
+}
+
+
+static void
+logRequests(Logger & logger, int first, int last)
+{
+    for (int i = first; i != last; ++i)
+    {
+        tostringstream req;
+        req << LOG4CPLUS_TEXT("req-") << i / 100;
+        NDCContextCreator _context(req.str());
+        LOG4CPLUS_INFO(logger, "Handling request, event #" << i
+            << ", with some padding to make the lines longer");
+    }
+}
+
+
+// Checks the index of one file against its contents.
+static bool
+checkIndexedFile(std::string const & name, std::string & tokens)
+{
+    std::ifstream in(name.c_str(), std::ios::binary);
+    std::string const text((std::istreambuf_iterator<char>(in)),
+        std::istreambuf_iterator<char>());
+
+    FileIndex index;
+    if (! index.read(LOG4CPLUS_STRING_TO_TSTRING(name) + FileIndex::SUFFIX)
+        || index.getEndOffset() != text.size()
+        || index.getCheckpoints().size() < text.size() / (8 * 1024))
+    {
+        std::cout << "Bad index of " << name << std::endl;
+        return false;
+    }
+
+    // Checkpoints are at line starts and in order.
+    unsigned long prev = 0;
+    FileIndex::CheckpointList const & cps = index.getCheckpoints();
+    for (std::size_t i = 0; i != cps.size(); ++i)
+    {
+        unsigned long const off = cps[i].offset;
+        if ((off != 0 && text[off - 1] != '\n') || (i != 0 && off <= prev)
+            || cps[i].time < index.getFirstTime()
+            || index.getLastTime() < cps[i].time)
+        {
+            std::cout << "Bad checkpoint in " << name << std::endl;
+            return false;
+        }
+        prev = off;
+    }
+
+    // Every request id in the file is in the filter.
+    std::string::size_type pos = 0;
+    while ((pos = text.find("req-", pos)) != std::string::npos)
+    {
+        std::string::size_type const end = text.find(' ', pos);
+        std::string const token = text.substr(pos, end - pos);
+        if (! index.mightContain(LOG4CPLUS_STRING_TO_TSTRING(token)))
+        {
+            std::cout << token << " missing in " << name << std::endl;
+            return false;
+        }
+        if (tokens.find(" " + token + " ") == std::string::npos)
+            tokens += token + " ";
+        pos = end;
+    }
+
+    if (index.mightContain(LOG4CPLUS_TEXT("req-999999")))
+    {
+        std::cout << "False positive in " << name << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+// Writes rolling files with sidecar indexes, reopens the current file
+// for appending, and checks every index.
+static bool
+checkIndex()
+{
+    Logger logger = Logger::getInstance(LOG4CPLUS_TEXT("indexed"));
+    logger.setAdditivity(false);
+
+    SharedAppenderPtr app = makeIndexedAppender();
+    logger.addAppender(app);
+    logRequests(logger, 0, 6000);
+    logger.removeAllAppenders();
+    app->close();
+
+    app = makeIndexedAppender();
+    logger.addAppender(app);
+    logRequests(logger, 6000, 6500);
+    logger.removeAllAppenders();
+    app->close();
+
+    std::string tokens = " ";
+    char const * const names[] = { "Indexed.log", "Indexed.log.1",
+        "Indexed.log.2" };
+    for (std::size_t i = 0; i != sizeof(names) / sizeof(names[0]); ++i)
+        if (! checkIndexedFile(names[i], tokens))
+            return false;
+
+    if (tokens.find(" req-64 ") == std::string::npos)
+    {
+        std::cout << "Appended events are not indexed" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+
 int
 main()
 {
@@ -29,6 +214,11 @@ main()
         LOG4CPLUS_DEBUG(subTest, "Entering loop #" << i);
     }
 
+    if (! checkUTF8())
+        return 1;
+
+    if (! checkIndex())
+        return 1;
 
     return 0;
 }
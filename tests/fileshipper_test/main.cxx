@@ -0,0 +1,233 @@
+#include <log4cplus/fileappender.h>
+#include <log4cplus/fileshipper.h>
+#include <log4cplus/layout.h>
+#include <log4cplus/logger.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/helpers/sleep.h>
+#include <log4cplus/helpers/socket.h>
+#include <log4cplus/thread/syncprims.h>
+#include <log4cplus/thread/threads.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <dirent.h>
+
+
+using namespace log4cplus;
+
+const int LOOP_COUNT = 20000;
+const unsigned short PORT = 9873;
+
+
+//! Returns the names in the current directory that start with prefix
+//! and end with suffix, sorted.
+static std::vector<std::string>
+listFiles(std::string const & prefix, std::string const & suffix)
+{
+    std::vector<std::string> names;
+    DIR * const d = opendir(".");
+    while (struct dirent const * entry = readdir(d))
+    {
+        std::string const name = entry->d_name;
+        if (name.size() > prefix.size() + suffix.size()
+            && name.compare(0, prefix.size(), prefix) == 0
+            && name.compare(name.size() - suffix.size(), suffix.size(),
+                suffix) == 0)
+            names.push_back(name);
+    }
+    closedir(d);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+
+static std::string
+readFile(std::string const & name)
+{
+    std::ifstream in(name.c_str(), std::ios::in | std::ios::binary);
+    std::ostringstream oss;
+    oss << in.rdbuf();
+    return oss.str();
+}
+
+
+// Stands in for loggingserver -files.  It serves one connection at a
+// time until stopped.
+class Receiver : public thread::AbstractThread
+{
+public:
+    Receiver() : stopping(false)
+    {
+        server = helpers::openSocket(PORT, state);
+    }
+
+    virtual void run()
+    {
+        FileReceiver receiver(LOG4CPLUS_TEXT("."));
+        while (true)
+        {
+            helpers::SOCKET_TYPE const client
+                = helpers::acceptSocket(server, state);
+            {
+                thread::MutexGuard guard(mutex);
+                if (stopping)
+                {
+                    helpers::closeSocket(client);
+                    break;
+                }
+            }
+            receiver.receive(client);
+            helpers::closeSocket(client);
+        }
+        helpers::closeSocket(server);
+    }
+
+    void stop()
+    {
+        {
+            thread::MutexGuard guard(mutex);
+            stopping = true;
+        }
+        helpers::Socket wakeup(LOG4CPLUS_TEXT("localhost"), PORT);
+        join();
+    }
+
+private:
+    helpers::SocketState state;
+    helpers::SOCKET_TYPE server;
+    thread::Mutex mutex;
+    bool stopping;
+};
+
+
+int
+main()
+{
+    helpers::SharedObjectPtr<Receiver> receiver(new Receiver);
+    receiver->start();
+
+    // Each file rolled over is shipped.  Together with the current
+    // file, the shipped files hold all the lines in order, although
+    // the appender keeps only two backups.
+    {
+        helpers::Properties props;
+        props.setProperty(LOG4CPLUS_TEXT("File"), LOG4CPLUS_TEXT("test.log"));
+        props.setProperty(LOG4CPLUS_TEXT("Append"), LOG4CPLUS_TEXT("false"));
+        props.setProperty(LOG4CPLUS_TEXT("MaxFileSize"), LOG4CPLUS_TEXT("200KB"));
+        props.setProperty(LOG4CPLUS_TEXT("MaxBackupIndex"), LOG4CPLUS_TEXT("2"));
+        props.setProperty(LOG4CPLUS_TEXT("ShipTo"),
+            LOG4CPLUS_TEXT("localhost:9873"));
+        props.setProperty(LOG4CPLUS_TEXT("ShipSource"), LOG4CPLUS_TEXT("src"));
+        SharedAppenderPtr append(new RollingFileAppender(props));
+        append->setLayout(std::auto_ptr<Layout>(
+            new PatternLayout(LOG4CPLUS_TEXT("%m%n"))));
+        Logger logger = Logger::getInstance(LOG4CPLUS_TEXT("test.ship"));
+        logger.addAppender(append);
+        logger.setAdditivity(false);
+        for (int i = 0; i < LOOP_COUNT; ++i)
+            LOG4CPLUS_INFO(logger, "Entering loop #" << i
+                << ", nothing unusual to report, just some padding");
+
+        // The spool links are removed once the files are stored.
+        for (int wait = 0; wait < 100
+                 && ! listFiles("test.log.", ".ship").empty(); ++wait)
+            helpers::sleepmillis(100);
+        logger.removeAllAppenders();
+        append->close();
+    }
+
+    std::vector<std::string> const shipped = listFiles("src.test.log.", "");
+    std::cout << shipped.size() << " files shipped" << std::endl;
+    if (shipped.size() < 3 || ! listFiles("test.log.", ".ship").empty())
+    {
+        std::cout << "Rolled files not shipped" << std::endl;
+        return 1;
+    }
+    std::string all;
+    for (std::size_t i = 0; i < shipped.size(); ++i)
+    {
+        if (shipped[i].find(".part") != std::string::npos)
+        {
+            std::cout << "Partial file left: " << shipped[i] << std::endl;
+            return 1;
+        }
+        all += readFile(shipped[i]);
+    }
+    all += readFile("test.log");
+    std::istringstream lines(all);
+    std::string line;
+    int count = 0;
+    while (std::getline(lines, line))
+    {
+        std::ostringstream expected;
+        expected << "Entering loop #" << count
+            << ", nothing unusual to report, just some padding";
+        if (line != expected.str())
+        {
+            std::cout << "Unexpected line " << count << std::endl;
+            return 1;
+        }
+        ++count;
+    }
+    if (count != LOOP_COUNT)
+    {
+        std::cout << "Lines lost" << std::endl;
+        return 1;
+    }
+
+    // A file whose transfer was cut short is continued from what the
+    // server has, after the shipper is started again.
+    std::string const data(3 * 1024 * 1024 + 123, 'd');
+    {
+        std::ofstream out("resume.log.1", std::ios::out | std::ios::binary);
+        out << data;
+    }
+    {
+        FileShipper shipper(LOG4CPLUS_TEXT("localhost"), PORT + 1,
+            LOG4CPLUS_TEXT("resume.log"), LOG4CPLUS_TEXT("src"));
+        shipper.ship(LOG4CPLUS_TEXT("resume.log.1"));
+        shipper.close();
+    }
+    std::remove("resume.log.1");
+    std::vector<std::string> const spooled = listFiles("resume.log.", ".ship");
+    if (spooled.size() != 1)
+    {
+        std::cout << "File not spooled" << std::endl;
+        return 1;
+    }
+    std::string const target = "src." + spooled[0].substr(0,
+        spooled[0].size() - 5);
+    {
+        // The received part differs from the data, so that it shows
+        // which bytes were sent again.
+        std::ofstream out((target + ".part").c_str(),
+            std::ios::out | std::ios::binary);
+        out << std::string(1024 * 1024, 'p');
+    }
+    {
+        FileShipper shipper(LOG4CPLUS_TEXT("localhost"), PORT,
+            LOG4CPLUS_TEXT("resume.log"), LOG4CPLUS_TEXT("src"));
+        if (! shipper.waitShipped(10000) || shipper.getShippedCount() != 1)
+        {
+            std::cout << "Spooled file not shipped" << std::endl;
+            return 1;
+        }
+    }
+    std::string const received = readFile(target);
+    if (received != std::string(1024 * 1024, 'p')
+        + data.substr(1024 * 1024)
+        || ! listFiles("resume.log.", ".ship").empty())
+    {
+        std::cout << "Transfer not resumed" << std::endl;
+        return 1;
+    }
+
+    receiver->stop();
+    std::cout << "Exiting main()..." << std::endl;
+    return 0;
+}
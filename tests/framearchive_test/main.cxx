@@ -0,0 +1,173 @@
+#include <log4cplus/framearchive.h>
+#include <log4cplus/socketappender.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/socketbuffer.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+
+using namespace log4cplus;
+
+const int LOOP_COUNT = 20000;
+const int MAX_BACKUP_INDEX = 20;
+
+
+static tstring
+archiveName(int index)
+{
+    tostringstream oss;
+    oss << LOG4CPLUS_TEXT("frames.bin");
+    if (index != 0)
+        oss << LOG4CPLUS_TEXT(".") << index;
+    return oss.str();
+}
+
+
+static tstring
+message(int i)
+{
+    tostringstream oss;
+    oss << LOG4CPLUS_TEXT("Entering loop #") << i;
+    return oss.str();
+}
+
+
+static void
+removeArchives()
+{
+    for (int i = 0; i <= MAX_BACKUP_INDEX; ++i)
+    {
+        tstring const name = archiveName(i);
+        std::remove(LOG4CPLUS_TSTRING_TO_STRING(name).c_str());
+        tstring const indexName = name + FileIndex::SUFFIX;
+        std::remove(LOG4CPLUS_TSTRING_TO_STRING(indexName).c_str());
+    }
+}
+
+
+static void
+writeArchive(int first, int count)
+{
+    FrameArchiveWriter writer(LOG4CPLUS_TEXT("frames.bin"), 256 * 1024,
+        MAX_BACKUP_INDEX, 4 * 1024);
+    unsigned long const sources[2] = {
+        writer.addSource(LOG4CPLUS_TEXT("source a")),
+        writer.addSource(LOG4CPLUS_TEXT("source b")) };
+
+    for (int i = first; i < first + count; ++i)
+    {
+        spi::InternalLoggingEvent const event(
+            i % 2 ? LOG4CPLUS_TEXT("test.archive.b")
+                : LOG4CPLUS_TEXT("test.archive.a"),
+            i % 10 == 0 ? ERROR_LOG_LEVEL : INFO_LOG_LEVEL,
+            LOG4CPLUS_TEXT("ndc"), message(i), LOG4CPLUS_TEXT("main"),
+            helpers::Time(1000000 + i, 0), LOG4CPLUS_TEXT(__FILE__),
+            __LINE__);
+        helpers::SocketBuffer buffer(LOG4CPLUS_MAX_MESSAGE_SIZE
+            - sizeof(unsigned int));
+        helpers::convertToBuffer(buffer, event, tstring());
+        writer.append(sources[i % 2], buffer.getBuffer(), buffer.getSize());
+    }
+    writer.close();
+}
+
+
+int
+main()
+{
+    removeArchives();
+    writeArchive(0, LOOP_COUNT);
+
+    // Read all files, the oldest first.
+    std::vector<spi::InternalLoggingEvent> events;
+    int files = 0;
+    int newest = 0;
+    for (int index = MAX_BACKUP_INDEX; index >= 0; --index)
+    {
+        FrameArchiveReader reader(archiveName(index));
+        if (! reader.isOpen())
+            continue;
+
+        ++files;
+        newest = static_cast<int>(events.size());
+        while (reader.readEvent(events))
+        {
+            int const i = static_cast<int>(events.size()) - 1;
+            if (reader.getSource() != (i % 2 ? LOG4CPLUS_TEXT("source b")
+                    : LOG4CPLUS_TEXT("source a")))
+            {
+                std::cout << "Wrong source of event " << i << std::endl;
+                return 1;
+            }
+        }
+        if (reader.isDamaged())
+        {
+            std::cout << "Damaged archive" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << files << " archive files, " << events.size() << " events"
+        << std::endl;
+    if (files < 2 || events.size() != static_cast<std::size_t>(LOOP_COUNT))
+    {
+        std::cout << "Unexpected number of files or events" << std::endl;
+        return 1;
+    }
+    for (int i = 0; i < LOOP_COUNT; ++i)
+        if (events[i].getMessage() != message(i)
+            || events[i].getTimestamp() != helpers::Time(1000000 + i, 0))
+        {
+            std::cout << "Unexpected event " << i << std::endl;
+            return 1;
+        }
+
+    // A time range read starts at an index checkpoint and still finds
+    // every matching event of the newest file.
+    int const from = newest + (LOOP_COUNT - newest) / 2;
+    int const to = from + 100;
+    FileIndex index;
+    if (! index.read(archiveName(0) + FileIndex::SUFFIX)
+        || index.getCheckpoints().size() < 2)
+    {
+        std::cout << "Missing index" << std::endl;
+        return 1;
+    }
+
+    FrameArchiveReader reader(archiveName(0));
+    reader.setTimeRange(helpers::Time(1000000 + from, 0),
+        helpers::Time(1000000 + to, 0));
+    reader.setMinLogLevel(ERROR_LOG_LEVEL);
+    std::vector<spi::InternalLoggingEvent> found;
+    while (reader.readEvent(found))
+        ;
+    std::size_t expected = 0;
+    for (int i = from; i <= to; ++i)
+        if (i % 10 == 0)
+            ++expected;
+    std::cout << found.size() << " events in range" << std::endl;
+    if (found.size() != expected
+        || found.front().getMessage() != message((from + 9) / 10 * 10))
+    {
+        std::cout << "Unexpected events in range" << std::endl;
+        return 1;
+    }
+
+    // A new writer does not append to the file of the earlier one.
+    writeArchive(LOOP_COUNT, 10);
+    events.clear();
+    FrameArchiveReader restarted(archiveName(0));
+    while (restarted.readEvent(events))
+        ;
+    if (events.size() != 10 || events[0].getMessage() != message(LOOP_COUNT))
+    {
+        std::cout << "Archive of the earlier writer not rolled" << std::endl;
+        return 1;
+    }
+
+    removeArchives();
+    std::cout << "Exiting main()..." << std::endl;
+    return 0;
+}
@@ -0,0 +1,209 @@
+#include <log4cplus/framerelay.h>
+#include <log4cplus/socketappender.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/sleep.h>
+#include <log4cplus/helpers/socket.h>
+#include <log4cplus/helpers/socketbuffer.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/thread/syncprims.h>
+#include <log4cplus/thread/threads.h>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+
+using namespace log4cplus;
+
+const int LOOP_COUNT = 3000;
+const unsigned short PORT = 9871;
+
+
+static tstring
+message(int i)
+{
+    tostringstream oss;
+    oss << LOG4CPLUS_TEXT("Entering loop #") << i
+        << LOG4CPLUS_TEXT(", nothing unusual to report");
+    return oss.str();
+}
+
+
+static void
+appendFrame(FrameRelay & relay, int i)
+{
+    spi::InternalLoggingEvent const event(LOG4CPLUS_TEXT("test.relay"),
+        INFO_LOG_LEVEL, message(i), __FILE__, __LINE__);
+    helpers::SocketBuffer buffer(LOG4CPLUS_MAX_MESSAGE_SIZE
+        - sizeof(unsigned int));
+    helpers::convertToBuffer(buffer, event, LOG4CPLUS_TEXT("rack"));
+    relay.append(buffer.getBuffer(), buffer.getSize());
+}
+
+
+static long
+fileSize(char const * name)
+{
+    std::ifstream in(name, std::ios::in | std::ios::binary);
+    in.seekg(0, std::ios::end);
+    return in ? static_cast<long>(in.tellg()) : 0;
+}
+
+
+// Stands in for the upstream loggingserver.  It reads the expected
+// number of frames or, with none expected, one connection.
+class Receiver : public thread::AbstractThread
+{
+public:
+    explicit Receiver(std::size_t expected_) : expected(expected_) { }
+
+    virtual void run()
+    {
+        helpers::ServerSocket server(PORT);
+        do
+        {
+            helpers::Socket client = server.accept();
+            while ((expected == 0 || messages.size() < expected)
+                   && client.isOpen())
+            {
+                helpers::SocketBuffer sizeBuffer(sizeof(unsigned int));
+                if (! client.read(sizeBuffer))
+                    break;
+                helpers::SocketBuffer buffer(sizeBuffer.readInt());
+                if (! client.read(buffer))
+                    break;
+                messages.push_back(
+                    helpers::readFromBuffer(buffer).getMessage());
+            }
+        }
+        while (messages.size() < expected);
+    }
+
+    std::size_t expected;
+    std::vector<tstring> messages;
+};
+
+
+class Producer : public thread::AbstractThread
+{
+public:
+    explicit Producer(FrameRelay & relay_) : relay(relay_), produced(0) { }
+
+    virtual void run()
+    {
+        for (int i = 0; i < LOOP_COUNT; ++i)
+        {
+            appendFrame(relay, i);
+            thread::MutexGuard guard(mutex);
+            ++produced;
+        }
+    }
+
+    int getProduced()
+    {
+        thread::MutexGuard guard(mutex);
+        return produced;
+    }
+
+private:
+    FrameRelay & relay;
+    thread::Mutex mutex;
+    int produced;
+};
+
+
+int
+main()
+{
+    std::remove("relay.spool");
+
+    // With the upstream server down, frames fill the memory queue, then
+    // the spool file, and then the producer has to wait.
+    {
+        FrameRelay relay(LOG4CPLUS_TEXT("localhost"), PORT, 32 * 1024,
+            LOG4CPLUS_TEXT("relay.spool"), 128 * 1024, 64 * 1024);
+        helpers::SharedObjectPtr<Producer> producer(new Producer(relay));
+        producer->start();
+        helpers::sleepmillis(500);
+
+        int const produced = producer->getProduced();
+        long const spooled = fileSize("relay.spool");
+        std::cout << produced << " frames queued, " << spooled
+            << " bytes spooled" << std::endl;
+        if (produced == LOOP_COUNT || spooled == 0)
+        {
+            std::cout << "No backpressure" << std::endl;
+            return 1;
+        }
+
+        helpers::SharedObjectPtr<Receiver> receiver(
+            new Receiver(LOOP_COUNT));
+        receiver->start();
+        producer->join();
+        relay.flush();
+        receiver->join();
+
+        std::cout << relay.getForwardedCount() << " frames forwarded"
+            << std::endl;
+        if (relay.getForwardedCount() != static_cast<unsigned long>(LOOP_COUNT)
+            || receiver->messages.size() != static_cast<std::size_t>(LOOP_COUNT))
+        {
+            std::cout << "Unexpected number of frames" << std::endl;
+            return 1;
+        }
+        for (int i = 0; i < LOOP_COUNT; ++i)
+            if (receiver->messages[i] != message(i))
+            {
+                std::cout << "Unexpected frame " << i << std::endl;
+                return 1;
+            }
+        relay.close();
+    }
+
+    // The spool of a relay closed while the upstream server was down is
+    // forwarded by the next one.
+    int const spoolCount = 500;
+    {
+        FrameRelay relay(LOG4CPLUS_TEXT("localhost"), PORT, 0,
+            LOG4CPLUS_TEXT("relay.spool"));
+        for (int i = 0; i < spoolCount; ++i)
+            appendFrame(relay, i);
+        relay.close();
+    }
+    if (fileSize("relay.spool") == 0)
+    {
+        std::cout << "Nothing spooled" << std::endl;
+        return 1;
+    }
+    helpers::SharedObjectPtr<Receiver> receiver(new Receiver(0));
+    receiver->start();
+    unsigned long forwarded;
+    {
+        FrameRelay relay(LOG4CPLUS_TEXT("localhost"), PORT, 0,
+            LOG4CPLUS_TEXT("relay.spool"));
+        relay.flush();
+        forwarded = relay.getForwardedCount();
+    }
+    receiver->join();
+
+    // The spool holds the newest frames, after those kept in memory.
+    std::size_t const received = receiver->messages.size();
+    std::cout << received << " spooled frames forwarded" << std::endl;
+    if (received == 0 || received != forwarded)
+    {
+        std::cout << "Unexpected number of spooled frames" << std::endl;
+        return 1;
+    }
+    for (std::size_t i = 0; i < received; ++i)
+        if (receiver->messages[i] != message(
+                static_cast<int>(spoolCount - received + i)))
+        {
+            std::cout << "Unexpected spooled frame " << i << std::endl;
+            return 1;
+        }
+
+    std::remove("relay.spool");
+    std::cout << "Exiting main()..." << std::endl;
+    return 0;
+}
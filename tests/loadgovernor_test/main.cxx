@@ -0,0 +1,165 @@
+
+#include <log4cplus/logger.h>
+#include <log4cplus/appender.h>
+#include <log4cplus/configurator.h>
+#include <log4cplus/hierarchy.h>
+#include <log4cplus/loadgovernor.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/helpers/sleep.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <iostream>
+#include <map>
+
+
+using namespace log4cplus;
+using namespace log4cplus::helpers;
+
+
+// Counts the events that reach it per logger.
+class CountingAppender : public Appender
+{
+public:
+    virtual ~CountingAppender()
+    {
+        destructorImpl();
+    }
+
+    virtual void close()
+    {
+        closed = true;
+    }
+
+    std::map<tstring, int> counts;
+
+protected:
+    virtual void append(spi::InternalLoggingEvent const & event)
+    {
+        ++counts[event.getLoggerName()];
+    }
+};
+
+
+static int failures = 0;
+
+
+static void
+check(bool ok, char const * what)
+{
+    std::cout << (ok ? "ok: " : "FAILED: ") << what << std::endl;
+    if(! ok) {
+        ++failures;
+    }
+}
+
+
+// Ends the current measuring window.
+static void
+nextWindow(Logger & quiet)
+{
+    sleepmillis(120);
+    LOG4CPLUS_INFO(quiet, "tick");
+}
+
+
+int
+main()
+{
+    LogLog::getLogLog()->setInternalDebugging(true);
+
+    Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("log4cplus.rootLogger"),
+        LOG4CPLUS_TEXT("DEBUG"));
+    props.setProperty(LOG4CPLUS_TEXT("log4cplus.governor.EventsPerSecond"),
+        LOG4CPLUS_TEXT("1000"));
+    props.setProperty(LOG4CPLUS_TEXT("log4cplus.governor.Interval"),
+        LOG4CPLUS_TEXT("100"));
+    props.setProperty(LOG4CPLUS_TEXT("log4cplus.governor.RestoreAfter"),
+        LOG4CPLUS_TEXT("2"));
+    PropertyConfigurator config(props);
+    config.configure();
+
+    CountingAppender * counter = new CountingAppender;
+    Logger::getRoot().addAppender(SharedAppenderPtr(counter));
+
+    LoadGovernor & governor
+        = Logger::getDefaultHierarchy().getLoadGovernor();
+    tstring const noisyName = LOG4CPLUS_TEXT("test.noisy");
+    tstring const governorName = LOG4CPLUS_TEXT("log4cplus.governor");
+    Logger noisy = Logger::getInstance(noisyName);
+    Logger quiet = Logger::getInstance(LOG4CPLUS_TEXT("test.quiet"));
+    check(governor.isEnabled(), "the governor is configured");
+
+    // A burst over the budget raises the noisy logger one step.
+    for(int i = 0; i < 500; ++i) {
+        LOG4CPLUS_DEBUG(noisy, "debug " << i);
+    }
+    LOG4CPLUS_INFO(quiet, "quiet");
+    nextWindow(quiet);
+    check(noisy.getLogLevel() == INFO_LOG_LEVEL
+        && quiet.getLogLevel() == NOT_SET_LOG_LEVEL
+        && governor.getShedCount() == 1,
+        "the noisiest logger is raised to INFO");
+    check(counter->counts[governorName] == 1,
+        "the adjustment is logged");
+
+    for(int i = 0; i < 500; ++i) {
+        LOG4CPLUS_DEBUG(noisy, "debug " << i);
+        LOG4CPLUS_INFO(noisy, "info " << i);
+    }
+    check(counter->counts[noisyName] == 1000,
+        "DEBUG events of the raised logger are dropped");
+    nextWindow(quiet);
+    check(noisy.getLogLevel() == WARN_LOG_LEVEL
+        && governor.getShedCount() == 1,
+        "a continued burst raises it to MaxLevel");
+
+    for(int i = 0; i < 500; ++i) {
+        LOG4CPLUS_INFO(noisy, "info " << i);
+    }
+    LOG4CPLUS_WARN(noisy, "warning");
+    check(counter->counts[noisyName] == 1001,
+        "WARN events are kept");
+
+    // Levels come back only after RestoreAfter quiet windows.
+    nextWindow(quiet);
+    check(noisy.getLogLevel() == WARN_LOG_LEVEL,
+        "one quiet window does not restore the level");
+    nextWindow(quiet);
+    check(noisy.getLogLevel() == NOT_SET_LOG_LEVEL
+        && governor.getShedCount() == 0,
+        "quiet windows restore the inherited level");
+    check(counter->counts[governorName] == 3,
+        "each adjustment is logged");
+
+    // A level changed by hand is left alone.
+    for(int i = 0; i < 500; ++i) {
+        LOG4CPLUS_DEBUG(noisy, "debug " << i);
+    }
+    nextWindow(quiet);
+    noisy.setLogLevel(ERROR_LOG_LEVEL);
+    nextWindow(quiet);
+    nextWindow(quiet);
+    check(noisy.getLogLevel() == ERROR_LOG_LEVEL
+        && governor.getShedCount() == 0,
+        "a level set meanwhile is kept");
+
+    // Windows without any events count as quiet, too.
+    noisy.setLogLevel(NOT_SET_LOG_LEVEL);
+    for(int i = 0; i < 500; ++i) {
+        LOG4CPLUS_DEBUG(noisy, "debug " << i);
+    }
+    nextWindow(quiet);
+    check(noisy.getLogLevel() == INFO_LOG_LEVEL,
+        "a new burst raises the level again");
+    sleepmillis(250);
+    nextWindow(quiet);
+    check(noisy.getLogLevel() == NOT_SET_LOG_LEVEL
+        && governor.getShedCount() == 0,
+        "windows without events restore the level");
+
+    Logger::getDefaultHierarchy().resetConfiguration();
+    check(! governor.isEnabled(), "resetConfiguration() disables it");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,314 @@
+// Runs log4cplus-query over rotated text logs and a segment file and
+// compares its output with the records that match each query.
+
+// The tool is compiled into the test, its main() renamed.
+#define main logquery_main
+#include "../../logquery/logquery.cxx"
+#undef main
+
+#include <log4cplus/segmentappender.h>
+#include <cerrno>
+
+#if defined (_WIN32)
+#  include <io.h>
+#  include <fcntl.h>
+#  define dup _dup
+#  define dup2 _dup2
+#  define close _close
+#  define open _open
+#endif
+
+
+// Records are 10 ms apart.  Even records are in the text logs, the
+// older ones in the rotated app.log.1, every tenth odd record is in
+// app.seg.
+int const RECORDS = 80000;
+int const ROTATED = 60000;
+
+char const NEEDLE[] = "caused-by-pool-timeout-in-worker";
+
+
+static Time base;
+static int failures = 0;
+
+
+static void
+check(bool ok, char const * what)
+{
+    std::cout << (ok ? "ok: " : "FAILED: ") << what << std::endl;
+    if (! ok)
+        ++failures;
+}
+
+
+static bool
+inText(int i)
+{
+    return i % 2 == 0;
+}
+
+
+static bool
+inSegment(int i)
+{
+    return i % 10 == 1;
+}
+
+
+static Time
+timeOf(int i)
+{
+    return base + Time(i / 100, (i % 100) * 10000);
+}
+
+
+static spi::InternalLoggingEvent
+eventOf(int i)
+{
+    LogLevel const ll = i % 7 == 0 ? ERROR_LOG_LEVEL
+        : (i % 5 == 0 ? WARN_LOG_LEVEL : INFO_LOG_LEVEL);
+    // app.dbx is not a descendant of app.db.
+    tchar const * const loggers[3] = { LOG4CPLUS_TEXT("app.db"),
+        LOG4CPLUS_TEXT("app.db.pool"), LOG4CPLUS_TEXT("app.dbx") };
+
+    tostringstream msg;
+    msg << LOG4CPLUS_TEXT("request ") << i;
+    if (inText(i))
+    {
+        // Long enough for app.log.1 to be searched in two chunks.
+        msg << LOG4CPLUS_TEXT(' ') << tstring(100, LOG4CPLUS_TEXT('.'));
+        if (i % 1000 == 0)
+            msg << LOG4CPLUS_TEXT("\n\t") << LOG4CPLUS_C_STR_TO_TSTRING(NEEDLE);
+    }
+    else if (i % 100 == 1)
+        msg << LOG4CPLUS_TEXT(' ') << LOG4CPLUS_C_STR_TO_TSTRING(NEEDLE);
+
+    return spi::InternalLoggingEvent(loggers[i % 3], ll, tstring(),
+        msg.str(), LOG4CPLUS_TEXT("main"), timeOf(i), tstring(), 0);
+}
+
+
+static string
+render(PatternLayout & layout, int i)
+{
+    tostringstream oss;
+    layout.formatAndAppend(oss, eventOf(i));
+    return LOG4CPLUS_TSTRING_TO_STRING(oss.str());
+}
+
+
+static void
+writeLogs()
+{
+    PatternLayout layout(LOG4CPLUS_C_STR_TO_TSTRING(
+        logquery::DEFAULT_PATTERN));
+    std::ofstream rotated("app.log.1", std::ios::binary | std::ios::trunc);
+    std::ofstream current("app.log", std::ios::binary | std::ios::trunc);
+    SharedAppenderPtr segment(new SegmentAppender(LOG4CPLUS_TEXT("app.seg"),
+        1000));
+    for (int i = 0; i != RECORDS; ++i)
+    {
+        if (inText(i))
+            (i < ROTATED ? rotated : current) << render(layout, i);
+        else if (inSegment(i))
+            segment->doAppend(eventOf(i));
+    }
+    segment->close();
+}
+
+
+struct Filter
+{
+    Filter()
+        : from(0)
+        , to(RECORDS)
+        , minLevel(NOT_SET_LOG_LEVEL)
+        , needle(false)
+    { }
+
+    int from;
+    int to;
+    LogLevel minLevel;
+    string logger;
+    bool needle;
+};
+
+
+//! The records the query should print, in time order.
+static string
+expected(Filter const & f)
+{
+    PatternLayout layout(LOG4CPLUS_C_STR_TO_TSTRING(
+        logquery::DEFAULT_PATTERN));
+    string result;
+    for (int i = f.from; i <= f.to && i != RECORDS; ++i)
+    {
+        if (! inText(i) && ! inSegment(i))
+            continue;
+        spi::InternalLoggingEvent const event = eventOf(i);
+        string const logger = LOG4CPLUS_TSTRING_TO_STRING(
+            event.getLoggerName());
+        string const text = render(layout, i);
+        if (event.getLogLevel() < f.minLevel
+            || (! f.logger.empty() && logger != f.logger
+                && logger.compare(0, f.logger.size() + 1,
+                    f.logger + ".") != 0)
+            || (f.needle && text.find(NEEDLE) == string::npos))
+            continue;
+        result += text;
+    }
+    return result;
+}
+
+
+//! Runs the tool with its standard output sent to a file.
+static string
+query(char const * const * args, int & rc)
+{
+    std::vector<char *> argv;
+    argv.push_back(const_cast<char *>("log4cplus-query"));
+    for (; *args; ++args)
+        argv.push_back(const_cast<char *>(*args));
+    argv.push_back(0);
+
+    std::cout.flush();
+    fflush(stdout);
+    int const saved = dup(1);
+    int const fd = open("query.out", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    dup2(fd, 1);
+    close(fd);
+    rc = logquery_main(static_cast<int>(argv.size() - 1), &argv[0]);
+    fflush(stdout);
+    dup2(saved, 1);
+    close(saved);
+
+    std::ifstream in("query.out", std::ios::binary);
+    std::ostringstream oss;
+    oss << in.rdbuf();
+    return oss.str();
+}
+
+
+static void
+checkQuery(char const * const * args, Filter const & f, char const * what)
+{
+    int rc = -1;
+    string const out = query(args, rc);
+    string const want = expected(f);
+    bool const ok = rc == 0 && out == want;
+    check(ok, what);
+    if (! ok)
+        std::cout << "  rc " << rc << ", " << out.size() << " bytes, expected "
+                  << want.size() << std::endl;
+}
+
+
+static string
+localTime(int i, char const * fmt)
+{
+    tstring const s = timeOf(i).getFormattedTime(
+        LOG4CPLUS_C_STR_TO_TSTRING(fmt));
+    return LOG4CPLUS_TSTRING_TO_STRING(s);
+}
+
+
+int
+main()
+{
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_year = 2026 - 1900;
+    tm.tm_mon = 2;
+    tm.tm_mday = 1;
+    tm.tm_hour = 12;
+    tm.tm_isdst = -1;
+    base.setTime(&tm);
+
+    writeLogs();
+
+    // The files are given newest first; the merge restores time order.
+    {
+        char const * args[] = { "app.log", "app.seg", "app.log.1", 0 };
+        checkQuery(args, Filter(), "all records are merged in time order");
+    }
+    {
+        char const * args[] = { "-j", "1", "app.log.1", "app.log",
+            "app.seg", 0 };
+        checkQuery(args, Filter(), "a single thread prints the same");
+    }
+
+    // Across the rotation, in both time formats.
+    {
+        Filter f;
+        f.from = 55000;
+        f.to = 65000;
+        string const from = localTime(f.from, "%Y-%m-%dT%H:%M:%S");
+        string const to = localTime(f.to, "%Y-%m-%d %H:%M:%S");
+        char const * args[] = { "-from", from.c_str(), "-to", to.c_str(),
+            "app.log", "app.log.1", "app.seg", 0 };
+        checkQuery(args, f, "-from and -to select a time range");
+    }
+    {
+        Filter f;
+        f.from = 30000;
+        std::ostringstream oss;
+        oss << timeOf(f.from).sec();
+        string const from = oss.str();
+        char const * args[] = { "-from", from.c_str(), "app.log",
+            "app.log.1", "app.seg", 0 };
+        checkQuery(args, f, "-from takes seconds since the epoch");
+    }
+
+    {
+        Filter f;
+        f.minLevel = WARN_LOG_LEVEL;
+        char const * args[] = { "-level", "WARN", "app.log", "app.log.1",
+            "app.seg", 0 };
+        checkQuery(args, f, "-level selects the level and above");
+    }
+    {
+        Filter f;
+        f.logger = "app.db";
+        char const * args[] = { "-logger", "app.db", "app.log", "app.log.1",
+            "app.seg", 0 };
+        checkQuery(args, f, "-logger selects the logger and descendants");
+    }
+    {
+        Filter f;
+        f.needle = true;
+        char const * args[] = { "-text", NEEDLE, "app.log", "app.log.1",
+            "app.seg", 0 };
+        checkQuery(args, f, "-text searches messages and continuation lines");
+    }
+    {
+        Filter f;
+        f.from = 20000;
+        f.to = 70000;
+        f.minLevel = WARN_LOG_LEVEL;
+        f.logger = "app.db";
+        f.needle = true;
+        string const from = localTime(f.from, "%Y-%m-%dT%H:%M:%S");
+        string const to = localTime(f.to, "%Y-%m-%dT%H:%M:%S");
+        char const * args[] = { "-from", from.c_str(), "-to", to.c_str(),
+            "-level", "WARN", "-logger", "app.db", "-text", NEEDLE,
+            "app.log", "app.log.1", "app.seg", 0 };
+        checkQuery(args, f, "the filters combine");
+    }
+
+    {
+        char const * args[] = { "-level", "LOUD", "app.log", 0 };
+        int rc = 0;
+        query(args, rc);
+        check(rc == 2, "an invalid level is rejected");
+    }
+    {
+        char const * args[] = { "missing.log", 0 };
+        int rc = 0;
+        string const out = query(args, rc);
+        check(rc == 1 && out.empty(), "a missing file is reported");
+    }
+
+    std::cout << (failures == 0 ? "All tests passed." : "Some tests failed.")
+              << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -2,11 +2,202 @@
 #include "log4cplus/logger.h"
 #include "log4cplus/consoleappender.h"
 #include "log4cplus/loglevel.h"
+#include "log4cplus/helpers/property.h"
+#include "log4cplus/helpers/stringhelper.h"
 #include <iomanip>
+#include <iostream>
+#include <limits>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#if defined (__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 using namespace log4cplus;
 
+
+// Checks helpers::decimal() and the conversions behind it.
+static bool
+checkDecimal()
+{
+    struct { double value; char const * expected; } const doubles[] = {
+        { 0.1, "0.1" }, { 1.5, "1.5" }, { -2.0, "-2" }, { 0.0, "0" },
+        { -0.0, "-0" }, { 1e300, "1e+300" }, { 123456789012345.0,
+            "123456789012345" }, { 1234567890123456.0, "1234567890123456" },
+        { 0.30000000000000004, "0.30000000000000004" },
+        { 5e-324, "5e-324" }, { 2.5e-320, "2.5e-320" }
+    };
+    for (size_t i = 0; i != sizeof (doubles) / sizeof (doubles[0]); ++i)
+    {
+        tstring str;
+        helpers::convertDoubleToString(str, doubles[i].value);
+        if (str != LOG4CPLUS_C_STR_TO_TSTRING(doubles[i].expected))
+        {
+            cout << "decimal(" << doubles[i].expected << ") failed" << endl;
+            return false;
+        }
+    }
+
+    srand(1);
+    for (int i = 0; i != 100000; ++i)
+    {
+        double value;
+        unsigned char * const bytes = reinterpret_cast<unsigned char *>(&value);
+        for (size_t j = 0; j != sizeof (value); ++j)
+            bytes[j] = static_cast<unsigned char>(rand());
+        if (value != value || value - value != 0)
+            continue;
+
+        tostringstream os;
+        os << helpers::decimal(value);
+        tstring const str = os.str();
+        if (strtod(LOG4CPLUS_TSTRING_TO_STRING(str).c_str(), 0) != value)
+        {
+            tcout << LOG4CPLUS_TEXT("no round trip: ") << str << endl;
+            return false;
+        }
+    }
+
+    tostringstream os;
+    os << helpers::decimal((numeric_limits<long>::min)()) << ' '
+        << helpers::decimal(1234567u) << ' ' << helpers::decimal(-7)
+        << ' ' << helpers::decimal(0);
+    ostringstream expected;
+    expected << (numeric_limits<long>::min)() << " 1234567 -7 0";
+    if (os.str() != LOG4CPLUS_STRING_TO_TSTRING(expected.str()))
+    {
+        tcout << LOG4CPLUS_TEXT("integers: ") << os.str() << endl;
+        return false;
+    }
+
+    return true;
+}
+
+#if defined (__linux__)
+// Reads what is in the pipe without waiting.
+static string
+drainPipe(int fd)
+{
+    string data;
+    char buf[4096];
+    ssize_t ret;
+    while ((ret = read(fd, buf, sizeof (buf))) > 0)
+        data.append(buf, ret);
+    return data;
+}
+
+
+// Logs to a pipe nobody reads with NonBlocking DirectWrite.  Events
+// that do not fit are dropped and counted, the rest arrive as whole
+// lines, and an event too long for the pipe does not block either.
+static bool
+checkNonBlocking()
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+
+    cout.flush();
+    tcout.flush();
+    int const saved_stdout = dup(STDOUT_FILENO);
+    dup2(fds[1], STDOUT_FILENO);
+    // A blocked write fails the test instead of hanging it.
+    alarm(30);
+
+    helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("DirectWrite"), LOG4CPLUS_TEXT("true"));
+    props.setProperty(LOG4CPLUS_TEXT("NonBlocking"), LOG4CPLUS_TEXT("true"));
+    props.setProperty(LOG4CPLUS_TEXT("PipeSize"), LOG4CPLUS_TEXT("4096"));
+    props.setProperty(LOG4CPLUS_TEXT("ImmediateFlush"),
+        LOG4CPLUS_TEXT("false"));
+    ConsoleAppender * console = new ConsoleAppender(props);
+    SharedAppenderPtr appender(console);
+    Logger logger = Logger::getInstance(LOG4CPLUS_TEXT("nonblocking"));
+    logger.setAdditivity(false);
+    logger.addAppender(appender);
+
+    int const total = 5000;
+    tstring const padding(60, LOG4CPLUS_TEXT('x'));
+    for (int i = 0; i != total; ++i)
+        LOG4CPLUS_INFO(logger, "event " << i << ' ' << padding);
+    appender->close();
+    unsigned long const dropped = console->getDroppedCount();
+
+    // Everything that was written consists of whole lines.
+    string const data = drainPipe(fds[0]);
+    bool ok = dropped != 0 && ! data.empty () && data[data.size() - 1] == '\n';
+    unsigned long lines = 0;
+    for (string::size_type pos = 0, end; ok && pos != data.size(); pos = end + 1)
+    {
+        end = data.find('\n', pos);
+        ok = data.compare(pos, 13, "INFO - event ") == 0
+            && end - pos > padding.size() && data[end - 1] == 'x';
+        ++lines;
+    }
+    ok = ok && lines + dropped == static_cast<unsigned long>(total);
+
+    // An event longer than the pipe is written in part, then cut off.
+    SharedAppenderPtr long_appender(new ConsoleAppender(props));
+    ConsoleAppender * long_console
+        = static_cast<ConsoleAppender *>(long_appender.get());
+    logger.removeAllAppenders();
+    logger.addAppender(long_appender);
+    LOG4CPLUS_INFO(logger, tstring(1 << 20, LOG4CPLUS_TEXT('y')));
+    ok = ok && long_console->getDroppedCount() == 1;
+    logger.removeAllAppenders();
+    drainPipe(fds[0]);
+
+    alarm(0);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+    close(fds[0]);
+    close(fds[1]);
+
+    cout << "NonBlocking: " << lines << " lines written, " << dropped
+         << " events dropped" << endl;
+    return ok;
+}
+
+
+// Without ImmediateFlush set, DirectWrite writes each event at once, so
+// nothing is left in the batch when the process exits.
+static bool
+checkDirectWriteDefault()
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+
+    cout.flush();
+    tcout.flush();
+    int const saved_stdout = dup(STDOUT_FILENO);
+    dup2(fds[1], STDOUT_FILENO);
+
+    helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("DirectWrite"), LOG4CPLUS_TEXT("true"));
+    SharedAppenderPtr appender(new ConsoleAppender(props));
+    Logger logger = Logger::getInstance(LOG4CPLUS_TEXT("direct"));
+    logger.setAdditivity(false);
+    logger.addAppender(appender);
+    LOG4CPLUS_INFO(logger, "written at once");
+    string const data = drainPipe(fds[0]);
+    logger.removeAllAppenders();
+
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+    close(fds[0]);
+    close(fds[1]);
+
+    return data == "INFO - written at once\n";
+}
+#endif
+
+
 int
 main()
 {
@@ -44,7 +235,39 @@ main()
     LOG4CPLUS_WARN(test, "The following message is empty:");
     LOG4CPLUS_WARN(test, "");
 
-    return 0;
+    // The same through write(2), batched and then one call per event.
+    helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("DirectWrite"), LOG4CPLUS_TEXT("true"));
+    for (int immediate = 0; immediate != 2; ++immediate)
+    {
+        props.setProperty(LOG4CPLUS_TEXT("ImmediateFlush"),
+            immediate ? LOG4CPLUS_TEXT("true") : LOG4CPLUS_TEXT("false"));
+        SharedAppenderPtr direct(new ConsoleAppender(props));
+        direct->setName(LOG4CPLUS_TEXT("Direct"));
+        root.removeAllAppenders();
+        root.addAppender(direct);
+
+        LOG4CPLUS_INFO(test, "DirectWrite, ImmediateFlush: " << immediate);
+        LOG4CPLUS_WARN(test, "This is a double: " << (double)1.2345234234);
+        direct->flush();
+        LOG4CPLUS_ERROR(test, "Written on close");
+        root.removeAllAppenders();
+    }
+
+    bool ok = checkDecimal();
+#if defined (__linux__)
+    if (! checkNonBlocking())
+    {
+        cout << "NonBlocking check failed" << endl;
+        ok = false;
+    }
+    if (! checkDirectWriteDefault())
+    {
+        cout << "DirectWrite default check failed" << endl;
+        ok = false;
+    }
+#endif
+    return ok ? 0 : 1;
 }
 
 
@@ -1,12 +1,18 @@
 
 #include <log4cplus/logger.h>
 #include <log4cplus/consoleappender.h>
+#include <log4cplus/socketappender.h>
 #include <log4cplus/layout.h>
 #include <log4cplus/ndc.h>
+#include <log4cplus/spi/loggingevent.h>
 #include <log4cplus/helpers/loglog.h>
 #include <log4cplus/thread/threads.h>
 #include <log4cplus/helpers/sleep.h>
+#include <log4cplus/helpers/property.h>
+#include <cstring>
+#include <limits>
 #include <iostream>
+#include <locale>
 #include <string>
 
 using namespace std;
@@ -27,6 +33,13 @@ main()
         append_1->setLayout( std::auto_ptr<Layout>(new PatternLayout(pattern)) );
         Logger::getRoot().addAppender(append_1);
 
+        // A second appender with the same pattern reuses the output
+        // formatted for the first one.
+        SharedObjectPtr<Appender> append_2(new ConsoleAppender());
+        append_2->setName(LOG4CPLUS_TEXT("Second"));
+        append_2->setLayout( std::auto_ptr<Layout>(new PatternLayout(pattern)) );
+        Logger::getRoot().addAppender(append_2);
+
         Logger logger = Logger::getInstance(LOG4CPLUS_TEXT("test.a.long_logger_name.c.logger"));
         LOG4CPLUS_DEBUG(logger, "This is the FIRST log message...");
 
@@ -44,6 +57,151 @@ main()
 
         sleep(1, 0);
         LOG4CPLUS_FATAL(logger, "This is the FOURTH log message...");
+
+        spi::InternalLoggingEvent event(logger.getName(), INFO_LOG_LEVEL,
+            LOG4CPLUS_TEXT("Shared output"), __FILE__, __LINE__);
+        PatternLayout first(pattern);
+        PatternLayout second(pattern);
+        log4cplus::tostringstream out_0, out_1, out_2;
+        first.formatAndAppend(out_0, event);
+        if(event.hasFormattedOutput()) {
+            cout << "Output of an event for one appender was stored" << endl;
+            return 1;
+        }
+        event.setOutputShared(true);
+        first.formatAndAppend(out_1, event);
+        second.formatAndAppend(out_2, event);
+        if(out_0.str() != out_1.str() || out_1.str() != out_2.str()
+           || event.getFormattedOutput(&second, out_2.getloc()) == 0) {
+            cout << "Output of equivalent layouts was not shared" << endl;
+            return 1;
+        }
+
+        // Output for a stream with another locale is not reused.
+        log4cplus::tostringstream out_3;
+        out_3.imbue(std::locale(std::locale::classic(),
+            new std::numpunct<tchar>()));
+        if(event.getFormattedOutput(&second, out_3.getloc()) != 0) {
+            cout << "Output was shared across locales" << endl;
+            return 1;
+        }
+
+        // JSON lines, with characters that need escaping.
+        Properties props;
+        props.setProperty(LOG4CPLUS_TEXT("Fields"),
+            LOG4CPLUS_TEXT("level, logger,line,message"));
+        JsonLayout json(props);
+        spi::InternalLoggingEvent json_event(LOG4CPLUS_TEXT("json"),
+            WARN_LOG_LEVEL,
+            LOG4CPLUS_TEXT("a \"quoted\" word\\ across\nlines\tand\x01 a long tail"),
+            __FILE__, 42);
+        log4cplus::tostringstream json_out;
+        json.formatAndAppend(json_out, json_event);
+        log4cplus::tcout << json_out.str();
+        if(json_out.str() != LOG4CPLUS_TEXT("{\"level\":\"WARN\",\"logger\":\"json\",")
+           LOG4CPLUS_TEXT("\"line\":42,\"message\":\"a \\\"quoted\\\" word\\\\ across")
+           LOG4CPLUS_TEXT("\\nlines\\tand\\u0001 a long tail\"}\n")) {
+            cout << "Unexpected JsonLayout output" << endl;
+            return 1;
+        }
+
+        // Typed event fields.  Unsigned values above LONG_MAX keep
+        // their value.
+        unsigned long const bytes = (std::numeric_limits<unsigned long>::max)();
+        log4cplus::tostringstream bytes_text;
+        bytes_text << bytes;
+        spi::InternalLoggingEvent fields_event(LOG4CPLUS_TEXT("fields"),
+            INFO_LOG_LEVEL, LOG4CPLUS_TEXT("done"), __FILE__, 7);
+        fields_event.setFields(spi::EventFields()
+            (LOG4CPLUS_TEXT("user"), LOG4CPLUS_TEXT("bob \"b\""))
+            (LOG4CPLUS_TEXT("ms"), 12.5)
+            (LOG4CPLUS_TEXT("count"), -3)
+            (LOG4CPLUS_TEXT("cached"), true)
+            (LOG4CPLUS_TEXT("bytes"), bytes));
+        std::auto_ptr<spi::InternalLoggingEvent> fields_clone
+            = fields_event.clone();
+
+        PatternLayout fields_pattern(
+            LOG4CPLUS_TEXT("%X{ms}|%X{missing}|%X%n"));
+        log4cplus::tostringstream pattern_out;
+        fields_pattern.formatAndAppend(pattern_out, *fields_clone);
+        log4cplus::tcout << pattern_out.str();
+        if(pattern_out.str() != LOG4CPLUS_TEXT("12.5||user=bob \"b\" ms=12.5 ")
+           LOG4CPLUS_TEXT("count=-3 cached=true bytes=") + bytes_text.str()
+           + LOG4CPLUS_TEXT("\n")) {
+            cout << "Unexpected %X output" << endl;
+            return 1;
+        }
+
+        // The fields survive the socket protocol.
+        SocketBuffer socket_buffer(8192);
+        convertToBuffer(socket_buffer, fields_event, LOG4CPLUS_TEXT(""));
+        SocketBuffer read_buffer(socket_buffer.getSize());
+        std::memcpy(read_buffer.getBuffer(), socket_buffer.getBuffer(),
+            socket_buffer.getSize());
+        spi::InternalLoggingEvent received = readFromBuffer(read_buffer);
+
+        props.setProperty(LOG4CPLUS_TEXT("Fields"),
+            LOG4CPLUS_TEXT("message,fields"));
+        JsonLayout json_fields(props);
+        log4cplus::tostringstream fields_out;
+        json_fields.formatAndAppend(fields_out, received);
+        log4cplus::tcout << fields_out.str();
+        if(fields_out.str() != LOG4CPLUS_TEXT("{\"message\":\"done\",\"fields\":")
+           LOG4CPLUS_TEXT("{\"user\":\"bob \\\"b\\\"\",\"ms\":12.5,")
+           LOG4CPLUS_TEXT("\"count\":-3,\"cached\":true,\"bytes\":")
+           + bytes_text.str() + LOG4CPLUS_TEXT("}}\n")) {
+            cout << "Unexpected JsonLayout fields output" << endl;
+            return 1;
+        }
+
+        // Events that need neither nanoseconds nor fields go out as
+        // version 2, which older readers understand.
+        spi::InternalLoggingEvent plain_event(LOG4CPLUS_TEXT("plain"),
+            INFO_LOG_LEVEL, LOG4CPLUS_TEXT(""), LOG4CPLUS_TEXT("plain"),
+            LOG4CPLUS_TEXT("1"), Time(1000, 250), LOG4CPLUS_TEXT(""), 1);
+        SocketBuffer plain_buffer(8192);
+        convertToBuffer(plain_buffer, plain_event, LOG4CPLUS_TEXT(""));
+        if(static_cast<unsigned char>(plain_buffer.getBuffer()[0]) != 2) {
+            cout << "Plain event not sent as message version 2" << endl;
+            return 1;
+        }
+        SocketBuffer plain_read(plain_buffer.getSize());
+        std::memcpy(plain_read.getBuffer(), plain_buffer.getBuffer(),
+            plain_buffer.getSize());
+        if(readFromBuffer(plain_read).getTimestamp() != Time(1000, 250)) {
+            cout << "Version 2 message timestamp mismatch" << endl;
+            return 1;
+        }
+
+        // A sub-microsecond part that would carry into the microseconds
+        // is ignored.
+        SocketBuffer carry_src(plain_buffer.getSize() + 4);
+        carry_src.appendBuffer(plain_buffer);
+        carry_src.appendInt(1000);
+        carry_src.getBuffer()[0] = 3;
+        SocketBuffer carry(carry_src.getSize());
+        std::memcpy(carry.getBuffer(), carry_src.getBuffer(),
+            carry_src.getSize());
+        if(readFromBuffer(carry).getTimestamp() != Time(1000, 250)) {
+            cout << "Invalid sub-microsecond part accepted" << endl;
+            return 1;
+        }
+
+        // A version 4 message claiming more fields than it can hold is
+        // rejected at once.
+        SocketBuffer hostile_src(plain_buffer.getSize() + 8);
+        hostile_src.appendBuffer(plain_buffer);
+        hostile_src.appendInt(0);
+        hostile_src.appendInt(0xFFFFFFFFu);
+        hostile_src.getBuffer()[0] = 4;
+        SocketBuffer hostile(hostile_src.getSize());
+        std::memcpy(hostile.getBuffer(), hostile_src.getBuffer(),
+            hostile_src.getSize());
+        if(! readFromBuffer(hostile).getFields().empty()) {
+            cout << "Bogus field count accepted" << endl;
+            return 1;
+        }
     }
     catch(...) {
         cout << "Exception..." << endl;
@@ -0,0 +1,229 @@
+#include <log4cplus/logger.h>
+#include <log4cplus/segmentappender.h>
+#include <log4cplus/ndc.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/lzcodec.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+using namespace log4cplus;
+
+//! Above LONG_MAX, so the ids only survive as unsigned fields.
+const unsigned long ID_BASE = (std::numeric_limits<unsigned long>::max)();
+const int LOOP_COUNT = 20000;
+const int MAX_BACKUP_INDEX = 20;
+
+
+static bool
+checkLZ()
+{
+    std::string inputs[4];
+    for (int i = 0; i != 1000; ++i)
+    {
+        std::ostringstream oss;
+        oss << "request " << i << " done in " << (i * 7 % 13) << " ms\n";
+        inputs[1] += oss.str();
+        inputs[2] += static_cast<char>(std::rand());
+    }
+    inputs[3] = std::string(70000, 'a') + "tail";
+
+    for (int i = 0; i != 4; ++i)
+    {
+        std::string compressed;
+        helpers::lzCompress(compressed, inputs[i].data(), inputs[i].size());
+        std::string restored;
+        if (! helpers::lzDecompress(restored, compressed.data(),
+                compressed.size(), inputs[i].size())
+            || restored != inputs[i])
+        {
+            std::cout << "LZ round trip " << i << " failed" << std::endl;
+            return false;
+        }
+        std::cout << "LZ " << inputs[i].size() << " -> "
+            << compressed.size() << std::endl;
+
+        if (! inputs[i].empty ())
+        {
+            std::string damaged;
+            if (helpers::lzDecompress(damaged, compressed.data(),
+                    compressed.size() - 1, inputs[i].size()))
+            {
+                std::cout << "Truncated LZ input accepted" << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+static tstring
+backupName(int index)
+{
+    tostringstream oss;
+    oss << LOG4CPLUS_TEXT("segment.log");
+    if (index != 0)
+        oss << LOG4CPLUS_TEXT(".") << index;
+    return oss.str();
+}
+
+
+static LogLevel
+levelOf(int i)
+{
+    return i % 1000 == 0 ? ERROR_LOG_LEVEL
+        : (i % 3 == 0 ? INFO_LOG_LEVEL : DEBUG_LOG_LEVEL);
+}
+
+
+int
+main()
+{
+    if (! checkLZ())
+        return 1;
+
+    for (int i = 0; i <= MAX_BACKUP_INDEX; ++i)
+        std::remove(LOG4CPLUS_TSTRING_TO_STRING(backupName(i)).c_str());
+
+    SharedAppenderPtr append_1(new SegmentAppender(
+        LOG4CPLUS_TEXT("segment.log"), 256, 200 * 1024, MAX_BACKUP_INDEX));
+    append_1->setName(LOG4CPLUS_TEXT("First"));
+
+    Logger root = Logger::getRoot();
+    root.setLogLevel(TRACE_LOG_LEVEL);
+    root.addAppender(append_1);
+    Logger loggers[2] = {
+        Logger::getInstance(LOG4CPLUS_TEXT("test.segment.a")),
+        Logger::getInstance(LOG4CPLUS_TEXT("test.segment.b")) };
+
+    NDCContextCreator ndc(LOG4CPLUS_TEXT("segment"));
+    for (int i = 0; i < LOOP_COUNT; ++i)
+    {
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT("Entering loop #") << i
+            << LOG4CPLUS_TEXT(", nothing unusual to report");
+        if (i % 10 == 0)
+            loggers[i % 2].forcedLog(levelOf(i), oss.str(),
+                spi::EventFields()
+                    (LOG4CPLUS_TEXT("i"), i)
+                    (LOG4CPLUS_TEXT("half"), i / 2.0)
+                    (LOG4CPLUS_TEXT("even"), i % 20 == 0)
+                    (LOG4CPLUS_TEXT("id"), ID_BASE - i),
+                __FILE__, __LINE__);
+        else
+            loggers[i % 2].forcedLog(levelOf(i), oss.str(), __FILE__,
+                __LINE__);
+    }
+    root.removeAllAppenders();
+    append_1->close();
+
+    // Read all files, the oldest first.
+    std::vector<spi::InternalLoggingEvent> events;
+    int files = 0;
+    for (int index = MAX_BACKUP_INDEX; index >= 0; --index)
+    {
+        SegmentReader reader(backupName(index));
+        if (! reader.isOpen())
+            continue;
+
+        ++files;
+        while (reader.readRowGroup(events))
+            ;
+        if (reader.isDamaged())
+        {
+            std::cout << "Damaged segment file" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << files << " segment files, " << events.size() << " events"
+        << std::endl;
+    if (files < 2 || events.size() != static_cast<std::size_t>(LOOP_COUNT))
+    {
+        std::cout << "Unexpected number of files or events" << std::endl;
+        return 1;
+    }
+
+    for (int i = 0; i < LOOP_COUNT; ++i)
+    {
+        spi::InternalLoggingEvent const & event = events[i];
+        tostringstream oss;
+        oss << LOG4CPLUS_TEXT("Entering loop #") << i
+            << LOG4CPLUS_TEXT(", nothing unusual to report");
+        if (event.getMessage() != oss.str()
+            || event.getLogLevel() != levelOf(i)
+            || event.getLoggerName() != loggers[i % 2].getName()
+            || event.getNDC() != LOG4CPLUS_TEXT("segment")
+            || event.getLine() <= 0
+            || event.getFields().size() != (i % 10 == 0 ? 4u : 0u))
+        {
+            std::cout << "Event " << i << " does not match" << std::endl;
+            return 1;
+        }
+        if (i % 10 == 0)
+        {
+            spi::EventField const * half
+                = event.getFields().find(LOG4CPLUS_TEXT("half"));
+            spi::EventField const * even
+                = event.getFields().find(LOG4CPLUS_TEXT("even"));
+            spi::EventField const * id
+                = event.getFields().find(LOG4CPLUS_TEXT("id"));
+            if (! half || half->getDouble() != i / 2.0
+                || ! even || even->getBool() != (i % 20 == 0)
+                || ! id || id->getUnsigned() != ID_BASE - i)
+            {
+                std::cout << "Fields of event " << i << " do not match"
+                    << std::endl;
+                return 1;
+            }
+        }
+        if (i != 0 && event.getTimestamp() < events[i - 1].getTimestamp())
+        {
+            std::cout << "Timestamps out of order" << std::endl;
+            return 1;
+        }
+    }
+
+    // Row groups without errors are skipped.
+    std::size_t errors = 0;
+    unsigned long skipped = 0;
+    for (int index = MAX_BACKUP_INDEX; index >= 0; --index)
+    {
+        SegmentReader reader(backupName(index));
+        reader.setMinLogLevel(ERROR_LOG_LEVEL);
+        std::vector<spi::InternalLoggingEvent> found;
+        while (reader.readRowGroup(found))
+            ;
+        errors += found.size();
+        skipped += reader.getSkippedRowGroups();
+    }
+    std::cout << errors << " errors, " << skipped << " row groups skipped"
+        << std::endl;
+    if (errors != LOOP_COUNT / 1000 || skipped == 0)
+    {
+        std::cout << "Level filter failed" << std::endl;
+        return 1;
+    }
+
+    // A time range past the events skips everything.
+    SegmentReader reader(backupName(0));
+    helpers::Time const future = events.back().getTimestamp()
+        + helpers::Time(3600, 0);
+    reader.setTimeRange(future, future + helpers::Time(60, 0));
+    std::vector<spi::InternalLoggingEvent> none;
+    while (reader.readRowGroup(none))
+        ;
+    if (! none.empty() || reader.getSkippedRowGroups() == 0)
+    {
+        std::cout << "Time filter failed" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include <log4cplus/logger.h>
+#include <log4cplus/sharedmemoryappender.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#if defined (__linux__)
+#  include <unistd.h>
+#endif
+
+
+using namespace log4cplus;
+
+const int LOOP_COUNT = 1000;
+
+
+// Keeps the messages of the events passed on by the collector.
+class RecordingAppender : public Appender
+{
+public:
+    RecordingAppender() { }
+    virtual ~RecordingAppender() { destructorImpl(); }
+
+    virtual void close() { closed = true; }
+
+    std::vector<tstring> messages;
+
+protected:
+    virtual void append(const spi::InternalLoggingEvent& event)
+    {
+        messages.push_back(event.getMessage());
+    }
+};
+
+
+static tstring
+ringPrefix(char const * name)
+{
+    tostringstream oss;
+    oss << LOG4CPLUS_TEXT("/log4cplus-test-") << name
+        << LOG4CPLUS_TEXT("-");
+#if defined (__linux__)
+    oss << getpid() << LOG4CPLUS_TEXT("-");
+#endif
+    return oss.str();
+}
+
+
+static tstring
+message(int i)
+{
+    tostringstream oss;
+    oss << LOG4CPLUS_TEXT("Entering loop #") << i;
+    return oss.str();
+}
+
+
+int
+main()
+{
+#if defined (__linux__)
+    helpers::LogLog::getLogLog()->setInternalDebugging(true);
+    Logger logger = Logger::getInstance(LOG4CPLUS_TEXT("test.shm"));
+    logger.setLogLevel(TRACE_LOG_LEVEL);
+    logger.setAdditivity(false);
+
+    // All events fit into the ring.
+    tstring const prefix = ringPrefix("all");
+    SharedAppenderPtr shm(new SharedMemoryAppender(prefix, 1024 * 1024));
+    logger.addAppender(shm);
+    for (int i = 0; i < LOOP_COUNT; ++i)
+        LOG4CPLUS_INFO(logger, message(i));
+    logger.removeAllAppenders();
+
+    // The collector passes the events on to the appenders of the same
+    // logger, which must not be the producer here.
+    RecordingAppender* recorder = new RecordingAppender;
+    SharedAppenderPtr recorderPtr(recorder);
+    logger.addAppender(recorderPtr);
+
+    SharedMemoryCollector collector(prefix);
+    if (collector.getRingCount() != 1)
+    {
+        std::cout << "Ring not found" << std::endl;
+        return 1;
+    }
+    std::size_t const drained = collector.drain();
+    std::cout << drained << " events drained" << std::endl;
+    if (drained != static_cast<std::size_t>(LOOP_COUNT)
+        || recorder->messages.size() != drained)
+    {
+        std::cout << "Unexpected number of events" << std::endl;
+        return 1;
+    }
+    for (int i = 0; i < LOOP_COUNT; ++i)
+        if (recorder->messages[i] != message(i))
+        {
+            std::cout << "Unexpected message " << i << std::endl;
+            return 1;
+        }
+
+    // Closing the appender lets the collector remove the ring.
+    shm->close();
+    collector.drain();
+    if (collector.getRingCount() != 0)
+    {
+        std::cout << "Closed ring not removed" << std::endl;
+        return 1;
+    }
+    collector.rescan();
+    if (collector.getRingCount() != 0)
+    {
+        std::cout << "Closed ring still exists" << std::endl;
+        return 1;
+    }
+
+    // A full ring drops events instead of overwriting them.
+    logger.removeAllAppenders();
+    tstring const smallPrefix = ringPrefix("small");
+    SharedMemoryAppender* small = new SharedMemoryAppender(smallPrefix, 1);
+    SharedAppenderPtr smallPtr(small);
+    logger.addAppender(smallPtr);
+    for (int i = 0; i < LOOP_COUNT * 10; ++i)
+        LOG4CPLUS_INFO(logger, message(i));
+    logger.removeAllAppenders();
+    unsigned long const dropped = small->getDroppedCount();
+
+    recorder->messages.clear();
+    logger.addAppender(recorderPtr);
+    SharedMemoryCollector smallCollector(smallPrefix);
+    std::size_t const kept = smallCollector.drain();
+    std::cout << kept << " events kept, " << dropped << " dropped"
+        << std::endl;
+    if (dropped == 0 || kept + dropped
+        != static_cast<std::size_t>(LOOP_COUNT * 10))
+    {
+        std::cout << "Unexpected number of dropped events" << std::endl;
+        return 1;
+    }
+    for (std::size_t i = 0; i < kept; ++i)
+        if (recorder->messages[i] != message(static_cast<int>(i)))
+        {
+            std::cout << "Unexpected message " << i << std::endl;
+            return 1;
+        }
+
+    small->close();
+    smallCollector.drain();
+    logger.removeAllAppenders();
+    if (smallCollector.getRingCount() != 0)
+    {
+        std::cout << "Closed ring not removed" << std::endl;
+        return 1;
+    }
+#endif
+
+    std::cout << "Exiting main()..." << std::endl;
+    return 0;
+}
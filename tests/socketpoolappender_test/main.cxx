@@ -0,0 +1,254 @@
+#include <log4cplus/socketpoolappender.h>
+#include <log4cplus/socketappender.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/helpers/sleep.h>
+#include <log4cplus/helpers/socket.h>
+#include <log4cplus/helpers/socketbuffer.h>
+#include <log4cplus/helpers/stringhelper.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/thread/threads.h>
+#include <iostream>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+
+using namespace log4cplus;
+
+const int SERVER_COUNT = 3;
+const int LOGGER_COUNT = 20;
+const int LOOP_COUNT = 20;
+const unsigned short FIRST_PORT = 9881;
+
+typedef std::vector<std::pair<tstring, tstring> > Frames;
+
+
+// Stands in for a loggingserver.  It reads frames until the appender
+// closes the connection or, with a limit, fails after that many.
+class Receiver : public thread::AbstractThread
+{
+public:
+    Receiver(unsigned short port_, std::size_t limit_)
+        : port(port_), limit(limit_)
+    { }
+
+    virtual void run()
+    {
+        helpers::ServerSocket server(port);
+        helpers::Socket client = server.accept();
+        while ((limit == 0 || frames.size() < limit) && client.isOpen())
+        {
+            helpers::SocketBuffer sizeBuffer(sizeof(unsigned int));
+            if (! client.read(sizeBuffer))
+                break;
+            helpers::SocketBuffer buffer(sizeBuffer.readInt());
+            if (! client.read(buffer))
+                break;
+            spi::InternalLoggingEvent const event
+                = helpers::readFromBuffer(buffer);
+            frames.push_back(std::make_pair(event.getLoggerName(),
+                event.getMessage()));
+        }
+    }
+
+    unsigned short port;
+    std::size_t limit;
+    Frames frames;
+};
+
+typedef helpers::SharedObjectPtr<Receiver> ReceiverPtr;
+
+
+static tstring
+servers()
+{
+    tstring result;
+    for (int i = 0; i < SERVER_COUNT; ++i)
+    {
+        if (i != 0)
+            result += LOG4CPLUS_TEXT(",");
+        result += LOG4CPLUS_TEXT("localhost:")
+            + helpers::convertIntegerToString(FIRST_PORT + i);
+    }
+    return result;
+}
+
+
+static tstring
+loggerName(int i)
+{
+    return LOG4CPLUS_TEXT("test.pool.logger")
+        + helpers::convertIntegerToString(i);
+}
+
+
+static void
+logEvents(SocketPoolAppender & pool, bool slowly)
+{
+    for (int n = 0; n < LOOP_COUNT; ++n)
+        for (int i = 0; i < LOGGER_COUNT; ++i)
+        {
+            spi::InternalLoggingEvent const event(loggerName(i),
+                INFO_LOG_LEVEL, helpers::convertIntegerToString(n),
+                __FILE__, __LINE__);
+            pool.doAppend(event);
+            if (slowly)
+                helpers::sleepmillis(1);
+        }
+}
+
+
+static std::vector<ReceiverPtr>
+startReceivers(std::size_t limited, std::size_t limit)
+{
+    std::vector<ReceiverPtr> receivers;
+    for (int i = 0; i < SERVER_COUNT; ++i)
+    {
+        receivers.push_back(ReceiverPtr(new Receiver(
+            static_cast<unsigned short>(FIRST_PORT + i),
+            static_cast<std::size_t>(i) == limited ? limit : 0)));
+        receivers.back()->start();
+    }
+    helpers::sleepmillis(200);
+    return receivers;
+}
+
+
+//! Maps each logger to the receivers its events arrived at.
+static std::map<tstring, std::set<int> >
+placement(std::vector<ReceiverPtr> const & receivers, int skip)
+{
+    std::map<tstring, std::set<int> > result;
+    for (int i = 0; i < SERVER_COUNT; ++i)
+    {
+        if (i == skip)
+            continue;
+        Frames const & frames = receivers[i]->frames;
+        for (Frames::const_iterator it = frames.begin();
+             it != frames.end(); ++it)
+            result[it->first].insert(i);
+    }
+    return result;
+}
+
+
+int
+main()
+{
+    helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("Servers"), servers());
+    props.setProperty(LOG4CPLUS_TEXT("RetryDelay"), LOG4CPLUS_TEXT("60000"));
+
+    // All events of a logger go to one server, and the loggers are
+    // spread over the pool.
+    std::vector<ReceiverPtr> receivers = startReceivers(SERVER_COUNT, 0);
+    std::map<tstring, std::set<int> > first;
+    {
+        SocketPoolAppender pool(props);
+        logEvents(pool, false);
+        std::vector<SocketPoolAppender::EndpointStats> const stats
+            = pool.getEndpointStats();
+        pool.close();
+        for (int i = 0; i < SERVER_COUNT; ++i)
+        {
+            receivers[i]->join();
+            std::cout << "Server " << i << ": " << stats[i].sent
+                << " events sent, " << receivers[i]->frames.size()
+                << " received" << std::endl;
+            if (stats[i].sent != receivers[i]->frames.size()
+                || ! stats[i].healthy || stats[i].failovers != 0)
+            {
+                std::cout << "Unexpected server stats" << std::endl;
+                return 1;
+            }
+        }
+    }
+    first = placement(receivers, -1);
+    std::set<int> used;
+    for (std::map<tstring, std::set<int> >::const_iterator it
+             = first.begin(); it != first.end(); ++it)
+    {
+        if (it->second.size() != 1)
+        {
+            std::cout << "Logger split over servers" << std::endl;
+            return 1;
+        }
+        used.insert(*it->second.begin());
+    }
+    if (first.size() != static_cast<std::size_t>(LOGGER_COUNT)
+        || used.size() < 2)
+    {
+        std::cout << "Loggers not spread over the pool" << std::endl;
+        return 1;
+    }
+
+    // The first server fails after a few events.  Its loggers move to
+    // the other servers, each again to a single one, and the loggers of
+    // the other servers stay where they were.
+    int const failed = *used.begin();
+    receivers = startReceivers(failed, 5);
+    {
+        SocketPoolAppender pool(props);
+        logEvents(pool, true);
+        std::vector<SocketPoolAppender::EndpointStats> const stats
+            = pool.getEndpointStats();
+        unsigned long const dropped = pool.getDroppedCount();
+        pool.close();
+        for (int i = 0; i < SERVER_COUNT; ++i)
+            receivers[i]->join();
+
+        std::cout << "Failed server: " << stats[failed].failures
+            << " failures" << std::endl;
+        if (stats[failed].healthy || stats[failed].failures == 0
+            || dropped != 0)
+        {
+            std::cout << "Failure not detected" << std::endl;
+            return 1;
+        }
+        unsigned long failovers = 0;
+        for (int i = 0; i < SERVER_COUNT; ++i)
+            failovers += stats[i].failovers;
+        if (failovers == 0)
+        {
+            std::cout << "No failover" << std::endl;
+            return 1;
+        }
+    }
+
+    std::map<tstring, std::set<int> > const second
+        = placement(receivers, failed);
+    tstring const last = helpers::convertIntegerToString(LOOP_COUNT - 1);
+    for (int i = 0; i < LOGGER_COUNT; ++i)
+    {
+        tstring const name = loggerName(i);
+        std::map<tstring, std::set<int> >::const_iterator const it
+            = second.find(name);
+        if (it == second.end() || it->second.size() != 1)
+        {
+            std::cout << "Logger not on a single live server" << std::endl;
+            return 1;
+        }
+        int const server = *it->second.begin();
+        if (*first[name].begin() != failed
+            && *first[name].begin() != server)
+        {
+            std::cout << "Logger of a live server moved" << std::endl;
+            return 1;
+        }
+
+        Frames const & frames = receivers[server]->frames;
+        bool found = false;
+        for (Frames::const_iterator f = frames.begin(); f != frames.end(); ++f)
+            found = found || (f->first == name && f->second == last);
+        if (! found)
+        {
+            std::cout << "Last event of a logger lost" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "Exiting main()..." << std::endl;
+    return 0;
+}
@@ -61,9 +61,48 @@ private:
 };
 
 
+// Returns the number of failed ThreadPlacement checks.
+static int
+checkPlacement()
+{
+    int failures = 0;
+
+    ThreadPlacement list;
+    if(! list.addCpuList(LOG4CPLUS_TEXT("0-3, 8"))
+       || list.getCpus().size() != 5 || list.getCpus()[4] != 8)
+    {
+        tcout << "FAILED: CPU list 0-3, 8" << endl;
+        ++failures;
+    }
+
+    char const * const bad[] = { "3-1", "0-4294967295",
+        "18446744073709551615", "1,x" };
+    for(size_t i = 0; i != sizeof(bad) / sizeof(bad[0]); ++i) {
+        ThreadPlacement placement;
+        if(placement.addCpuList(LOG4CPLUS_C_STR_TO_TSTRING(bad[i]))
+           || ! placement.getCpus().empty())
+        {
+            tcout << "FAILED: CPU list " << bad[i] << " is accepted" << endl;
+            ++failures;
+        }
+    }
+
+    int const nodes = getNumaNodeCount();
+    tcout << "NUMA nodes: " << nodes << endl;
+    if(nodes < 1) {
+        tcout << "FAILED: NUMA node count" << endl;
+        ++failures;
+    }
+
+    return failures;
+}
+
+
 int
 main() 
 {
+    int failures = checkPlacement();
+
     auto_ptr<SlowObject> globalContainer(new SlowObject());
     global = globalContainer.get();
 
@@ -89,6 +128,11 @@ main()
             threads[i] = new TestThread(s.str());
         }
 
+        // Keep the first thread on the first CPU.
+        ThreadPlacement placement;
+        placement.addCpuList(LOG4CPLUS_TEXT("0"));
+        threads[0]->setPlacement(placement);
+
         for(i=0; i<NUM_THREADS; ++i) {
             threads[i]->start();
         }
@@ -109,7 +153,7 @@ main()
     }
 
     log4cplus::Logger::shutdown();
-    return 0;
+    return failures == 0 ? 0 : 1;
 }
 
 
@@ -1,11 +1,25 @@
 #include <log4cplus/helpers/timehelper.h>
 #include <log4cplus/streams.h>
 #include <iostream>
+#include <cstdlib>
 
 using namespace log4cplus;
 using namespace log4cplus::helpers;
 
 
+#if defined (LOG4CPLUS_HAVE_LOCALTIME_R) && defined (LOG4CPLUS_HAVE_GMTIME_R)
+static bool
+same_tm (tm const & a, tm const & b)
+{
+    return a.tm_year == b.tm_year && a.tm_mon == b.tm_mon
+        && a.tm_mday == b.tm_mday && a.tm_hour == b.tm_hour
+        && a.tm_min == b.tm_min && a.tm_sec == b.tm_sec
+        && a.tm_wday == b.tm_wday && a.tm_yday == b.tm_yday
+        && a.tm_isdst == b.tm_isdst;
+}
+#endif
+
+
 log4cplus::tchar const fmtstr[] =
     LOG4CPLUS_TEXT("%s, %Q%%q%q %%Q %%q=%%%q%%;%%q, %%Q=%Q");
 
@@ -50,6 +64,108 @@ main()
         time = Time (0, 0);
         str = time.getFormattedTime (fmtstr);
         log4cplus::tcout << str << std::endl;
+
+        time = Time (0, 123456);
+        time.nsec (time.nsec () + 789);
+        str = time.getFormattedTime (LOG4CPLUS_TEXT ("%s.%N %Q"));
+        log4cplus::tcout << str << std::endl;
+
+        time.nsec (5);
+        str = time.getFormattedTime (LOG4CPLUS_TEXT ("%s.%N %Q"));
+        log4cplus::tcout << str << std::endl;
+
+        // Compiled formats must agree with getFormattedTime().
+        log4cplus::tchar const * const formats[] = {
+            fmtstr,
+            LOG4CPLUS_TEXT ("%Y-%m-%d %H:%M:%S,%q"),
+            LOG4CPLUS_TEXT ("%F %T.%N %j %e %y %I %D %R %a %b %p %Z %z"),
+            LOG4CPLUS_TEXT ("%%%n%t%Ec%Oy%s%Q%"),
+            LOG4CPLUS_TEXT ("")
+        };
+        for (std::size_t i = 0; i != sizeof (formats) / sizeof (formats[0]);
+            ++i)
+        {
+            Time t (1234567890, 123456);
+            for (int j = 0; j != 100; ++j)
+            {
+                t += Time (86400 * 3 + 3601, 10007);
+                bool const gmt = j % 2 == 0;
+                CompiledTimeFormat const compiled (formats[i], gmt);
+                log4cplus::tstring const expected
+                    = t.getFormattedTime (formats[i], gmt);
+                if (compiled.formatTime (t) != expected)
+                {
+                    log4cplus::tcout << LOG4CPLUS_TEXT ("compiled format ")
+                        << formats[i] << LOG4CPLUS_TEXT (" gave ")
+                        << compiled.formatTime (t)
+                        << LOG4CPLUS_TEXT (" instead of ") << expected
+                        << std::endl;
+                    return 1;
+                }
+            }
+        }
+        log4cplus::tcout << LOG4CPLUS_TEXT ("compiled formats match")
+            << std::endl;
+
+        Time::EventClock const clocks[] = { Time::REALTIME_CLOCK,
+            Time::COARSE_REALTIME_CLOCK, Time::TSC_CLOCK };
+        for (std::size_t i = 0; i != sizeof (clocks) / sizeof (clocks[0]);
+            ++i)
+        {
+            bool const available = Time::setEventClock (clocks[i]);
+            Time const t1 = Time::eventTime ();
+            Time const t2 = Time::eventTime ();
+            log4cplus::tcout << LOG4CPLUS_TEXT ("clock ") << i
+                << (available ? LOG4CPLUS_TEXT (" available")
+                    : LOG4CPLUS_TEXT (" unavailable"))
+                << LOG4CPLUS_TEXT (": ")
+                << t1.getFormattedTime (LOG4CPLUS_TEXT ("%s.%N"))
+                << std::endl;
+            if (t2 < t1 || t1.nsec () >= 1000000000 || t1.nsec () < 0)
+            {
+                log4cplus::tcout << LOG4CPLUS_TEXT ("bad event time")
+                    << std::endl;
+                return 1;
+            }
+        }
+        Time::setEventClock (Time::REALTIME_CLOCK);
+
+#if defined (LOG4CPLUS_HAVE_LOCALTIME_R) && defined (LOG4CPLUS_HAVE_GMTIME_R)
+        // Compare against the C library across DST transitions.
+        char const * const zones[] = { "UTC0", "Europe/Prague",
+            "America/New_York", "Asia/Kolkata", "Australia/Lord_Howe" };
+        for (std::size_t i = 0; i != sizeof (zones) / sizeof (zones[0]);
+            ++i)
+        {
+            // Cache the offset of the previous zone for this hour; it
+            // has to be dropped when TZ changes.
+            time_t const base = 946684800;
+            tm actual;
+            Time (base).localtime (&actual);
+
+            setenv ("TZ", zones[i], 1);
+            tzset ();
+            for (time_t clock = base; clock < base + 366 * 86400;
+                clock += 1799)
+            {
+                tm expected;
+                localtime_r (&clock, &expected);
+                Time (clock).localtime (&actual);
+                bool ok = same_tm (expected, actual);
+                gmtime_r (&clock, &expected);
+                Time (clock).gmtime (&actual);
+                ok = ok && same_tm (expected, actual);
+                if (! ok)
+                {
+                    std::cout << "mismatch in " << zones[i] << " at "
+                        << clock << std::endl;
+                    return 1;
+                }
+            }
+        }
+        log4cplus::tcout << LOG4CPLUS_TEXT ("localtime/gmtime match")
+            << std::endl;
+#endif
     }
     catch(std::exception const & e)
     {